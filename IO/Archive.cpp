@@ -0,0 +1,252 @@
+#define TEKSTORM_BUILD
+#include "Archive.h"
+
+namespace Tekstorm
+{
+	namespace IO
+	{
+		using namespace Tekstorm::Core;
+
+		Archive::Archive()
+		{
+			m_hFile = INVALID_HANDLE_VALUE;
+			m_hMapping = nullptr;
+			m_pView = nullptr;
+			m_nSize = 0;
+			m_pEntries = nullptr;
+			m_pNames = nullptr;
+			m_nEntryCount = 0;
+			m_nNamesSize = 0;
+		}
+
+		///
+		/// Opens and maps the given archive.
+		///
+		Archive::Archive(const std::string &filePath)
+		{
+			m_hFile = INVALID_HANDLE_VALUE;
+			m_hMapping = nullptr;
+			m_pView = nullptr;
+			m_nSize = 0;
+			m_pEntries = nullptr;
+			m_pNames = nullptr;
+			m_nEntryCount = 0;
+			m_nNamesSize = 0;
+			Open(filePath);
+		}
+
+		Archive::~Archive()
+		{
+			Close();
+		}
+
+		///
+		/// Opens and maps the given archive, closing any archive that is already open.
+		///
+		bool Archive::Open(const std::string &filePath)
+		{
+			Close();
+
+			m_hFile = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+				OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, nullptr);
+			if (m_hFile == INVALID_HANDLE_VALUE)
+			{
+#if defined(TEKSTORM_DEBUG)
+				TEKDEBUG_W("Unable to open archive " << filePath);
+#endif
+				return false;
+			}
+
+			LARGE_INTEGER size;
+			if (GetFileSizeEx(m_hFile, &size) == FALSE || size.QuadPart < (LONGLONG)sizeof(ArchiveHeader)
+				|| size.QuadPart > 0x7FFFFFFF)
+			{
+#if defined(TEKSTORM_DEBUG)
+				TEKDEBUG_W("Archive " << filePath << " has an invalid size");
+#endif
+				Close();
+				return false;
+			}
+
+			// the view is backed by the file, not the heap, so it is not charged to the IO budget
+			m_nSize = (uint32_t)size.QuadPart;
+			m_hMapping = CreateFileMappingA(m_hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			if (m_hMapping != nullptr)
+				m_pView = (const char *)MapViewOfFile(m_hMapping, FILE_MAP_READ, 0, 0, 0);
+
+			if (m_pView == nullptr)
+			{
+#if defined(TEKSTORM_DEBUG)
+				TEKDEBUG_W("Unable to map archive " << filePath);
+#endif
+				Close();
+				return false;
+			}
+
+			if (!Validate())
+			{
+#if defined(TEKSTORM_DEBUG)
+				TEKDEBUG_W("Archive " << filePath << " is not a valid .tekpak file");
+#endif
+				Close();
+				return false;
+			}
+
+			return true;
+		}
+
+		///
+		/// Checks the header and table of contents of the mapped file.
+		///
+		bool Archive::Validate()
+		{
+			const ArchiveHeader *pHeader = (const ArchiveHeader *)m_pView;
+			if (pHeader->magic != ArchiveMagic || pHeader->version != ArchiveVersion)
+				return false;
+
+			uint64_t tableEnd = sizeof(ArchiveHeader) + (uint64_t)pHeader->entryCount * sizeof(ArchiveEntry);
+			uint64_t namesEnd = tableEnd + pHeader->namesSize;
+			if (namesEnd > m_nSize || (pHeader->namesSize > 0 && m_pView[namesEnd - 1] != 0))
+				return false;
+
+			m_pEntries = (const ArchiveEntry *)(m_pView + sizeof(ArchiveHeader));
+			m_pNames = m_pView + tableEnd;
+			m_nEntryCount = pHeader->entryCount;
+			m_nNamesSize = pHeader->namesSize;
+
+			for (uint32_t i = 0; i < m_nEntryCount; i++)
+			{
+				const ArchiveEntry &entry = m_pEntries[i];
+				if (entry.nameOffset >= m_nNamesSize || (entry.offset % ArchiveAlignment) != 0
+					|| (uint64_t)entry.offset + entry.size > m_nSize)
+					return false;
+
+				if (entry.compression > TEKPAK_COMPRESSION_ZSTD
+					|| (entry.compression == TEKPAK_COMPRESSION_NONE && entry.size != entry.unpackedSize))
+					return false;
+
+				// the binary search relies on the order
+				if (i > 0 && entry.hash < m_pEntries[i - 1].hash)
+					return false;
+			}
+
+			return true;
+		}
+
+		///
+		/// Unmaps and closes the archive.
+		///
+		void Archive::Close()
+		{
+			if (m_pView != nullptr)
+				UnmapViewOfFile(m_pView);
+
+			if (m_hMapping != nullptr)
+				CloseHandle(m_hMapping);
+
+			if (m_hFile != INVALID_HANDLE_VALUE)
+				CloseHandle(m_hFile);
+
+			m_hFile = INVALID_HANDLE_VALUE;
+			m_hMapping = nullptr;
+			m_pView = nullptr;
+			m_nSize = 0;
+			m_pEntries = nullptr;
+			m_pNames = nullptr;
+			m_nEntryCount = 0;
+			m_nNamesSize = 0;
+		}
+
+		///
+		/// Returns whether or not an archive is open.
+		///
+		bool Archive::IsOpen() const
+		{
+			return (m_pView != nullptr);
+		}
+
+		///
+		/// Gets the number of entries.
+		///
+		int32_t Archive::GetEntryCount() const
+		{
+			return (int32_t)m_nEntryCount;
+		}
+
+		///
+		/// Gets the first entry with a hash, or the entry count if there is none.
+		///
+		uint32_t Archive::FindFirst(uint32_t hash) const
+		{
+			uint32_t low = 0;
+			uint32_t high = m_nEntryCount;
+			while (low < high)
+			{
+				uint32_t middle = low + (high - low) / 2;
+				if (m_pEntries[middle].hash < hash)
+					low = middle + 1;
+				else
+					high = middle;
+			}
+
+			return (low < m_nEntryCount && m_pEntries[low].hash == hash) ? low : m_nEntryCount;
+		}
+
+		///
+		/// Finds an entry by name.
+		///
+		int32_t Archive::Find(const StringRef &name) const
+		{
+			uint32_t hash = HashFnv1aBytes(name.GetData(), name.GetLength());
+			for (uint32_t i = FindFirst(hash); i < m_nEntryCount && m_pEntries[i].hash == hash; i++)
+			{
+				if (StringRef(m_pNames + m_pEntries[i].nameOffset) == name)
+					return (int32_t)i;
+			}
+
+			return -1;
+		}
+
+		///
+		/// Finds an entry by id.
+		///
+		int32_t Archive::Find(StringId id) const
+		{
+			const char *pName = id.GetString();
+			if (pName != nullptr)
+				return Find(StringRef(pName));
+
+			uint32_t index = FindFirst(id.GetValue());
+			return (index < m_nEntryCount) ? (int32_t)index : -1;
+		}
+
+		///
+		/// Gets an entry, or nullptr if the index is out of range.
+		///
+		const ArchiveEntry *Archive::GetEntry(int32_t index) const
+		{
+			if (index < 0 || (uint32_t)index >= m_nEntryCount)
+				return nullptr;
+
+			return &m_pEntries[index];
+		}
+
+		///
+		/// Gets the name of an entry.
+		///
+		const char *Archive::GetName(int32_t index) const
+		{
+			const ArchiveEntry *pEntry = GetEntry(index);
+			return (pEntry != nullptr) ? m_pNames + pEntry->nameOffset : nullptr;
+		}
+
+		///
+		/// Gets the stored data of an entry, inside the mapping.
+		///
+		const char *Archive::GetData(int32_t index) const
+		{
+			const ArchiveEntry *pEntry = GetEntry(index);
+			return (pEntry != nullptr) ? m_pView + pEntry->offset : nullptr;
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,188 @@
+#pragma once
+#ifndef _TEKSTORM_ARCHIVE_H
+#define _TEKSTORM_ARCHIVE_H
+#include "../tekconfig.h"
+#include "../core/StringRef.h"
+#include "../core/StringId.h"
+
+namespace Tekstorm
+{
+	namespace IO
+	{
+		///
+		/// How an archive entry is stored. Compressed entries hold a CompressStream
+		/// stream of the matching CompressionCodec.
+		///
+		enum ArchiveCompression
+		{
+			TEKPAK_COMPRESSION_NONE = 0,
+			TEKPAK_COMPRESSION_LZ4 = 1,
+			TEKPAK_COMPRESSION_ZSTD = 2
+		};
+
+		///
+		/// The header at the start of a .tekpak file.
+		///
+		struct ArchiveHeader
+		{
+			// ArchiveMagic.
+			uint32_t magic;
+
+			// ArchiveVersion.
+			uint16_t version;
+			uint16_t reserved;
+
+			// The number of entries in the table of contents, which follows the header.
+			uint32_t entryCount;
+
+			// The size of the name table, which follows the table of contents.
+			uint32_t namesSize;
+		};
+
+		///
+		/// A table of contents entry. Entries are sorted by hash, then by name.
+		///
+		struct ArchiveEntry
+		{
+			// The HashFnv1a() of the name, so a StringId of the name finds the entry.
+			uint32_t hash;
+
+			// The offset of the name in the name table; names are null-terminated.
+			uint32_t nameOffset;
+
+			// The offset of the stored data from the start of the file, a multiple of ArchiveAlignment.
+			uint32_t offset;
+
+			// The size of the stored data.
+			uint32_t size;
+
+			// The size of the data once decompressed; equal to size when stored as is.
+			uint32_t unpackedSize;
+
+			// An ArchiveCompression.
+			uint32_t compression;
+		};
+
+		///
+		/// "TPAK", read as a little-endian integer.
+		///
+		const uint32_t ArchiveMagic = 0x4B415054;
+		const uint16_t ArchiveVersion = 1;
+
+		///
+		/// Entry data is aligned to pages, so every entry can be mapped on its own.
+		///
+		const uint32_t ArchiveAlignment = 4096;
+
+		///
+		/// A read-only .tekpak archive, mapped into memory.
+		///
+		/// A .tekpak file is the ArchiveHeader, the table of contents, the name table,
+		/// then the entry data, each entry starting on an ArchiveAlignment boundary.
+		/// Opening an archive maps the whole file and checks the table; finding an
+		/// entry is a binary search on the name's hash. Uncompressed entries can be
+		/// read straight from the mapping with GetData(), without a copy; compressed
+		/// ones are read through a DecompressStream (see ArchiveStream).
+		///
+		/// The mapping is read-only, so any thread may read an open archive. Pointers
+		/// into it stay valid until Close().
+		///
+		class TEKAPI Archive
+		{
+		protected:
+			HANDLE m_hFile;
+			HANDLE m_hMapping;
+
+			///
+			/// The mapped file.
+			///
+			const char *m_pView;
+			uint32_t m_nSize;
+
+			///
+			/// The table of contents and name table, inside the mapping.
+			///
+			const ArchiveEntry *m_pEntries;
+			const char *m_pNames;
+			uint32_t m_nEntryCount;
+			uint32_t m_nNamesSize;
+
+			///
+			/// Archives are not copyable.
+			///
+			Archive(const Archive &other);
+			Archive &operator=(const Archive &other);
+
+			///
+			/// Checks the header and table of contents of the mapped file.
+			///
+			bool Validate();
+
+			///
+			/// Gets the first entry with a hash, or the entry count if there is none.
+			///
+			uint32_t FindFirst(uint32_t hash) const;
+
+		public:
+			Archive();
+
+			///
+			/// Opens and maps the given archive.
+			///
+			Archive(const std::string &filePath);
+
+			~Archive();
+
+			///
+			/// Opens and maps the given archive, closing any archive that is already open.
+			///
+			bool Open(const std::string &filePath);
+
+			///
+			/// Unmaps and closes the archive.
+			///
+			void Close();
+
+			///
+			/// Returns whether or not an archive is open.
+			///
+			bool IsOpen() const;
+
+			///
+			/// Gets the number of entries.
+			///
+			int32_t GetEntryCount() const;
+
+			///
+			/// Finds an entry by name. Returns its index, or -1.
+			///
+			int32_t Find(const Core::StringRef &name) const;
+
+			///
+			/// Finds an entry by id. If the id's name was interned it is compared too,
+			/// otherwise the first entry with the id's hash is returned. Returns -1 if
+			/// there is none.
+			///
+			int32_t Find(Core::StringId id) const;
+
+			///
+			/// Gets an entry, or nullptr if the index is out of range.
+			///
+			const ArchiveEntry *GetEntry(int32_t index) const;
+
+			///
+			/// Gets the name of an entry.
+			///
+			const char *GetName(int32_t index) const;
+
+			///
+			/// Gets the stored data of an entry, inside the mapping. The data is the
+			/// entry's contents when it is not compressed, and a CompressStream stream
+			/// otherwise.
+			///
+			const char *GetData(int32_t index) const;
+		};
+	}
+}
+
+#endif /* _TEKSTORM_ARCHIVE_H */
\ No newline at end of file
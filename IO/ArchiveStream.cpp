@@ -0,0 +1,178 @@
+#define TEKSTORM_BUILD
+#include "ArchiveStream.h"
+
+namespace Tekstorm
+{
+	namespace IO
+	{
+		using namespace Tekstorm::Core;
+
+		ArchiveStream::ArchiveStream()
+		{
+			m_pData = nullptr;
+			m_nLength = 0;
+			m_nCurrentIndex = 0;
+		}
+
+		///
+		/// Opens the named entry of an archive.
+		///
+		ArchiveStream::ArchiveStream(const Archive &archive, const StringRef &name)
+		{
+			m_pData = nullptr;
+			m_nLength = 0;
+			m_nCurrentIndex = 0;
+			Open(archive, name);
+		}
+
+		///
+		/// Opens an entry of an archive by index, closing any entry that is already open.
+		///
+		bool ArchiveStream::Open(const Archive &archive, int32_t index)
+		{
+			Close();
+
+			const ArchiveEntry *pEntry = archive.GetEntry(index);
+			if (pEntry == nullptr)
+				return false;
+
+			if (pEntry->compression != TEKPAK_COMPRESSION_NONE)
+			{
+#if defined(TEKSTORM_DEBUG)
+				TEKDEBUG_W("Archive entry " << archive.GetName(index) << " is compressed");
+#endif
+				return false;
+			}
+
+			return OpenStored(archive, index);
+		}
+
+		///
+		/// Opens the stored bytes of an entry, compressed or not.
+		///
+		bool ArchiveStream::OpenStored(const Archive &archive, int32_t index)
+		{
+			Close();
+
+			const ArchiveEntry *pEntry = archive.GetEntry(index);
+			if (pEntry == nullptr)
+				return false;
+
+			m_pData = archive.GetData(index);
+			m_nLength = (int32_t)pEntry->size;
+			return true;
+		}
+
+		///
+		/// Opens the named entry of an archive, closing any entry that is already open.
+		///
+		bool ArchiveStream::Open(const Archive &archive, const StringRef &name)
+		{
+			int32_t index = archive.Find(name);
+			if (index < 0)
+			{
+				Close();
+				return false;
+			}
+
+			return Open(archive, index);
+		}
+
+		///
+		/// Returns whether or not an entry is open.
+		///
+		bool ArchiveStream::IsOpen() const
+		{
+			return (m_pData != nullptr);
+		}
+
+		///
+		/// Reads a single byte from the stream, and advances the
+		/// current stream pointer forward by 1 byte.
+		///
+		int32_t ArchiveStream::ReadByte()
+		{
+			if (m_nCurrentIndex >= m_nLength)
+				return -1;
+
+			return (uint8_t)m_pData[m_nCurrentIndex++];
+		}
+
+		///
+		/// Reads an array of bytes from the stream, and advances the
+		/// current stream pointer forward by the number of bytes
+		/// that were actually read.
+		///
+		int32_t ArchiveStream::Read(char *pDestination, int32_t count, int32_t offset)
+		{
+			int32_t available = m_nLength - m_nCurrentIndex;
+			if (count > available)
+				count = available;
+
+			if (count <= 0)
+				return 0;
+
+			memcpy(&pDestination[offset], &m_pData[m_nCurrentIndex], count);
+			m_nCurrentIndex += count;
+			return count;
+		}
+
+		///
+		/// Archive entries are read-only; does nothing.
+		///
+		void ArchiveStream::WriteByte(int8_t value)
+		{
+#if defined(TEKSTORM_DEBUG)
+			TEKDEBUG_W("Cannot write to an archive entry.");
+#endif
+		}
+
+		///
+		/// Archive entries are read-only; writes nothing and returns 0.
+		///
+		int32_t ArchiveStream::Write(const char *pSource, int32_t count, int32_t offset)
+		{
+#if defined(TEKSTORM_DEBUG)
+			TEKDEBUG_W("Cannot write to an archive entry.");
+#endif
+			return 0;
+		}
+
+		///
+		/// Flushes this stream.
+		///
+		void ArchiveStream::Flush()
+		{
+			// stream is read-only so there's nothing to flush
+		}
+
+		///
+		/// Closes this stream.
+		///
+		void ArchiveStream::Close()
+		{
+			m_pData = nullptr;
+			m_nLength = 0;
+			m_nCurrentIndex = 0;
+		}
+
+		///
+		/// Sets the current index into the stream.
+		///
+		void ArchiveStream::Seek(int32_t value, int32_t offset)
+		{
+			int32_t index = value;
+			if (offset == SEEK_END)
+				index = m_nLength + value;
+			else if (offset == SEEK_CUR)
+				index = m_nCurrentIndex + value;
+
+			if (index < 0)
+				index = 0;
+			else if (index > m_nLength)
+				index = m_nLength;
+
+			m_nCurrentIndex = index;
+		}
+	}
+}
\ No newline at end of file
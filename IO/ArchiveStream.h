@@ -0,0 +1,134 @@
+#pragma once
+#ifndef _TEKSTORM_ARCHIVESTREAM_H
+#define _TEKSTORM_ARCHIVESTREAM_H
+#include "../tekconfig.h"
+#include "IStream.h"
+#include "Archive.h"
+
+namespace Tekstorm
+{
+	namespace IO
+	{
+		///
+		/// A read-only stream over an uncompressed archive entry. Reads copy straight
+		/// out of the archive's mapping; GetData() gives the mapped bytes themselves.
+		///
+		/// OpenStored() opens the stored bytes of any entry, so a compressed one can
+		/// be read through a DecompressStream over this stream.
+		///
+		/// The archive must stay open while the stream is in use.
+		///
+		class TEKAPI ArchiveStream : public IStream
+		{
+		protected:
+			// The entry's bytes, inside the archive's mapping.
+			const char *m_pData;
+
+			// The size, in bytes, of the entry.
+			int32_t m_nLength;
+
+			// The current index into the entry.
+			int32_t m_nCurrentIndex;
+
+		public:
+			ArchiveStream();
+
+			///
+			/// Opens the named entry of an archive.
+			///
+			ArchiveStream(const Archive &archive, const Core::StringRef &name);
+
+			///
+			/// Opens an entry of an archive by index, closing any entry that is already open.
+			/// Returns false if there is no such entry or it is compressed.
+			///
+			virtual bool Open(const Archive &archive, int32_t index);
+
+			///
+			/// Opens the named entry of an archive, closing any entry that is already open.
+			///
+			virtual bool Open(const Archive &archive, const Core::StringRef &name);
+
+			///
+			/// Opens the stored bytes of an entry, compressed or not, closing any entry
+			/// that is already open.
+			///
+			virtual bool OpenStored(const Archive &archive, int32_t index);
+
+			///
+			/// Returns whether or not an entry is open.
+			///
+			virtual bool IsOpen() const;
+
+			///
+			/// Gets the entry's bytes, inside the archive's mapping.
+			///
+			const char *GetData() const { return m_pData; }
+
+			///
+			/// Returns whether or not this stream can be read from.
+			///
+			virtual bool CanRead() const { return true; }
+
+			///
+			/// Returns whether or not this stream can be written to.
+			///
+			virtual bool CanWrite() const { return false; }
+
+			///
+			/// Returns whether or not this stream can seek.
+			///
+			virtual bool CanSeek() const { return true; }
+
+			///
+			/// Returns the length, in bytes, of this stream. If
+			/// the length is not supported, the result is -1.
+			///
+			virtual int32_t GetLength() const { return m_nLength; }
+
+			///
+			/// Reads a single byte from the stream, and advances the
+			/// current stream pointer forward by 1 byte.
+			/// The result is the read byte, or -1 at the end of the entry.
+			///
+			virtual int32_t ReadByte();
+
+			///
+			/// Reads an array of bytes from the stream, and advances the
+			/// current stream pointer forward by the number of bytes
+			/// that were actually read.
+			/// The return value is the number of bytes that were actually read.
+			/// count - the number of bytes to read from the stream
+			/// offset - the offset into the destination buffer to begin reading to
+			///
+			virtual int32_t Read(char *pDestination, int32_t count, int32_t offset = 0);
+
+			///
+			/// Archive entries are read-only; does nothing.
+			///
+			virtual void WriteByte(int8_t value);
+
+			///
+			/// Archive entries are read-only; writes nothing and returns 0.
+			///
+			virtual int32_t Write(const char *pSource, int32_t count, int32_t offset = 0);
+
+			///
+			/// Flushes this stream.
+			///
+			virtual void Flush();
+
+			///
+			/// Closes this stream.
+			///
+			virtual void Close();
+
+			///
+			/// Sets the current index into the stream.
+			///
+			virtual void Seek(int32_t value, int32_t offset = SEEK_SET);
+		};
+	}
+}
+
+#endif /* _TEKSTORM_ARCHIVESTREAM_H */
\ No newline at end of file
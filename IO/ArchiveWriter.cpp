@@ -0,0 +1,265 @@
+#define TEKSTORM_BUILD
+#include "ArchiveWriter.h"
+#include "FileStream.h"
+#include "MemoryStream.h"
+#include "CompressStream.h"
+#include <algorithm>
+
+namespace Tekstorm
+{
+	namespace IO
+	{
+		using namespace Tekstorm::Core;
+
+		///
+		/// Orders sources as the table of contents is: by hash, then by name.
+		///
+		struct CompareSources
+		{
+			const std::vector<ArchiveSource> *pSources;
+
+			bool operator()(size_t a, size_t b) const
+			{
+				const ArchiveSource &left = (*pSources)[a];
+				const ArchiveSource &right = (*pSources)[b];
+				if (left.hash != right.hash)
+					return left.hash < right.hash;
+
+				return left.name < right.name;
+			}
+		};
+
+		///
+		/// Writes zeros up to the next multiple of ArchiveAlignment.
+		///
+		static bool WritePadding(FileStream &stream, uint64_t &position)
+		{
+			static const char s_zeros[ArchiveAlignment] = { 0 };
+
+			int32_t padding = (int32_t)((ArchiveAlignment - position % ArchiveAlignment) % ArchiveAlignment);
+			if (padding > 0 && stream.Write(s_zeros, padding) != padding)
+				return false;
+
+			position += padding;
+			return true;
+		}
+
+		///
+		/// Compresses contents into a CompressStream stream. Returns the stored size, or
+		/// -1 if the codec is not supported.
+		///
+		static int32_t CompressContents(const std::vector<char> &contents, CompressionCodec codec, int32_t level,
+			JobSystem *pJobs, std::vector<char> &compressed)
+		{
+			if (!Compression::IsSupported(codec))
+			{
+#if defined(TEKSTORM_DEBUG)
+				TEKDEBUG_W("ArchiveWriter: the codec is not supported by this build");
+#endif
+				return -1;
+			}
+
+			int32_t size = (int32_t)contents.size();
+			int32_t blocks = (size + CompressionDefaultBlockSize - 1) / CompressionDefaultBlockSize;
+			int32_t bound = Compression::GetBound(codec, CompressionDefaultBlockSize);
+			compressed.resize(sizeof(CompressionHeader) + blocks * (sizeof(CompressionBlockHeader) + bound)
+				+ sizeof(CompressionBlockHeader));
+
+			MemoryStream memory(&compressed[0], (int32_t)compressed.size());
+			CompressStream compress(&memory, codec, level, CompressionDefaultBlockSize, pJobs);
+			compress.Write(&contents[0], size);
+			compress.Close();
+			return memory.GetPosition();
+		}
+
+		ArchiveWriter::ArchiveWriter(JobSystem *pJobs)
+		{
+			m_pJobs = pJobs;
+			m_nLevel = 0;
+		}
+
+		///
+		/// Sets the level zstd-compressed entries use.
+		///
+		void ArchiveWriter::SetLevel(int32_t level)
+		{
+			m_nLevel = level;
+		}
+
+		///
+		/// Adds an entry without contents and returns it.
+		///
+		ArchiveSource &ArchiveWriter::AddSource(const std::string &name, ArchiveCompression compression)
+		{
+			m_sources.push_back(ArchiveSource());
+
+			ArchiveSource &source = m_sources.back();
+			source.name = name;
+			std::replace(source.name.begin(), source.name.end(), '\\', '/');
+			source.hash = HashFnv1aBytes(source.name.c_str(), source.name.length());
+			source.compression = compression;
+			return source;
+		}
+
+		///
+		/// Adds an entry whose contents are read from a file when the archive is written.
+		///
+		void ArchiveWriter::AddFile(const std::string &name, const std::string &filePath, ArchiveCompression compression)
+		{
+			AddSource(name, compression).filePath = filePath;
+		}
+
+		///
+		/// Adds an entry with a copy of the given contents.
+		///
+		void ArchiveWriter::AddData(const std::string &name, const char *pData, int32_t size, ArchiveCompression compression)
+		{
+			AddSource(name, compression).data.assign(pData, pData + size);
+		}
+
+		///
+		/// Gets the number of entries added.
+		///
+		int32_t ArchiveWriter::GetCount() const
+		{
+			return (int32_t)m_sources.size();
+		}
+
+		///
+		/// Removes every entry.
+		///
+		void ArchiveWriter::Clear()
+		{
+			m_sources.clear();
+		}
+
+		///
+		/// Writes the archive.
+		///
+		bool ArchiveWriter::Write(const std::string &filePath)
+		{
+			std::vector<size_t> order(m_sources.size());
+			for (size_t i = 0; i < order.size(); i++)
+				order[i] = i;
+
+			CompareSources compare = { &m_sources };
+			std::sort(order.begin(), order.end(), compare);
+
+			// the table of contents and name table; data offsets are filled in as it is written
+			std::vector<ArchiveEntry> entries(order.size());
+			std::string names;
+			for (size_t i = 0; i < order.size(); i++)
+			{
+				const ArchiveSource &source = m_sources[order[i]];
+				if (i > 0 && source.name == m_sources[order[i - 1]].name)
+				{
+#if defined(TEKSTORM_DEBUG)
+					TEKDEBUG_W("Archive entry " << source.name << " was added twice");
+#endif
+					return false;
+				}
+
+				ArchiveEntry &entry = entries[i];
+				memset(&entry, 0, sizeof(ArchiveEntry));
+				entry.hash = source.hash;
+				entry.nameOffset = (uint32_t)names.size();
+				entry.compression = TEKPAK_COMPRESSION_NONE;
+
+				names.append(source.name);
+				names.push_back(0);
+			}
+
+			ArchiveHeader header;
+			memset(&header, 0, sizeof(ArchiveHeader));
+			header.magic = ArchiveMagic;
+			header.version = ArchiveVersion;
+			header.entryCount = (uint32_t)entries.size();
+			header.namesSize = (uint32_t)names.size();
+
+			FileStream stream(filePath, "wb");
+			if (!stream.IsOpen())
+				return false;
+
+			int32_t tableSize = (int32_t)(entries.size() * sizeof(ArchiveEntry));
+			stream.Write((const char *)&header, sizeof(ArchiveHeader));
+			if (tableSize > 0)
+				stream.Write((const char *)&entries[0], tableSize);
+			stream.Write(names.data(), (int32_t)names.size());
+
+			uint64_t position = sizeof(ArchiveHeader) + tableSize + names.size();
+			if (!WritePadding(stream, position))
+				return false;
+
+			std::vector<char> contents;
+			std::vector<char> compressed;
+			for (size_t i = 0; i < order.size(); i++)
+			{
+				const ArchiveSource &source = m_sources[order[i]];
+				const std::vector<char> *pContents = &source.data;
+				if (!source.filePath.empty())
+				{
+					FileStream input(source.filePath, "rb");
+					int32_t length = input.GetLength();
+					if (length < 0)
+						return false;
+
+					contents.resize(length);
+					if (length > 0 && input.Read(&contents[0], length) != length)
+					{
+#if defined(TEKSTORM_DEBUG)
+						TEKDEBUG_W("Unable to read " << source.filePath);
+#endif
+						return false;
+					}
+
+					pContents = &contents;
+				}
+
+				int32_t unpackedSize = (int32_t)pContents->size();
+				int32_t size = unpackedSize;
+				const char *pStored = (size > 0) ? &(*pContents)[0] : nullptr;
+				if (source.compression != TEKPAK_COMPRESSION_NONE && size > 0)
+				{
+					int32_t compressedSize = CompressContents(*pContents, (CompressionCodec)source.compression, m_nLevel,
+						m_pJobs, compressed);
+					if (compressedSize < 0)
+						return false;
+
+					if (compressedSize < size)
+					{
+						entries[i].compression = source.compression;
+						pStored = &compressed[0];
+						size = compressedSize;
+					}
+				}
+
+				if (position + size > 0x7FFFFFFF)
+				{
+#if defined(TEKSTORM_DEBUG)
+					TEKDEBUG_W("Archive " << filePath << " would exceed 2 GB");
+#endif
+					return false;
+				}
+
+				entries[i].offset = (uint32_t)position;
+				entries[i].size = (uint32_t)size;
+				entries[i].unpackedSize = (uint32_t)unpackedSize;
+
+				if (size > 0 && stream.Write(pStored, size) != size)
+					return false;
+
+				position += size;
+				if (!WritePadding(stream, position))
+					return false;
+			}
+
+			// now that the offsets are known
+			stream.Seek(sizeof(ArchiveHeader), SEEK_SET);
+			if (tableSize > 0 && stream.Write((const char *)&entries[0], tableSize) != tableSize)
+				return false;
+
+			stream.Close();
+			return true;
+		}
+	}
+}
\ No newline at end of file
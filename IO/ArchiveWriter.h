@@ -0,0 +1,106 @@
+#pragma once
+#ifndef _TEKSTORM_ARCHIVEWRITER_H
+#define _TEKSTORM_ARCHIVEWRITER_H
+#include "../tekconfig.h"
+#include "Archive.h"
+#include "../core/JobSystem.h"
+
+namespace Tekstorm
+{
+	namespace IO
+	{
+		///
+		/// An entry to be written by ArchiveWriter.
+		///
+		struct ArchiveSource
+		{
+			// The entry name, with '/' separators.
+			std::string name;
+
+			// The file to read the contents from, or empty if they are in data.
+			std::string filePath;
+
+			// The contents, when added from memory.
+			std::vector<char> data;
+
+			// The HashFnv1a() of the name.
+			uint32_t hash;
+
+			// How to store the contents.
+			ArchiveCompression compression;
+		};
+
+		///
+		/// Builds a .tekpak archive (see Archive).
+		///
+		/// Entries are collected with AddFile() and AddData(), then Write() lays out
+		/// the table of contents and streams the contents into the archive one entry
+		/// at a time, so only one file is held in memory at once.
+		///
+		/// Entries added with a compression are compressed through a CompressStream,
+		/// on the job system's workers if there is one, and stored compressed only if
+		/// that makes them smaller.
+		///
+		class TEKAPI ArchiveWriter
+		{
+		protected:
+			std::vector<ArchiveSource> m_sources;
+
+			// Compresses entries in parallel, or nullptr to compress on the calling thread.
+			Core::JobSystem *m_pJobs;
+
+			// The zstd level (0 = its default).
+			int32_t m_nLevel;
+
+			///
+			/// Writers are not copyable.
+			///
+			ArchiveWriter(const ArchiveWriter &other);
+			ArchiveWriter &operator=(const ArchiveWriter &other);
+
+			///
+			/// Adds an entry without contents and returns it.
+			///
+			ArchiveSource &AddSource(const std::string &name, ArchiveCompression compression);
+
+		public:
+			ArchiveWriter(Core::JobSystem *pJobs = nullptr);
+
+			///
+			/// Sets the level zstd-compressed entries use (0 = its default).
+			///
+			void SetLevel(int32_t level);
+
+			///
+			/// Adds an entry whose contents are read from a file when the archive is written.
+			/// Backslashes in the name are replaced by '/'.
+			///
+			void AddFile(const std::string &name, const std::string &filePath,
+				ArchiveCompression compression = TEKPAK_COMPRESSION_NONE);
+
+			///
+			/// Adds an entry with a copy of the given contents.
+			///
+			void AddData(const std::string &name, const char *pData, int32_t size,
+				ArchiveCompression compression = TEKPAK_COMPRESSION_NONE);
+
+			///
+			/// Gets the number of entries added.
+			///
+			int32_t GetCount() const;
+
+			///
+			/// Removes every entry.
+			///
+			void Clear();
+
+			///
+			/// Writes the archive. Returns false if a source cannot be read, two entries
+			/// share a name or the archive would exceed 2 GB.
+			///
+			bool Write(const std::string &filePath);
+		};
+	}
+}
+
+#endif /* _TEKSTORM_ARCHIVEWRITER_H */
\ No newline at end of file
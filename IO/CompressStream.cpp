@@ -0,0 +1,215 @@
+#define TEKSTORM_BUILD
+#include "CompressStream.h"
+#include "../core/MemoryTracker.h"
+
+namespace Tekstorm
+{
+	namespace IO
+	{
+		using namespace Tekstorm::Core;
+
+		///
+		/// Compresses into pStream.
+		///
+		CompressStream::CompressStream(IStream *pStream, CompressionCodec codec, int32_t level, int32_t blockSize, JobSystem *pJobs)
+		{
+			if (blockSize < CompressionMinBlockSize)
+				blockSize = CompressionMinBlockSize;
+			else if (blockSize > CompressionMaxBlockSize)
+				blockSize = CompressionMaxBlockSize;
+
+			m_pStream = pStream;
+			m_pJobs = pJobs;
+			m_codec = codec;
+			m_nLevel = level;
+			m_nBlockSize = blockSize;
+			m_nBatchBlocks = (pJobs != nullptr) ? pJobs->GetThreadCount() * 2 : 1;
+			m_nInputLength = 0;
+			m_nBound = Compression::GetBound(codec, blockSize);
+			m_bStarted = false;
+			m_bClosed = false;
+
+#if defined(TEKSTORM_DEBUG)
+			if (!Compression::IsSupported(codec))
+			{
+				TEKDEBUG_W("CompressStream: the codec is not supported by this build");
+			}
+#endif
+
+			m_input.resize((size_t)m_nBatchBlocks * blockSize);
+			m_output.resize((size_t)m_nBatchBlocks * m_nBound);
+			m_sizes.resize(m_nBatchBlocks);
+			TEKMEM_ALLOC(TEKMEMTAG_IO, m_input.capacity() + m_output.capacity() + m_sizes.capacity() * sizeof(int32_t));
+		}
+
+		CompressStream::~CompressStream()
+		{
+			Close();
+			TEKMEM_FREE(TEKMEMTAG_IO, m_input.capacity() + m_output.capacity() + m_sizes.capacity() * sizeof(int32_t));
+		}
+
+		///
+		/// Compresses the blocks [begin, end) of the batch.
+		///
+		void CompressStream::CompressBlocks(void *pData, int32_t begin, int32_t end)
+		{
+			CompressStream *pStream = (CompressStream *)pData;
+			for (int32_t i = begin; i < end; i++)
+			{
+				int32_t start = i * pStream->m_nBlockSize;
+				int32_t rawSize = pStream->m_nInputLength - start;
+				if (rawSize > pStream->m_nBlockSize)
+					rawSize = pStream->m_nBlockSize;
+
+				pStream->m_sizes[i] = Compression::Compress(pStream->m_codec, pStream->m_nLevel, &pStream->m_input[start],
+					rawSize, &pStream->m_output[(size_t)i * pStream->m_nBound], pStream->m_nBound);
+			}
+		}
+
+		///
+		/// Compresses the buffered input and writes it out.
+		///
+		void CompressStream::WriteBlocks()
+		{
+			if (!m_bStarted)
+			{
+				CompressionHeader header;
+				header.magic = CompressionMagic;
+				header.codec = (uint16_t)m_codec;
+				header.reserved = 0;
+				header.blockSize = (uint32_t)m_nBlockSize;
+				m_pStream->Write((const char *)&header, sizeof(CompressionHeader));
+				m_bStarted = true;
+			}
+
+			if (m_nInputLength == 0)
+				return;
+
+			int32_t blocks = (m_nInputLength + m_nBlockSize - 1) / m_nBlockSize;
+			if (m_pJobs != nullptr && blocks > 1)
+				m_pJobs->ParallelFor(blocks, &CompressStream::CompressBlocks, this, 1);
+			else
+				CompressBlocks(this, 0, blocks);
+
+			for (int32_t i = 0; i < blocks; i++)
+			{
+				int32_t start = i * m_nBlockSize;
+				int32_t rawSize = m_nInputLength - start;
+				if (rawSize > m_nBlockSize)
+					rawSize = m_nBlockSize;
+
+				// store blocks that did not shrink
+				const char *pStored = &m_output[(size_t)i * m_nBound];
+				int32_t storedSize = m_sizes[i];
+				if (storedSize < 0 || storedSize >= rawSize)
+				{
+					pStored = &m_input[start];
+					storedSize = rawSize;
+				}
+
+				CompressionBlockHeader block;
+				block.rawSize = (uint32_t)rawSize;
+				block.storedSize = (uint32_t)storedSize;
+				m_pStream->Write((const char *)&block, sizeof(CompressionBlockHeader));
+				m_pStream->Write(pStored, storedSize);
+			}
+
+			m_nInputLength = 0;
+		}
+
+		///
+		/// Compression streams are write-only; returns -1.
+		///
+		int32_t CompressStream::ReadByte()
+		{
+			return -1;
+		}
+
+		///
+		/// Compression streams are write-only; reads nothing and returns 0.
+		///
+		int32_t CompressStream::Read(char *pDestination, int32_t count, int32_t offset)
+		{
+			return 0;
+		}
+
+		///
+		/// Writes a single byte to the stream.
+		///
+		void CompressStream::WriteByte(int8_t value)
+		{
+			Write((const char *)&value, 1);
+		}
+
+		///
+		/// Writes an array of bytes to the stream.
+		///
+		int32_t CompressStream::Write(const char *pSource, int32_t count, int32_t offset)
+		{
+			if (m_bClosed)
+			{
+#if defined(TEKSTORM_DEBUG)
+				TEKDEBUG_W("Cannot write to a closed CompressStream.");
+#endif
+				return 0;
+			}
+
+			const char *pCurrent = &pSource[offset];
+			int32_t remaining = count;
+			while (remaining > 0)
+			{
+				int32_t space = (int32_t)m_input.size() - m_nInputLength;
+				int32_t copy = (remaining < space) ? remaining : space;
+				memcpy(&m_input[m_nInputLength], pCurrent, copy);
+				m_nInputLength += copy;
+				pCurrent += copy;
+				remaining -= copy;
+
+				if (m_nInputLength == (int32_t)m_input.size())
+					WriteBlocks();
+			}
+
+			return count;
+		}
+
+		///
+		/// Compresses and writes everything buffered, then flushes the inner stream.
+		///
+		void CompressStream::Flush()
+		{
+			if (m_bClosed)
+				return;
+
+			WriteBlocks();
+			m_pStream->Flush();
+		}
+
+		///
+		/// Writes what is buffered and ends the compressed stream.
+		///
+		void CompressStream::Close()
+		{
+			if (m_bClosed)
+				return;
+
+			WriteBlocks();
+
+			CompressionBlockHeader end;
+			end.rawSize = 0;
+			end.storedSize = 0;
+			m_pStream->Write((const char *)&end, sizeof(CompressionBlockHeader));
+			m_pStream->Flush();
+			m_bClosed = true;
+		}
+
+		///
+		/// Compression streams cannot seek; does nothing.
+		///
+		void CompressStream::Seek(int32_t value, int32_t offset)
+		{
+#if defined(TEKSTORM_DEBUG)
+			TEKDEBUG_W("Cannot seek a CompressStream.");
+#endif
+		}
+	}
+}
\ No newline at end of file
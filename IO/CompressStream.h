@@ -0,0 +1,143 @@
+#pragma once
+#ifndef _TEKSTORM_COMPRESSSTREAM_H
+#define _TEKSTORM_COMPRESSSTREAM_H
+#include "../tekconfig.h"
+#include "IStream.h"
+#include "Compression.h"
+#include "../core/JobSystem.h"
+
+namespace Tekstorm
+{
+	namespace IO
+	{
+		///
+		/// A write-only stream that compresses what is written to it into another stream.
+		///
+		/// Input is cut into blocks of a fixed size, each compressed on its own (see
+		/// CompressionHeader for the layout); blocks that do not shrink are stored as
+		/// is. Given a JobSystem, the stream buffers a batch of blocks per thread and
+		/// compresses them in parallel, so large writes scale with the workers.
+		///
+		/// Close() ends the compressed stream but leaves the inner stream open. Read
+		/// it back with DecompressStream.
+		///
+		class TEKAPI CompressStream : public IStream
+		{
+		protected:
+			// The stream the compressed data is written to.
+			IStream *m_pStream;
+
+			// Compresses batches in parallel, or nullptr to compress on the calling thread.
+			Core::JobSystem *m_pJobs;
+
+			CompressionCodec m_codec;
+			int32_t m_nLevel;
+			int32_t m_nBlockSize;
+
+			// The number of blocks buffered before they are compressed.
+			int32_t m_nBatchBlocks;
+
+			// The buffered input and the number of bytes in it.
+			std::vector<char> m_input;
+			int32_t m_nInputLength;
+
+			// The compressed blocks of a batch, GetBound() bytes apart, and their sizes.
+			std::vector<char> m_output;
+			std::vector<int32_t> m_sizes;
+			int32_t m_nBound;
+
+			// Whether or not the stream header has been written.
+			bool m_bStarted;
+
+			// Whether or not Close() has ended the stream.
+			bool m_bClosed;
+
+			///
+			/// Compression streams are not copyable.
+			///
+			CompressStream(const CompressStream &other);
+			CompressStream &operator=(const CompressStream &other);
+
+			///
+			/// Compresses the buffered input and writes it out.
+			///
+			void WriteBlocks();
+
+			///
+			/// Compresses the blocks [begin, end) of the batch (a ParallelFor body).
+			///
+			static void CompressBlocks(void *pData, int32_t begin, int32_t end);
+
+		public:
+			///
+			/// Compresses into pStream. level only applies to zstd (0 = its default).
+			///
+			CompressStream(IStream *pStream, CompressionCodec codec = TEKCOMPRESSION_LZ4, int32_t level = 0,
+				int32_t blockSize = CompressionDefaultBlockSize, Core::JobSystem *pJobs = nullptr);
+
+			~CompressStream();
+
+			///
+			/// Returns whether or not this stream can be read from.
+			///
+			virtual bool CanRead() const { return false; }
+
+			///
+			/// Returns whether or not this stream can be written to.
+			///
+			virtual bool CanWrite() const { return !m_bClosed; }
+
+			///
+			/// Returns whether or not this stream can seek.
+			///
+			virtual bool CanSeek() const { return false; }
+
+			///
+			/// Returns the length, in bytes, of this stream. If
+			/// the length is not supported, the result is -1.
+			///
+			virtual int32_t GetLength() const { return -1; }
+
+			///
+			/// Compression streams are write-only; returns -1.
+			///
+			virtual int32_t ReadByte();
+
+			///
+			/// Compression streams are write-only; reads nothing and returns 0.
+			///
+			virtual int32_t Read(char *pDestination, int32_t count, int32_t offset = 0);
+
+			///
+			/// Writes a single byte to the stream, and advances the current
+			/// stream pointer forward by 1 byte.
+			///
+			virtual void WriteByte(int8_t value);
+
+			///
+			/// Writes an array of bytes to the stream.
+			/// The return value is the number of bytes that were actually written.
+			/// count - the number of bytes to write to the stream
+			/// offset - the offset into the source buffer to begin reading from
+			///
+			virtual int32_t Write(const char *pSource, int32_t count, int32_t offset = 0);
+
+			///
+			/// Compresses and writes everything buffered, then flushes the inner stream.
+			///
+			virtual void Flush();
+
+			///
+			/// Writes what is buffered and ends the compressed stream.
+			///
+			virtual void Close();
+
+			///
+			/// Compression streams cannot seek; does nothing.
+			///
+			virtual void Seek(int32_t value, int32_t offset = SEEK_SET);
+		};
+	}
+}
+
+#endif /* _TEKSTORM_COMPRESSSTREAM_H */
\ No newline at end of file
@@ -0,0 +1,304 @@
+#define TEKSTORM_BUILD
+#include "Compression.h"
+
+#if defined(TEKSTORM_USE_ZSTD)
+	#include <zstd.h>
+	#pragma comment(lib, "libzstd.lib")
+#endif
+
+namespace Tekstorm
+{
+	namespace IO
+	{
+		///
+		/// LZ4 block format limits: matches are at least 4 bytes, the last match starts
+		/// 12 bytes or more before the end and the last 5 bytes are always literals.
+		///
+		static const int32_t Lz4MinMatch = 4;
+		static const int32_t Lz4MatchLimit = 12;
+		static const int32_t Lz4LastLiterals = 5;
+		static const int32_t Lz4MaxOffset = 65535;
+
+		///
+		/// The compressor remembers the last position of 2^Lz4HashBits 4-byte sequences.
+		///
+		static const int32_t Lz4HashBits = 12;
+
+		static inline uint32_t ReadUInt32(const uint8_t *pData)
+		{
+			uint32_t value;
+			memcpy(&value, pData, sizeof(uint32_t));
+			return value;
+		}
+
+		static inline uint32_t HashSequence(uint32_t sequence)
+		{
+			return (sequence * 2654435761u) >> (32 - Lz4HashBits);
+		}
+
+		///
+		/// Writes the part of a literal or match length that does not fit its token nibble.
+		///
+		static inline uint8_t *WriteLength(uint8_t *pOut, int32_t length)
+		{
+			while (length >= 255)
+			{
+				*pOut++ = 255;
+				length -= 255;
+			}
+
+			*pOut++ = (uint8_t)length;
+			return pOut;
+		}
+
+		///
+		/// Reads the extra bytes of a length; returns false on running out of input.
+		///
+		static inline bool ReadLength(const uint8_t *&pIn, const uint8_t *pInEnd, size_t &length)
+		{
+			uint8_t value;
+			do
+			{
+				if (pIn >= pInEnd)
+					return false;
+
+				value = *pIn++;
+				length += value;
+			}
+			while (value == 255);
+
+			return true;
+		}
+
+		///
+		/// Writes the final run of literals.
+		///
+		static inline uint8_t *WriteLiterals(uint8_t *pOut, const uint8_t *pLiterals, int32_t count)
+		{
+			*pOut++ = (uint8_t)((count < 15 ? count : 15) << 4);
+			if (count >= 15)
+				pOut = WriteLength(pOut, count - 15);
+
+			memcpy(pOut, pLiterals, count);
+			return pOut + count;
+		}
+
+		static int32_t GetLz4Bound(int32_t size)
+		{
+			return size + size / 255 + 16;
+		}
+
+		///
+		/// Greedy LZ4 compression with a single-entry hash table. The step over
+		/// unmatched input grows the longer nothing matches, so incompressible data
+		/// passes quickly.
+		///
+		static int32_t CompressLz4(const char *pSource, int32_t size, char *pDestination, int32_t capacity)
+		{
+			if (capacity < GetLz4Bound(size))
+				return -1;
+
+			const uint8_t *pStart = (const uint8_t *)pSource;
+			const uint8_t *pEnd = pStart + size;
+			const uint8_t *pAnchor = pStart;
+			uint8_t *pOut = (uint8_t *)pDestination;
+
+			if (size > Lz4MatchLimit)
+			{
+				uint32_t table[1 << Lz4HashBits];
+				memset(table, 0, sizeof(table));
+
+				const uint8_t *pLimit = pEnd - Lz4MatchLimit;
+				const uint8_t *pMatchEnd = pEnd - Lz4LastLiterals;
+				const uint8_t *pIn = pStart;
+				while (pIn <= pLimit)
+				{
+					uint32_t sequence = ReadUInt32(pIn);
+					uint32_t hash = HashSequence(sequence);
+					const uint8_t *pMatch = pStart + table[hash];
+					table[hash] = (uint32_t)(pIn - pStart);
+
+					if (pMatch >= pIn || pIn - pMatch > Lz4MaxOffset || ReadUInt32(pMatch) != sequence)
+					{
+						pIn += 1 + ((pIn - pAnchor) >> 6);
+						continue;
+					}
+
+					while (pIn > pAnchor && pMatch > pStart && pIn[-1] == pMatch[-1])
+					{
+						pIn--;
+						pMatch--;
+					}
+
+					const uint8_t *pScan = pIn + Lz4MinMatch;
+					const uint8_t *pMatchScan = pMatch + Lz4MinMatch;
+					while (pScan < pMatchEnd && *pScan == *pMatchScan)
+					{
+						pScan++;
+						pMatchScan++;
+					}
+
+					int32_t literals = (int32_t)(pIn - pAnchor);
+					int32_t matchLength = (int32_t)(pScan - pIn) - Lz4MinMatch;
+					int32_t offset = (int32_t)(pIn - pMatch);
+
+					uint8_t *pToken = pOut++;
+					*pToken = (uint8_t)(((literals < 15 ? literals : 15) << 4) | (matchLength < 15 ? matchLength : 15));
+					if (literals >= 15)
+						pOut = WriteLength(pOut, literals - 15);
+
+					memcpy(pOut, pAnchor, literals);
+					pOut += literals;
+					*pOut++ = (uint8_t)(offset & 0xFF);
+					*pOut++ = (uint8_t)(offset >> 8);
+					if (matchLength >= 15)
+						pOut = WriteLength(pOut, matchLength - 15);
+
+					pIn = pScan;
+					pAnchor = pIn;
+
+					// index inside the match too, so runs of matches chain up
+					table[HashSequence(ReadUInt32(pIn - 2))] = (uint32_t)(pIn - 2 - pStart);
+				}
+			}
+
+			pOut = WriteLiterals(pOut, pAnchor, (int32_t)(pEnd - pAnchor));
+			return (int32_t)(pOut - (uint8_t *)pDestination);
+		}
+
+		///
+		/// Decodes an LZ4 block, checking every length and offset against the buffers.
+		///
+		static bool DecompressLz4(const char *pSource, int32_t size, char *pDestination, int32_t rawSize)
+		{
+			const uint8_t *pIn = (const uint8_t *)pSource;
+			const uint8_t *pInEnd = pIn + size;
+			uint8_t *pStart = (uint8_t *)pDestination;
+			uint8_t *pOut = pStart;
+			uint8_t *pOutEnd = pStart + rawSize;
+
+			while (pIn < pInEnd)
+			{
+				uint8_t token = *pIn++;
+
+				size_t literals = token >> 4;
+				if (literals == 15 && !ReadLength(pIn, pInEnd, literals))
+					return false;
+
+				if (literals > (size_t)(pInEnd - pIn) || literals > (size_t)(pOutEnd - pOut))
+					return false;
+
+				memcpy(pOut, pIn, literals);
+				pIn += literals;
+				pOut += literals;
+
+				// the last sequence has no match
+				if (pIn == pInEnd)
+					break;
+
+				if (pInEnd - pIn < 2)
+					return false;
+
+				size_t offset = pIn[0] | ((size_t)pIn[1] << 8);
+				pIn += 2;
+				if (offset == 0 || offset > (size_t)(pOut - pStart))
+					return false;
+
+				size_t matchLength = token & 15;
+				if (matchLength == 15 && !ReadLength(pIn, pInEnd, matchLength))
+					return false;
+
+				matchLength += Lz4MinMatch;
+				if (matchLength > (size_t)(pOutEnd - pOut))
+					return false;
+
+				const uint8_t *pMatch = pOut - offset;
+				uint8_t *pMatchEnd = pOut + matchLength;
+				if (offset >= 8)
+				{
+					// 8 bytes at a time never reads bytes it has not written yet
+					while (pMatchEnd - pOut >= 8)
+					{
+						memcpy(pOut, pMatch, 8);
+						pOut += 8;
+						pMatch += 8;
+					}
+				}
+
+				while (pOut < pMatchEnd)
+					*pOut++ = *pMatch++;
+			}
+
+			return (pOut == pOutEnd);
+		}
+
+		///
+		/// Returns whether or not the codec is available in this build.
+		///
+		bool Compression::IsSupported(CompressionCodec codec)
+		{
+			if (codec == TEKCOMPRESSION_LZ4)
+				return true;
+
+#if defined(TEKSTORM_USE_ZSTD)
+			if (codec == TEKCOMPRESSION_ZSTD)
+				return true;
+#endif
+
+			return false;
+		}
+
+		///
+		/// Gets the largest compressed size of a block of the given size.
+		///
+		int32_t Compression::GetBound(CompressionCodec codec, int32_t size)
+		{
+#if defined(TEKSTORM_USE_ZSTD)
+			if (codec == TEKCOMPRESSION_ZSTD)
+				return (int32_t)ZSTD_compressBound(size);
+#endif
+
+			return GetLz4Bound(size);
+		}
+
+		///
+		/// Compresses a block.
+		///
+		int32_t Compression::Compress(CompressionCodec codec, int32_t level, const char *pSource, int32_t size,
+			char *pDestination, int32_t capacity)
+		{
+			if (codec == TEKCOMPRESSION_LZ4)
+				return CompressLz4(pSource, size, pDestination, capacity);
+
+#if defined(TEKSTORM_USE_ZSTD)
+			if (codec == TEKCOMPRESSION_ZSTD)
+			{
+				size_t result = ZSTD_compress(pDestination, capacity, pSource, size, level > 0 ? level : ZSTD_CLEVEL_DEFAULT);
+				return ZSTD_isError(result) ? -1 : (int32_t)result;
+			}
+#endif
+
+			return -1;
+		}
+
+		///
+		/// Decompresses a block of rawSize bytes.
+		///
+		bool Compression::Decompress(CompressionCodec codec, const char *pSource, int32_t size,
+			char *pDestination, int32_t rawSize)
+		{
+			if (codec == TEKCOMPRESSION_LZ4)
+				return DecompressLz4(pSource, size, pDestination, rawSize);
+
+#if defined(TEKSTORM_USE_ZSTD)
+			if (codec == TEKCOMPRESSION_ZSTD)
+			{
+				size_t result = ZSTD_decompress(pDestination, rawSize, pSource, size);
+				return !ZSTD_isError(result) && result == (size_t)rawSize;
+			}
+#endif
+
+			return false;
+		}
+	}
+}
\ No newline at end of file
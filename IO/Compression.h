@@ -0,0 +1,107 @@
+#pragma once
+#ifndef _TEKSTORM_COMPRESSION_H
+#define _TEKSTORM_COMPRESSION_H
+#include "../tekconfig.h"
+
+namespace Tekstorm
+{
+	namespace IO
+	{
+		///
+		/// A block compression codec.
+		///
+		enum CompressionCodec
+		{
+			TEKCOMPRESSION_LZ4 = 1,
+			TEKCOMPRESSION_ZSTD = 2
+		};
+
+		///
+		/// The header of a compressed stream (see CompressStream). It is followed by
+		/// blocks, each a CompressionBlockHeader and its data, and ends with a block
+		/// header whose rawSize is 0.
+		///
+		struct CompressionHeader
+		{
+			// CompressionMagic.
+			uint32_t magic;
+
+			// A CompressionCodec.
+			uint16_t codec;
+			uint16_t reserved;
+
+			// The largest rawSize of any block.
+			uint32_t blockSize;
+		};
+
+		///
+		/// The header of one block of a compressed stream.
+		///
+		struct CompressionBlockHeader
+		{
+			// The size of the block once decompressed; 0 ends the stream.
+			uint32_t rawSize;
+
+			// The size of the data that follows. If it equals rawSize the block did not
+			// compress and is stored as is.
+			uint32_t storedSize;
+		};
+
+		///
+		/// "TKZ1", read as a little-endian integer.
+		///
+		const uint32_t CompressionMagic = 0x315A4B54;
+
+		///
+		/// Limits on the block size of a stream.
+		///
+		const int32_t CompressionMinBlockSize = 4096;
+		const int32_t CompressionMaxBlockSize = 4 * 1024 * 1024;
+		const int32_t CompressionDefaultBlockSize = 256 * 1024;
+
+		///
+		/// Compresses and decompresses single blocks.
+		///
+		/// LZ4 is built in and favours speed; it writes standard LZ4 blocks and has a
+		/// single level. zstd favours ratio and takes levels 1 to 22; it is only
+		/// available when built with TEKSTORM_USE_ZSTD and the zstd library.
+		///
+		/// Every function is thread-safe.
+		///
+		class TEKAPI Compression
+		{
+		private:
+			///
+			/// No public constructor
+			///
+			Compression() { }
+
+		public:
+			///
+			/// Returns whether or not the codec is available in this build.
+			///
+			static bool IsSupported(CompressionCodec codec);
+
+			///
+			/// Gets the largest compressed size of a block of the given size.
+			///
+			static int32_t GetBound(CompressionCodec codec, int32_t size);
+
+			///
+			/// Compresses a block. pDestination must hold GetBound() bytes. Returns the
+			/// compressed size, or -1 on error.
+			///
+			static int32_t Compress(CompressionCodec codec, int32_t level, const char *pSource, int32_t size,
+				char *pDestination, int32_t capacity);
+
+			///
+			/// Decompresses a block of rawSize bytes. Returns false if the data is
+			/// malformed or does not decompress to exactly rawSize bytes.
+			///
+			static bool Decompress(CompressionCodec codec, const char *pSource, int32_t size,
+				char *pDestination, int32_t rawSize);
+		};
+	}
+}
+
+#endif /* _TEKSTORM_COMPRESSION_H */
\ No newline at end of file
@@ -0,0 +1,213 @@
+#define TEKSTORM_BUILD
+#include "DecompressStream.h"
+#include "../core/MemoryTracker.h"
+
+namespace Tekstorm
+{
+	namespace IO
+	{
+		///
+		/// Decompresses from pStream.
+		///
+		DecompressStream::DecompressStream(IStream *pStream)
+		{
+			m_pStream = pStream;
+			m_codec = TEKCOMPRESSION_LZ4;
+			m_nBlockSize = 0;
+			m_nBlockLength = 0;
+			m_nBlockIndex = 0;
+			m_bStarted = false;
+			m_bValid = true;
+			m_bEnded = false;
+		}
+
+		DecompressStream::~DecompressStream()
+		{
+			TEKMEM_FREE(Core::TEKMEMTAG_IO, m_block.capacity() + m_stored.capacity());
+		}
+
+		///
+		/// Returns false if the data read so far was malformed.
+		///
+		bool DecompressStream::IsValid() const
+		{
+			return m_bValid;
+		}
+
+		///
+		/// Marks the stream as malformed and ends it.
+		///
+		bool DecompressStream::Fail()
+		{
+#if defined(TEKSTORM_DEBUG)
+			TEKDEBUG_W("DecompressStream: the compressed data is malformed");
+#endif
+			m_bValid = false;
+			m_bEnded = true;
+			return false;
+		}
+
+		///
+		/// Reads exactly count bytes from the inner stream.
+		///
+		bool DecompressStream::ReadStream(char *pDestination, int32_t count)
+		{
+			int32_t total = 0;
+			while (total < count)
+			{
+				int32_t read = m_pStream->Read(pDestination, count - total, total);
+				if (read <= 0)
+					return false;
+
+				total += read;
+			}
+
+			return true;
+		}
+
+		///
+		/// Reads the stream header.
+		///
+		bool DecompressStream::ReadHeader()
+		{
+			m_bStarted = true;
+
+			CompressionHeader header;
+			if (!ReadStream((char *)&header, sizeof(CompressionHeader)) || header.magic != CompressionMagic
+				|| header.blockSize < (uint32_t)CompressionMinBlockSize || header.blockSize > (uint32_t)CompressionMaxBlockSize
+				|| !Compression::IsSupported((CompressionCodec)header.codec))
+				return Fail();
+
+			m_codec = (CompressionCodec)header.codec;
+			m_nBlockSize = (int32_t)header.blockSize;
+			m_block.resize(m_nBlockSize);
+			m_stored.resize(Compression::GetBound(m_codec, m_nBlockSize));
+			TEKMEM_ALLOC(Core::TEKMEMTAG_IO, m_block.capacity() + m_stored.capacity());
+			return true;
+		}
+
+		///
+		/// Reads and decompresses the next block.
+		///
+		bool DecompressStream::ReadBlock()
+		{
+			if (m_bEnded)
+				return false;
+
+			if (!m_bStarted && !ReadHeader())
+				return false;
+
+			CompressionBlockHeader block;
+			if (!ReadStream((char *)&block, sizeof(CompressionBlockHeader)))
+				return Fail();
+
+			if (block.rawSize == 0)
+			{
+				m_bEnded = true;
+				return false;
+			}
+
+			if (block.rawSize > (uint32_t)m_nBlockSize || block.storedSize > block.rawSize)
+				return Fail();
+
+			int32_t rawSize = (int32_t)block.rawSize;
+			int32_t storedSize = (int32_t)block.storedSize;
+			if (storedSize == rawSize)
+			{
+				if (!ReadStream(&m_block[0], rawSize))
+					return Fail();
+			}
+			else
+			{
+				if (!ReadStream(&m_stored[0], storedSize)
+					|| !Compression::Decompress(m_codec, &m_stored[0], storedSize, &m_block[0], rawSize))
+					return Fail();
+			}
+
+			m_nBlockLength = rawSize;
+			m_nBlockIndex = 0;
+			return true;
+		}
+
+		///
+		/// Reads a single byte from the stream.
+		///
+		int32_t DecompressStream::ReadByte()
+		{
+			char value;
+			return (Read(&value, 1) == 1) ? (uint8_t)value : -1;
+		}
+
+		///
+		/// Reads an array of bytes from the stream.
+		///
+		int32_t DecompressStream::Read(char *pDestination, int32_t count, int32_t offset)
+		{
+			int32_t total = 0;
+			while (total < count)
+			{
+				if (m_nBlockIndex == m_nBlockLength && !ReadBlock())
+					break;
+
+				int32_t available = m_nBlockLength - m_nBlockIndex;
+				int32_t copy = (count - total < available) ? count - total : available;
+				memcpy(&pDestination[offset + total], &m_block[m_nBlockIndex], copy);
+				m_nBlockIndex += copy;
+				total += copy;
+			}
+
+			return total;
+		}
+
+		///
+		/// Decompression streams are read-only; does nothing.
+		///
+		void DecompressStream::WriteByte(int8_t value)
+		{
+#if defined(TEKSTORM_DEBUG)
+			TEKDEBUG_W("Cannot write to a DecompressStream.");
+#endif
+		}
+
+		///
+		/// Decompression streams are read-only; writes nothing and returns 0.
+		///
+		int32_t DecompressStream::Write(const char *pSource, int32_t count, int32_t offset)
+		{
+#if defined(TEKSTORM_DEBUG)
+			TEKDEBUG_W("Cannot write to a DecompressStream.");
+#endif
+			return 0;
+		}
+
+		///
+		/// Flushes this stream.
+		///
+		void DecompressStream::Flush()
+		{
+			// stream is read-only so there's nothing to flush
+		}
+
+		///
+		/// Closes this stream.
+		///
+		void DecompressStream::Close()
+		{
+			m_block.clear();
+			m_stored.clear();
+			m_nBlockLength = 0;
+			m_nBlockIndex = 0;
+			m_bEnded = true;
+		}
+
+		///
+		/// Decompression streams cannot seek; does nothing.
+		///
+		void DecompressStream::Seek(int32_t value, int32_t offset)
+		{
+#if defined(TEKSTORM_DEBUG)
+			TEKDEBUG_W("Cannot seek a DecompressStream.");
+#endif
+		}
+	}
+}
\ No newline at end of file
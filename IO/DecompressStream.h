@@ -0,0 +1,149 @@
+#pragma once
+#ifndef _TEKSTORM_DECOMPRESSSTREAM_H
+#define _TEKSTORM_DECOMPRESSSTREAM_H
+#include "../tekconfig.h"
+#include "IStream.h"
+#include "Compression.h"
+
+namespace Tekstorm
+{
+	namespace IO
+	{
+		///
+		/// A read-only stream that decompresses what CompressStream wrote to another
+		/// stream, one block at a time.
+		///
+		/// Malformed data ends the stream early and makes IsValid() return false.
+		/// Closing the stream leaves the inner stream open.
+		///
+		class TEKAPI DecompressStream : public IStream
+		{
+		protected:
+			// The stream the compressed data is read from.
+			IStream *m_pStream;
+
+			CompressionCodec m_codec;
+			int32_t m_nBlockSize;
+
+			// The current block, decompressed, and the read index into it.
+			std::vector<char> m_block;
+			int32_t m_nBlockLength;
+			int32_t m_nBlockIndex;
+
+			// The stored data of the current block.
+			std::vector<char> m_stored;
+
+			// Whether or not the header has been read, and whether it was valid.
+			bool m_bStarted;
+			bool m_bValid;
+
+			// Whether or not the end of the compressed stream was reached.
+			bool m_bEnded;
+
+			///
+			/// Decompression streams are not copyable.
+			///
+			DecompressStream(const DecompressStream &other);
+			DecompressStream &operator=(const DecompressStream &other);
+
+			///
+			/// Reads exactly count bytes from the inner stream. Returns false if it ends first.
+			///
+			bool ReadStream(char *pDestination, int32_t count);
+
+			///
+			/// Reads the stream header.
+			///
+			bool ReadHeader();
+
+			///
+			/// Reads and decompresses the next block. Returns false at the end of the stream.
+			///
+			bool ReadBlock();
+
+			///
+			/// Marks the stream as malformed and ends it.
+			///
+			bool Fail();
+
+		public:
+			///
+			/// Decompresses from pStream, which must be positioned at the stream header.
+			///
+			DecompressStream(IStream *pStream);
+
+			~DecompressStream();
+
+			///
+			/// Returns false if the data read so far was malformed or uses a codec
+			/// this build does not support.
+			///
+			bool IsValid() const;
+
+			///
+			/// Returns whether or not this stream can be read from.
+			///
+			virtual bool CanRead() const { return true; }
+
+			///
+			/// Returns whether or not this stream can be written to.
+			///
+			virtual bool CanWrite() const { return false; }
+
+			///
+			/// Returns whether or not this stream can seek.
+			///
+			virtual bool CanSeek() const { return false; }
+
+			///
+			/// Returns the length, in bytes, of this stream. If
+			/// the length is not supported, the result is -1.
+			///
+			virtual int32_t GetLength() const { return -1; }
+
+			///
+			/// Reads a single byte from the stream, and advances the
+			/// current stream pointer forward by 1 byte.
+			/// The result is the read byte, or -1 at the end of the stream.
+			///
+			virtual int32_t ReadByte();
+
+			///
+			/// Reads an array of bytes from the stream, and advances the
+			/// current stream pointer forward by the number of bytes
+			/// that were actually read.
+			/// The return value is the number of bytes that were actually read.
+			/// count - the number of bytes to read from the stream
+			/// offset - the offset into the destination buffer to begin reading to
+			///
+			virtual int32_t Read(char *pDestination, int32_t count, int32_t offset = 0);
+
+			///
+			/// Decompression streams are read-only; does nothing.
+			///
+			virtual void WriteByte(int8_t value);
+
+			///
+			/// Decompression streams are read-only; writes nothing and returns 0.
+			///
+			virtual int32_t Write(const char *pSource, int32_t count, int32_t offset = 0);
+
+			///
+			/// Flushes this stream.
+			///
+			virtual void Flush();
+
+			///
+			/// Closes this stream.
+			///
+			virtual void Close();
+
+			///
+			/// Decompression streams cannot seek; does nothing.
+			///
+			virtual void Seek(int32_t value, int32_t offset = SEEK_SET);
+		};
+	}
+}
+
+#endif /* _TEKSTORM_DECOMPRESSSTREAM_H */
\ No newline at end of file
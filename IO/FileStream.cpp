@@ -0,0 +1,194 @@
+#define TEKSTORM_BUILD
+#include "FileStream.h"
+
+namespace Tekstorm
+{
+	namespace IO
+	{
+		FileStream::FileStream()
+		{
+			m_pFile = nullptr;
+			m_bCanRead = false;
+			m_bCanWrite = false;
+		}
+
+		///
+		/// Opens the given file. mode is a C fopen mode (i.e. "rb", "wb").
+		///
+		FileStream::FileStream(const std::string &filePath, const char *mode)
+		{
+			m_pFile = nullptr;
+			m_bCanRead = false;
+			m_bCanWrite = false;
+			Open(filePath, mode);
+		}
+
+		FileStream::~FileStream()
+		{
+			Close();
+		}
+
+		///
+		/// Opens the given file, closing any file that is already open.
+		///
+		bool FileStream::Open(const std::string &filePath, const char *mode)
+		{
+			Close();
+
+			m_pFile = fopen(filePath.c_str(), mode);
+			if (m_pFile == nullptr)
+			{
+#if defined(TEKSTORM_DEBUG)
+				TEKDEBUG_W("Unable to open file " << filePath);
+#endif
+				return false;
+			}
+
+			m_bCanRead = (strchr(mode, 'r') != nullptr || strchr(mode, '+') != nullptr);
+			m_bCanWrite = (strchr(mode, 'w') != nullptr || strchr(mode, 'a') != nullptr || strchr(mode, '+') != nullptr);
+			return true;
+		}
+
+		///
+		/// Returns whether or not a file is open.
+		///
+		bool FileStream::IsOpen() const
+		{
+			return (m_pFile != nullptr);
+		}
+
+		///
+		/// Returns whether or not this stream can be read from.
+		///
+		bool FileStream::CanRead() const
+		{
+			return m_bCanRead;
+		}
+
+		///
+		/// Returns whether or not this stream can be written to.
+		///
+		bool FileStream::CanWrite() const
+		{
+			return m_bCanWrite;
+		}
+
+		///
+		/// Returns whether or not this stream can seek.
+		///
+		bool FileStream::CanSeek() const
+		{
+			return (m_pFile != nullptr);
+		}
+
+		///
+		/// Returns the length, in bytes, of this stream. If
+		/// the length is not supported, the result is -1.
+		///
+		int32_t FileStream::GetLength() const
+		{
+			if (m_pFile == nullptr)
+				return -1;
+
+			long current = ftell(m_pFile);
+			fseek(m_pFile, 0, SEEK_END);
+			long length = ftell(m_pFile);
+			fseek(m_pFile, current, SEEK_SET);
+
+			return (int32_t)length;
+		}
+
+		///
+		/// Reads a single byte from the stream, and advances the
+		/// current stream pointer forward by 1 byte.
+		///
+		int32_t FileStream::ReadByte()
+		{
+#if defined(TEKSTORM_DEBUG)
+			if (m_pFile == nullptr) {
+				TEKDEBUG_EF("Cannot read from a closed file.");
+			}
+#endif
+			return fgetc(m_pFile);
+		}
+
+		///
+		/// Reads an array of bytes from the stream, and advances the
+		/// current stream pointer forward by the number of bytes
+		/// that were actually read.
+		///
+		int32_t FileStream::Read(char *pDestination, int32_t count, int32_t offset)
+		{
+#if defined(TEKSTORM_DEBUG)
+			if (m_pFile == nullptr) {
+				TEKDEBUG_EF("Cannot read from a closed file.");
+			}
+#endif
+			return (int32_t)fread((void *)(&pDestination[offset]), sizeof(int8_t), count, m_pFile);
+		}
+
+		///
+		/// Writes a single byte to the stream, and advances the current
+		/// stream pointer forward by 1 byte.
+		///
+		void FileStream::WriteByte(int8_t value)
+		{
+#if defined(TEKSTORM_DEBUG)
+			if (m_pFile == nullptr) {
+				TEKDEBUG_EF("Cannot write to a closed file.");
+			}
+#endif
+			fputc((unsigned char)value, m_pFile);
+		}
+
+		///
+		/// Writes an array of bytes from the stream, and advances the
+		/// current stream pointer forward by the number of bytes
+		/// that were actually written.
+		///
+		int32_t FileStream::Write(const char *pSource, int32_t count, int32_t offset)
+		{
+#if defined(TEKSTORM_DEBUG)
+			if (m_pFile == nullptr) {
+				TEKDEBUG_EF("Cannot write to a closed file.");
+			}
+#endif
+			return (int32_t)fwrite((const void *)(&pSource[offset]), sizeof(int8_t), count, m_pFile);
+		}
+
+		///
+		/// Flushes this stream.
+		///
+		void FileStream::Flush()
+		{
+			if (m_pFile != nullptr)
+				fflush(m_pFile);
+		}
+
+		///
+		/// Closes this stream.
+		///
+		void FileStream::Close()
+		{
+			if (m_pFile != nullptr)
+				fclose(m_pFile);
+
+			m_pFile = nullptr;
+			m_bCanRead = false;
+			m_bCanWrite = false;
+		}
+
+		///
+		/// Sets the current index into the stream.
+		///
+		void FileStream::Seek(int32_t value, int32_t offset)
+		{
+#if defined(TEKSTORM_DEBUG)
+			if (m_pFile == nullptr) {
+				TEKDEBUG_EF("Cannot seek a closed file.");
+			}
+#endif
+			fseek(m_pFile, value, offset);
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,190 @@
+#define TEKSTORM_BUILD
+#include "HashStream.h"
+
+namespace Tekstorm
+{
+	namespace IO
+	{
+		using namespace Tekstorm::Core;
+
+		///
+		/// The chunk size used to read a stream through to its end.
+		///
+		static const int32_t HashReadChunkSize = 64 * 1024;
+
+		///
+		/// Hashes the data passing through pStream. seed applies to the XXH3 hashes.
+		///
+		HashStream::HashStream(IStream *pStream, int32_t mode, uint64_t seed)
+			: m_xxh3(seed)
+		{
+			m_pStream = pStream;
+			m_nMode = mode;
+			m_nCrc = 0;
+			m_nHashedLength = 0;
+		}
+
+		///
+		/// Restarts the hashes.
+		///
+		void HashStream::Reset(uint64_t seed)
+		{
+			m_nCrc = 0;
+			m_xxh3.Reset(seed);
+			m_nHashedLength = 0;
+		}
+
+		///
+		/// Hashes bytes that passed through the stream.
+		///
+		void HashStream::Hash(const char *pData, int32_t count)
+		{
+			if (count <= 0)
+				return;
+
+			if ((m_nMode & TEKHASH_CRC32C) != 0)
+				m_nCrc = Checksum::Crc32c(pData, count, m_nCrc);
+
+			if ((m_nMode & TEKHASH_XXH3) != 0)
+				m_xxh3.Update(pData, count);
+
+			m_nHashedLength += count;
+		}
+
+		///
+		/// Reads the stream through to its end.
+		///
+		void HashStream::ReadToEnd()
+		{
+			std::vector<char> buffer(HashReadChunkSize);
+			while (Read(&buffer[0], HashReadChunkSize) > 0)
+			{
+			}
+		}
+
+		///
+		/// Reads a single byte from the stream, and advances the
+		/// current stream pointer forward by 1 byte.
+		///
+		int32_t HashStream::ReadByte()
+		{
+			int32_t value = m_pStream->ReadByte();
+			if (value >= 0)
+			{
+				char byte = (char)value;
+				Hash(&byte, 1);
+			}
+
+			return value;
+		}
+
+		///
+		/// Reads an array of bytes from the stream, and hashes what was read.
+		///
+		int32_t HashStream::Read(char *pDestination, int32_t count, int32_t offset)
+		{
+			int32_t read = m_pStream->Read(pDestination, count, offset);
+			Hash(&pDestination[offset], read);
+			return read;
+		}
+
+		///
+		/// Writes a single byte to the stream.
+		///
+		void HashStream::WriteByte(int8_t value)
+		{
+			m_pStream->WriteByte(value);
+			Hash((const char *)&value, 1);
+		}
+
+		///
+		/// Writes an array of bytes to the stream, and hashes what was written.
+		///
+		int32_t HashStream::Write(const char *pSource, int32_t count, int32_t offset)
+		{
+			int32_t written = m_pStream->Write(pSource, count, offset);
+			Hash(&pSource[offset], written);
+			return written;
+		}
+
+		///
+		/// Flushes the inner stream.
+		///
+		void HashStream::Flush()
+		{
+			m_pStream->Flush();
+		}
+
+		///
+		/// Flushes the inner stream; it is left open.
+		///
+		void HashStream::Close()
+		{
+			m_pStream->Flush();
+		}
+
+		///
+		/// Hash streams cannot seek; does nothing.
+		///
+		void HashStream::Seek(int32_t value, int32_t offset)
+		{
+#if defined(TEKSTORM_DEBUG)
+			TEKDEBUG_W("Cannot seek a HashStream.");
+#endif
+		}
+
+		///
+		/// Reads pStream to its end and gets the CRC-32C of what was read.
+		///
+		uint32_t HashStream::ComputeCrc32c(IStream *pStream)
+		{
+			HashStream hashStream(pStream, TEKHASH_CRC32C);
+			hashStream.ReadToEnd();
+			return hashStream.GetCrc32c();
+		}
+
+		///
+		/// Reads pStream to its end and gets the XXH3 64-bit hash of what was read.
+		///
+		uint64_t HashStream::ComputeHash64(IStream *pStream, uint64_t seed)
+		{
+			HashStream hashStream(pStream, TEKHASH_XXH3, seed);
+			hashStream.ReadToEnd();
+			return hashStream.GetHash64();
+		}
+
+		///
+		/// Reads pStream to its end and gets the XXH3 128-bit hash of what was read.
+		///
+		Hash128 HashStream::ComputeHash128(IStream *pStream, uint64_t seed)
+		{
+			HashStream hashStream(pStream, TEKHASH_XXH3, seed);
+			hashStream.ReadToEnd();
+			return hashStream.GetHash128();
+		}
+
+		///
+		/// Gets the CRC-32C of a memory stream from its position to its end.
+		///
+		uint32_t HashStream::ComputeCrc32c(const MemoryStream &stream)
+		{
+			return Checksum::Crc32c(stream.GetBuffer() + stream.GetPosition(), stream.GetLength() - stream.GetPosition());
+		}
+
+		///
+		/// Gets the XXH3 64-bit hash of a memory stream from its position to its end.
+		///
+		uint64_t HashStream::ComputeHash64(const MemoryStream &stream, uint64_t seed)
+		{
+			return Xxh3::Compute64(stream.GetBuffer() + stream.GetPosition(), stream.GetLength() - stream.GetPosition(), seed);
+		}
+
+		///
+		/// Gets the XXH3 128-bit hash of a memory stream from its position to its end.
+		///
+		Hash128 HashStream::ComputeHash128(const MemoryStream &stream, uint64_t seed)
+		{
+			return Xxh3::Compute128(stream.GetBuffer() + stream.GetPosition(), stream.GetLength() - stream.GetPosition(), seed);
+		}
+	}
+}
\ No newline at end of file
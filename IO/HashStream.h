@@ -0,0 +1,197 @@
+#pragma once
+#ifndef _TEKSTORM_HASHSTREAM_H
+#define _TEKSTORM_HASHSTREAM_H
+#include "../tekconfig.h"
+#include "IStream.h"
+#include "MemoryStream.h"
+#include "../core/Checksum.h"
+#include "../core/Xxh3.h"
+
+namespace Tekstorm
+{
+	namespace IO
+	{
+		///
+		/// The hashes a HashStream keeps; combine them with |.
+		///
+		enum HashStreamMode
+		{
+			TEKHASH_CRC32C = 1,
+			TEKHASH_XXH3 = 2,
+			TEKHASH_ALL = 3
+		};
+
+		///
+		/// A stream that hashes everything read from or written to another stream, so
+		/// assets and packets can be checked while they are loaded or saved instead of
+		/// in a second pass.
+		///
+		/// The stream cannot seek, since that would skip or repeat hashed bytes.
+		/// Closing the stream leaves the inner stream open.
+		///
+		class TEKAPI HashStream : public IStream
+		{
+		protected:
+			// The stream the data passes through.
+			IStream *m_pStream;
+
+			int32_t m_nMode;
+			uint32_t m_nCrc;
+			Core::Xxh3 m_xxh3;
+
+			// The number of bytes hashed.
+			uint64_t m_nHashedLength;
+
+			///
+			/// Hash streams are not copyable.
+			///
+			HashStream(const HashStream &other);
+			HashStream &operator=(const HashStream &other);
+
+			///
+			/// Hashes bytes that passed through the stream.
+			///
+			void Hash(const char *pData, int32_t count);
+
+			///
+			/// Reads the stream through to its end.
+			///
+			void ReadToEnd();
+
+		public:
+			///
+			/// Hashes the data passing through pStream. seed applies to the XXH3 hashes.
+			///
+			HashStream(IStream *pStream, int32_t mode = TEKHASH_ALL, uint64_t seed = 0);
+
+			///
+			/// Restarts the hashes.
+			///
+			void Reset(uint64_t seed = 0);
+
+			///
+			/// Gets the CRC-32C of the bytes so far (needs TEKHASH_CRC32C).
+			///
+			uint32_t GetCrc32c() const { return m_nCrc; }
+
+			///
+			/// Gets the XXH3 64-bit hash of the bytes so far (needs TEKHASH_XXH3).
+			///
+			uint64_t GetHash64() const { return m_xxh3.Digest64(); }
+
+			///
+			/// Gets the XXH3 128-bit hash of the bytes so far (needs TEKHASH_XXH3).
+			///
+			Core::Hash128 GetHash128() const { return m_xxh3.Digest128(); }
+
+			///
+			/// Gets the number of bytes hashed.
+			///
+			uint64_t GetHashedLength() const { return m_nHashedLength; }
+
+			///
+			/// Returns whether or not this stream can be read from.
+			///
+			virtual bool CanRead() const { return m_pStream->CanRead(); }
+
+			///
+			/// Returns whether or not this stream can be written to.
+			///
+			virtual bool CanWrite() const { return m_pStream->CanWrite(); }
+
+			///
+			/// Returns whether or not this stream can seek.
+			///
+			virtual bool CanSeek() const { return false; }
+
+			///
+			/// Returns the length, in bytes, of this stream. If
+			/// the length is not supported, the result is -1.
+			///
+			virtual int32_t GetLength() const { return m_pStream->GetLength(); }
+
+			///
+			/// Reads a single byte from the stream, and advances the
+			/// current stream pointer forward by 1 byte.
+			/// The result is the read byte, or -1 at the end of the stream.
+			///
+			virtual int32_t ReadByte();
+
+			///
+			/// Reads an array of bytes from the stream, and advances the
+			/// current stream pointer forward by the number of bytes
+			/// that were actually read.
+			/// The return value is the number of bytes that were actually read.
+			/// count - the number of bytes to read from the stream
+			/// offset - the offset into the destination buffer to begin reading to
+			///
+			virtual int32_t Read(char *pDestination, int32_t count, int32_t offset = 0);
+
+			///
+			/// Writes a single byte to the stream, and advances the current
+			/// stream pointer forward by 1 byte.
+			///
+			virtual void WriteByte(int8_t value);
+
+			///
+			/// Writes an array of bytes to the stream, and advances the
+			/// current stream pointer forward by the number of bytes
+			/// that were actually written.
+			/// The return value is the number of bytes that were actually written.
+			/// count - the number of bytes to write to the stream
+			/// offset - the offset into the source buffer to begin reading from
+			///
+			virtual int32_t Write(const char *pSource, int32_t count, int32_t offset = 0);
+
+			///
+			/// Flushes this stream.
+			///
+			virtual void Flush();
+
+			///
+			/// Closes this stream.
+			///
+			virtual void Close();
+
+			///
+			/// Hash streams cannot seek; does nothing.
+			///
+			virtual void Seek(int32_t value, int32_t offset = SEEK_SET);
+
+			///
+			/// Reads pStream to its end and gets the CRC-32C of what was read.
+			///
+			static uint32_t ComputeCrc32c(IStream *pStream);
+
+			///
+			/// Reads pStream to its end and gets the XXH3 64-bit hash of what was read.
+			///
+			static uint64_t ComputeHash64(IStream *pStream, uint64_t seed = 0);
+
+			///
+			/// Reads pStream to its end and gets the XXH3 128-bit hash of what was read.
+			///
+			static Core::Hash128 ComputeHash128(IStream *pStream, uint64_t seed = 0);
+
+			///
+			/// Gets the CRC-32C of a memory stream from its position to its end. The
+			/// buffer is hashed in place and the position is left unchanged.
+			///
+			static uint32_t ComputeCrc32c(const MemoryStream &stream);
+
+			///
+			/// Gets the XXH3 64-bit hash of a memory stream from its position to its
+			/// end. The buffer is hashed in place and the position is left unchanged.
+			///
+			static uint64_t ComputeHash64(const MemoryStream &stream, uint64_t seed = 0);
+
+			///
+			/// Gets the XXH3 128-bit hash of a memory stream from its position to its
+			/// end. The buffer is hashed in place and the position is left unchanged.
+			///
+			static Core::Hash128 ComputeHash128(const MemoryStream &stream, uint64_t seed = 0);
+		};
+	}
+}
+
+#endif /* _TEKSTORM_HASHSTREAM_H */
\ No newline at end of file
@@ -0,0 +1,510 @@
+#define TEKSTORM_BUILD
+#include "Inflate.h"
+
+namespace Tekstorm
+{
+	namespace IO
+	{
+		///
+		/// Codes of up to InflateFastBits bits are decoded with a single lookup;
+		/// longer ones fall back to a canonical decode.
+		///
+		static const int32_t InflateFastBits = 10;
+		static const uint64_t InflateFastMask = (1 << InflateFastBits) - 1;
+		static const int32_t InflateMaxBits = 15;
+
+		///
+		/// The base values and extra bits of length symbols 257-285 and distance
+		/// symbols 0-29.
+		///
+		static const uint16_t s_lengthBase[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+			35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+		static const uint8_t s_lengthExtra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+			3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+		static const uint16_t s_distanceBase[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+			257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+		static const uint8_t s_distanceExtra[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+			7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+		///
+		/// The order the code length code lengths of a dynamic block are stored in.
+		///
+		static const uint8_t s_codeLengthOrder[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+		///
+		/// A Huffman code.
+		///
+		struct InflateHuffman
+		{
+			// (length << 9) | symbol for each code of up to InflateFastBits bits,
+			// indexed by its bits as read; 0 where a longer code starts.
+			uint16_t fast[1 << InflateFastBits];
+
+			// The number of codes of each length, and the symbols in code order.
+			uint16_t counts[InflateMaxBits + 1];
+			uint16_t symbols[288];
+		};
+
+		///
+		/// The bit reader over the input segments.
+		///
+		struct InflateInput
+		{
+			const InflateSegment *pSegments;
+			int32_t segmentCount;
+			int32_t segment;
+			const uint8_t *p;
+			const uint8_t *pEnd;
+
+			// Unread bits, from the least significant; bits above count may hold the
+			// stream's next bits.
+			uint64_t bits;
+			int32_t count;
+
+			// Zero bytes fed in past the end of the input.
+			int32_t overrun;
+		};
+
+		static InflateHuffman s_fixedLengths;
+		static InflateHuffman s_fixedDistances;
+
+		static inline uint32_t ReverseBits(uint32_t code, int32_t length)
+		{
+			uint32_t reversed = 0;
+			for (int32_t i = 0; i < length; i++, code >>= 1)
+				reversed = (reversed << 1) | (code & 1);
+
+			return reversed;
+		}
+
+		///
+		/// Builds a code from the code length of each symbol. Over-subscribed codes
+		/// are rejected; incomplete ones are allowed, their unused codes fail to decode.
+		///
+		static bool BuildHuffman(InflateHuffman &huffman, const uint8_t *pLengths, int32_t count)
+		{
+			memset(huffman.counts, 0, sizeof(huffman.counts));
+			for (int32_t i = 0; i < count; i++)
+				huffman.counts[pLengths[i]]++;
+
+			huffman.counts[0] = 0;
+
+			int32_t left = 1;
+			for (int32_t length = 1; length <= InflateMaxBits; length++)
+			{
+				left = (left << 1) - huffman.counts[length];
+				if (left < 0)
+					return false;
+			}
+
+			uint16_t offsets[InflateMaxBits + 1];
+			offsets[1] = 0;
+			for (int32_t length = 1; length < InflateMaxBits; length++)
+				offsets[length + 1] = offsets[length] + huffman.counts[length];
+
+			for (int32_t i = 0; i < count; i++)
+			{
+				if (pLengths[i] != 0)
+					huffman.symbols[offsets[pLengths[i]]++] = (uint16_t)i;
+			}
+
+			memset(huffman.fast, 0, sizeof(huffman.fast));
+			uint32_t code = 0;
+			int32_t index = 0;
+			for (int32_t length = 1; length <= InflateFastBits; length++)
+			{
+				for (int32_t i = 0; i < huffman.counts[length]; i++, code++, index++)
+				{
+					// deflate sends codes from their most significant bit
+					uint16_t entry = (uint16_t)((length << 9) | huffman.symbols[index]);
+					for (uint32_t j = ReverseBits(code, length); j < (1u << InflateFastBits); j += (1u << length))
+						huffman.fast[j] = entry;
+				}
+
+				code <<= 1;
+			}
+
+			return true;
+		}
+
+		///
+		/// Builds the codes of fixed Huffman blocks; returns true so it can
+		/// initialize a static.
+		///
+		static bool BuildFixedHuffman()
+		{
+			uint8_t lengths[288];
+			memset(lengths, 8, 144);
+			memset(lengths + 144, 9, 112);
+			memset(lengths + 256, 7, 24);
+			memset(lengths + 280, 8, 8);
+			BuildHuffman(s_fixedLengths, lengths, 288);
+
+			memset(lengths, 5, 30);
+			BuildHuffman(s_fixedDistances, lengths, 30);
+			return true;
+		}
+
+		static const bool s_bFixedHuffmanBuilt = BuildFixedHuffman();
+
+		///
+		/// Moves to the next non-empty segment; returns false at the end of the input.
+		///
+		static bool NextSegment(InflateInput &in)
+		{
+			while (in.segment + 1 < in.segmentCount)
+			{
+				in.segment++;
+				in.p = (const uint8_t *)in.pSegments[in.segment].pData;
+				in.pEnd = in.p + in.pSegments[in.segment].size;
+				if (in.p != in.pEnd)
+					return true;
+			}
+
+			return false;
+		}
+
+		///
+		/// Tops the bit buffer up to at least 56 bits, feeding zeros past the end.
+		///
+		static inline void Refill(InflateInput &in)
+		{
+			if (in.pEnd - in.p >= 8)
+			{
+				uint64_t value;
+				memcpy(&value, in.p, sizeof(uint64_t));
+				in.bits |= value << in.count;
+				in.p += (63 - in.count) >> 3;
+				in.count |= 56;
+				return;
+			}
+
+			while (in.count <= 56)
+			{
+				if (in.p != in.pEnd || NextSegment(in))
+					in.bits |= (uint64_t)*in.p++ << in.count;
+				else
+					in.overrun++;
+
+				in.count += 8;
+			}
+		}
+
+		///
+		/// Takes count bits; the buffer must hold them.
+		///
+		static inline uint32_t TakeBits(InflateInput &in, int32_t count)
+		{
+			uint32_t value = (uint32_t)(in.bits & ((1ull << count) - 1));
+			in.bits >>= count;
+			in.count -= count;
+			return value;
+		}
+
+		///
+		/// Returns whether or not bits past the end of the input were consumed.
+		///
+		static inline bool Overran(const InflateInput &in)
+		{
+			return in.overrun * 8 > in.count;
+		}
+
+		///
+		/// Decodes a code longer than InflateFastBits one bit at a time.
+		///
+		static int32_t DecodeSlow(InflateInput &in, const InflateHuffman &huffman)
+		{
+			uint64_t bits = in.bits;
+			int32_t code = 0;
+			int32_t first = 0;
+			int32_t index = 0;
+			for (int32_t length = 1; length <= InflateMaxBits; length++)
+			{
+				code |= (int32_t)(bits & 1);
+				bits >>= 1;
+
+				int32_t count = huffman.counts[length];
+				if (code - first < count)
+				{
+					in.bits >>= length;
+					in.count -= length;
+					return huffman.symbols[index + code - first];
+				}
+
+				index += count;
+				first = (first + count) << 1;
+				code <<= 1;
+			}
+
+			return -1;
+		}
+
+		///
+		/// Decodes a symbol; the buffer must hold 15 bits. Returns -1 for an unused code.
+		///
+		static inline int32_t DecodeSymbol(InflateInput &in, const InflateHuffman &huffman)
+		{
+			uint16_t entry = huffman.fast[in.bits & InflateFastMask];
+			if (entry == 0)
+				return DecodeSlow(in, huffman);
+
+			in.bits >>= entry >> 9;
+			in.count -= entry >> 9;
+			return entry & 0x1FF;
+		}
+
+		///
+		/// Copies a stored block.
+		///
+		static bool CopyStored(InflateInput &in, uint8_t *&pOut, uint8_t *pOutEnd)
+		{
+			TakeBits(in, in.count & 7);
+			Refill(in);
+
+			uint32_t length = TakeBits(in, 16);
+			uint32_t inverse = TakeBits(in, 16);
+			if (length != (~inverse & 0xFFFF) || (int64_t)length > pOutEnd - pOut)
+				return false;
+
+			// first the whole bytes still in the buffer, then straight from the input
+			while (length > 0 && in.count > 0)
+			{
+				if (in.count <= in.overrun * 8)
+					return false;
+
+				*pOut++ = (uint8_t)TakeBits(in, 8);
+				length--;
+			}
+
+			if (in.count == 0)
+				in.bits = 0;
+
+			while (length > 0)
+			{
+				if (in.p == in.pEnd && !NextSegment(in))
+					return false;
+
+				uint32_t available = (uint32_t)(in.pEnd - in.p);
+				uint32_t copied = (length < available) ? length : available;
+				memcpy(pOut, in.p, copied);
+				in.p += copied;
+				pOut += copied;
+				length -= copied;
+			}
+
+			return true;
+		}
+
+		///
+		/// Decodes the codes of a Huffman block up to its end-of-block symbol.
+		///
+		static bool DecodeCodes(InflateInput &in, const InflateHuffman &lengths, const InflateHuffman &distances,
+			uint8_t *pStart, uint8_t *&pOut, uint8_t *pOutEnd)
+		{
+			for (;;)
+			{
+				// a length code and a distance code with their extra bits take up to 48 bits
+				Refill(in);
+
+				int32_t symbol = DecodeSymbol(in, lengths);
+				if (symbol < 256)
+				{
+					if (symbol < 0 || pOut == pOutEnd)
+						return false;
+
+					*pOut++ = (uint8_t)symbol;
+					continue;
+				}
+
+				if (symbol == 256)
+					return true;
+
+				symbol -= 257;
+				if (symbol >= 29)
+					return false;
+
+				int32_t length = s_lengthBase[symbol] + (int32_t)TakeBits(in, s_lengthExtra[symbol]);
+
+				symbol = DecodeSymbol(in, distances);
+				if (symbol < 0 || symbol >= 30)
+					return false;
+
+				int32_t distance = s_distanceBase[symbol] + (int32_t)TakeBits(in, s_distanceExtra[symbol]);
+				if (distance > pOut - pStart || length > pOutEnd - pOut)
+					return false;
+
+				const uint8_t *pFrom = pOut - distance;
+				if (distance >= length)
+				{
+					memcpy(pOut, pFrom, length);
+				}
+				else if (distance == 1)
+				{
+					memset(pOut, *pFrom, length);
+				}
+				else
+				{
+					for (int32_t i = 0; i < length; i++)
+						pOut[i] = pFrom[i];
+				}
+
+				pOut += length;
+			}
+		}
+
+		///
+		/// Reads the codes of a dynamic Huffman block.
+		///
+		static bool ReadDynamicHuffman(InflateInput &in, InflateHuffman &lengths, InflateHuffman &distances)
+		{
+			Refill(in);
+			int32_t lengthCount = (int32_t)TakeBits(in, 5) + 257;
+			int32_t distanceCount = (int32_t)TakeBits(in, 5) + 1;
+			int32_t codeLengthCount = (int32_t)TakeBits(in, 4) + 4;
+			if (lengthCount > 286 || distanceCount > 30)
+				return false;
+
+			uint8_t codeLengths[19];
+			memset(codeLengths, 0, sizeof(codeLengths));
+			for (int32_t i = 0; i < codeLengthCount; i++)
+			{
+				Refill(in);
+				codeLengths[s_codeLengthOrder[i]] = (uint8_t)TakeBits(in, 3);
+			}
+
+			// the code length code is decoded with the lengths table
+			if (!BuildHuffman(lengths, codeLengths, 19))
+				return false;
+
+			uint8_t codeLengthsOfCodes[286 + 30];
+			int32_t total = lengthCount + distanceCount;
+			for (int32_t index = 0; index < total; )
+			{
+				Refill(in);
+				int32_t symbol = DecodeSymbol(in, lengths);
+				if (symbol < 0)
+					return false;
+
+				if (symbol < 16)
+				{
+					codeLengthsOfCodes[index++] = (uint8_t)symbol;
+					continue;
+				}
+
+				uint8_t value = 0;
+				int32_t repeat;
+				if (symbol == 16)
+				{
+					if (index == 0)
+						return false;
+
+					value = codeLengthsOfCodes[index - 1];
+					repeat = 3 + (int32_t)TakeBits(in, 2);
+				}
+				else if (symbol == 17)
+				{
+					repeat = 3 + (int32_t)TakeBits(in, 3);
+				}
+				else
+				{
+					repeat = 11 + (int32_t)TakeBits(in, 7);
+				}
+
+				if (index + repeat > total)
+					return false;
+
+				memset(codeLengthsOfCodes + index, value, repeat);
+				index += repeat;
+			}
+
+			// a block without an end-of-block code cannot end
+			if (codeLengthsOfCodes[256] == 0)
+				return false;
+
+			return BuildHuffman(lengths, codeLengthsOfCodes, lengthCount)
+				&& BuildHuffman(distances, codeLengthsOfCodes + lengthCount, distanceCount);
+		}
+
+		///
+		/// Decompresses a deflate or zlib stream of exactly rawSize bytes.
+		///
+		static bool InflateStream(const InflateSegment *pSegments, int32_t count, bool zlib, char *pDestination, int32_t rawSize)
+		{
+			InflateInput in;
+			in.pSegments = pSegments;
+			in.segmentCount = count;
+			in.segment = -1;
+			in.p = nullptr;
+			in.pEnd = nullptr;
+			in.bits = 0;
+			in.count = 0;
+			in.overrun = 0;
+			NextSegment(in);
+
+			if (zlib)
+			{
+				// deflate with a window of at most 32 KB and no preset dictionary
+				Refill(in);
+				uint32_t method = TakeBits(in, 8);
+				uint32_t flags = TakeBits(in, 8);
+				if ((method & 15) != 8 || (method >> 4) > 7 || ((method << 8) | flags) % 31 != 0 || (flags & 0x20) != 0)
+					return false;
+			}
+
+			uint8_t *pStart = (uint8_t *)pDestination;
+			uint8_t *pOut = pStart;
+			uint8_t *pOutEnd = pStart + rawSize;
+			InflateHuffman lengths;
+			InflateHuffman distances;
+
+			bool final = false;
+			while (!final)
+			{
+				Refill(in);
+				final = TakeBits(in, 1) != 0;
+				uint32_t type = TakeBits(in, 2);
+
+				bool decoded;
+				if (type == 0)
+					decoded = CopyStored(in, pOut, pOutEnd);
+				else if (type == 1)
+					decoded = DecodeCodes(in, s_fixedLengths, s_fixedDistances, pStart, pOut, pOutEnd);
+				else if (type == 2)
+					decoded = ReadDynamicHuffman(in, lengths, distances) && DecodeCodes(in, lengths, distances, pStart, pOut, pOutEnd);
+				else
+					decoded = false;
+
+				if (!decoded || Overran(in))
+					return false;
+			}
+
+			return pOut == pOutEnd;
+		}
+
+		///
+		/// Decompresses a raw deflate stream of rawSize bytes.
+		///
+		bool Inflate::Decompress(const char *pSource, int32_t size, char *pDestination, int32_t rawSize)
+		{
+			InflateSegment segment = { pSource, size };
+			return InflateStream(&segment, 1, false, pDestination, rawSize);
+		}
+
+		///
+		/// Decompresses a zlib stream of rawSize bytes.
+		///
+		bool Inflate::DecompressZlib(const char *pSource, int32_t size, char *pDestination, int32_t rawSize)
+		{
+			InflateSegment segment = { pSource, size };
+			return InflateStream(&segment, 1, true, pDestination, rawSize);
+		}
+
+		///
+		/// Decompresses a zlib stream of rawSize bytes that is split across segments.
+		///
+		bool Inflate::DecompressZlib(const InflateSegment *pSegments, int32_t count, char *pDestination, int32_t rawSize)
+		{
+			return InflateStream(pSegments, count, true, pDestination, rawSize);
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,59 @@
+#pragma once
+#ifndef _TEKSTORM_INFLATE_H
+#define _TEKSTORM_INFLATE_H
+#include "../tekconfig.h"
+
+namespace Tekstorm
+{
+	namespace IO
+	{
+		///
+		/// A piece of a compressed stream that is split across buffers (for example
+		/// the IDAT chunks of a PNG file).
+		///
+		struct InflateSegment
+		{
+			const char *pData;
+			int32_t size;
+		};
+
+		///
+		/// Decompresses deflate (RFC 1951) and zlib (RFC 1950) streams of a known
+		/// size, reading the input in place.
+		///
+		/// Codes of up to 10 bits are decoded with one table lookup and the input
+		/// is read 64 bits at a time. The zlib Adler-32 is not checked; a stream is
+		/// rejected if it is malformed or does not decompress to exactly rawSize
+		/// bytes.
+		///
+		/// Every function is thread-safe.
+		///
+		class TEKAPI Inflate
+		{
+		private:
+			///
+			/// No public constructor
+			///
+			Inflate() { }
+
+		public:
+			///
+			/// Decompresses a raw deflate stream of rawSize bytes.
+			///
+			static bool Decompress(const char *pSource, int32_t size, char *pDestination, int32_t rawSize);
+
+			///
+			/// Decompresses a zlib stream of rawSize bytes.
+			///
+			static bool DecompressZlib(const char *pSource, int32_t size, char *pDestination, int32_t rawSize);
+
+			///
+			/// Decompresses a zlib stream of rawSize bytes that is split across
+			/// segments, without joining them.
+			///
+			static bool DecompressZlib(const InflateSegment *pSegments, int32_t count, char *pDestination, int32_t rawSize);
+		};
+	}
+}
+
+#endif /* _TEKSTORM_INFLATE_H */
\ No newline at end of file
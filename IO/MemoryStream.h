@@ -33,6 +33,16 @@ namespace Tekstorm
 			///
 			virtual void SetDestination(char *pDest, int32_t size);
 
+			///
+			/// Gets the current index into the buffer.
+			///
+			int32_t GetPosition() const { return m_nCurrentIndex; }
+
+			///
+			/// Gets the underlying buffer.
+			///
+			const char *GetBuffer() const { return m_pBuffer; }
+
 			///
 			/// Returns whether or not this stream can be read from.
 			///
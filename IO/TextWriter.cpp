@@ -1,6 +1,5 @@
 #define TEKSTORM_BUILD
 #include "TextWriter.h"
-#include <sstream>
 
 namespace Tekstorm
 {
@@ -69,6 +68,25 @@ namespace Tekstorm
 			m_pStream->Write(tempBuff, length, 0);
 		}
 
+		///
+		/// Writes a 64-bit integral number to the stream.
+		///
+		void TextWriter::Write(int64_t number)
+		{
+#if defined(TEKSTORM_DEBUG)
+			if (m_pStream == nullptr) {
+				TEKDEBUG_EF("Cannot write to a null stream.");
+			}
+#endif
+
+			// 19 digits + 1 for sign + 1 for null
+			char text[19 + 1 + 1];
+			int length = _snprintf(text, sizeof(text), "%I64d", number);
+			if (length < 0 || length >= (int)sizeof(text))
+				length = (int)sizeof(text) - 1;
+			m_pStream->Write(text, length, 0);
+		}
+
 		///
 		/// Writes a single character to the stream.
 		///
@@ -94,12 +112,12 @@ namespace Tekstorm
 			}
 #endif
 
-			std::string temp = "";
-			
-			std::stringstream stream;
-			stream << number;
-			stream >> temp;
-			m_pStream->Write(temp.c_str(), temp.length(), 0);
+			// %g matches what a default std::stringstream writes
+			char text[32];
+			int length = _snprintf(text, sizeof(text), "%g", number);
+			if (length < 0 || length >= (int)sizeof(text))
+				length = (int)sizeof(text) - 1;
+			m_pStream->Write(text, length, 0);
 		}
 
 	}
@@ -45,6 +45,11 @@ namespace Tekstorm
 			///
 			virtual void Write(int32_t number);
 
+			///
+			/// Writes a 64-bit integral number to the stream.
+			///
+			virtual void Write(int64_t number);
+
 			///
 			/// Writes a single character to the stream.
 			///
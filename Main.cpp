@@ -5,6 +5,8 @@
 #include "math/Color4.h"
 #include "graphics/Texture.h"
 #include "math/Matrix4.h"
+#include "core/FrameAllocator.h"
+#include "core/MemoryTracker.h"
 #include <D3D11.h>
 #include <xnamath.h>
 
@@ -68,11 +70,14 @@ int main()
 		pDevice->Draw(3);
 
 		pDevice->Present();
+		FrameAllocator::EndFrame();
+		MemoryTracker::Update();
 	}
 
 	delete dataBuff;
 	delete tex;
 	delete buffer;
 	delete pDevice;
+	FrameAllocator::Shutdown();
 	return 0;
 }
\ No newline at end of file
@@ -0,0 +1,156 @@
+#define TEKSTORM_BUILD
+#include "ArenaAllocator.h"
+
+namespace Tekstorm
+{
+	namespace Core
+	{
+		///
+		/// Precedes every overflow block.
+		///
+		struct ArenaOverflowBlock
+		{
+			ArenaOverflowBlock *pNext;
+			void *pAllocation;
+		};
+
+		///
+		/// Initializes an arena with its own buffer of 'capacity' bytes.
+		///
+		ArenaAllocator::ArenaAllocator(size_t capacity)
+		{
+			m_pBuffer = (char *)_aligned_malloc(capacity, DefaultAlignment);
+			m_nCapacity = (m_pBuffer != nullptr) ? capacity : 0;
+			m_nOffset = 0;
+			m_nPeak = 0;
+			m_pOverflow = nullptr;
+			m_nOverflowCount = 0;
+			m_bOwnsBuffer = true;
+		}
+
+		///
+		/// Initializes an arena over a caller-owned buffer.
+		///
+		ArenaAllocator::ArenaAllocator(void *pBuffer, size_t capacity)
+		{
+			m_pBuffer = (char *)pBuffer;
+			m_nCapacity = capacity;
+			m_nOffset = 0;
+			m_nPeak = 0;
+			m_pOverflow = nullptr;
+			m_nOverflowCount = 0;
+			m_bOwnsBuffer = false;
+		}
+
+		ArenaAllocator::~ArenaAllocator()
+		{
+			Reset();
+			if (m_bOwnsBuffer)
+				_aligned_free(m_pBuffer);
+		}
+
+		///
+		/// Allocates 'size' bytes aligned to 'alignment' (a power of two).
+		///
+		void *ArenaAllocator::Allocate(size_t size, size_t alignment)
+		{
+			size_t address = (size_t)(m_pBuffer + m_nOffset);
+			size_t padding = (alignment - (address & (alignment - 1))) & (alignment - 1);
+
+			if (m_nOffset + padding + size <= m_nCapacity)
+			{
+				void *p = m_pBuffer + m_nOffset + padding;
+				m_nOffset += padding + size;
+				if (m_nOffset > m_nPeak)
+					m_nPeak = m_nOffset;
+
+				return p;
+			}
+
+			// out of arena; fall back to the heap until the next rewind
+			ArenaOverflowBlock *pBlock = (ArenaOverflowBlock *)malloc(sizeof(ArenaOverflowBlock));
+			if (pBlock == nullptr)
+				return nullptr;
+
+			pBlock->pAllocation = _aligned_malloc(size, alignment < DefaultAlignment ? DefaultAlignment : alignment);
+			if (pBlock->pAllocation == nullptr)
+			{
+				free(pBlock);
+				return nullptr;
+			}
+
+			pBlock->pNext = (ArenaOverflowBlock *)m_pOverflow;
+			m_pOverflow = pBlock;
+			m_nOverflowCount++;
+			return pBlock->pAllocation;
+		}
+
+		///
+		/// Gets the current position.
+		///
+		ArenaMarker ArenaAllocator::GetMarker() const
+		{
+			ArenaMarker marker;
+			marker.offset = m_nOffset;
+			marker.pOverflow = m_pOverflow;
+			return marker;
+		}
+
+		///
+		/// Rewinds to a marker, releasing everything allocated after it.
+		///
+		void ArenaAllocator::Reset(const ArenaMarker &marker)
+		{
+			while (m_pOverflow != nullptr && m_pOverflow != marker.pOverflow)
+			{
+				ArenaOverflowBlock *pBlock = (ArenaOverflowBlock *)m_pOverflow;
+				m_pOverflow = pBlock->pNext;
+				_aligned_free(pBlock->pAllocation);
+				free(pBlock);
+			}
+
+			m_nOffset = marker.offset;
+		}
+
+		///
+		/// Releases everything.
+		///
+		void ArenaAllocator::Reset()
+		{
+			ArenaMarker start = { 0, nullptr };
+			Reset(start);
+		}
+
+		///
+		/// Gets the number of arena bytes in use.
+		///
+		size_t ArenaAllocator::GetUsed() const
+		{
+			return m_nOffset;
+		}
+
+		///
+		/// Gets the size of the arena.
+		///
+		size_t ArenaAllocator::GetCapacity() const
+		{
+			return m_nCapacity;
+		}
+
+		///
+		/// Gets the highest number of arena bytes ever in use.
+		///
+		size_t ArenaAllocator::GetPeak() const
+		{
+			return m_nPeak;
+		}
+
+		///
+		/// Gets the number of allocations that overflowed to the heap.
+		///
+		int32_t ArenaAllocator::GetOverflowCount() const
+		{
+			return m_nOverflowCount;
+		}
+	}
+}
\ No newline at end of file
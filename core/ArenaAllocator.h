@@ -0,0 +1,238 @@
+#pragma once
+#ifndef _TEKSTORM_ARENAALLOCATOR_H
+#define _TEKSTORM_ARENAALLOCATOR_H
+#include "../tekconfig.h"
+#include <new>
+
+namespace Tekstorm
+{
+	namespace Core
+	{
+		///
+		/// A position in an ArenaAllocator that it can be rewound to.
+		///
+		struct ArenaMarker
+		{
+			// The bump offset.
+			size_t offset;
+
+			// The newest overflow block.
+			void *pOverflow;
+		};
+
+		///
+		/// A linear (bump) allocator over one contiguous buffer. Individual allocations
+		/// are never freed; the arena is rewound to a marker or reset as a whole.
+		///
+		/// Requests that do not fit are served from the heap and released on the
+		/// next rewind past them, so running out of arena costs speed, not correctness.
+		/// An arena belongs to a single thread.
+		///
+		class TEKAPI ArenaAllocator
+		{
+		protected:
+			///
+			/// The arena memory.
+			///
+			char *m_pBuffer;
+
+			///
+			/// The size of the arena memory.
+			///
+			size_t m_nCapacity;
+
+			///
+			/// The bump offset.
+			///
+			size_t m_nOffset;
+
+			///
+			/// The highest offset reached since the arena was created.
+			///
+			size_t m_nPeak;
+
+			///
+			/// Heap blocks allocated once the arena was full, newest first.
+			///
+			void *m_pOverflow;
+
+			///
+			/// The number of allocations that overflowed to the heap.
+			///
+			int32_t m_nOverflowCount;
+
+			///
+			/// Whether or not the arena owns m_pBuffer.
+			///
+			bool m_bOwnsBuffer;
+
+			///
+			/// Arenas are not copyable.
+			///
+			ArenaAllocator(const ArenaAllocator &other);
+			ArenaAllocator &operator=(const ArenaAllocator &other);
+
+		public:
+			///
+			/// The default alignment of allocations.
+			///
+			static const size_t DefaultAlignment = 16;
+
+			///
+			/// Initializes an arena with its own buffer of 'capacity' bytes.
+			///
+			ArenaAllocator(size_t capacity);
+
+			///
+			/// Initializes an arena over a caller-owned buffer.
+			///
+			ArenaAllocator(void *pBuffer, size_t capacity);
+
+			~ArenaAllocator();
+
+			///
+			/// Allocates 'size' bytes aligned to 'alignment' (a power of two).
+			///
+			void *Allocate(size_t size, size_t alignment = DefaultAlignment);
+
+			///
+			/// Allocates and default-constructs 'count' objects. Their destructors are never run.
+			///
+			template <class _Type>
+			_Type *New(size_t count = 1)
+			{
+				_Type *pObjects = (_Type *)Allocate(sizeof(_Type) * count, __alignof(_Type));
+				for (size_t i = 0; i < count; i++)
+					new (&pObjects[i]) _Type();
+
+				return pObjects;
+			}
+
+			///
+			/// Gets the current position.
+			///
+			ArenaMarker GetMarker() const;
+
+			///
+			/// Rewinds to a marker, releasing everything allocated after it.
+			///
+			void Reset(const ArenaMarker &marker);
+
+			///
+			/// Releases everything.
+			///
+			void Reset();
+
+			///
+			/// Gets the number of arena bytes in use.
+			///
+			size_t GetUsed() const;
+
+			///
+			/// Gets the size of the arena.
+			///
+			size_t GetCapacity() const;
+
+			///
+			/// Gets the highest number of arena bytes ever in use.
+			///
+			size_t GetPeak() const;
+
+			///
+			/// Gets the number of allocations that overflowed to the heap.
+			///
+			int32_t GetOverflowCount() const;
+		};
+
+		///
+		/// Rewinds an arena to where it was when the scope was entered.
+		///
+		class ArenaScope
+		{
+		protected:
+			ArenaAllocator *m_pArena;
+			ArenaMarker m_marker;
+
+			ArenaScope(const ArenaScope &other);
+			ArenaScope &operator=(const ArenaScope &other);
+
+		public:
+			ArenaScope(ArenaAllocator *pArena)
+			{
+				m_pArena = pArena;
+				m_marker = pArena->GetMarker();
+			}
+
+			~ArenaScope()
+			{
+				m_pArena->Reset(m_marker);
+			}
+		};
+
+		///
+		/// A std::allocator-compatible adapter so standard containers can live in an arena:
+		///   ArenaStlAllocator<int> allocator(&arena);
+		///   std::vector<int, ArenaStlAllocator<int> > values(allocator);
+		/// deallocate() is a no-op; the memory returns with the arena.
+		///
+		template <class _Type>
+		class ArenaStlAllocator
+		{
+		public:
+			typedef _Type value_type;
+			typedef _Type *pointer;
+			typedef const _Type *const_pointer;
+			typedef _Type &reference;
+			typedef const _Type &const_reference;
+			typedef size_t size_type;
+			typedef ptrdiff_t difference_type;
+
+			template <class _Other>
+			struct rebind
+			{
+				typedef ArenaStlAllocator<_Other> other;
+			};
+
+			// The arena allocations come from.
+			ArenaAllocator *m_pArena;
+
+			ArenaStlAllocator(ArenaAllocator *pArena) : m_pArena(pArena)
+			{
+			}
+
+			template <class _Other>
+			ArenaStlAllocator(const ArenaStlAllocator<_Other> &other) : m_pArena(other.m_pArena)
+			{
+			}
+
+			pointer address(reference value) const { return &value; }
+			const_pointer address(const_reference value) const { return &value; }
+
+			pointer allocate(size_type count, const void * = nullptr)
+			{
+				void *p = m_pArena->Allocate(count * sizeof(_Type), __alignof(_Type));
+				if (p == nullptr)
+					throw std::bad_alloc();
+
+				return (pointer)p;
+			}
+
+			void deallocate(pointer, size_type)
+			{
+			}
+
+			void construct(pointer p, const _Type &value) { new ((void *)p) _Type(value); }
+			void destroy(pointer p) { p->~_Type(); }
+
+			size_type max_size() const { return (size_type)-1 / sizeof(_Type); }
+
+			template <class _Other>
+			bool operator==(const ArenaStlAllocator<_Other> &other) const { return m_pArena == other.m_pArena; }
+
+			template <class _Other>
+			bool operator!=(const ArenaStlAllocator<_Other> &other) const { return m_pArena != other.m_pArena; }
+		};
+	}
+}
+
+#endif /* _TEKSTORM_ARENAALLOCATOR_H */
\ No newline at end of file
@@ -0,0 +1,129 @@
+#define TEKSTORM_BUILD
+#include "Checksum.h"
+#include <intrin.h>
+#include <nmmintrin.h>
+
+namespace Tekstorm
+{
+	namespace Core
+	{
+		///
+		/// The reflected CRC-32C polynomial.
+		///
+		static const uint32_t Crc32cPolynomial = 0x82F63B78;
+
+		///
+		/// Slicing-by-8 tables: s_crcTables[k][b] is the CRC of byte b followed by k zero bytes.
+		///
+		static uint32_t s_crcTables[8][256];
+
+		///
+		/// Fills the tables; returns true so it can initialize a static.
+		///
+		static bool BuildCrcTables()
+		{
+			for (uint32_t i = 0; i < 256; i++)
+			{
+				uint32_t crc = i;
+				for (int32_t bit = 0; bit < 8; bit++)
+					crc = (crc >> 1) ^ (Crc32cPolynomial & (0 - (crc & 1)));
+
+				s_crcTables[0][i] = crc;
+			}
+
+			for (uint32_t i = 0; i < 256; i++)
+			{
+				for (int32_t k = 1; k < 8; k++)
+					s_crcTables[k][i] = (s_crcTables[k - 1][i] >> 8) ^ s_crcTables[0][s_crcTables[k - 1][i] & 0xFF];
+			}
+
+			return true;
+		}
+
+		///
+		/// Checks cpuid for SSE4.2 (leaf 1, ECX bit 20).
+		///
+		static bool DetectSse42()
+		{
+			int info[4];
+			__cpuid(info, 1);
+			return (info[2] & (1 << 20)) != 0;
+		}
+
+		static const bool s_bCrcTablesBuilt = BuildCrcTables();
+		static const bool s_bHasSse42 = DetectSse42();
+
+		///
+		/// The table CRC over an inverted crc.
+		///
+		static uint32_t Crc32cTable(const uint8_t *p, size_t size, uint32_t crc)
+		{
+			for (; size >= 8; size -= 8, p += 8)
+			{
+				uint32_t low;
+				uint32_t high;
+				memcpy(&low, p, sizeof(uint32_t));
+				memcpy(&high, p + 4, sizeof(uint32_t));
+				low ^= crc;
+
+				crc = s_crcTables[7][low & 0xFF] ^ s_crcTables[6][(low >> 8) & 0xFF]
+					^ s_crcTables[5][(low >> 16) & 0xFF] ^ s_crcTables[4][low >> 24]
+					^ s_crcTables[3][high & 0xFF] ^ s_crcTables[2][(high >> 8) & 0xFF]
+					^ s_crcTables[1][(high >> 16) & 0xFF] ^ s_crcTables[0][high >> 24];
+			}
+
+			for (; size > 0; size--, p++)
+				crc = (crc >> 8) ^ s_crcTables[0][(crc ^ *p) & 0xFF];
+
+			return crc;
+		}
+
+		///
+		/// The SSE4.2 CRC over an inverted crc.
+		///
+		static uint32_t Crc32cHardware(const uint8_t *p, size_t size, uint32_t crc)
+		{
+#if defined(_M_X64) || defined(__x86_64__)
+			uint64_t crc64 = crc;
+			for (; size >= 8; size -= 8, p += 8)
+			{
+				uint64_t value;
+				memcpy(&value, p, sizeof(uint64_t));
+				crc64 = _mm_crc32_u64(crc64, value);
+			}
+			crc = (uint32_t)crc64;
+#endif
+
+			for (; size >= 4; size -= 4, p += 4)
+			{
+				uint32_t value;
+				memcpy(&value, p, sizeof(uint32_t));
+				crc = _mm_crc32_u32(crc, value);
+			}
+
+			for (; size > 0; size--, p++)
+				crc = _mm_crc32_u8(crc, *p);
+
+			return crc;
+		}
+
+		///
+		/// Gets the CRC-32C of a run of bytes.
+		///
+		uint32_t Checksum::Crc32c(const void *pData, size_t size, uint32_t crc)
+		{
+			const uint8_t *p = (const uint8_t *)pData;
+			crc = ~crc;
+			crc = s_bHasSse42 ? Crc32cHardware(p, size, crc) : Crc32cTable(p, size, crc);
+			return ~crc;
+		}
+
+		///
+		/// Returns whether or not Crc32c() uses the SSE4.2 instruction.
+		///
+		bool Checksum::HasHardwareCrc32c()
+		{
+			return s_bHasSse42;
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,39 @@
+#pragma once
+#ifndef _TEKSTORM_CHECKSUM_H
+#define _TEKSTORM_CHECKSUM_H
+#include "../tekconfig.h"
+
+namespace Tekstorm
+{
+	namespace Core
+	{
+		///
+		/// CRC-32C (Castagnoli) checksums, for catching corrupted assets and packets.
+		///
+		/// Uses the SSE4.2 crc32 instruction when the CPU has it (checked once, with
+		/// cpuid) and a slicing-by-8 table otherwise; both give the same result.
+		///
+		class TEKAPI Checksum
+		{
+		private:
+			///
+			/// No public constructor
+			///
+			Checksum() { }
+
+		public:
+			///
+			/// Gets the CRC-32C of a run of bytes. Pass the previous result as crc to
+			/// continue a checksum over several runs.
+			///
+			static uint32_t Crc32c(const void *pData, size_t size, uint32_t crc = 0);
+
+			///
+			/// Returns whether or not Crc32c() uses the SSE4.2 instruction.
+			///
+			static bool HasHardwareCrc32c();
+		};
+	}
+}
+
+#endif /* _TEKSTORM_CHECKSUM_H */
\ No newline at end of file
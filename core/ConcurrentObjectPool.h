@@ -0,0 +1,226 @@
+#pragma once
+#ifndef _TEKSTORM_CONCURRENTOBJECTPOOL_H
+#define _TEKSTORM_CONCURRENTOBJECTPOOL_H
+#include "ObjectPool.h"
+
+namespace Tekstorm
+{
+	namespace Core
+	{
+		///
+		/// A thread-safe ObjectPool. Every thread keeps a small cache of free slots, so
+		/// Create() and Destroy() only take the pool lock to refill or drain a cache,
+		/// once per CacheSize / 2 operations.
+		///
+		/// Get() takes no lock. As with raw pointers, the caller must make sure the
+		/// object is not destroyed by another thread while it is being used.
+		///
+		template <class _Type>
+		class ConcurrentObjectPool : protected ObjectPool<_Type>
+		{
+		protected:
+			typedef ObjectPool<_Type> BaseType;
+
+			// The number of free slots a thread caches.
+			static const uint32_t CacheSize = 64;
+
+			///
+			/// The free slots cached by one thread.
+			///
+			struct ThreadCache
+			{
+				uint32_t count;
+				uint32_t indices[CacheSize];
+			};
+
+			///
+			/// The TLS slot holding each thread's cache.
+			///
+			DWORD m_nTlsIndex;
+
+			///
+			/// Guards the base pool and m_caches.
+			///
+			CRITICAL_SECTION m_lock;
+
+			///
+			/// Every thread cache, freed with the pool.
+			///
+			std::vector<ThreadCache *> m_caches;
+
+			///
+			/// The number of live objects.
+			///
+			volatile LONG m_nLiveCount;
+
+			///
+			/// Gets the calling thread's cache, creating it on first use.
+			///
+			ThreadCache *GetCache()
+			{
+				ThreadCache *pCache = (ThreadCache *)TlsGetValue(m_nTlsIndex);
+				if (pCache == nullptr)
+				{
+					pCache = new ThreadCache();
+					pCache->count = 0;
+					TlsSetValue(m_nTlsIndex, pCache);
+
+					EnterCriticalSection(&m_lock);
+					m_caches.push_back(pCache);
+					LeaveCriticalSection(&m_lock);
+				}
+
+				return pCache;
+			}
+
+		public:
+			ConcurrentObjectPool()
+			{
+				m_nTlsIndex = TlsAlloc();
+				m_nLiveCount = 0;
+				InitializeCriticalSection(&m_lock);
+			}
+
+			~ConcurrentObjectPool()
+			{
+				for (size_t i = 0; i < m_caches.size(); i++)
+					delete m_caches[i];
+
+				TlsFree(m_nTlsIndex);
+				DeleteCriticalSection(&m_lock);
+			}
+
+			///
+			/// Creates a default-constructed object. Returns a null handle if the pool is full.
+			///
+			Handle Create()
+			{
+				uint32_t index = TakeIndex();
+				if (index == BaseType::NoSlot)
+					return Handle();
+
+				new (BaseType::GetObject(index)) _Type();
+				InterlockedIncrement(&m_nLiveCount);
+				return BaseType::Publish(index);
+			}
+
+			///
+			/// Creates a copy of 'value'. Returns a null handle if the pool is full.
+			///
+			Handle Create(const _Type &value)
+			{
+				uint32_t index = TakeIndex();
+				if (index == BaseType::NoSlot)
+					return Handle();
+
+				new (BaseType::GetObject(index)) _Type(value);
+				InterlockedIncrement(&m_nLiveCount);
+				return BaseType::Publish(index);
+			}
+
+			///
+			/// Destroys an object. Returns false if the handle was stale.
+			///
+			bool Destroy(Handle handle)
+			{
+				if (!BaseType::Resolves(handle))
+					return false;
+
+				uint32_t index = handle.GetIndex();
+				BaseType::Retire(index);
+				InterlockedDecrement(&m_nLiveCount);
+
+				// a full cache hands half of its slots back to the pool
+				ThreadCache *pCache = GetCache();
+				if (pCache->count == CacheSize)
+				{
+					EnterCriticalSection(&m_lock);
+					while (pCache->count > CacheSize / 2)
+						BaseType::FreeIndex(pCache->indices[--pCache->count]);
+					LeaveCriticalSection(&m_lock);
+				}
+
+				pCache->indices[pCache->count++] = index;
+				return true;
+			}
+
+			///
+			/// Gets an object, or nullptr if the handle is null or stale.
+			///
+			_Type *Get(Handle handle) const
+			{
+				return BaseType::Get(handle);
+			}
+
+			///
+			/// Returns true if the handle refers to a live object.
+			///
+			bool IsValid(Handle handle) const
+			{
+				return BaseType::Resolves(handle);
+			}
+
+			///
+			/// Gets the number of live objects.
+			///
+			uint32_t GetCount() const
+			{
+				return (uint32_t)m_nLiveCount;
+			}
+
+			///
+			/// Destroys every object and empties the thread caches. No other thread may
+			/// use the pool meanwhile.
+			///
+			void Clear()
+			{
+				EnterCriticalSection(&m_lock);
+				for (size_t i = 0; i < m_caches.size(); i++)
+					m_caches[i]->count = 0;
+
+				BaseType::Clear();
+				m_nLiveCount = 0;
+				LeaveCriticalSection(&m_lock);
+			}
+
+			///
+			/// Calls function(handle, pObject) for every live object. No other thread may
+			/// create or destroy objects meanwhile.
+			///
+			template <class _Function>
+			void ForEach(_Function function)
+			{
+				BaseType::ForEach(function);
+			}
+
+		protected:
+			///
+			/// Takes a free slot from the calling thread's cache, refilling it from the pool.
+			///
+			uint32_t TakeIndex()
+			{
+				ThreadCache *pCache = GetCache();
+				if (pCache->count == 0)
+				{
+					EnterCriticalSection(&m_lock);
+					while (pCache->count < CacheSize / 2)
+					{
+						uint32_t index = BaseType::AllocateIndex();
+						if (index == BaseType::NoSlot)
+							break;
+
+						pCache->indices[pCache->count++] = index;
+					}
+					LeaveCriticalSection(&m_lock);
+
+					if (pCache->count == 0)
+						return BaseType::NoSlot;
+				}
+
+				return pCache->indices[--pCache->count];
+			}
+		};
+	}
+}
+
+#endif /* _TEKSTORM_CONCURRENTOBJECTPOOL_H */
\ No newline at end of file
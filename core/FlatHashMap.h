@@ -0,0 +1,512 @@
+#pragma once
+#ifndef _TEKSTORM_FLATHASHMAP_H
+#define _TEKSTORM_FLATHASHMAP_H
+#include "../tekconfig.h"
+#include "Hash.h"
+#include "Debug.h"
+#include <new>
+#include <intrin.h>
+#include <emmintrin.h>
+
+namespace Tekstorm
+{
+	namespace Core
+	{
+		///
+		/// The open-addressing table behind FlatHashMap and FlatHashSet.
+		///
+		/// Entries live in one flat array, split into groups of GroupSize slots. Each
+		/// slot has a control byte: empty, deleted, or the low 7 bits of the hash of
+		/// its key. A lookup loads a group's 16 control bytes with one SSE2 load and
+		/// compares all of them against the key's tag at once, so it only touches the
+		/// entries whose tag matches, and stops at the first group with an empty slot.
+		/// Groups are probed quadratically from the group picked by the high hash bits.
+		///
+		/// Lookup methods are templates taking any key type the hash and equality
+		/// accept, so a table keyed by std::string can be searched with a StringRef
+		/// without building a string.
+		///
+		/// Entries move when the table grows, so pointers to them are invalidated by
+		/// inserts. Not thread-safe.
+		///
+		template <class _Entry, class _Hash>
+		class FlatHashTable
+		{
+		protected:
+			static const size_t GroupSize = 16;
+
+			// Marks a slot search that found nothing.
+			static const size_t NoIndex = (size_t)-1;
+
+			// Control bytes; full slots hold a 7-bit tag, i.e. a non-negative value.
+			static const int8_t CtrlEmpty = -128;
+			static const int8_t CtrlDeleted = -2;
+
+			///
+			/// One control byte per slot.
+			///
+			int8_t *m_pCtrl;
+
+			///
+			/// The slots.
+			///
+			_Entry *m_pEntries;
+
+			///
+			/// The number of slots; zero or a power of two of at least GroupSize.
+			///
+			size_t m_nCapacity;
+
+			///
+			/// The number of entries.
+			///
+			size_t m_nCount;
+
+			///
+			/// The number of empty slots that can be filled before the table must grow.
+			///
+			size_t m_nGrowthLeft;
+
+			_Hash m_hash;
+
+			///
+			/// Tables are not copyable.
+			///
+			FlatHashTable(const FlatHashTable &other);
+			FlatHashTable &operator=(const FlatHashTable &other);
+
+			static int8_t GetTag(uint64_t hash)
+			{
+				return (int8_t)(hash & 0x7F);
+			}
+
+			///
+			/// Gets the bits of a group's slots whose control byte equals 'value'.
+			///
+			uint32_t MatchGroup(size_t group, int8_t value) const
+			{
+				__m128i ctrl = _mm_load_si128((const __m128i *)(m_pCtrl + group * GroupSize));
+				return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(value)));
+			}
+
+			///
+			/// Gets the bits of a group's empty or deleted slots.
+			///
+			uint32_t MatchFree(size_t group) const
+			{
+				return (uint32_t)_mm_movemask_epi8(_mm_load_si128((const __m128i *)(m_pCtrl + group * GroupSize)));
+			}
+
+			static size_t LowestBit(uint32_t mask)
+			{
+				unsigned long index;
+				_BitScanForward(&index, mask);
+				return index;
+			}
+
+			///
+			/// Finds the slot of a key, or NoIndex.
+			///
+			template <class _Lookup>
+			size_t FindIndex(const _Lookup &key, uint64_t hash) const
+			{
+				if (m_nCapacity == 0)
+					return NoIndex;
+
+				size_t groupMask = m_nCapacity / GroupSize - 1;
+				size_t group = (size_t)(hash >> 7) & groupMask;
+				int8_t tag = GetTag(hash);
+
+				for (size_t probe = 1; ; probe++)
+				{
+					for (uint32_t match = MatchGroup(group, tag); match != 0; match &= match - 1)
+					{
+						size_t index = group * GroupSize + LowestBit(match);
+						if (m_pEntries[index].key == key)
+							return index;
+					}
+
+					if (MatchGroup(group, CtrlEmpty) != 0 || probe > groupMask)
+						return NoIndex;
+
+					group = (group + probe) & groupMask;
+				}
+			}
+
+			///
+			/// Finds the first empty or deleted slot on a hash's probe sequence.
+			///
+			size_t FindFreeIndex(uint64_t hash) const
+			{
+				size_t groupMask = m_nCapacity / GroupSize - 1;
+				size_t group = (size_t)(hash >> 7) & groupMask;
+
+				for (size_t probe = 1; ; probe++)
+				{
+					uint32_t free = MatchFree(group);
+					if (free != 0)
+						return group * GroupSize + LowestBit(free);
+
+					group = (group + probe) & groupMask;
+				}
+			}
+
+			///
+			/// Claims a slot for a new key with the given hash, growing the table if
+			/// needed. The caller constructs the entry. Returns NoIndex if the table
+			/// cannot grow.
+			///
+			size_t ClaimIndex(uint64_t hash)
+			{
+				if (m_nGrowthLeft == 0)
+				{
+					// grow, unless deleted slots are what filled the table
+					size_t capacity = (m_nCapacity == 0) ? GroupSize : m_nCapacity;
+					if ((m_nCount + 1) * 16 > capacity * 7)
+						capacity *= 2;
+
+					if (!Rehash(capacity))
+						return NoIndex;
+				}
+
+				size_t index = FindFreeIndex(hash);
+				if (m_pCtrl[index] == CtrlEmpty)
+					m_nGrowthLeft--;
+
+				m_pCtrl[index] = GetTag(hash);
+				m_nCount++;
+				return index;
+			}
+
+			///
+			/// Destroys the entry of a slot.
+			///
+			void EraseIndex(size_t index)
+			{
+				m_pEntries[index].~_Entry();
+				m_nCount--;
+
+				// a group with an empty slot ends every probe through it, so the slot can
+				// become empty too; otherwise probes must continue past it
+				if (MatchGroup(index / GroupSize, CtrlEmpty) != 0)
+				{
+					m_pCtrl[index] = CtrlEmpty;
+					m_nGrowthLeft++;
+				}
+				else
+				{
+					m_pCtrl[index] = CtrlDeleted;
+				}
+			}
+
+			///
+			/// Moves every entry into a table of 'capacity' slots. Returns false, and
+			/// keeps the current table, if the new one cannot be allocated.
+			///
+			bool Rehash(size_t capacity)
+			{
+				size_t alignment = (__alignof(_Entry) > 16) ? __alignof(_Entry) : 16;
+				int8_t *pCtrl = (int8_t *)_aligned_malloc(capacity, 16);
+				_Entry *pEntries = (_Entry *)_aligned_malloc(capacity * sizeof(_Entry), alignment);
+				if (pCtrl == nullptr || pEntries == nullptr)
+				{
+					_aligned_free(pCtrl);
+					_aligned_free(pEntries);
+					TEKDEBUG_EF("FlatHashTable could not allocate a larger table.");
+					return false;
+				}
+
+				int8_t *pOldCtrl = m_pCtrl;
+				_Entry *pOldEntries = m_pEntries;
+				size_t oldCapacity = m_nCapacity;
+
+				m_pCtrl = pCtrl;
+				m_pEntries = pEntries;
+				m_nCapacity = capacity;
+				m_nGrowthLeft = capacity * 7 / 8 - m_nCount;
+				memset(m_pCtrl, CtrlEmpty, capacity);
+
+				for (size_t i = 0; i < oldCapacity; i++)
+				{
+					if (pOldCtrl[i] < 0)
+						continue;
+
+					uint64_t hash = m_hash(pOldEntries[i].key);
+					size_t index = FindFreeIndex(hash);
+					m_pCtrl[index] = GetTag(hash);
+					new (&m_pEntries[index]) _Entry(std::move(pOldEntries[i]));
+					pOldEntries[i].~_Entry();
+				}
+
+				_aligned_free(pOldCtrl);
+				_aligned_free(pOldEntries);
+				return true;
+			}
+
+		public:
+			FlatHashTable()
+			{
+				m_pCtrl = nullptr;
+				m_pEntries = nullptr;
+				m_nCapacity = 0;
+				m_nCount = 0;
+				m_nGrowthLeft = 0;
+			}
+
+			~FlatHashTable()
+			{
+				Clear();
+				_aligned_free(m_pCtrl);
+				_aligned_free(m_pEntries);
+			}
+
+			///
+			/// Gets the number of entries.
+			///
+			size_t GetCount() const
+			{
+				return m_nCount;
+			}
+
+			///
+			/// Gets the number of slots.
+			///
+			size_t GetCapacity() const
+			{
+				return m_nCapacity;
+			}
+
+			///
+			/// Makes room for 'count' entries without further growth.
+			///
+			void Reserve(size_t count)
+			{
+				size_t capacity = GroupSize;
+				while (capacity * 7 / 8 < count)
+					capacity *= 2;
+
+				if (capacity > m_nCapacity)
+					Rehash(capacity);
+			}
+
+			///
+			/// Returns true if the table holds a key.
+			///
+			template <class _Lookup>
+			bool Contains(const _Lookup &key) const
+			{
+				return FindIndex(key, m_hash(key)) != NoIndex;
+			}
+
+			///
+			/// Removes a key. Returns false if it was not present.
+			///
+			template <class _Lookup>
+			bool Erase(const _Lookup &key)
+			{
+				size_t index = FindIndex(key, m_hash(key));
+				if (index == NoIndex)
+					return false;
+
+				EraseIndex(index);
+				return true;
+			}
+
+			///
+			/// Removes every entry, keeping the slots.
+			///
+			void Clear()
+			{
+				for (size_t i = 0; i < m_nCapacity; i++)
+				{
+					if (m_pCtrl[i] >= 0)
+						m_pEntries[i].~_Entry();
+				}
+
+				if (m_nCapacity > 0)
+					memset(m_pCtrl, CtrlEmpty, m_nCapacity);
+
+				m_nCount = 0;
+				m_nGrowthLeft = m_nCapacity * 7 / 8;
+			}
+		};
+
+		///
+		/// A FlatHashMap entry.
+		///
+		template <class _Key, class _Value>
+		struct FlatHashMapEntry
+		{
+			_Key key;
+			_Value value;
+
+			FlatHashMapEntry(const _Key &k, const _Value &v) : key(k), value(v)
+			{
+			}
+		};
+
+		///
+		/// A hash map storing its entries inline in a flat, SSE2-probed table; see
+		/// FlatHashTable. Replaces std::map and std::unordered_map on hot paths.
+		///
+		template <class _Key, class _Value, class _Hash = Hash<_Key> >
+		class FlatHashMap : public FlatHashTable<FlatHashMapEntry<_Key, _Value>, _Hash>
+		{
+		protected:
+			typedef FlatHashTable<FlatHashMapEntry<_Key, _Value>, _Hash> BaseType;
+
+		public:
+			///
+			/// Adds a key unless present. Returns false if it already was, or if the
+			/// table cannot grow.
+			///
+			bool Insert(const _Key &key, const _Value &value)
+			{
+				uint64_t hash = BaseType::m_hash(key);
+				if (BaseType::FindIndex(key, hash) != BaseType::NoIndex)
+					return false;
+
+				size_t index = BaseType::ClaimIndex(hash);
+				if (index == BaseType::NoIndex)
+					return false;
+
+				new (&BaseType::m_pEntries[index]) FlatHashMapEntry<_Key, _Value>(key, value);
+				return true;
+			}
+
+			///
+			/// Sets the value of a key, adding it if needed. Returns false if the table
+			/// cannot grow.
+			///
+			bool Set(const _Key &key, const _Value &value)
+			{
+				uint64_t hash = BaseType::m_hash(key);
+				size_t index = BaseType::FindIndex(key, hash);
+				if (index != BaseType::NoIndex)
+				{
+					BaseType::m_pEntries[index].value = value;
+					return true;
+				}
+
+				index = BaseType::ClaimIndex(hash);
+				if (index == BaseType::NoIndex)
+					return false;
+
+				new (&BaseType::m_pEntries[index]) FlatHashMapEntry<_Key, _Value>(key, value);
+				return true;
+			}
+
+			///
+			/// Gets the value of a key, adding a default-constructed one if needed.
+			/// If the table cannot grow, the error is reported and a default value
+			/// that is not in the map is returned.
+			///
+			_Value &operator[](const _Key &key)
+			{
+				uint64_t hash = BaseType::m_hash(key);
+				size_t index = BaseType::FindIndex(key, hash);
+				if (index == BaseType::NoIndex)
+				{
+					index = BaseType::ClaimIndex(hash);
+					if (index == BaseType::NoIndex)
+					{
+						static _Value s_unstored;
+						s_unstored = _Value();
+						return s_unstored;
+					}
+
+					new (&BaseType::m_pEntries[index]) FlatHashMapEntry<_Key, _Value>(key, _Value());
+				}
+
+				return BaseType::m_pEntries[index].value;
+			}
+
+			///
+			/// Gets the value of a key, or nullptr.
+			///
+			template <class _Lookup>
+			_Value *Find(const _Lookup &key)
+			{
+				size_t index = BaseType::FindIndex(key, BaseType::m_hash(key));
+				return (index != BaseType::NoIndex) ? &BaseType::m_pEntries[index].value : nullptr;
+			}
+
+			template <class _Lookup>
+			const _Value *Find(const _Lookup &key) const
+			{
+				size_t index = BaseType::FindIndex(key, BaseType::m_hash(key));
+				return (index != BaseType::NoIndex) ? &BaseType::m_pEntries[index].value : nullptr;
+			}
+
+			///
+			/// Calls function(key, value) for every entry, in slot order.
+			///
+			template <class _Function>
+			void ForEach(_Function function)
+			{
+				for (size_t i = 0; i < BaseType::m_nCapacity; i++)
+				{
+					if (BaseType::m_pCtrl[i] >= 0)
+						function(BaseType::m_pEntries[i].key, BaseType::m_pEntries[i].value);
+				}
+			}
+		};
+
+		///
+		/// A FlatHashSet entry.
+		///
+		template <class _Key>
+		struct FlatHashSetEntry
+		{
+			_Key key;
+
+			FlatHashSetEntry(const _Key &k) : key(k)
+			{
+			}
+		};
+
+		///
+		/// A hash set storing its keys inline in a flat, SSE2-probed table; see FlatHashTable.
+		///
+		template <class _Key, class _Hash = Hash<_Key> >
+		class FlatHashSet : public FlatHashTable<FlatHashSetEntry<_Key>, _Hash>
+		{
+		protected:
+			typedef FlatHashTable<FlatHashSetEntry<_Key>, _Hash> BaseType;
+
+		public:
+			///
+			/// Adds a key. Returns false if it was already present, or if the table
+			/// cannot grow.
+			///
+			bool Insert(const _Key &key)
+			{
+				uint64_t hash = BaseType::m_hash(key);
+				if (BaseType::FindIndex(key, hash) != BaseType::NoIndex)
+					return false;
+
+				size_t index = BaseType::ClaimIndex(hash);
+				if (index == BaseType::NoIndex)
+					return false;
+
+				new (&BaseType::m_pEntries[index]) FlatHashSetEntry<_Key>(key);
+				return true;
+			}
+
+			///
+			/// Calls function(key) for every key, in slot order.
+			///
+			template <class _Function>
+			void ForEach(_Function function) const
+			{
+				for (size_t i = 0; i < BaseType::m_nCapacity; i++)
+				{
+					if (BaseType::m_pCtrl[i] >= 0)
+						function(BaseType::m_pEntries[i].key);
+				}
+			}
+		};
+	}
+}
+
+#endif /* _TEKSTORM_FLATHASHMAP_H */
\ No newline at end of file
@@ -0,0 +1,147 @@
+#define TEKSTORM_BUILD
+#include "FrameAllocator.h"
+
+namespace Tekstorm
+{
+	namespace Core
+	{
+		///
+		/// The arena pair of one thread.
+		///
+		struct FrameArenas
+		{
+			ArenaAllocator *pArenas[2];
+
+			// The owning thread, signaled once it exits (nullptr if it could not be opened).
+			HANDLE hThread;
+
+			// The frame in which the thread was seen to have exited, -1 while it runs.
+			LONG exitFrame;
+		};
+
+		// The calling thread's arenas.
+		static __declspec(thread) FrameArenas *s_pThreadArenas = nullptr;
+
+		// Every thread's arenas, so EndFrame() can flip them all.
+		static std::vector<FrameArenas *> s_arenas;
+		static volatile LONG s_nArenasLock = 0;
+
+		static volatile LONG s_nFrame = 0;
+		static size_t s_nThreadCapacity = FrameAllocator::DefaultThreadCapacity;
+
+		static inline void LockArenas()
+		{
+			while (InterlockedExchange(&s_nArenasLock, 1) != 0)
+			{
+				while (s_nArenasLock != 0)
+					YieldProcessor();
+			}
+		}
+
+		///
+		/// Frees a thread's arenas.
+		///
+		static void ReleaseArenas(FrameArenas *pArenas)
+		{
+			if (pArenas->hThread != nullptr)
+				CloseHandle(pArenas->hThread);
+
+			delete pArenas->pArenas[0];
+			delete pArenas->pArenas[1];
+			delete pArenas;
+		}
+
+		///
+		/// Sets the size of the arenas of threads that have not allocated yet.
+		///
+		void FrameAllocator::SetThreadCapacity(size_t capacity)
+		{
+			s_nThreadCapacity = capacity;
+		}
+
+		///
+		/// Gets the calling thread's arena for the current frame.
+		///
+		ArenaAllocator *FrameAllocator::GetThreadArena()
+		{
+			FrameArenas *pArenas = s_pThreadArenas;
+			if (pArenas == nullptr)
+			{
+				pArenas = new FrameArenas();
+				pArenas->pArenas[0] = new ArenaAllocator(s_nThreadCapacity);
+				pArenas->pArenas[1] = new ArenaAllocator(s_nThreadCapacity);
+				pArenas->hThread = OpenThread(SYNCHRONIZE, FALSE, GetCurrentThreadId());
+				pArenas->exitFrame = -1;
+
+				LockArenas();
+				s_arenas.push_back(pArenas);
+				InterlockedExchange(&s_nArenasLock, 0);
+
+				s_pThreadArenas = pArenas;
+			}
+
+			return pArenas->pArenas[s_nFrame & 1];
+		}
+
+		///
+		/// Allocates frame memory on the calling thread.
+		///
+		void *FrameAllocator::Allocate(size_t size, size_t alignment)
+		{
+			return GetThreadArena()->Allocate(size, alignment);
+		}
+
+		///
+		/// Ends the frame.
+		///
+		void FrameAllocator::EndFrame()
+		{
+			LONG frame = InterlockedIncrement(&s_nFrame);
+
+			LockArenas();
+			for (size_t i = 0; i < s_arenas.size(); )
+			{
+				FrameArenas *pArenas = s_arenas[i];
+				if (pArenas->exitFrame < 0 && pArenas->hThread != nullptr && WaitForSingleObject(pArenas->hThread, 0) == WAIT_OBJECT_0)
+					pArenas->exitFrame = frame;
+
+				// what the thread allocated in its last frame expires at the end of the next one
+				if (pArenas->exitFrame >= 0 && frame > pArenas->exitFrame)
+				{
+					ReleaseArenas(pArenas);
+					s_arenas[i] = s_arenas.back();
+					s_arenas.pop_back();
+					continue;
+				}
+
+				pArenas->pArenas[frame & 1]->Reset();
+				i++;
+			}
+			InterlockedExchange(&s_nArenasLock, 0);
+		}
+
+		///
+		/// Gets the number of frames ended.
+		///
+		int32_t FrameAllocator::GetFrameIndex()
+		{
+			return (int32_t)s_nFrame;
+		}
+
+		///
+		/// Releases the arenas of every thread.
+		///
+		void FrameAllocator::Shutdown()
+		{
+			LockArenas();
+			for (size_t i = 0; i < s_arenas.size(); i++)
+				ReleaseArenas(s_arenas[i]);
+
+			s_arenas.clear();
+			InterlockedExchange(&s_nArenasLock, 0);
+
+			// only the calling thread's pointer can be cleared; others must not allocate again
+			s_pThreadArenas = nullptr;
+		}
+	}
+}
\ No newline at end of file
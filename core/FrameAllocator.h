@@ -0,0 +1,78 @@
+#pragma once
+#ifndef _TEKSTORM_FRAMEALLOCATOR_H
+#define _TEKSTORM_FRAMEALLOCATOR_H
+#include "../tekconfig.h"
+#include "ArenaAllocator.h"
+
+namespace Tekstorm
+{
+	namespace Core
+	{
+		///
+		/// Per-thread, double-buffered scratch memory for data that lives for at most
+		/// two frames (vertex staging, network scratch, formatted strings...).
+		///
+		/// Every thread gets a pair of arenas on its first allocation. Memory allocated
+		/// during frame N stays valid until EndFrame() is called at the end of frame
+		/// N + 1, so results can be handed to the next frame without copying. The
+		/// arenas of a thread that has exited are released by EndFrame() once its
+		/// last frame's memory has expired.
+		class TEKAPI FrameAllocator
+		{
+		private:
+			///
+			/// No public constructor
+			///
+			FrameAllocator();
+
+		public:
+			///
+			/// The default size of each of a thread's two arenas.
+			///
+			static const size_t DefaultThreadCapacity = 1024 * 1024;
+
+			///
+			/// Sets the size of the arenas of threads that have not allocated yet.
+			///
+			static void SetThreadCapacity(size_t capacity);
+
+			///
+			/// Allocates frame memory on the calling thread.
+			///
+			static void *Allocate(size_t size, size_t alignment = ArenaAllocator::DefaultAlignment);
+
+			///
+			/// Allocates and default-constructs 'count' objects. Their destructors are never run.
+			///
+			template <class _Type>
+			static _Type *New(size_t count = 1)
+			{
+				return GetThreadArena()->New<_Type>(count);
+			}
+
+			///
+			/// Gets the calling thread's arena for the current frame, i.e. for an ArenaStlAllocator.
+			///
+			static ArenaAllocator *GetThreadArena();
+
+			///
+			/// Ends the frame: every thread switches arenas, and the arenas of the frame
+			/// before are reset; exited threads' arenas are released. Call from the main
+			/// thread while no other thread allocates.
+			///
+			static void EndFrame();
+
+			///
+			/// Gets the number of frames ended.
+			///
+			static int32_t GetFrameIndex();
+
+			///
+			/// Releases the arenas of every thread.
+			///
+			static void Shutdown();
+		};
+	}
+}
+
+#endif /* _TEKSTORM_FRAMEALLOCATOR_H */
\ No newline at end of file
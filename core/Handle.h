@@ -0,0 +1,114 @@
+#pragma once
+#ifndef _TEKSTORM_HANDLE_H
+#define _TEKSTORM_HANDLE_H
+#include "../tekconfig.h"
+
+namespace Tekstorm
+{
+	namespace Core
+	{
+		///
+		/// A 32-bit reference to a pooled object: a slot index in the low IndexBits
+		/// bits and the slot's generation in the rest. Destroying an object bumps the
+		/// generation of its slot, so handles to it stop resolving even after the
+		/// slot is reused. The zero handle is null; generations start at 1.
+		///
+		/// With 20 index bits a pool, slot map or resource cache holds at most
+		/// 1,048,576 (2^20) live objects. Going past that is an error reported in
+		/// every build, and the container hands out a null handle.
+		///
+		class Handle
+		{
+		protected:
+			uint32_t m_nValue;
+
+		public:
+			///
+			/// The number of index bits; pools hold at most MaxIndices objects.
+			///
+			static const uint32_t IndexBits = 20;
+
+			///
+			/// The number of generation bits.
+			///
+			static const uint32_t GenerationBits = 32 - IndexBits;
+
+			static const uint32_t IndexMask = (1u << IndexBits) - 1;
+
+			///
+			/// The number of distinct indices, and so of live objects per container.
+			///
+			static const uint32_t MaxIndices = IndexMask + 1;
+			static const uint32_t GenerationMask = (1u << GenerationBits) - 1;
+
+			///
+			/// Initializes a null handle.
+			///
+			Handle() : m_nValue(0)
+			{
+			}
+
+			Handle(uint32_t index, uint32_t generation)
+				: m_nValue((index & IndexMask) | ((generation & GenerationMask) << IndexBits))
+			{
+			}
+
+			///
+			/// Gets the slot index.
+			///
+			uint32_t GetIndex() const
+			{
+				return m_nValue & IndexMask;
+			}
+
+			///
+			/// Gets the slot generation.
+			///
+			uint32_t GetGeneration() const
+			{
+				return m_nValue >> IndexBits;
+			}
+
+			///
+			/// Gets the packed value, i.e. to pass the handle to a script.
+			///
+			uint32_t GetValue() const
+			{
+				return m_nValue;
+			}
+
+			///
+			/// Rebuilds a handle from its packed value.
+			///
+			static Handle FromValue(uint32_t value)
+			{
+				Handle handle;
+				handle.m_nValue = value;
+				return handle;
+			}
+
+			///
+			/// Returns true for the null handle.
+			///
+			bool IsNull() const
+			{
+				return m_nValue == 0;
+			}
+
+			///
+			/// Gets the generation following 'generation', skipping 0.
+			///
+			static uint32_t NextGeneration(uint32_t generation)
+			{
+				generation = (generation + 1) & GenerationMask;
+				return (generation == 0) ? 1 : generation;
+			}
+
+			bool operator==(const Handle &other) const { return m_nValue == other.m_nValue; }
+			bool operator!=(const Handle &other) const { return m_nValue != other.m_nValue; }
+			bool operator<(const Handle &other) const { return m_nValue < other.m_nValue; }
+		};
+	}
+}
+
+#endif /* _TEKSTORM_HANDLE_H */
\ No newline at end of file
@@ -0,0 +1,127 @@
+#pragma once
+#ifndef _TEKSTORM_HASH_H
+#define _TEKSTORM_HASH_H
+#include "../tekconfig.h"
+#include "Handle.h"
+#include "StringRef.h"
+
+namespace Tekstorm
+{
+	namespace Core
+	{
+		///
+		/// Scrambles a 64-bit value so every input bit affects every output bit
+		/// (the MurmurHash3 finalizer). Hash tables take their bucket from the high
+		/// bits and a tag from the low bits, so both must be well mixed.
+		///
+		inline uint64_t MixHash(uint64_t value)
+		{
+			value ^= value >> 33;
+			value *= 0xFF51AFD7ED558CCDULL;
+			value ^= value >> 33;
+			value *= 0xC4CEB9FE1A85EC53ULL;
+			value ^= value >> 33;
+			return value;
+		}
+
+		///
+		/// The 32-bit FNV-1a hash of a run of bytes, as used for StringIds and archive
+		/// names. HashFnv1a() gives the same hash of a null-terminated string.
+		///
+		inline uint32_t HashFnv1aBytes(const void *pData, size_t length)
+		{
+			const uint8_t *p = (const uint8_t *)pData;
+			uint32_t hash = 2166136261u;
+			for (size_t i = 0; i < length; i++)
+				hash = (hash ^ p[i]) * 16777619u;
+
+			return hash;
+		}
+
+		///
+		/// Hashes a run of bytes, eight at a time.
+		///
+		inline uint64_t HashBytes(const void *pData, size_t length, uint64_t seed = 0)
+		{
+			const uint64_t multiplier = 0x9E3779B97F4A7C15ULL;
+			const char *p = (const char *)pData;
+			uint64_t hash = seed ^ ((uint64_t)length * multiplier);
+
+			for (; length >= 8; length -= 8, p += 8)
+			{
+				uint64_t word;
+				memcpy(&word, p, 8);
+				hash = (hash ^ MixHash(word)) * multiplier;
+			}
+
+			if (length > 0)
+			{
+				uint64_t word = 0;
+				memcpy(&word, p, length);
+				hash = (hash ^ MixHash(word)) * multiplier;
+			}
+
+			return MixHash(hash);
+		}
+
+		///
+		/// The default hash of a key type, used by FlatHashMap and FlatHashSet.
+		/// Types that compare equal across types (std::string and StringRef) hash
+		/// equally, which allows looking one up with the other.
+		///
+		template <class _Type>
+		struct Hash;
+
+		template <class _Type>
+		struct Hash<_Type *>
+		{
+			uint64_t operator()(const _Type *p) const { return MixHash((uint64_t)(size_t)p); }
+		};
+
+#define TEKSTORM_INTEGER_HASH(type) \
+		template <> \
+		struct Hash<type> \
+		{ \
+			uint64_t operator()(type value) const { return MixHash((uint64_t)value); } \
+		};
+
+		TEKSTORM_INTEGER_HASH(char)
+		TEKSTORM_INTEGER_HASH(int8_t)
+		TEKSTORM_INTEGER_HASH(uint8_t)
+		TEKSTORM_INTEGER_HASH(int16_t)
+		TEKSTORM_INTEGER_HASH(uint16_t)
+		TEKSTORM_INTEGER_HASH(int32_t)
+		TEKSTORM_INTEGER_HASH(uint32_t)
+		TEKSTORM_INTEGER_HASH(int64_t)
+		TEKSTORM_INTEGER_HASH(uint64_t)
+#if defined(_MSC_VER)
+		// LONG, ULONG and DWORD are distinct from the fixed-width types here
+		TEKSTORM_INTEGER_HASH(long)
+		TEKSTORM_INTEGER_HASH(unsigned long)
+#endif
+
+#undef TEKSTORM_INTEGER_HASH
+
+		template <>
+		struct Hash<Handle>
+		{
+			uint64_t operator()(const Handle &handle) const { return MixHash(handle.GetValue()); }
+		};
+
+		template <>
+		struct Hash<StringRef>
+		{
+			uint64_t operator()(const StringRef &text) const { return HashBytes(text.GetData(), text.GetLength()); }
+		};
+
+		template <>
+		struct Hash<std::string>
+		{
+			uint64_t operator()(const std::string &text) const { return HashBytes(text.c_str(), text.length()); }
+			uint64_t operator()(const StringRef &text) const { return HashBytes(text.GetData(), text.GetLength()); }
+			uint64_t operator()(const char *text) const { return HashBytes(text, strlen(text)); }
+		};
+	}
+}
+
+#endif /* _TEKSTORM_HASH_H */
\ No newline at end of file
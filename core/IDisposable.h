@@ -13,6 +13,10 @@ namespace Tekstorm
 		class TEKAPI IDisposable
 		{
 		public:
+			virtual ~IDisposable()
+			{
+			}
+
 			///
 			/// Releases this object from memory along with all of its resources.
 			///
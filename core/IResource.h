@@ -20,7 +20,8 @@ namespace Tekstorm
 			virtual bool LoadFromFile(const std::string &filePath, void *args = nullptr) = 0;
 
 			///
-			/// Loads a resource from memory.
+			/// Loads a resource from memory. The memory may be a read-only archive mapping
+			/// (see ResourceManager), which stays valid while the resource is loaded.
 			///
 			virtual bool LoadFromMemory(const char *memory, int32_t size, void *args = nullptr) = 0;
 
@@ -0,0 +1,766 @@
+#define TEKSTORM_BUILD
+#include "JobSystem.h"
+
+namespace Tekstorm
+{
+	namespace Core
+	{
+		// Marks the end of the free record list.
+		static const uint32_t NoRecord = 0xFFFFFFFF;
+
+		// Idle iterations a worker spins before it sleeps.
+		static const int32_t IdleSpinCount = 2000;
+
+		// The worker index of the calling thread.
+		static __declspec(thread) int32_t s_nWorkerIndex = -1;
+
+		// The fiber the calling thread is running, if it runs jobs on fibers.
+		static __declspec(thread) FiberRecord *s_pCurrentFiber = nullptr;
+
+		// The fiber that last switched away on this thread, and what to do with it.
+		static __declspec(thread) FiberRecord *s_pHandoffFiber = nullptr;
+		static __declspec(thread) int32_t s_nHandoff = 0;
+
+		///
+		/// A pooled job record.
+		///
+		struct JobRecord
+		{
+			// The job, or nullptr for a ParallelFor range.
+			JobFunction function;
+			void *pData;
+
+			// The counter completed by this job.
+			JobCounter *pCounter;
+
+			// The ParallelFor body and the range still to process.
+			ParallelForFunction rangeFunction;
+			int32_t begin;
+			int32_t end;
+			int32_t grainSize;
+
+			// The next job waiting on the same counter.
+			JobRecord *pNext;
+
+			// The next free record.
+			uint32_t nextFree;
+		};
+
+		///
+		/// A fiber a job system runs jobs on.
+		///
+		struct FiberRecord
+		{
+			JobSystem *pSystem;
+			LPVOID hFiber;
+
+			// The counter a parked fiber waits for.
+			JobCounter *pWaitCounter;
+
+			// False for the fibers worker threads were converted to.
+			bool pooled;
+		};
+
+		static inline void LockCounter(volatile LONG *pLock)
+		{
+			while (InterlockedExchange(pLock, 1) != 0)
+			{
+				while (*pLock != 0)
+					YieldProcessor();
+			}
+		}
+
+		JobCounter::JobCounter()
+		{
+			m_nValue = 0;
+			m_nLock = 0;
+			m_pWaiting = nullptr;
+		}
+
+		///
+		/// Gets the number of outstanding jobs.
+		///
+		int32_t JobCounter::GetValue() const
+		{
+			return (int32_t)m_nValue;
+		}
+
+		///
+		/// Returns true if every job counted has completed. The completing thread may
+		/// still hold the lock after the final decrement, so that is waited out too.
+		///
+		bool JobCounter::IsDone() const
+		{
+			return (m_nValue == 0 && m_nLock == 0);
+		}
+
+		JobSystem::JobSystem()
+		{
+			m_pRecords = nullptr;
+			m_nRecordCount = 0;
+			m_nFreeHead = NoRecord;
+			m_nRunning = 0;
+			m_nSleeping = 0;
+			m_hWake = nullptr;
+			m_pFibers = nullptr;
+			m_nFiberCount = 0;
+			m_nFiberLock = 0;
+			m_nWaitingCount = 0;
+			m_pExternalHead = nullptr;
+			m_pExternalTail = nullptr;
+			m_nExternalLock = 0;
+		}
+
+		JobSystem::~JobSystem()
+		{
+			Stop();
+		}
+
+		///
+		/// Starts the worker threads. The calling thread becomes the main thread.
+		///
+		bool JobSystem::Start(int32_t workerCount, int32_t jobCapacity, int32_t fiberCount, int32_t fiberStackSize)
+		{
+			Stop();
+
+			SYSTEM_INFO info;
+			GetSystemInfo(&info);
+			if (workerCount <= 0)
+				workerCount = (int32_t)info.dwNumberOfProcessors - 1;
+
+			m_nRecordCount = jobCapacity;
+			m_pRecords = new JobRecord[jobCapacity];
+			for (int32_t i = 0; i < jobCapacity; i++)
+				m_pRecords[i].nextFree = (i + 1 < jobCapacity) ? (uint32_t)(i + 1) : NoRecord;
+			m_nFreeHead = 0;
+
+			if (fiberCount > 0)
+			{
+				m_pFibers = new FiberRecord[fiberCount];
+				m_nFiberCount = fiberCount;
+				m_freeFibers.reserve(fiberCount);
+				m_waitingFibers.reserve(fiberCount);
+				for (int32_t i = 0; i < fiberCount; i++)
+				{
+					FiberRecord &fiber = m_pFibers[i];
+					fiber.pSystem = this;
+					fiber.pWaitCounter = nullptr;
+					fiber.pooled = true;
+					fiber.hFiber = CreateFiberEx(0, fiberStackSize, FIBER_FLAG_FLOAT_SWITCH, &JobSystem::FiberMain, &fiber);
+					if (fiber.hFiber != nullptr)
+						m_freeFibers.push_back(&fiber);
+				}
+			}
+
+			m_hWake = CreateSemaphore(nullptr, 0, 0x7FFFFFFF, nullptr);
+			m_nSleeping = 0;
+			m_nRunning = 1;
+
+			for (int32_t i = 0; i <= workerCount; i++)
+			{
+				Worker *pWorker = new Worker();
+				pWorker->pSystem = this;
+				pWorker->index = i;
+				pWorker->hThread = nullptr;
+				pWorker->pDeque = new WorkStealingDeque<JobRecord>(QueueCapacity);
+				pWorker->pThreadFiber = nullptr;
+				m_workers.push_back(pWorker);
+			}
+
+			s_nWorkerIndex = 0;
+			for (int32_t i = 1; i <= workerCount; i++)
+			{
+				m_workers[i]->hThread = CreateThread(nullptr, 0, &JobSystem::WorkerThread, m_workers[i], 0, nullptr);
+				if (m_workers[i]->hThread == nullptr)
+				{
+#if defined(TEKSTORM_DEBUG)
+					TEKDEBUG_W("Could not start a job worker thread.");
+#endif
+					Stop();
+					return false;
+				}
+			}
+
+			return true;
+		}
+
+		///
+		/// Stops and joins the workers.
+		///
+		void JobSystem::Stop()
+		{
+			if (m_workers.empty())
+				return;
+
+			InterlockedExchange(&m_nRunning, 0);
+			ReleaseSemaphore(m_hWake, (LONG)m_workers.size(), nullptr);
+
+			for (size_t i = 0; i < m_workers.size(); i++)
+			{
+				if (m_workers[i]->hThread != nullptr)
+				{
+					WaitForSingleObject(m_workers[i]->hThread, INFINITE);
+					CloseHandle(m_workers[i]->hThread);
+				}
+
+				delete m_workers[i]->pDeque;
+				delete m_workers[i]->pThreadFiber;
+				delete m_workers[i];
+			}
+
+			m_workers.clear();
+
+			// every worker is back on its own fiber, so none of the pool is running
+			for (int32_t i = 0; i < m_nFiberCount; i++)
+			{
+				if (m_pFibers[i].hFiber != nullptr)
+					DeleteFiber(m_pFibers[i].hFiber);
+			}
+
+			delete [] m_pFibers;
+			m_pFibers = nullptr;
+			m_nFiberCount = 0;
+			m_freeFibers.clear();
+			m_waitingFibers.clear();
+			m_nWaitingCount = 0;
+			m_pExternalHead = nullptr;
+			m_pExternalTail = nullptr;
+
+			CloseHandle(m_hWake);
+			m_hWake = nullptr;
+
+			delete [] m_pRecords;
+			m_pRecords = nullptr;
+			m_nRecordCount = 0;
+			m_nFreeHead = NoRecord;
+			s_nWorkerIndex = -1;
+		}
+
+		///
+		/// Gets the number of threads running jobs, including the main thread.
+		///
+		int32_t JobSystem::GetThreadCount() const
+		{
+			return (int32_t)m_workers.size();
+		}
+
+		///
+		/// Gets the calling thread's worker index (0 for the main thread), or -1.
+		///
+		int32_t JobSystem::GetWorkerIndex()
+		{
+			return s_nWorkerIndex;
+		}
+
+		///
+		/// Takes a record from the pool, or returns nullptr if it is exhausted.
+		///
+		JobRecord *JobSystem::AllocateRecord()
+		{
+			for (;;)
+			{
+				LONGLONG head = m_nFreeHead;
+				uint32_t index = (uint32_t)head;
+				if (index == NoRecord)
+					return nullptr;
+
+				// a stale nextFree only happens when the tag has moved on, failing the exchange
+				LONGLONG tag = (head >> 32) + 1;
+				LONGLONG next = (tag << 32) | m_pRecords[index].nextFree;
+				if (InterlockedCompareExchange64(&m_nFreeHead, next, head) == head)
+					return &m_pRecords[index];
+			}
+		}
+
+		///
+		/// Returns a record to the pool.
+		///
+		void JobSystem::FreeRecord(JobRecord *pRecord)
+		{
+			uint32_t index = (uint32_t)(pRecord - m_pRecords);
+			for (;;)
+			{
+				LONGLONG head = m_nFreeHead;
+				pRecord->nextFree = (uint32_t)head;
+
+				LONGLONG tag = (head >> 32) + 1;
+				if (InterlockedCompareExchange64(&m_nFreeHead, (tag << 32) | index, head) == head)
+					return;
+			}
+		}
+
+		///
+		/// Pushes a job onto the calling thread's deque (or the external queue, from
+		/// threads outside the system), or runs it if it cannot be queued.
+		///
+		void JobSystem::Submit(JobRecord *pRecord)
+		{
+			int32_t index = s_nWorkerIndex;
+			if (index < 0 && m_nRunning != 0)
+			{
+				// a thread without a deque; queue it for the workers
+				pRecord->pNext = nullptr;
+				LockCounter(&m_nExternalLock);
+				if (m_pExternalTail != nullptr)
+					m_pExternalTail->pNext = pRecord;
+				else
+					m_pExternalHead = pRecord;
+				m_pExternalTail = pRecord;
+				InterlockedExchange(&m_nExternalLock, 0);
+			}
+			else if (index < 0 || index >= (int32_t)m_workers.size() || !m_workers[index]->pDeque->Push(pRecord))
+			{
+				Execute(pRecord);
+				return;
+			}
+
+			// the push must be visible before the sleeper count is read
+			MemoryBarrier();
+			if (m_nSleeping > 0)
+				ReleaseSemaphore(m_hWake, 1, nullptr);
+		}
+
+		///
+		/// Queues a job to be submitted once pDependency reaches zero.
+		///
+		void JobSystem::SubmitAfter(JobRecord *pRecord, JobCounter *pDependency)
+		{
+			LockCounter(&pDependency->m_nLock);
+			if (pDependency->m_nValue != 0)
+			{
+				pRecord->pNext = pDependency->m_pWaiting;
+				pDependency->m_pWaiting = pRecord;
+				InterlockedExchange(&pDependency->m_nLock, 0);
+				return;
+			}
+
+			InterlockedExchange(&pDependency->m_nLock, 0);
+			Submit(pRecord);
+		}
+
+		///
+		/// Decrements a counter, submitting the jobs waiting for it when it reaches zero.
+		///
+		void JobSystem::Complete(JobCounter *pCounter)
+		{
+			if (pCounter == nullptr)
+				return;
+
+			JobRecord *pWaiting = nullptr;
+			LockCounter(&pCounter->m_nLock);
+			if (InterlockedDecrement(&pCounter->m_nValue) == 0)
+			{
+				pWaiting = pCounter->m_pWaiting;
+				pCounter->m_pWaiting = nullptr;
+			}
+
+			// the counter may be gone as soon as this releases
+			InterlockedExchange(&pCounter->m_nLock, 0);
+
+			// a parked fiber may be ready now
+			if (m_nWaitingCount > 0 && m_nSleeping > 0)
+				ReleaseSemaphore(m_hWake, 1, nullptr);
+
+			while (pWaiting != nullptr)
+			{
+				JobRecord *pNext = pWaiting->pNext;
+				Submit(pWaiting);
+				pWaiting = pNext;
+			}
+		}
+
+		///
+		/// Finds a job for a worker: its own newest job, else one stolen from the others.
+		///
+		JobRecord *JobSystem::FindJob(int32_t workerIndex)
+		{
+			int32_t count = (int32_t)m_workers.size();
+			if (workerIndex >= 0 && workerIndex < count)
+			{
+				JobRecord *pRecord = m_workers[workerIndex]->pDeque->Pop();
+				if (pRecord != nullptr)
+					return pRecord;
+			}
+
+			for (int32_t i = 1; i <= count; i++)
+			{
+				int32_t victim = (workerIndex + i) % count;
+				if (victim < 0 || victim == workerIndex)
+					continue;
+
+				JobRecord *pRecord = m_workers[victim]->pDeque->Steal();
+				if (pRecord != nullptr)
+					return pRecord;
+			}
+
+			return TakeExternalJob();
+		}
+
+		///
+		/// Takes the oldest job submitted from outside the system, or returns nullptr.
+		///
+		JobRecord *JobSystem::TakeExternalJob()
+		{
+			if (m_pExternalHead == nullptr)
+				return nullptr;
+
+			LockCounter(&m_nExternalLock);
+			JobRecord *pRecord = m_pExternalHead;
+			if (pRecord != nullptr)
+			{
+				m_pExternalHead = pRecord->pNext;
+				if (m_pExternalHead == nullptr)
+					m_pExternalTail = nullptr;
+			}
+			InterlockedExchange(&m_nExternalLock, 0);
+
+			return pRecord;
+		}
+
+		///
+		/// Runs a job, frees its record and completes its counter.
+		///
+		void JobSystem::Execute(JobRecord *pRecord)
+		{
+			if (pRecord->function != nullptr)
+			{
+				pRecord->function(pRecord->pData);
+			}
+			else
+			{
+				// split off the upper halves of the range for other threads to steal
+				int32_t begin = pRecord->begin;
+				int32_t end = pRecord->end;
+				while (end - begin > pRecord->grainSize)
+				{
+					JobRecord *pSplit = AllocateRecord();
+					if (pSplit == nullptr)
+						break;
+
+					int32_t middle = begin + (end - begin) / 2;
+					*pSplit = *pRecord;
+					pSplit->begin = middle;
+					pSplit->end = end;
+					InterlockedIncrement(&pRecord->pCounter->m_nValue);
+					Submit(pSplit);
+					end = middle;
+				}
+
+				pRecord->rangeFunction(pRecord->pData, begin, end);
+			}
+
+			JobCounter *pCounter = pRecord->pCounter;
+			FreeRecord(pRecord);
+			Complete(pCounter);
+		}
+
+		///
+		/// Takes a free fiber, or returns nullptr if all are in use.
+		///
+		FiberRecord *JobSystem::AllocateFiber()
+		{
+			FiberRecord *pFiber = nullptr;
+			LockCounter(&m_nFiberLock);
+			if (!m_freeFibers.empty())
+			{
+				pFiber = m_freeFibers.back();
+				m_freeFibers.pop_back();
+			}
+
+			InterlockedExchange(&m_nFiberLock, 0);
+			return pFiber;
+		}
+
+		///
+		/// Takes a parked fiber whose counter has reached zero, or returns nullptr.
+		///
+		FiberRecord *JobSystem::TakeReadyFiber()
+		{
+			if (m_nWaitingCount == 0)
+				return nullptr;
+
+			FiberRecord *pFiber = nullptr;
+			LockCounter(&m_nFiberLock);
+			for (size_t i = 0; i < m_waitingFibers.size(); i++)
+			{
+				if (m_waitingFibers[i]->pWaitCounter->IsDone())
+				{
+					pFiber = m_waitingFibers[i];
+					m_waitingFibers[i] = m_waitingFibers.back();
+					m_waitingFibers.pop_back();
+					InterlockedDecrement(&m_nWaitingCount);
+					break;
+				}
+			}
+
+			InterlockedExchange(&m_nFiberLock, 0);
+			return pFiber;
+		}
+
+		///
+		/// Switches the calling thread to another fiber.
+		///
+		void JobSystem::SwitchFiber(FiberRecord *pTarget, FiberHandoff handoff)
+		{
+			s_pHandoffFiber = s_pCurrentFiber;
+			s_nHandoff = handoff;
+			s_pCurrentFiber = pTarget;
+			SwitchToFiber(pTarget->hFiber);
+
+			// resumed, possibly on another thread
+			ProcessHandoff();
+		}
+
+		///
+		/// Completes the handoff of the fiber that switched to the current one. Until
+		/// now that fiber was still running on this thread, so it could not be
+		/// published to other threads before.
+		///
+		void JobSystem::ProcessHandoff()
+		{
+			FiberRecord *pPrevious = s_pHandoffFiber;
+			s_pHandoffFiber = nullptr;
+			if (pPrevious == nullptr || !pPrevious->pooled)
+				return;
+
+			LockCounter(&m_nFiberLock);
+			if (s_nHandoff == FIBER_HANDOFF_WAIT)
+			{
+				m_waitingFibers.push_back(pPrevious);
+				InterlockedIncrement(&m_nWaitingCount);
+			}
+			else if (s_nHandoff == FIBER_HANDOFF_FREE)
+			{
+				pPrevious->pWaitCounter = nullptr;
+				m_freeFibers.push_back(pPrevious);
+			}
+
+			InterlockedExchange(&m_nFiberLock, 0);
+		}
+
+		///
+		/// Entry point of the pooled fibers.
+		///
+		void WINAPI JobSystem::FiberMain(LPVOID pParameter)
+		{
+			JobSystem *pSystem = ((FiberRecord *)pParameter)->pSystem;
+			pSystem->ProcessHandoff();
+
+			// fibers never return; once the system stops they hand the thread back
+			for (;;)
+			{
+				pSystem->RunWorker();
+				pSystem->SwitchFiber(pSystem->m_workers[s_nWorkerIndex]->pThreadFiber, FIBER_HANDOFF_FREE);
+			}
+		}
+
+		///
+		/// Entry point of the worker threads.
+		///
+		DWORD WINAPI JobSystem::WorkerThread(LPVOID pParameter)
+		{
+			Worker *pWorker = (Worker *)pParameter;
+			JobSystem *pSystem = pWorker->pSystem;
+			s_nWorkerIndex = pWorker->index;
+
+			SYSTEM_INFO info;
+			GetSystemInfo(&info);
+			int32_t processor = pWorker->index % (int32_t)info.dwNumberOfProcessors;
+			SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << processor);
+
+			FiberRecord *pFiber = (pSystem->m_nFiberCount > 0) ? pSystem->AllocateFiber() : nullptr;
+			if (pFiber != nullptr)
+			{
+				FiberRecord *pThreadFiber = new FiberRecord();
+				pThreadFiber->pSystem = pSystem;
+				pThreadFiber->pWaitCounter = nullptr;
+				pThreadFiber->pooled = false;
+				pThreadFiber->hFiber = ConvertThreadToFiberEx(nullptr, FIBER_FLAG_FLOAT_SWITCH);
+				pWorker->pThreadFiber = pThreadFiber;
+
+				if (pThreadFiber->hFiber != nullptr)
+				{
+					// runs jobs on pooled fibers until the system stops
+					s_pCurrentFiber = pThreadFiber;
+					pSystem->SwitchFiber(pFiber, FIBER_HANDOFF_NONE);
+					s_pCurrentFiber = nullptr;
+					ConvertFiberToThread();
+					return 0;
+				}
+
+				s_pHandoffFiber = pFiber;
+				s_nHandoff = FIBER_HANDOFF_FREE;
+				pSystem->ProcessHandoff();
+			}
+
+			pSystem->RunWorker();
+			return 0;
+		}
+
+		///
+		/// Runs jobs on the calling worker until the system stops.
+		///
+		void JobSystem::RunWorker()
+		{
+			int32_t idle = 0;
+			while (m_nRunning != 0)
+			{
+				// a fiber that resumed a parked one may continue on another thread
+				int32_t index = s_nWorkerIndex;
+				FiberRecord *pCurrent = s_pCurrentFiber;
+
+				if (pCurrent != nullptr && pCurrent->pooled)
+				{
+					FiberRecord *pReady = TakeReadyFiber();
+					if (pReady != nullptr)
+					{
+						SwitchFiber(pReady, FIBER_HANDOFF_FREE);
+						idle = 0;
+						continue;
+					}
+				}
+
+				JobRecord *pRecord = FindJob(index);
+				if (pRecord != nullptr)
+				{
+					Execute(pRecord);
+					idle = 0;
+					continue;
+				}
+
+				if (++idle < IdleSpinCount)
+				{
+					YieldProcessor();
+					continue;
+				}
+
+				// announce the sleep, then look once more so a concurrent Submit or
+				// Complete cannot be missed
+				FiberRecord *pReady = nullptr;
+				InterlockedIncrement(&m_nSleeping);
+				pRecord = FindJob(index);
+				if (pRecord == nullptr && pCurrent != nullptr && pCurrent->pooled)
+					pReady = TakeReadyFiber();
+				if (pRecord == nullptr && pReady == nullptr)
+					WaitForSingleObject(m_hWake, INFINITE);
+				InterlockedDecrement(&m_nSleeping);
+
+				if (pReady != nullptr)
+					SwitchFiber(pReady, FIBER_HANDOFF_FREE);
+				else if (pRecord != nullptr)
+					Execute(pRecord);
+				idle = 0;
+			}
+		}
+
+		///
+		/// Runs a job.
+		///
+		void JobSystem::Run(JobFunction function, void *pData, JobCounter *pCounter, JobCounter *pDependency)
+		{
+			JobDeclaration job = { function, pData };
+			Run(&job, 1, pCounter, pDependency);
+		}
+
+		///
+		/// Runs a batch of jobs counted by pCounter.
+		///
+		void JobSystem::Run(const JobDeclaration *pJobs, int32_t count, JobCounter *pCounter, JobCounter *pDependency)
+		{
+			if (pCounter != nullptr)
+				InterlockedExchangeAdd(&pCounter->m_nValue, count);
+
+			for (int32_t i = 0; i < count; i++)
+			{
+				JobRecord *pRecord = AllocateRecord();
+				if (pRecord == nullptr)
+				{
+					// the pool is exhausted; run it here
+					if (pDependency != nullptr)
+						Wait(pDependency);
+					pJobs[i].function(pJobs[i].pData);
+					Complete(pCounter);
+					continue;
+				}
+
+				pRecord->function = pJobs[i].function;
+				pRecord->pData = pJobs[i].pData;
+				pRecord->pCounter = pCounter;
+				pRecord->rangeFunction = nullptr;
+				pRecord->pNext = nullptr;
+
+				if (pDependency != nullptr)
+					SubmitAfter(pRecord, pDependency);
+				else
+					Submit(pRecord);
+			}
+		}
+
+		///
+		/// Runs other jobs until the counter reaches zero.
+		///
+		void JobSystem::Wait(JobCounter *pCounter)
+		{
+			FiberRecord *pCurrent = s_pCurrentFiber;
+			if (pCurrent != nullptr && pCurrent->pooled && !pCounter->IsDone())
+			{
+				// park this fiber and keep the worker busy on a fresh one
+				FiberRecord *pNext = AllocateFiber();
+				if (pNext != nullptr)
+				{
+					pCurrent->pWaitCounter = pCounter;
+					SwitchFiber(pNext, FIBER_HANDOFF_WAIT);
+					return;
+				}
+			}
+
+			int32_t index = s_nWorkerIndex;
+			while (!pCounter->IsDone())
+			{
+				JobRecord *pRecord = FindJob(index);
+				if (pRecord != nullptr)
+					Execute(pRecord);
+				else
+					YieldProcessor();
+			}
+		}
+
+		///
+		/// Calls function(pData, begin, end) over [0, count) across all threads and waits.
+		///
+		void JobSystem::ParallelFor(int32_t count, ParallelForFunction function, void *pData, int32_t grainSize)
+		{
+			if (count <= 0)
+				return;
+
+			if (grainSize <= 0)
+			{
+				grainSize = count / (8 * (m_workers.empty() ? 1 : (int32_t)m_workers.size()));
+				if (grainSize < 1)
+					grainSize = 1;
+			}
+
+			JobRecord *pRecord = (count > grainSize) ? AllocateRecord() : nullptr;
+			if (pRecord == nullptr)
+			{
+				function(pData, 0, count);
+				return;
+			}
+
+			JobCounter counter;
+			counter.m_nValue = 1;
+			pRecord->function = nullptr;
+			pRecord->pData = pData;
+			pRecord->pCounter = &counter;
+			pRecord->rangeFunction = function;
+			pRecord->begin = 0;
+			pRecord->end = count;
+			pRecord->grainSize = grainSize;
+			pRecord->pNext = nullptr;
+
+			// the calling thread starts splitting right away, the rest is stolen
+			Execute(pRecord);
+			Wait(&counter);
+		}
+	}
+}
\ No newline at end of file
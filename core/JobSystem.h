@@ -0,0 +1,360 @@
+#pragma once
+#ifndef _TEKSTORM_JOBSYSTEM_H
+#define _TEKSTORM_JOBSYSTEM_H
+#include "../tekconfig.h"
+#include "WorkStealingDeque.h"
+
+namespace Tekstorm
+{
+	namespace Core
+	{
+		///
+		/// A job entry point.
+		///
+		typedef void (*JobFunction)(void *pData);
+
+		///
+		/// A ParallelFor body; processes the elements [begin, end).
+		///
+		typedef void (*ParallelForFunction)(void *pData, int32_t begin, int32_t end);
+
+		///
+		/// Describes a job to run.
+		///
+		struct JobDeclaration
+		{
+			JobFunction function;
+			void *pData;
+		};
+
+		///
+		/// A pooled job record (internal to JobSystem).
+		///
+		struct JobRecord;
+
+		///
+		/// A fiber a job system runs jobs on (internal to JobSystem).
+		///
+		struct FiberRecord;
+
+		///
+		/// Counts the outstanding jobs of a batch. Jobs can be made to wait for a
+		/// counter, and threads can wait for one with JobSystem::Wait().
+		///
+		class TEKAPI JobCounter
+		{
+			friend class JobSystem;
+
+		protected:
+			///
+			/// The number of outstanding jobs.
+			///
+			volatile LONG m_nValue;
+
+			///
+			/// Guards m_pWaiting and the final decrement.
+			///
+			volatile LONG m_nLock;
+
+			///
+			/// Jobs to submit once the counter reaches zero.
+			///
+			JobRecord *m_pWaiting;
+
+			///
+			/// Counters are not copyable.
+			///
+			JobCounter(const JobCounter &other);
+			JobCounter &operator=(const JobCounter &other);
+
+		public:
+			JobCounter();
+
+			///
+			/// Gets the number of outstanding jobs.
+			///
+			int32_t GetValue() const;
+
+			///
+			/// Returns true if every job counted has completed.
+			///
+			bool IsDone() const;
+		};
+
+		///
+		/// A work-stealing job system.
+		///
+		/// Every worker thread, and the thread that called Start() (the main thread),
+		/// owns a Chase-Lev deque. Jobs are pushed onto the deque of the thread that
+		/// submits them; idle workers steal from the others. Job records come from a
+		/// fixed lock-free pool, so submitting never touches the heap.
+		///
+		/// Threads outside the system, i.e. an I/O thread, submit into a shared queue
+		/// that workers check once their deques and stealing come up empty. When the
+		/// pool or a deque is full, or the system is stopped, jobs run inline.
+		///
+		/// With a fiber pool (fiberCount in Start()), workers run jobs on fibers. A job
+		/// that waits on a counter parks its fiber, and the worker continues on a fresh
+		/// one. Any worker later resumes the parked fiber once the counter reaches
+		/// zero, so a resumed job may continue on a different thread. That is why the
+		/// project builds with fiber-safe TLS (/GT). The main thread never parks; it
+		/// runs other jobs while it waits, so main-thread code stays on its thread.
+		///
+		class TEKAPI JobSystem
+		{
+		protected:
+			///
+			/// A thread taking part in the job system.
+			///
+			struct Worker
+			{
+				JobSystem *pSystem;
+				int32_t index;
+				HANDLE hThread;
+				WorkStealingDeque<JobRecord> *pDeque;
+
+				// The fiber the thread was converted to; it is switched back to on Stop().
+				FiberRecord *pThreadFiber;
+			};
+
+			///
+			/// What the next fiber does with the one that switched to it.
+			///
+			enum FiberHandoff
+			{
+				FIBER_HANDOFF_NONE,
+				FIBER_HANDOFF_FREE,
+				FIBER_HANDOFF_WAIT
+			};
+
+			///
+			/// The workers; index 0 is the main thread.
+			///
+			std::vector<Worker *> m_workers;
+
+			///
+			/// The job record pool.
+			///
+			JobRecord *m_pRecords;
+
+			///
+			/// The number of job records.
+			///
+			int32_t m_nRecordCount;
+
+			///
+			/// Head of the free record list: the record index in the low 32 bits and
+			/// an ABA tag in the high 32 bits.
+			///
+			volatile LONGLONG m_nFreeHead;
+
+			///
+			/// Whether or not the workers keep running.
+			///
+			volatile LONG m_nRunning;
+
+			///
+			/// The number of workers blocked on m_hWake.
+			///
+			volatile LONG m_nSleeping;
+
+			///
+			/// Wakes sleeping workers when jobs are submitted.
+			///
+			HANDLE m_hWake;
+
+			///
+			/// The fiber pool, or nullptr when workers run jobs on their threads.
+			///
+			FiberRecord *m_pFibers;
+
+			///
+			/// The number of pooled fibers.
+			///
+			int32_t m_nFiberCount;
+
+			///
+			/// Guards m_freeFibers and m_waitingFibers.
+			///
+			volatile LONG m_nFiberLock;
+
+			///
+			/// Fibers ready to run a worker loop.
+			///
+			std::vector<FiberRecord *> m_freeFibers;
+
+			///
+			/// Fibers parked until their counter reaches zero.
+			///
+			std::vector<FiberRecord *> m_waitingFibers;
+
+			///
+			/// The number of parked fibers.
+			///
+			volatile LONG m_nWaitingCount;
+
+			///
+			/// Jobs submitted by threads outside the system, oldest first.
+			///
+			JobRecord * volatile m_pExternalHead;
+			JobRecord *m_pExternalTail;
+
+			///
+			/// Guards the external queue.
+			///
+			volatile LONG m_nExternalLock;
+
+			///
+			/// Takes a record from the pool, or returns nullptr if it is exhausted.
+			///
+			JobRecord *AllocateRecord();
+
+			///
+			/// Returns a record to the pool.
+			///
+			void FreeRecord(JobRecord *pRecord);
+
+			///
+			/// Pushes a job onto the calling thread's deque (or the external queue, from
+			/// threads outside the system), or runs it if it cannot be queued.
+			///
+			void Submit(JobRecord *pRecord);
+
+			///
+			/// Queues a job to be submitted once pDependency reaches zero.
+			///
+			void SubmitAfter(JobRecord *pRecord, JobCounter *pDependency);
+
+			///
+			/// Finds a job for a worker: its own newest job, else one stolen from the others.
+			///
+			JobRecord *FindJob(int32_t workerIndex);
+
+			///
+			/// Takes the oldest job submitted from outside the system, or returns nullptr.
+			///
+			JobRecord *TakeExternalJob();
+
+			///
+			/// Runs a job, frees its record and completes its counter.
+			///
+			void Execute(JobRecord *pRecord);
+
+			///
+			/// Decrements a counter, submitting the jobs waiting for it when it reaches zero.
+			///
+			void Complete(JobCounter *pCounter);
+
+			///
+			/// Takes a free fiber, or returns nullptr if all are in use.
+			///
+			FiberRecord *AllocateFiber();
+
+			///
+			/// Takes a parked fiber whose counter has reached zero, or returns nullptr.
+			///
+			FiberRecord *TakeReadyFiber();
+
+			///
+			/// Switches the calling thread to another fiber. The fiber switched away from
+			/// is handed to the target, which frees or parks it once it is off this thread.
+			///
+			void SwitchFiber(FiberRecord *pTarget, FiberHandoff handoff);
+
+			///
+			/// Completes the handoff of the fiber that switched to the current one.
+			///
+			void ProcessHandoff();
+
+			///
+			/// Entry point of the pooled fibers.
+			///
+			static void WINAPI FiberMain(LPVOID pParameter);
+
+			///
+			/// Entry point of the worker threads.
+			///
+			static DWORD WINAPI WorkerThread(LPVOID pParameter);
+
+			///
+			/// Runs jobs on the calling worker until the system stops.
+			///
+			void RunWorker();
+
+			///
+			/// Job systems are not copyable.
+			///
+			JobSystem(const JobSystem &other);
+			JobSystem &operator=(const JobSystem &other);
+
+		public:
+			///
+			/// The default number of job records.
+			///
+			static const int32_t DefaultJobCapacity = 16384;
+
+			///
+			/// The capacity of each worker's deque.
+			///
+			static const int32_t QueueCapacity = 4096;
+
+			///
+			/// The default stack size of pooled fibers.
+			///
+			static const int32_t DefaultFiberStackSize = 64 * 1024;
+
+			JobSystem();
+			~JobSystem();
+
+			///
+			/// Starts 'workerCount' worker threads (0 = one per additional processor).
+			/// The calling thread becomes the main thread. A non-zero fiberCount makes
+			/// workers run jobs on a pool of that many fibers, so waiting jobs park
+			/// instead of blocking their worker.
+			///
+			bool Start(int32_t workerCount = 0, int32_t jobCapacity = DefaultJobCapacity,
+				int32_t fiberCount = 0, int32_t fiberStackSize = DefaultFiberStackSize);
+
+			///
+			/// Stops and joins the workers. Outstanding jobs are abandoned.
+			///
+			void Stop();
+
+			///
+			/// Gets the number of threads running jobs, including the main thread.
+			///
+			int32_t GetThreadCount() const;
+
+			///
+			/// Gets the calling thread's worker index (0 for the main thread), or -1.
+			///
+			static int32_t GetWorkerIndex();
+
+			///
+			/// Runs a job. pCounter (optional) is incremented now and decremented when the
+			/// job completes. If pDependency is given, the job starts once it reaches zero.
+			///
+			void Run(JobFunction function, void *pData, JobCounter *pCounter, JobCounter *pDependency = nullptr);
+
+			///
+			/// Runs a batch of jobs counted by pCounter.
+			///
+			void Run(const JobDeclaration *pJobs, int32_t count, JobCounter *pCounter, JobCounter *pDependency = nullptr);
+
+			///
+			/// Waits until the counter reaches zero. Jobs on pooled fibers park; other
+			/// callers run other jobs meanwhile.
+			///
+			void Wait(JobCounter *pCounter);
+
+			///
+			/// Calls function(pData, begin, end) over [0, count) across all threads and waits.
+			/// Ranges are split in halves on demand down to grainSize elements
+			/// (0 = count / (8 * threads)), so idle threads steal large pieces first.
+			///
+			void ParallelFor(int32_t count, ParallelForFunction function, void *pData, int32_t grainSize = 0);
+		};
+	}
+}
+
+#endif /* _TEKSTORM_JOBSYSTEM_H */
\ No newline at end of file
@@ -0,0 +1,265 @@
+#define TEKSTORM_BUILD
+#include "MemoryTracker.h"
+#include "../IO/TextWriter.h"
+
+namespace Tekstorm
+{
+	namespace Core
+	{
+		using Tekstorm::IO::TextWriter;
+
+		///
+		/// The counters of one thread; only that thread writes them, with atomic adds
+		/// so Update() never reads half of a 64-bit update on 32-bit builds.
+		///
+		struct ThreadMemoryCounters
+		{
+			volatile int64_t allocatedBytes[TEKMEMTAG_COUNT];
+			volatile int64_t freedBytes[TEKMEMTAG_COUNT];
+			volatile int64_t allocations[TEKMEMTAG_COUNT];
+			volatile int64_t frees[TEKMEMTAG_COUNT];
+		};
+
+		///
+		/// Precedes every block from MemoryTracker::Allocate (16 bytes keeps the payload aligned).
+		///
+		struct TrackedHeader
+		{
+			int64_t size;
+			int32_t tag;
+			int32_t reserved;
+		};
+
+		static const char *s_tagNames[TEKMEMTAG_COUNT] = { "General", "IO", "Networking", "Scripting", "Graphics", "Scene" };
+
+		// The calling thread's counters.
+		static __declspec(thread) ThreadMemoryCounters *s_pThreadCounters = nullptr;
+
+		// Every thread's counters, merged by Update(). Threads' counters are kept after
+		// they exit so their totals are not lost.
+		static std::vector<ThreadMemoryCounters *> s_counters;
+		static volatile LONG s_nCountersLock = 0;
+
+		static MemoryTagStats s_stats[TEKMEMTAG_COUNT];
+		static bool s_budgetWarned[TEKMEMTAG_COUNT];
+		static int64_t s_lastAllocatedBytes[TEKMEMTAG_COUNT];
+		static MemoryBudgetFunction s_budgetFunction = nullptr;
+		static void *s_pBudgetData = nullptr;
+
+		///
+		/// Reads a counter in one piece.
+		///
+		static inline int64_t ReadCounter(volatile int64_t *pCounter)
+		{
+			return InterlockedCompareExchange64(pCounter, 0, 0);
+		}
+
+		static inline void LockCounters()
+		{
+			while (InterlockedExchange(&s_nCountersLock, 1) != 0)
+			{
+				while (s_nCountersLock != 0)
+					YieldProcessor();
+			}
+		}
+
+		///
+		/// Gets the calling thread's counters, creating them on first use.
+		///
+		static ThreadMemoryCounters *GetThreadCounters()
+		{
+			ThreadMemoryCounters *pCounters = s_pThreadCounters;
+			if (pCounters == nullptr)
+			{
+				// plain calloc so the tracker never records itself
+				pCounters = (ThreadMemoryCounters *)calloc(1, sizeof(ThreadMemoryCounters));
+
+				LockCounters();
+				s_counters.push_back(pCounters);
+				InterlockedExchange(&s_nCountersLock, 0);
+
+				s_pThreadCounters = pCounters;
+			}
+
+			return pCounters;
+		}
+
+		///
+		/// Records an allocation on the calling thread.
+		///
+		void MemoryTracker::RecordAllocation(MemoryTag tag, size_t size)
+		{
+			ThreadMemoryCounters *pCounters = GetThreadCounters();
+			InterlockedExchangeAdd64(&pCounters->allocatedBytes[tag], (int64_t)size);
+			InterlockedExchangeAdd64(&pCounters->allocations[tag], 1);
+		}
+
+		///
+		/// Records a free on the calling thread.
+		///
+		void MemoryTracker::RecordFree(MemoryTag tag, size_t size)
+		{
+			ThreadMemoryCounters *pCounters = GetThreadCounters();
+			InterlockedExchangeAdd64(&pCounters->freedBytes[tag], (int64_t)size);
+			InterlockedExchangeAdd64(&pCounters->frees[tag], 1);
+		}
+
+		///
+		/// Records a block growing or shrinking.
+		///
+		void MemoryTracker::RecordResize(MemoryTag tag, size_t oldSize, size_t newSize)
+		{
+			if (oldSize == newSize)
+				return;
+
+			if (oldSize > 0)
+				RecordFree(tag, oldSize);
+			if (newSize > 0)
+				RecordAllocation(tag, newSize);
+		}
+
+		///
+		/// Allocates tracked memory.
+		///
+		void *MemoryTracker::Allocate(size_t size, MemoryTag tag)
+		{
+#if defined(TEKSTORM_TRACK_MEMORY)
+			TrackedHeader *pHeader = (TrackedHeader *)malloc(sizeof(TrackedHeader) + size);
+			if (pHeader == nullptr)
+				return nullptr;
+
+			pHeader->size = (int64_t)size;
+			pHeader->tag = tag;
+			pHeader->reserved = 0;
+			RecordAllocation(tag, size);
+			return pHeader + 1;
+#else
+			return malloc(size);
+#endif
+		}
+
+		///
+		/// Frees memory from Allocate().
+		///
+		void MemoryTracker::Free(void *p)
+		{
+#if defined(TEKSTORM_TRACK_MEMORY)
+			if (p == nullptr)
+				return;
+
+			TrackedHeader *pHeader = (TrackedHeader *)p - 1;
+			RecordFree((MemoryTag)pHeader->tag, (size_t)pHeader->size);
+			free(pHeader);
+#else
+			free(p);
+#endif
+		}
+
+		///
+		/// Sets the budget of a tag in bytes (0 = none).
+		///
+		void MemoryTracker::SetBudget(MemoryTag tag, int64_t bytes)
+		{
+			s_stats[tag].budgetBytes = bytes;
+			s_budgetWarned[tag] = false;
+		}
+
+		///
+		/// Sets the function called once each time a tag goes over its budget.
+		///
+		void MemoryTracker::SetBudgetFunction(MemoryBudgetFunction function, void *pData)
+		{
+			s_budgetFunction = function;
+			s_pBudgetData = pData;
+		}
+
+		///
+		/// Merges the per-thread counters.
+		///
+		void MemoryTracker::Update()
+		{
+			int64_t allocatedBytes[TEKMEMTAG_COUNT] = { 0 };
+			int64_t freedBytes[TEKMEMTAG_COUNT] = { 0 };
+			int64_t allocations[TEKMEMTAG_COUNT] = { 0 };
+			int64_t frees[TEKMEMTAG_COUNT] = { 0 };
+
+			LockCounters();
+			for (size_t i = 0; i < s_counters.size(); i++)
+			{
+				for (int32_t tag = 0; tag < TEKMEMTAG_COUNT; tag++)
+				{
+					allocatedBytes[tag] += ReadCounter(&s_counters[i]->allocatedBytes[tag]);
+					freedBytes[tag] += ReadCounter(&s_counters[i]->freedBytes[tag]);
+					allocations[tag] += ReadCounter(&s_counters[i]->allocations[tag]);
+					frees[tag] += ReadCounter(&s_counters[i]->frees[tag]);
+				}
+			}
+			InterlockedExchange(&s_nCountersLock, 0);
+
+			for (int32_t tag = 0; tag < TEKMEMTAG_COUNT; tag++)
+			{
+				MemoryTagStats &stats = s_stats[tag];
+				stats.frameAllocations = allocations[tag] - stats.allocations;
+				stats.frameBytes = allocatedBytes[tag] - s_lastAllocatedBytes[tag];
+				stats.allocations = allocations[tag];
+				stats.frees = frees[tag];
+				stats.currentBytes = allocatedBytes[tag] - freedBytes[tag];
+				if (stats.currentBytes > stats.peakBytes)
+					stats.peakBytes = stats.currentBytes;
+				s_lastAllocatedBytes[tag] = allocatedBytes[tag];
+
+				// report once per excursion over the budget
+				bool over = (stats.budgetBytes > 0 && stats.currentBytes > stats.budgetBytes);
+				if (over && !s_budgetWarned[tag])
+				{
+					if (s_budgetFunction != nullptr)
+						s_budgetFunction(s_pBudgetData, (MemoryTag)tag, stats);
+
+#if defined(TEKSTORM_DEBUG)
+					TEKDEBUG_W("Memory budget exceeded for " << s_tagNames[tag] << ": " << (int32_t)(stats.currentBytes / 1024)
+						<< " KB of " << (int32_t)(stats.budgetBytes / 1024) << " KB");
+#endif
+				}
+
+				s_budgetWarned[tag] = over;
+			}
+		}
+
+		///
+		/// Gets the statistics of a tag as of the last Update().
+		///
+		const MemoryTagStats &MemoryTracker::GetStats(MemoryTag tag)
+		{
+			return s_stats[tag];
+		}
+
+		///
+		/// Gets the display name of a tag.
+		///
+		const char *MemoryTracker::GetTagName(MemoryTag tag)
+		{
+			return s_tagNames[tag];
+		}
+
+		///
+		/// Writes a table of every tag's statistics to a stream.
+		///
+		void MemoryTracker::Report(Tekstorm::IO::IStream *pStream)
+		{
+			TextWriter writer(pStream);
+			writer << std::string("tag\tcurrent_kb\tpeak_kb\tallocations\tfrees\tframe_allocations\tframe_kb\tbudget_kb\n");
+			for (int32_t tag = 0; tag < TEKMEMTAG_COUNT; tag++)
+			{
+				const MemoryTagStats &stats = s_stats[tag];
+				writer << std::string(s_tagNames[tag]) << '\t';
+				writer << (int64_t)(stats.currentBytes / 1024) << '\t';
+				writer << (int64_t)(stats.peakBytes / 1024) << '\t';
+				writer << (int64_t)stats.allocations << '\t';
+				writer << (int64_t)stats.frees << '\t';
+				writer << (int64_t)stats.frameAllocations << '\t';
+				writer << (int64_t)(stats.frameBytes / 1024) << '\t';
+				writer << (int64_t)(stats.budgetBytes / 1024) << '\n';
+			}
+		}
+	}
+}
\ No newline at end of file
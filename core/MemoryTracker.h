@@ -0,0 +1,143 @@
+#pragma once
+#ifndef _TEKSTORM_MEMORYTRACKER_H
+#define _TEKSTORM_MEMORYTRACKER_H
+#include "../tekconfig.h"
+#include "../IO/IStream.h"
+
+namespace Tekstorm
+{
+	namespace Core
+	{
+		///
+		/// The subsystems allocations are attributed to.
+		///
+		enum MemoryTag
+		{
+			TEKMEMTAG_GENERAL,
+			TEKMEMTAG_IO,
+			TEKMEMTAG_NETWORKING,
+			TEKMEMTAG_SCRIPTING,
+			TEKMEMTAG_GRAPHICS,
+			TEKMEMTAG_SCENE,
+			TEKMEMTAG_COUNT
+		};
+
+		///
+		/// Memory statistics of one tag, as of the last MemoryTracker::Update().
+		///
+		struct MemoryTagStats
+		{
+			// Bytes currently allocated.
+			int64_t currentBytes;
+
+			// The highest currentBytes seen by Update().
+			int64_t peakBytes;
+
+			// Allocations and frees ever recorded.
+			int64_t allocations;
+			int64_t frees;
+
+			// Allocations and allocated bytes since the Update() before.
+			int64_t frameAllocations;
+			int64_t frameBytes;
+
+			// The budget in bytes, 0 for none.
+			int64_t budgetBytes;
+		};
+
+		///
+		/// Called by MemoryTracker::Update() when a tag goes over its budget.
+		///
+		typedef void (*MemoryBudgetFunction)(void *pData, MemoryTag tag, const MemoryTagStats &stats);
+
+		///
+		/// Attributes allocations to subsystems and watches their budgets.
+		///
+		/// Recording only happens in builds defining TEKSTORM_TRACK_MEMORY; otherwise
+		/// the TEKMEM_ macros compile away and Allocate()/Free() are malloc/free.
+		/// Each thread counts into its own counters, which only it writes; the adds
+		/// are atomic so that 32-bit builds never merge a torn 64-bit value, but
+		/// never contended. Update(), called once per frame, merges them into
+		/// per-tag totals and derives the per-frame figures. When a tag goes over its
+		/// budget it calls the budget function (in any build that tracks memory) and
+		/// warns through Debug in debug builds. Peaks are therefore sampled once per
+		/// frame.
+		///
+		class TEKAPI MemoryTracker
+		{
+		private:
+			///
+			/// No public constructor
+			///
+			MemoryTracker();
+
+		public:
+			///
+			/// Records an allocation on the calling thread.
+			///
+			static void RecordAllocation(MemoryTag tag, size_t size);
+
+			///
+			/// Records a free on the calling thread.
+			///
+			static void RecordFree(MemoryTag tag, size_t size);
+
+			///
+			/// Records a block growing or shrinking from oldSize to newSize bytes.
+			///
+			static void RecordResize(MemoryTag tag, size_t oldSize, size_t newSize);
+
+			///
+			/// Allocates tracked memory; the tag and size are kept in a small header.
+			///
+			static void *Allocate(size_t size, MemoryTag tag);
+
+			///
+			/// Frees memory from Allocate().
+			///
+			static void Free(void *p);
+
+			///
+			/// Sets the budget of a tag in bytes (0 = none).
+			///
+			static void SetBudget(MemoryTag tag, int64_t bytes);
+
+			///
+			/// Sets the function called once each time a tag goes over its budget, or nullptr.
+			///
+			static void SetBudgetFunction(MemoryBudgetFunction function, void *pData = nullptr);
+
+			///
+			/// Merges the per-thread counters. Call once per frame.
+			///
+			static void Update();
+
+			///
+			/// Gets the statistics of a tag as of the last Update().
+			///
+			static const MemoryTagStats &GetStats(MemoryTag tag);
+
+			///
+			/// Gets the display name of a tag.
+			///
+			static const char *GetTagName(MemoryTag tag);
+
+			///
+			/// Writes a table of every tag's statistics to a stream.
+			///
+			static void Report(Tekstorm::IO::IStream *pStream);
+		};
+	}
+}
+
+#if defined(TEKSTORM_TRACK_MEMORY)
+	#define TEKMEM_ALLOC(tag, size) Tekstorm::Core::MemoryTracker::RecordAllocation(tag, size)
+	#define TEKMEM_FREE(tag, size) Tekstorm::Core::MemoryTracker::RecordFree(tag, size)
+	#define TEKMEM_RESIZE(tag, oldSize, newSize) Tekstorm::Core::MemoryTracker::RecordResize(tag, oldSize, newSize)
+#else
+	#define TEKMEM_ALLOC(tag, size)
+	#define TEKMEM_FREE(tag, size)
+	#define TEKMEM_RESIZE(tag, oldSize, newSize)
+#endif
+
+#endif /* _TEKSTORM_MEMORYTRACKER_H */
\ No newline at end of file
@@ -0,0 +1,318 @@
+#pragma once
+#ifndef _TEKSTORM_OBJECTPOOL_H
+#define _TEKSTORM_OBJECTPOOL_H
+#include "../tekconfig.h"
+#include "Handle.h"
+#include "Debug.h"
+#include <new>
+
+namespace Tekstorm
+{
+	namespace Core
+	{
+		///
+		/// A typed pool of objects addressed by generational Handles.
+		///
+		/// Objects live in chunks of ChunkSize contiguous elements that are allocated
+		/// on demand and never move, so pointers stay valid until the object is
+		/// destroyed. Free slots form an intrusive free list, which makes Create()
+		/// and Destroy() O(1). Get() returns nullptr for stale handles, so a
+		/// use-after-free shows up as a failed lookup instead of memory corruption.
+		///
+		/// Not thread-safe; see ConcurrentObjectPool.
+		///
+		template <class _Type>
+		class ObjectPool
+		{
+		protected:
+			// log2 of the number of objects per chunk.
+			static const uint32_t ChunkShift = 10;
+			static const uint32_t ChunkSize = 1u << ChunkShift;
+			static const uint32_t MaxChunks = Handle::MaxIndices >> ChunkShift;
+
+			// Marks the end of the free list.
+			static const uint32_t NoSlot = 0xFFFFFFFF;
+
+			///
+			/// Bookkeeping of one slot.
+			///
+			struct SlotInfo
+			{
+				// The next free slot while this one is free.
+				uint32_t nextFree;
+
+				// The generation handles to the current object carry.
+				uint16_t generation;
+
+				// Whether or not the slot holds an object.
+				uint16_t alive;
+			};
+
+			///
+			/// A block of ChunkSize objects and their bookkeeping.
+			///
+			struct Chunk
+			{
+				_Type *pObjects;
+				SlotInfo *pSlots;
+			};
+
+			///
+			/// The chunk table (MaxChunks entries, so it never reallocates).
+			///
+			Chunk *m_pChunks;
+
+			///
+			/// The number of allocated chunks.
+			///
+			uint32_t m_nChunkCount;
+
+			///
+			/// The first free slot.
+			///
+			uint32_t m_nFreeHead;
+
+			///
+			/// The number of live objects.
+			///
+			uint32_t m_nCount;
+
+			///
+			/// Pools are not copyable.
+			///
+			ObjectPool(const ObjectPool &other);
+			ObjectPool &operator=(const ObjectPool &other);
+
+			SlotInfo &GetSlot(uint32_t index) const
+			{
+				return m_pChunks[index >> ChunkShift].pSlots[index & (ChunkSize - 1)];
+			}
+
+			_Type *GetObject(uint32_t index) const
+			{
+				return &m_pChunks[index >> ChunkShift].pObjects[index & (ChunkSize - 1)];
+			}
+
+			///
+			/// Allocates another chunk and threads its slots onto the free list.
+			///
+			bool AddChunk()
+			{
+				if (m_nChunkCount == MaxChunks)
+				{
+					TEKDEBUG_EF("ObjectPool is full; it holds at most Handle::MaxIndices objects.");
+					return false;
+				}
+
+				size_t alignment = (__alignof(_Type) > 16) ? __alignof(_Type) : 16;
+				Chunk &chunk = m_pChunks[m_nChunkCount];
+				chunk.pObjects = (_Type *)_aligned_malloc(sizeof(_Type) * ChunkSize, alignment);
+				if (chunk.pObjects == nullptr)
+				{
+					TEKDEBUG_EF("ObjectPool could not allocate a chunk.");
+					return false;
+				}
+				chunk.pSlots = new SlotInfo[ChunkSize];
+
+				uint32_t first = m_nChunkCount << ChunkShift;
+				for (uint32_t i = 0; i < ChunkSize; i++)
+				{
+					chunk.pSlots[i].nextFree = (i + 1 < ChunkSize) ? first + i + 1 : m_nFreeHead;
+					chunk.pSlots[i].generation = 1;
+					chunk.pSlots[i].alive = 0;
+				}
+
+				m_nFreeHead = first;
+				m_nChunkCount++;
+				return true;
+			}
+
+			///
+			/// Takes a free slot, growing the pool if needed. Returns NoSlot when full.
+			///
+			uint32_t AllocateIndex()
+			{
+				if (m_nFreeHead == NoSlot && !AddChunk())
+					return NoSlot;
+
+				uint32_t index = m_nFreeHead;
+				m_nFreeHead = GetSlot(index).nextFree;
+				return index;
+			}
+
+			///
+			/// Returns a slot to the free list.
+			///
+			void FreeIndex(uint32_t index)
+			{
+				GetSlot(index).nextFree = m_nFreeHead;
+				m_nFreeHead = index;
+			}
+
+			///
+			/// Marks a constructed slot as live and gets its handle.
+			///
+			Handle Publish(uint32_t index)
+			{
+				SlotInfo &slot = GetSlot(index);
+				slot.alive = 1;
+				return Handle(index, slot.generation);
+			}
+
+			///
+			/// Destroys the object of a live slot and invalidates its handles.
+			///
+			void Retire(uint32_t index)
+			{
+				SlotInfo &slot = GetSlot(index);
+				GetObject(index)->~_Type();
+				slot.alive = 0;
+				slot.generation = (uint16_t)Handle::NextGeneration(slot.generation);
+			}
+
+			///
+			/// Returns true if the handle refers to a live object.
+			///
+			bool Resolves(Handle handle) const
+			{
+				uint32_t index = handle.GetIndex();
+				if (handle.IsNull() || (index >> ChunkShift) >= m_nChunkCount)
+					return false;
+
+				const SlotInfo &slot = GetSlot(index);
+				return slot.alive != 0 && slot.generation == handle.GetGeneration();
+			}
+
+		public:
+			ObjectPool()
+			{
+				m_pChunks = new Chunk[MaxChunks];
+				m_nChunkCount = 0;
+				m_nFreeHead = NoSlot;
+				m_nCount = 0;
+			}
+
+			~ObjectPool()
+			{
+				Clear();
+				for (uint32_t i = 0; i < m_nChunkCount; i++)
+				{
+					_aligned_free(m_pChunks[i].pObjects);
+					delete [] m_pChunks[i].pSlots;
+				}
+
+				delete [] m_pChunks;
+			}
+
+			///
+			/// Creates a default-constructed object. Returns a null handle if the pool is full.
+			///
+			Handle Create()
+			{
+				uint32_t index = AllocateIndex();
+				if (index == NoSlot)
+					return Handle();
+
+				new (GetObject(index)) _Type();
+				m_nCount++;
+				return Publish(index);
+			}
+
+			///
+			/// Creates a copy of 'value'. Returns a null handle if the pool is full.
+			///
+			Handle Create(const _Type &value)
+			{
+				uint32_t index = AllocateIndex();
+				if (index == NoSlot)
+					return Handle();
+
+				new (GetObject(index)) _Type(value);
+				m_nCount++;
+				return Publish(index);
+			}
+
+			///
+			/// Destroys an object. Returns false if the handle was stale.
+			///
+			bool Destroy(Handle handle)
+			{
+				if (!Resolves(handle))
+					return false;
+
+				Retire(handle.GetIndex());
+				FreeIndex(handle.GetIndex());
+				m_nCount--;
+				return true;
+			}
+
+			///
+			/// Gets an object, or nullptr if the handle is null or stale.
+			///
+			_Type *Get(Handle handle) const
+			{
+				return Resolves(handle) ? GetObject(handle.GetIndex()) : nullptr;
+			}
+
+			///
+			/// Returns true if the handle refers to a live object.
+			///
+			bool IsValid(Handle handle) const
+			{
+				return Resolves(handle);
+			}
+
+			///
+			/// Gets the number of live objects.
+			///
+			uint32_t GetCount() const
+			{
+				return m_nCount;
+			}
+
+			///
+			/// Gets the number of objects the allocated chunks can hold.
+			///
+			uint32_t GetCapacity() const
+			{
+				return m_nChunkCount << ChunkShift;
+			}
+
+			///
+			/// Destroys every object. The chunks are kept.
+			///
+			void Clear()
+			{
+				m_nFreeHead = NoSlot;
+				for (uint32_t index = m_nChunkCount << ChunkShift; index > 0; index--)
+				{
+					if (GetSlot(index - 1).alive != 0)
+						Retire(index - 1);
+
+					FreeIndex(index - 1);
+				}
+
+				m_nCount = 0;
+			}
+
+			///
+			/// Calls function(handle, pObject) for every live object, in memory order.
+			///
+			template <class _Function>
+			void ForEach(_Function function)
+			{
+				for (uint32_t c = 0; c < m_nChunkCount; c++)
+				{
+					const Chunk &chunk = m_pChunks[c];
+					for (uint32_t i = 0; i < ChunkSize; i++)
+					{
+						if (chunk.pSlots[i].alive != 0)
+							function(Handle((c << ChunkShift) + i, chunk.pSlots[i].generation), &chunk.pObjects[i]);
+					}
+				}
+			}
+		};
+	}
+}
+
+#endif /* _TEKSTORM_OBJECTPOOL_H */
\ No newline at end of file
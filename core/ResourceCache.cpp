@@ -0,0 +1,336 @@
+#define TEKSTORM_BUILD
+#include "ResourceCache.h"
+#include "Debug.h"
+
+namespace Tekstorm
+{
+	namespace Core
+	{
+		///
+		/// Collects the handles of a pool's entries, so they can be changed afterwards.
+		///
+		struct CollectEntries
+		{
+			std::vector<Handle> *pHandles;
+
+			void operator()(Handle handle, ResourceCacheEntry *pEntry) const
+			{
+				pHandles->push_back(handle);
+			}
+		};
+
+		///
+		/// Creates a cache loading through pManager.
+		///
+		ResourceCache::ResourceCache(ResourceManager *pManager, int64_t budgetBytes)
+		{
+			m_pManager = pManager;
+			m_pLruHead = nullptr;
+			m_pLruTail = nullptr;
+			m_nBudget = budgetBytes;
+			m_nBytes = 0;
+		}
+
+		ResourceCache::~ResourceCache()
+		{
+			std::vector<Handle> handles;
+			CollectEntries collect = { &handles };
+			m_entries.ForEach(collect);
+
+			for (size_t i = 0; i < handles.size(); i++)
+				Evict(m_entries.Get(handles[i]));
+		}
+
+		void ResourceCache::LinkLru(ResourceCacheEntry *pEntry)
+		{
+			pEntry->pPrev = nullptr;
+			pEntry->pNext = m_pLruHead;
+			if (m_pLruHead != nullptr)
+				m_pLruHead->pPrev = pEntry;
+			else
+				m_pLruTail = pEntry;
+			m_pLruHead = pEntry;
+		}
+
+		void ResourceCache::UnlinkLru(ResourceCacheEntry *pEntry)
+		{
+			if (pEntry->pPrev != nullptr)
+				pEntry->pPrev->pNext = pEntry->pNext;
+			else
+				m_pLruHead = pEntry->pNext;
+
+			if (pEntry->pNext != nullptr)
+				pEntry->pNext->pPrev = pEntry->pPrev;
+			else
+				m_pLruTail = pEntry->pPrev;
+
+			pEntry->pPrev = nullptr;
+			pEntry->pNext = nullptr;
+		}
+
+		///
+		/// Returns the entry's charge to the budget.
+		///
+		void ResourceCache::Uncharge(ResourceCacheEntry *pEntry)
+		{
+			if (pEntry->charged)
+			{
+				m_nBytes -= pEntry->size;
+				pEntry->charged = false;
+			}
+		}
+
+		///
+		/// Releases an entry's load and removes the entry.
+		///
+		void ResourceCache::Evict(ResourceCacheEntry *pEntry)
+		{
+			if (pEntry->refCount == 0)
+				UnlinkLru(pEntry);
+
+			Uncharge(pEntry);
+			m_pManager->Release(pEntry->load);
+			m_index.Erase(pEntry->id);
+			m_entries.Destroy(pEntry->handle);
+		}
+
+		///
+		/// Gets a reference to the resource of a path.
+		///
+		Handle ResourceCache::Acquire(const std::string &filePath, ResourceFactory factory, void *pArgs)
+		{
+			StringId id = StringId::FromHash(HashFnv1aBytes(filePath.c_str(), filePath.length()));
+			return Acquire(id, filePath, factory, pArgs);
+		}
+
+		///
+		/// Gets a reference to the resource of a path whose StringId is already known.
+		///
+		Handle ResourceCache::Acquire(StringId id, const std::string &filePath, ResourceFactory factory, void *pArgs)
+		{
+			Handle *pCached = m_index.Find(id);
+			if (pCached != nullptr)
+			{
+				// the path is kept with the entry, so a colliding path is caught here
+				// without the StringId table, which release builds may not fill
+				const ResourceCacheEntry *pCachedEntry = m_entries.Get(*pCached);
+				if (pCachedEntry->path != filePath)
+				{
+					TEKDEBUG_EF("ResourceCache: \"" << filePath << "\" and \"" << pCachedEntry->path << "\" share a StringId");
+					return Handle();
+				}
+
+				return AddRef(*pCached);
+			}
+
+			Handle handle = m_entries.Create();
+			ResourceCacheEntry *pEntry = m_entries.Get(handle);
+			if (pEntry == nullptr)
+				return Handle();
+
+			pEntry->handle = handle;
+			pEntry->id = id;
+			pEntry->path = filePath;
+			pEntry->factory = factory;
+			pEntry->pArgs = pArgs;
+			pEntry->load = m_pManager->Load(filePath, factory, pArgs);
+			pEntry->refCount = 1;
+			pEntry->size = 0;
+			pEntry->sizeSet = false;
+			pEntry->charged = false;
+			pEntry->pPrev = nullptr;
+			pEntry->pNext = nullptr;
+
+			m_index.Insert(id, handle);
+			m_uncharged.push_back(handle);
+			return handle;
+		}
+
+		///
+		/// Gets another reference to a cached resource.
+		///
+		Handle ResourceCache::AddRef(Handle handle)
+		{
+			ResourceCacheEntry *pEntry = m_entries.Get(handle);
+			if (pEntry == nullptr)
+				return Handle();
+
+			if (pEntry->refCount++ == 0)
+				UnlinkLru(pEntry);
+
+			return handle;
+		}
+
+		///
+		/// Drops a reference.
+		///
+		void ResourceCache::Release(Handle handle)
+		{
+			ResourceCacheEntry *pEntry = m_entries.Get(handle);
+			if (pEntry == nullptr || pEntry->refCount == 0)
+				return;
+
+			if (--pEntry->refCount > 0)
+				return;
+
+			// failed loads are not worth keeping
+			if (m_pManager->GetState(pEntry->load) == TEKRESOURCE_FAILED)
+			{
+				pEntry->refCount = 0;
+				LinkLru(pEntry);
+				Evict(pEntry);
+				return;
+			}
+
+			LinkLru(pEntry);
+			Trim();
+		}
+
+		///
+		/// Gets a ready resource, or nullptr.
+		///
+		IResource *ResourceCache::Get(Handle handle) const
+		{
+			const ResourceCacheEntry *pEntry = m_entries.Get(handle);
+			return (pEntry != nullptr) ? m_pManager->Get(pEntry->load) : nullptr;
+		}
+
+		///
+		/// Gets the load state of a resource.
+		///
+		ResourceState ResourceCache::GetState(Handle handle) const
+		{
+			const ResourceCacheEntry *pEntry = m_entries.Get(handle);
+			return (pEntry != nullptr) ? m_pManager->GetState(pEntry->load) : TEKRESOURCE_FAILED;
+		}
+
+		///
+		/// Sets the bytes a resource is charged.
+		///
+		void ResourceCache::SetSize(Handle handle, int64_t bytes)
+		{
+			ResourceCacheEntry *pEntry = m_entries.Get(handle);
+			if (pEntry == nullptr)
+				return;
+
+			if (pEntry->charged)
+				m_nBytes += bytes - pEntry->size;
+
+			pEntry->size = bytes;
+			pEntry->sizeSet = true;
+			Trim();
+		}
+
+		///
+		/// Sets the budget in bytes and evicts down to it.
+		///
+		void ResourceCache::SetBudget(int64_t bytes)
+		{
+			m_nBudget = bytes;
+			Trim();
+		}
+
+		///
+		/// Gets the budget in bytes.
+		///
+		int64_t ResourceCache::GetBudget() const
+		{
+			return m_nBudget;
+		}
+
+		///
+		/// Gets the bytes charged by cached resources.
+		///
+		int64_t ResourceCache::GetBytes() const
+		{
+			return m_nBytes;
+		}
+
+		///
+		/// Gets the number of cached resources.
+		///
+		int32_t ResourceCache::GetCount() const
+		{
+			return (int32_t)m_entries.GetCount();
+		}
+
+		///
+		/// Charges the resources loaded since the last call and evicts down to the budget.
+		///
+		void ResourceCache::Update()
+		{
+			for (size_t i = 0; i < m_uncharged.size(); )
+			{
+				ResourceCacheEntry *pEntry = m_entries.Get(m_uncharged[i]);
+				ResourceState state = (pEntry != nullptr) ? m_pManager->GetState(pEntry->load) : TEKRESOURCE_FAILED;
+				if (state == TEKRESOURCE_LOADING)
+				{
+					i++;
+					continue;
+				}
+
+				if (state == TEKRESOURCE_READY)
+				{
+					if (!pEntry->sizeSet)
+						pEntry->size = m_pManager->GetFileSize(pEntry->load);
+
+					pEntry->charged = true;
+					m_nBytes += pEntry->size;
+				}
+
+				m_uncharged[i] = m_uncharged.back();
+				m_uncharged.pop_back();
+			}
+
+			Trim();
+		}
+
+		///
+		/// Evicts unreferenced resources until the cache is within its budget.
+		///
+		void ResourceCache::Trim()
+		{
+			while (m_nBudget > 0 && m_nBytes > m_nBudget && m_pLruTail != nullptr)
+				Evict(m_pLruTail);
+		}
+
+		///
+		/// Evicts every unreferenced resource.
+		///
+		void ResourceCache::Purge()
+		{
+			while (m_pLruTail != nullptr)
+				Evict(m_pLruTail);
+		}
+
+		///
+		/// Drops unreferenced volatile resources and reloads referenced ones.
+		///
+		void ResourceCache::OnDeviceLost()
+		{
+			std::vector<Handle> handles;
+			CollectEntries collect = { &handles };
+			m_entries.ForEach(collect);
+
+			for (size_t i = 0; i < handles.size(); i++)
+			{
+				ResourceCacheEntry *pEntry = m_entries.Get(handles[i]);
+				IResource *pResource = m_pManager->Get(pEntry->load);
+				if (pResource == nullptr || !pResource->IsVolatile())
+					continue;
+
+				if (pEntry->refCount == 0)
+				{
+					Evict(pEntry);
+					continue;
+				}
+
+				// the handle stays valid; its resource reads as loading until reloaded
+				Uncharge(pEntry);
+				m_pManager->Release(pEntry->load);
+				pEntry->load = m_pManager->Load(pEntry->path, pEntry->factory, pEntry->pArgs);
+				m_uncharged.push_back(handles[i]);
+			}
+		}
+	}
+}
\ No newline at end of file
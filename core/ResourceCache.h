@@ -0,0 +1,203 @@
+#pragma once
+#ifndef _TEKSTORM_RESOURCECACHE_H
+#define _TEKSTORM_RESOURCECACHE_H
+#include "../tekconfig.h"
+#include "ResourceManager.h"
+#include "StringId.h"
+#include "FlatHashMap.h"
+
+namespace Tekstorm
+{
+	namespace Core
+	{
+		///
+		/// A cached resource (internal to ResourceCache).
+		///
+		struct ResourceCacheEntry
+		{
+			// The entry's own handle, the StringId of its path, which is the key, and the
+			// path itself, to load from.
+			Handle handle;
+			StringId id;
+			std::string path;
+
+			// How to (re)load the resource.
+			ResourceFactory factory;
+			void *pArgs;
+
+			// The ResourceManager load.
+			Handle load;
+
+			// The number of owners; unreferenced entries sit in the LRU list.
+			int32_t refCount;
+
+			// The bytes charged to the budget.
+			int64_t size;
+
+			// Whether the owner set the size, overriding the file size.
+			bool sizeSet;
+
+			// Whether the size is charged yet; it is once the load is published.
+			bool charged;
+
+			// The LRU list, most recently released first.
+			ResourceCacheEntry *pPrev;
+			ResourceCacheEntry *pNext;
+		};
+
+		///
+		/// Shares resources by name and bounds their memory.
+		///
+		/// Acquire() returns the cached resource of a path if there is one and starts
+		/// a ResourceManager load otherwise; every Acquire() or AddRef() is paired with
+		/// a Release(). Resources are keyed by the StringId of their path, so two paths
+		/// whose ids collide cannot both be cached; acquiring the second is an error. A resource whose last reference is released stays cached, in
+		/// least-recently-used order, and is only evicted while the cache is over its
+		/// budget. Each resource is charged the size of its file unless SetSize()
+		/// gives a better figure, e.g. a texture's decoded size.
+		///
+		/// After a device loss, OnDeviceLost() drops unreferenced volatile resources
+		/// and reloads referenced ones, whose handles then read as loading again.
+		///
+		/// Single-threaded, like ResourceManager's owner interface. Call Update() once
+		/// per frame after ResourceManager::Update().
+		///
+		class TEKAPI ResourceCache
+		{
+		protected:
+			ResourceManager *m_pManager;
+
+			///
+			/// The entries, by handle.
+			///
+			ObjectPool<ResourceCacheEntry> m_entries;
+
+			///
+			/// The entries by the StringId of their path.
+			///
+			FlatHashMap<StringId, Handle> m_index;
+
+			///
+			/// Entries whose size has not been charged yet.
+			///
+			std::vector<Handle> m_uncharged;
+
+			///
+			/// The unreferenced entries; the head was released last, the tail is evicted first.
+			///
+			ResourceCacheEntry *m_pLruHead;
+			ResourceCacheEntry *m_pLruTail;
+
+			///
+			/// The budget in bytes (0 = unbounded) and the bytes charged.
+			///
+			int64_t m_nBudget;
+			int64_t m_nBytes;
+
+			///
+			/// Caches are not copyable.
+			///
+			ResourceCache(const ResourceCache &other);
+			ResourceCache &operator=(const ResourceCache &other);
+
+			void LinkLru(ResourceCacheEntry *pEntry);
+			void UnlinkLru(ResourceCacheEntry *pEntry);
+
+			///
+			/// Releases an entry's load and removes the entry.
+			///
+			void Evict(ResourceCacheEntry *pEntry);
+
+			///
+			/// Returns the entry's charge to the budget.
+			///
+			void Uncharge(ResourceCacheEntry *pEntry);
+
+		public:
+			///
+			/// Creates a cache loading through pManager. A budget of 0 is unbounded.
+			///
+			ResourceCache(ResourceManager *pManager, int64_t budgetBytes = 0);
+			~ResourceCache();
+
+			///
+			/// Gets a reference to the resource of a path, loading it if it is not cached.
+			///
+			Handle Acquire(const std::string &filePath, ResourceFactory factory, void *pArgs = nullptr);
+
+			///
+			/// Gets a reference to the resource of a path whose StringId is already known,
+			/// i.e. from TEKSID(), saving the hash. id must be the StringId of filePath.
+			///
+			Handle Acquire(StringId id, const std::string &filePath, ResourceFactory factory, void *pArgs = nullptr);
+
+			///
+			/// Gets another reference to a cached resource, or a null handle if it is stale.
+			///
+			Handle AddRef(Handle handle);
+
+			///
+			/// Drops a reference. Unreferenced resources stay cached until evicted.
+			///
+			void Release(Handle handle);
+
+			///
+			/// Gets a ready resource, or nullptr.
+			///
+			IResource *Get(Handle handle) const;
+
+			///
+			/// Gets the load state of a resource; stale handles read as TEKRESOURCE_FAILED.
+			///
+			ResourceState GetState(Handle handle) const;
+
+			///
+			/// Sets the bytes a resource is charged, replacing its file size.
+			///
+			void SetSize(Handle handle, int64_t bytes);
+
+			///
+			/// Sets the budget in bytes (0 = unbounded) and evicts down to it.
+			///
+			void SetBudget(int64_t bytes);
+
+			///
+			/// Gets the budget in bytes.
+			///
+			int64_t GetBudget() const;
+
+			///
+			/// Gets the bytes charged by cached resources.
+			///
+			int64_t GetBytes() const;
+
+			///
+			/// Gets the number of cached resources.
+			///
+			int32_t GetCount() const;
+
+			///
+			/// Charges the resources loaded since the last call and evicts down to the budget.
+			///
+			void Update();
+
+			///
+			/// Evicts unreferenced resources, least recently used first, until the cache is
+			/// within its budget.
+			///
+			void Trim();
+
+			///
+			/// Evicts every unreferenced resource.
+			///
+			void Purge();
+
+			///
+			/// Drops unreferenced volatile resources and reloads referenced ones.
+			///
+			void OnDeviceLost();
+		};
+	}
+}
+
+#endif /* _TEKSTORM_RESOURCECACHE_H */
\ No newline at end of file
@@ -0,0 +1,444 @@
+#define TEKSTORM_BUILD
+#include "ResourceManager.h"
+#include "MemoryTracker.h"
+#include "../IO/ArchiveStream.h"
+#include "../IO/DecompressStream.h"
+#include <algorithm>
+
+namespace Tekstorm
+{
+	namespace Core
+	{
+		///
+		/// Disposes of the resources of every request (see ResourceManager::Stop()).
+		///
+		struct DisposeRequest
+		{
+			void operator()(Handle handle, ResourceRequest *pRequest) const
+			{
+				if (pRequest->pResource != nullptr)
+				{
+					pRequest->pResource->Dispose();
+					delete pRequest->pResource;
+					pRequest->pResource = nullptr;
+				}
+
+				if (!pRequest->mapped)
+					MemoryTracker::Free(pRequest->pData);
+				pRequest->pData = nullptr;
+			}
+		};
+
+		///
+		/// Decompresses a request's compressed archive entry into a heap copy.
+		///
+		static bool UnpackEntry(ResourceRequest *pRequest)
+		{
+			IO::ArchiveStream stored;
+			if (!stored.OpenStored(*pRequest->pArchive, pRequest->entry))
+				return false;
+
+			pRequest->pData = (char *)MemoryTracker::Allocate(pRequest->size > 0 ? pRequest->size : 1, TEKMEMTAG_IO);
+			if (pRequest->pData == nullptr)
+				return false;
+
+			IO::DecompressStream decompress(&stored);
+			return (decompress.Read(pRequest->pData, pRequest->size) == pRequest->size
+				&& decompress.ReadByte() == -1 && decompress.IsValid());
+		}
+
+		ResourceManager::ResourceManager()
+		{
+			m_pJobs = nullptr;
+			m_hThread = nullptr;
+			m_hQueued = nullptr;
+			m_pQueueHead = nullptr;
+			m_pQueueTail = nullptr;
+			m_pCompleted = nullptr;
+			m_nRunning = 0;
+			m_nPendingCount = 0;
+			InitializeCriticalSection(&m_lock);
+		}
+
+		ResourceManager::~ResourceManager()
+		{
+			Stop();
+			DeleteCriticalSection(&m_lock);
+		}
+
+		///
+		/// Starts the I/O thread.
+		///
+		bool ResourceManager::Start(JobSystem *pJobs)
+		{
+			if (m_hThread != nullptr)
+				return false;
+
+			m_pJobs = pJobs;
+			m_nRunning = 1;
+			m_hQueued = CreateSemaphore(nullptr, 0, 0x7FFFFFFF, nullptr);
+			m_hThread = CreateThread(nullptr, 0, &ResourceManager::IoThread, this, 0, nullptr);
+			if (m_hThread == nullptr)
+			{
+#if defined(TEKSTORM_DEBUG)
+				TEKDEBUG_W("Could not start the resource I/O thread");
+#endif
+				CloseHandle(m_hQueued);
+				m_hQueued = nullptr;
+				m_nRunning = 0;
+				return false;
+			}
+
+			return true;
+		}
+
+		///
+		/// Stops the I/O thread, waits for running decodes and releases every resource.
+		///
+		void ResourceManager::Stop()
+		{
+			if (m_hThread == nullptr)
+				return;
+
+			InterlockedExchange(&m_nRunning, 0);
+			ReleaseSemaphore(m_hQueued, 1, nullptr);
+			WaitForSingleObject(m_hThread, INFINITE);
+			CloseHandle(m_hThread);
+			CloseHandle(m_hQueued);
+			m_hThread = nullptr;
+			m_hQueued = nullptr;
+
+			if (m_pJobs != nullptr)
+				m_pJobs->Wait(&m_decodes);
+
+			m_requests.ForEach(DisposeRequest());
+			m_requests.Clear();
+			m_pQueueHead = nullptr;
+			m_pQueueTail = nullptr;
+			m_pCompleted = nullptr;
+			m_nPendingCount = 0;
+			m_pJobs = nullptr;
+		}
+
+		///
+		/// Queues a load and returns its handle.
+		///
+		Handle ResourceManager::Load(const std::string &filePath, ResourceFactory factory, void *pArgs)
+		{
+			if (m_hThread == nullptr)
+				return Handle();
+
+			Handle handle = m_requests.Create();
+			ResourceRequest *pRequest = m_requests.Get(handle);
+			if (pRequest == nullptr)
+				return Handle();
+
+			pRequest->path = filePath;
+			pRequest->factory = factory;
+			pRequest->pArgs = pArgs;
+			pRequest->pManager = this;
+			pRequest->handle = handle;
+			pRequest->pArchive = nullptr;
+			pRequest->entry = -1;
+			pRequest->pResource = nullptr;
+			pRequest->pData = nullptr;
+			pRequest->size = 0;
+			pRequest->mapped = false;
+			pRequest->result = TEKRESOURCE_LOADING;
+			pRequest->state = TEKRESOURCE_LOADING;
+			pRequest->released = false;
+			pRequest->pNext = nullptr;
+
+			for (size_t i = m_archives.size(); i > 0; i--)
+			{
+				int32_t entry = m_archives[i - 1]->Find(filePath);
+				if (entry >= 0)
+				{
+					pRequest->pArchive = m_archives[i - 1];
+					pRequest->entry = entry;
+					break;
+				}
+			}
+
+			EnterCriticalSection(&m_lock);
+			if (m_pQueueTail != nullptr)
+				m_pQueueTail->pNext = pRequest;
+			else
+				m_pQueueHead = pRequest;
+			m_pQueueTail = pRequest;
+			LeaveCriticalSection(&m_lock);
+
+			m_nPendingCount++;
+			ReleaseSemaphore(m_hQueued, 1, nullptr);
+			return handle;
+		}
+
+		///
+		/// Loads later paths from an archive when it has them.
+		///
+		void ResourceManager::Mount(const IO::Archive *pArchive)
+		{
+			Unmount(pArchive);
+			m_archives.push_back(pArchive);
+		}
+
+		///
+		/// Stops loading from an archive.
+		///
+		void ResourceManager::Unmount(const IO::Archive *pArchive)
+		{
+			m_archives.erase(std::remove(m_archives.begin(), m_archives.end(), pArchive), m_archives.end());
+		}
+
+		///
+		/// Publishes the loads completed since the last call.
+		///
+		int32_t ResourceManager::Update()
+		{
+			EnterCriticalSection(&m_lock);
+			ResourceRequest *pRequest = m_pCompleted;
+			m_pCompleted = nullptr;
+			LeaveCriticalSection(&m_lock);
+
+			int32_t published = 0;
+			while (pRequest != nullptr)
+			{
+				ResourceRequest *pNext = pRequest->pNext;
+				m_nPendingCount--;
+
+				if (pRequest->released)
+				{
+					Destroy(pRequest->handle, pRequest);
+				}
+				else
+				{
+					pRequest->state = pRequest->result;
+					published++;
+
+#if defined(TEKSTORM_DEBUG)
+					if (pRequest->state == TEKRESOURCE_FAILED)
+					{
+						TEKDEBUG_W("Failed to load resource " << pRequest->path);
+					}
+#endif
+				}
+
+				pRequest = pNext;
+			}
+
+			return published;
+		}
+
+		///
+		/// Gets the state of a load.
+		///
+		ResourceState ResourceManager::GetState(Handle handle) const
+		{
+			const ResourceRequest *pRequest = m_requests.Get(handle);
+			if (pRequest == nullptr || pRequest->released)
+				return TEKRESOURCE_FAILED;
+
+			return pRequest->state;
+		}
+
+		///
+		/// Gets a ready resource.
+		///
+		IResource *ResourceManager::Get(Handle handle) const
+		{
+			const ResourceRequest *pRequest = m_requests.Get(handle);
+			if (pRequest == nullptr || pRequest->released || pRequest->state != TEKRESOURCE_READY)
+				return nullptr;
+
+			return pRequest->pResource;
+		}
+
+		///
+		/// Gets the size of the file a ready resource was loaded from.
+		///
+		int32_t ResourceManager::GetFileSize(Handle handle) const
+		{
+			const ResourceRequest *pRequest = m_requests.Get(handle);
+			if (pRequest == nullptr || pRequest->released || pRequest->state != TEKRESOURCE_READY)
+				return 0;
+
+			return pRequest->size;
+		}
+
+		///
+		/// Disposes of a resource and invalidates its handle.
+		///
+		void ResourceManager::Release(Handle handle)
+		{
+			ResourceRequest *pRequest = m_requests.Get(handle);
+			if (pRequest == nullptr || pRequest->released)
+				return;
+
+			// in flight; Update() destroys it when it comes back
+			if (pRequest->state == TEKRESOURCE_LOADING)
+			{
+				pRequest->released = true;
+				return;
+			}
+
+			Destroy(handle, pRequest);
+		}
+
+		///
+		/// Gets the number of loads not yet published.
+		///
+		int32_t ResourceManager::GetPendingCount() const
+		{
+			return m_nPendingCount;
+		}
+
+		///
+		/// Disposes of a request's resource and frees its handle.
+		///
+		void ResourceManager::Destroy(Handle handle, ResourceRequest *pRequest)
+		{
+			DisposeRequest()(handle, pRequest);
+			m_requests.Destroy(handle);
+		}
+
+		///
+		/// Reads one request's file and hands it to a decode job.
+		///
+		void ResourceManager::Read(ResourceRequest *pRequest)
+		{
+			if (pRequest->pArchive != nullptr)
+			{
+				ReadArchive(pRequest);
+				return;
+			}
+
+			HANDLE hFile = CreateFileA(pRequest->path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+				OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+			if (hFile == INVALID_HANDLE_VALUE)
+			{
+				Complete(pRequest, TEKRESOURCE_FAILED);
+				return;
+			}
+
+			LARGE_INTEGER size;
+			bool ok = (GetFileSizeEx(hFile, &size) != FALSE && size.QuadPart < 0x7FFFFFFF);
+			if (ok)
+			{
+				pRequest->size = (int32_t)size.QuadPart;
+				pRequest->pData = (char *)MemoryTracker::Allocate(pRequest->size > 0 ? pRequest->size : 1, TEKMEMTAG_IO);
+
+				DWORD read = 0;
+				ok = (pRequest->pData != nullptr && ReadFile(hFile, pRequest->pData, (DWORD)pRequest->size, &read, nullptr) != FALSE
+					&& read == (DWORD)pRequest->size);
+			}
+
+			CloseHandle(hFile);
+
+			if (!ok)
+			{
+				MemoryTracker::Free(pRequest->pData);
+				pRequest->pData = nullptr;
+				Complete(pRequest, TEKRESOURCE_FAILED);
+				return;
+			}
+
+			Decode(pRequest);
+		}
+
+		///
+		/// Reads one request's archive entry and hands it to a decode job.
+		///
+		void ResourceManager::ReadArchive(ResourceRequest *pRequest)
+		{
+			const IO::ArchiveEntry *pEntry = pRequest->pArchive->GetEntry(pRequest->entry);
+			pRequest->size = (int32_t)pEntry->unpackedSize;
+
+			// the mapping is read-only, so the resource reads it in place; compressed
+			// entries are unpacked by the decode job instead
+			if (pEntry->compression == IO::TEKPAK_COMPRESSION_NONE)
+			{
+				pRequest->pData = (char *)pRequest->pArchive->GetData(pRequest->entry);
+				pRequest->mapped = true;
+			}
+
+			Decode(pRequest);
+		}
+
+		///
+		/// Runs the decode job of a request that has been read.
+		///
+		void ResourceManager::Decode(ResourceRequest *pRequest)
+		{
+			if (m_pJobs != nullptr)
+				m_pJobs->Run(&ResourceManager::DecodeJob, pRequest, &m_decodes);
+			else
+				DecodeJob(pRequest);
+		}
+
+		///
+		/// Creates and loads the resource of a request that has been read.
+		///
+		void ResourceManager::DecodeJob(void *pData)
+		{
+			ResourceRequest *pRequest = (ResourceRequest *)pData;
+
+			bool ok = !pRequest->released;
+			if (ok && pRequest->pData == nullptr && pRequest->pArchive != nullptr)
+				ok = UnpackEntry(pRequest);
+
+			if (ok)
+			{
+				pRequest->pResource = pRequest->factory(pRequest->pArgs);
+				ok = (pRequest->pResource != nullptr
+					&& pRequest->pResource->LoadFromMemory(pRequest->pData, pRequest->size, pRequest->pArgs));
+			}
+
+			if (!pRequest->mapped)
+				MemoryTracker::Free(pRequest->pData);
+			pRequest->pData = nullptr;
+			pRequest->pManager->Complete(pRequest, ok ? TEKRESOURCE_READY : TEKRESOURCE_FAILED);
+		}
+
+		///
+		/// Queues a finished request for Update().
+		///
+		void ResourceManager::Complete(ResourceRequest *pRequest, ResourceState result)
+		{
+			pRequest->result = result;
+
+			EnterCriticalSection(&m_lock);
+			pRequest->pNext = m_pCompleted;
+			m_pCompleted = pRequest;
+			LeaveCriticalSection(&m_lock);
+		}
+
+		///
+		/// Entry point of the I/O thread.
+		///
+		DWORD WINAPI ResourceManager::IoThread(LPVOID pParameter)
+		{
+			ResourceManager *pManager = (ResourceManager *)pParameter;
+			while (true)
+			{
+				WaitForSingleObject(pManager->m_hQueued, INFINITE);
+				if (pManager->m_nRunning == 0)
+					break;
+
+				EnterCriticalSection(&pManager->m_lock);
+				ResourceRequest *pRequest = pManager->m_pQueueHead;
+				if (pRequest != nullptr)
+				{
+					pManager->m_pQueueHead = pRequest->pNext;
+					if (pManager->m_pQueueHead == nullptr)
+						pManager->m_pQueueTail = nullptr;
+				}
+				LeaveCriticalSection(&pManager->m_lock);
+
+				if (pRequest != nullptr)
+					pManager->Read(pRequest);
+			}
+
+			return 0;
+		}
+	}
+}
\ No newline at end of file
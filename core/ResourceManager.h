@@ -0,0 +1,256 @@
+#pragma once
+#ifndef _TEKSTORM_RESOURCEMANAGER_H
+#define _TEKSTORM_RESOURCEMANAGER_H
+#include "../tekconfig.h"
+#include "IResource.h"
+#include "JobSystem.h"
+#include "ObjectPool.h"
+#include "../IO/Archive.h"
+
+namespace Tekstorm
+{
+	namespace Core
+	{
+		///
+		/// The state of a resource load.
+		///
+		enum ResourceState
+		{
+			TEKRESOURCE_LOADING,
+			TEKRESOURCE_READY,
+			TEKRESOURCE_FAILED
+		};
+
+		///
+		/// Creates an empty resource of some type; the manager then calls its
+		/// LoadFromMemory() with the file contents and the same arguments.
+		///
+		typedef IResource *(*ResourceFactory)(void *pArgs);
+
+		///
+		/// A queued or completed load (internal to ResourceManager).
+		///
+		struct ResourceRequest
+		{
+			std::string path;
+			ResourceFactory factory;
+			void *pArgs;
+			ResourceManager *pManager;
+
+			// The request's own handle.
+			Handle handle;
+
+			// The archive holding the resource, or nullptr to read the file.
+			const IO::Archive *pArchive;
+			int32_t entry;
+
+			// The resource, once created by the decode job.
+			IResource *pResource;
+
+			// The file contents while between the I/O thread and the decode job; the
+			// size is kept afterwards.
+			char *pData;
+			int32_t size;
+
+			// Whether pData points into an archive's mapping rather than at a copy.
+			bool mapped;
+
+			// The outcome the worker reports, published by Update().
+			ResourceState result;
+
+			// The state the owner sees; only changed by Update().
+			ResourceState state;
+
+			// Whether the owner released the handle while the load was in flight.
+			bool released;
+
+			// The next request in the I/O queue or the completion list.
+			ResourceRequest *pNext;
+		};
+
+		///
+		/// Loads resources in the background.
+		///
+		/// Load() queues a request and returns at once. A dedicated I/O thread reads
+		/// the file, then a job on the JobSystem creates the resource through its
+		/// factory and calls LoadFromMemory() (which must therefore be safe to call
+		/// from a worker thread). Completed loads become visible only in Update(),
+		/// called once per frame, so a resource never changes state in the middle of
+		/// a frame. Handles are generational: a released handle reads as failed.
+		///
+		/// Paths found in a mounted archive are loaded from it instead of the disk.
+		/// Uncompressed entries are handed to LoadFromMemory() straight from the
+		/// archive's mapping, without a copy; a resource may keep pointers into it,
+		/// so an archive must stay open until the resources loaded from it are
+		/// released. Compressed entries are decompressed by the decode job.
+		///
+		/// Load(), Update(), Get(), Release() and Mount() belong to the thread that
+		/// started the manager. Stop the manager before the job system it uses.
+		///
+		class TEKAPI ResourceManager
+		{
+		protected:
+			///
+			/// The job system decode jobs run on, or nullptr to decode on the I/O thread.
+			///
+			JobSystem *m_pJobs;
+
+			///
+			/// The requests, by handle.
+			///
+			ObjectPool<ResourceRequest> m_requests;
+
+			///
+			/// The I/O thread.
+			///
+			HANDLE m_hThread;
+
+			///
+			/// Counts the I/O queue; the I/O thread waits on it.
+			///
+			HANDLE m_hQueued;
+
+			///
+			/// Guards the I/O queue and the completion list.
+			///
+			CRITICAL_SECTION m_lock;
+
+			///
+			/// Requests waiting for the I/O thread, oldest first.
+			///
+			ResourceRequest *m_pQueueHead;
+			ResourceRequest *m_pQueueTail;
+
+			///
+			/// Requests finished since the last Update().
+			///
+			ResourceRequest *m_pCompleted;
+
+			///
+			/// Counts the decode jobs in flight.
+			///
+			JobCounter m_decodes;
+
+			///
+			/// Whether or not the I/O thread keeps running.
+			///
+			volatile LONG m_nRunning;
+
+			///
+			/// The number of requests not yet published by Update().
+			///
+			int32_t m_nPendingCount;
+
+			///
+			/// The mounted archives, searched last-mounted first.
+			///
+			std::vector<const IO::Archive *> m_archives;
+
+			///
+			/// Managers are not copyable.
+			///
+			ResourceManager(const ResourceManager &other);
+			ResourceManager &operator=(const ResourceManager &other);
+
+			///
+			/// Reads one request's file and hands it to a decode job.
+			///
+			void Read(ResourceRequest *pRequest);
+
+			///
+			/// Reads one request's archive entry and hands it to a decode job.
+			///
+			void ReadArchive(ResourceRequest *pRequest);
+
+			///
+			/// Runs the decode job of a request that has been read.
+			///
+			void Decode(ResourceRequest *pRequest);
+
+			///
+			/// Queues a finished request for Update().
+			///
+			void Complete(ResourceRequest *pRequest, ResourceState result);
+
+			///
+			/// Disposes of a request's resource and frees its handle.
+			///
+			void Destroy(Handle handle, ResourceRequest *pRequest);
+
+			///
+			/// Creates and loads the resource of a request that has been read.
+			///
+			static void DecodeJob(void *pData);
+
+			///
+			/// Entry point of the I/O thread.
+			///
+			static DWORD WINAPI IoThread(LPVOID pParameter);
+
+		public:
+			ResourceManager();
+			~ResourceManager();
+
+			///
+			/// Starts the I/O thread. Decoding runs on pJobs, or on the I/O thread if
+			/// it is nullptr.
+			///
+			bool Start(JobSystem *pJobs);
+
+			///
+			/// Stops the I/O thread, waits for running decodes and releases every resource.
+			///
+			void Stop();
+
+			///
+			/// Queues a load and returns its handle, which is TEKRESOURCE_LOADING until an
+			/// Update() publishes the outcome.
+			///
+			Handle Load(const std::string &filePath, ResourceFactory factory, void *pArgs = nullptr);
+
+			///
+			/// Loads later paths from an archive when it has them. Archives mounted later
+			/// take precedence, so a patch archive can override entries.
+			///
+			void Mount(const IO::Archive *pArchive);
+
+			///
+			/// Stops loading from an archive. Loads already queued still read it.
+			///
+			void Unmount(const IO::Archive *pArchive);
+
+			///
+			/// Publishes the loads completed since the last call. Returns the number published.
+			///
+			int32_t Update();
+
+			///
+			/// Gets the state of a load; stale handles read as TEKRESOURCE_FAILED.
+			///
+			ResourceState GetState(Handle handle) const;
+
+			///
+			/// Gets a ready resource, or nullptr if it is loading, failed or released.
+			///
+			IResource *Get(Handle handle) const;
+
+			///
+			/// Gets the size of the file a ready resource was loaded from, or 0.
+			///
+			int32_t GetFileSize(Handle handle) const;
+
+			///
+			/// Disposes of a resource and invalidates its handle. A load in flight is
+			/// discarded when it completes.
+			///
+			void Release(Handle handle);
+
+			///
+			/// Gets the number of loads not yet published.
+			///
+			int32_t GetPendingCount() const;
+		};
+	}
+}
+
+#endif /* _TEKSTORM_RESOURCEMANAGER_H */
\ No newline at end of file
@@ -0,0 +1,235 @@
+#pragma once
+#ifndef _TEKSTORM_SLOTMAP_H
+#define _TEKSTORM_SLOTMAP_H
+#include "../tekconfig.h"
+#include "Handle.h"
+#include "Debug.h"
+
+namespace Tekstorm
+{
+	namespace Core
+	{
+		///
+		/// Stores values addressed by generational Handles, packed densely.
+		///
+		/// Values live contiguously in insertion order (until an erase moves the last
+		/// value into the hole), so iterating over GetValues() is a linear walk. A slot
+		/// table maps each handle's index to the value's position; stale handles fail
+		/// the generation check. Insert() and Erase() are O(1). Unlike ObjectPool,
+		/// values move on erase, so keep handles rather than pointers.
+		///
+		/// A map holds at most Handle::MaxIndices (1,048,576) values; Insert() past
+		/// that reports an error and returns a null handle.
+		///
+		/// Not thread-safe.
+		///
+		template <class _Type>
+		class SlotMap
+		{
+		protected:
+			// Marks the end of the free list.
+			static const uint32_t NoSlot = 0xFFFFFFFF;
+
+			///
+			/// Maps a handle index to its value.
+			///
+			struct Slot
+			{
+				// The position of the value while the slot is used; the next free slot otherwise.
+				uint32_t target;
+
+				// The generation of the slot's current handle.
+				uint32_t generation;
+			};
+
+			///
+			/// The slot table, by handle index.
+			///
+			std::vector<Slot> m_slots;
+
+			///
+			/// The values.
+			///
+			std::vector<_Type> m_values;
+
+			///
+			/// The slot of each value.
+			///
+			std::vector<uint32_t> m_valueSlots;
+
+			///
+			/// The first free slot.
+			///
+			uint32_t m_nFreeHead;
+
+			///
+			/// Gets the position of a handle's value, or NoSlot.
+			///
+			uint32_t Find(Handle handle) const
+			{
+				uint32_t index = handle.GetIndex();
+				if (handle.IsNull() || index >= m_slots.size())
+					return NoSlot;
+
+				const Slot &slot = m_slots[index];
+				if (slot.generation != handle.GetGeneration() || slot.target >= m_values.size() || m_valueSlots[slot.target] != index)
+					return NoSlot;
+
+				return slot.target;
+			}
+
+			///
+			/// Slot maps are not copyable.
+			///
+			SlotMap(const SlotMap &other);
+			SlotMap &operator=(const SlotMap &other);
+
+		public:
+			SlotMap() : m_nFreeHead(NoSlot)
+			{
+			}
+
+			///
+			/// Adds a value. Returns a null handle, and reports an error, if the map
+			/// already holds Handle::MaxIndices values.
+			///
+			Handle Insert(const _Type &value)
+			{
+				uint32_t index = m_nFreeHead;
+				if (index != NoSlot)
+				{
+					m_nFreeHead = m_slots[index].target;
+				}
+				else
+				{
+					if (m_slots.size() >= Handle::MaxIndices)
+					{
+						TEKDEBUG_EF("SlotMap is full; it holds at most Handle::MaxIndices values.");
+						return Handle();
+					}
+
+					index = (uint32_t)m_slots.size();
+					Slot slot = { 0, 1 };
+					m_slots.push_back(slot);
+				}
+
+				Slot &slot = m_slots[index];
+				slot.target = (uint32_t)m_values.size();
+				m_values.push_back(value);
+				m_valueSlots.push_back(index);
+				return Handle(index, slot.generation);
+			}
+
+			///
+			/// Removes a value. Returns false if the handle was stale.
+			///
+			bool Erase(Handle handle)
+			{
+				uint32_t position = Find(handle);
+				if (position == NoSlot)
+					return false;
+
+				// move the last value into the hole
+				uint32_t last = (uint32_t)m_values.size() - 1;
+				if (position != last)
+				{
+					m_values[position] = m_values[last];
+					m_valueSlots[position] = m_valueSlots[last];
+					m_slots[m_valueSlots[position]].target = position;
+				}
+
+				m_values.pop_back();
+				m_valueSlots.pop_back();
+
+				Slot &slot = m_slots[handle.GetIndex()];
+				slot.generation = Handle::NextGeneration(slot.generation);
+				slot.target = m_nFreeHead;
+				m_nFreeHead = handle.GetIndex();
+				return true;
+			}
+
+			///
+			/// Gets a value, or nullptr if the handle is null or stale. The pointer is
+			/// valid until the next Insert() or Erase().
+			///
+			_Type *Get(Handle handle)
+			{
+				uint32_t position = Find(handle);
+				return (position != NoSlot) ? &m_values[position] : nullptr;
+			}
+
+			const _Type *Get(Handle handle) const
+			{
+				uint32_t position = Find(handle);
+				return (position != NoSlot) ? &m_values[position] : nullptr;
+			}
+
+			///
+			/// Returns true if the handle refers to a value.
+			///
+			bool IsValid(Handle handle) const
+			{
+				return Find(handle) != NoSlot;
+			}
+
+			///
+			/// Gets the number of values.
+			///
+			uint32_t GetCount() const
+			{
+				return (uint32_t)m_values.size();
+			}
+
+			///
+			/// Gets the first of GetCount() packed values.
+			///
+			_Type *GetValues()
+			{
+				return m_values.empty() ? nullptr : &m_values[0];
+			}
+
+			const _Type *GetValues() const
+			{
+				return m_values.empty() ? nullptr : &m_values[0];
+			}
+
+			///
+			/// Gets the handle of the value at a position in GetValues().
+			///
+			Handle GetHandle(uint32_t position) const
+			{
+				uint32_t index = m_valueSlots[position];
+				return Handle(index, m_slots[index].generation);
+			}
+
+			///
+			/// Reserves memory for a number of values.
+			///
+			void Reserve(uint32_t count)
+			{
+				m_slots.reserve(count);
+				m_values.reserve(count);
+				m_valueSlots.reserve(count);
+			}
+
+			///
+			/// Removes every value. Outstanding handles become stale.
+			///
+			void Clear()
+			{
+				for (uint32_t i = 0; i < m_valueSlots.size(); i++)
+				{
+					Slot &slot = m_slots[m_valueSlots[i]];
+					slot.generation = Handle::NextGeneration(slot.generation);
+					slot.target = m_nFreeHead;
+					m_nFreeHead = m_valueSlots[i];
+				}
+
+				m_values.clear();
+				m_valueSlots.clear();
+			}
+		};
+	}
+}
+
+#endif /* _TEKSTORM_SLOTMAP_H */
\ No newline at end of file
@@ -0,0 +1,233 @@
+#pragma once
+#ifndef _TEKSTORM_SPARSESET_H
+#define _TEKSTORM_SPARSESET_H
+#include "../tekconfig.h"
+#include "Handle.h"
+
+namespace Tekstorm
+{
+	namespace Core
+	{
+		///
+		/// Associates values with handles issued elsewhere, packed densely.
+		///
+		/// Where SlotMap issues its own handles, a sparse set attaches data to handles
+		/// owned by something else, i.e. per-entity or per-connection state. A paged
+		/// sparse array maps a handle's index to the value's position; the dense
+		/// arrays keep the full handle of every value, so a handle whose generation
+		/// moved on no longer finds the old value. Insert(), Erase() and Get() are
+		/// O(1), and values are iterated linearly.
+		///
+		/// Not thread-safe.
+		///
+		template <class _Type>
+		class SparseSet
+		{
+		protected:
+			// log2 of the number of sparse entries per page.
+			static const uint32_t PageShift = 12;
+			static const uint32_t PageSize = 1u << PageShift;
+
+			// Marks a sparse entry without a value.
+			static const uint32_t NoValue = 0xFFFFFFFF;
+
+			///
+			/// The sparse pages, allocated when an index in their range is first used.
+			///
+			std::vector<uint32_t *> m_pages;
+
+			///
+			/// The handle of each value.
+			///
+			std::vector<Handle> m_handles;
+
+			///
+			/// The values.
+			///
+			std::vector<_Type> m_values;
+
+			///
+			/// Sets are not copyable.
+			///
+			SparseSet(const SparseSet &other);
+			SparseSet &operator=(const SparseSet &other);
+
+			///
+			/// Gets the sparse entry of an index, allocating its page if asked to.
+			///
+			uint32_t *GetEntry(uint32_t index, bool create)
+			{
+				uint32_t page = index >> PageShift;
+				if (page >= m_pages.size())
+				{
+					if (!create)
+						return nullptr;
+
+					m_pages.resize(page + 1, nullptr);
+				}
+
+				if (m_pages[page] == nullptr)
+				{
+					if (!create)
+						return nullptr;
+
+					m_pages[page] = new uint32_t[PageSize];
+					memset(m_pages[page], 0xFF, PageSize * sizeof(uint32_t));
+				}
+
+				return &m_pages[page][index & (PageSize - 1)];
+			}
+
+			///
+			/// Gets the position of a handle's value, or NoValue.
+			///
+			uint32_t Find(Handle handle) const
+			{
+				uint32_t index = handle.GetIndex();
+				uint32_t page = index >> PageShift;
+				if (handle.IsNull() || page >= m_pages.size() || m_pages[page] == nullptr)
+					return NoValue;
+
+				uint32_t position = m_pages[page][index & (PageSize - 1)];
+				if (position == NoValue || m_handles[position] != handle)
+					return NoValue;
+
+				return position;
+			}
+
+		public:
+			SparseSet()
+			{
+			}
+
+			~SparseSet()
+			{
+				for (size_t i = 0; i < m_pages.size(); i++)
+					delete [] m_pages[i];
+			}
+
+			///
+			/// Sets the value of a handle. A value of an older generation of the same
+			/// index is replaced. Returns the stored value.
+			///
+			_Type *Insert(Handle handle, const _Type &value)
+			{
+				if (handle.IsNull())
+					return nullptr;
+
+				uint32_t *pEntry = GetEntry(handle.GetIndex(), true);
+				if (*pEntry != NoValue)
+				{
+					m_handles[*pEntry] = handle;
+					m_values[*pEntry] = value;
+					return &m_values[*pEntry];
+				}
+
+				*pEntry = (uint32_t)m_values.size();
+				m_handles.push_back(handle);
+				m_values.push_back(value);
+				return &m_values.back();
+			}
+
+			///
+			/// Removes the value of a handle. Returns false if it had none.
+			///
+			bool Erase(Handle handle)
+			{
+				uint32_t position = Find(handle);
+				if (position == NoValue)
+					return false;
+
+				// move the last value into the hole
+				uint32_t last = (uint32_t)m_values.size() - 1;
+				if (position != last)
+				{
+					m_values[position] = m_values[last];
+					m_handles[position] = m_handles[last];
+					*GetEntry(m_handles[position].GetIndex(), false) = position;
+				}
+
+				m_values.pop_back();
+				m_handles.pop_back();
+				*GetEntry(handle.GetIndex(), false) = NoValue;
+				return true;
+			}
+
+			///
+			/// Gets the value of a handle, or nullptr. The pointer is valid until the next
+			/// Insert() or Erase().
+			///
+			_Type *Get(Handle handle)
+			{
+				uint32_t position = Find(handle);
+				return (position != NoValue) ? &m_values[position] : nullptr;
+			}
+
+			const _Type *Get(Handle handle) const
+			{
+				uint32_t position = Find(handle);
+				return (position != NoValue) ? &m_values[position] : nullptr;
+			}
+
+			///
+			/// Returns true if the handle has a value.
+			///
+			bool Contains(Handle handle) const
+			{
+				return Find(handle) != NoValue;
+			}
+
+			///
+			/// Gets the number of values.
+			///
+			uint32_t GetCount() const
+			{
+				return (uint32_t)m_values.size();
+			}
+
+			///
+			/// Gets the first of GetCount() packed values.
+			///
+			_Type *GetValues()
+			{
+				return m_values.empty() ? nullptr : &m_values[0];
+			}
+
+			const _Type *GetValues() const
+			{
+				return m_values.empty() ? nullptr : &m_values[0];
+			}
+
+			///
+			/// Gets the first of GetCount() handles, parallel to GetValues().
+			///
+			const Handle *GetHandles() const
+			{
+				return m_handles.empty() ? nullptr : &m_handles[0];
+			}
+
+			///
+			/// Reserves memory for a number of values.
+			///
+			void Reserve(uint32_t count)
+			{
+				m_handles.reserve(count);
+				m_values.reserve(count);
+			}
+
+			///
+			/// Removes every value. The sparse pages are kept.
+			///
+			void Clear()
+			{
+				for (size_t i = 0; i < m_handles.size(); i++)
+					*GetEntry(m_handles[i].GetIndex(), false) = NoValue;
+
+				m_handles.clear();
+				m_values.clear();
+			}
+		};
+	}
+}
+
+#endif /* _TEKSTORM_SPARSESET_H */
\ No newline at end of file
@@ -0,0 +1,158 @@
+#pragma once
+#ifndef _TEKSTORM_SPSCQUEUE_H
+#define _TEKSTORM_SPSCQUEUE_H
+#include "../tekconfig.h"
+
+namespace Tekstorm
+{
+	namespace Core
+	{
+		///
+		/// A bounded, lock-free ring buffer that is safe for exactly one producer
+		/// thread and one consumer thread. The capacity is rounded up to a power of two.
+		///
+		/// The head and tail indices rely on MSVC volatile semantics (reads acquire,
+		/// writes release), so no interlocked operations are needed on x86/x64.
+		///
+		template <class _ElementType>
+		class SpscQueue
+		{
+		protected:
+			// The ring buffer of elements.
+			_ElementType *m_pBuffer;
+
+			// The capacity of the ring buffer minus one.
+			uint32_t m_nMask;
+
+			// Keeps the producer and consumer indices on separate cache lines.
+			char m_producerPad[64];
+
+			// The next slot the producer will write (only written by the producer).
+			volatile uint32_t m_nTail;
+
+			char m_consumerPad[64];
+
+			// The next slot the consumer will read (only written by the consumer).
+			volatile uint32_t m_nHead;
+
+			char m_endPad[64];
+
+			///
+			/// Queues are not copyable.
+			///
+			SpscQueue(const SpscQueue &other);
+			SpscQueue &operator=(const SpscQueue &other);
+
+		public:
+			///
+			/// Initializes a new queue able to hold at least 'capacity' elements.
+			///
+			SpscQueue(uint32_t capacity)
+			{
+				uint32_t size = 2;
+				while (size < capacity)
+					size <<= 1;
+
+				m_pBuffer = new _ElementType[size];
+				m_nMask = size - 1;
+				m_nHead = 0;
+				m_nTail = 0;
+			}
+
+			~SpscQueue()
+			{
+				delete [] m_pBuffer;
+			}
+
+			///
+			/// Gets the maximum number of elements this queue can hold.
+			///
+			uint32_t GetCapacity() const
+			{
+				return m_nMask + 1;
+			}
+
+			///
+			/// Gets an approximate count of queued elements. Exact only when called
+			/// from the producer or consumer while the other side is idle.
+			///
+			uint32_t GetCount() const
+			{
+				return m_nTail - m_nHead;
+			}
+
+			///
+			/// Producer: returns a pointer to the next free slot, or nullptr if the
+			/// queue is full. The slot is not visible to the consumer until
+			/// EndEnqueue() is called, which allows filling large elements in place.
+			///
+			_ElementType *BeginEnqueue()
+			{
+				uint32_t tail = m_nTail;
+				if (tail - m_nHead > m_nMask)
+					return nullptr;
+
+				return &m_pBuffer[tail & m_nMask];
+			}
+
+			///
+			/// Producer: publishes the slot returned by BeginEnqueue().
+			///
+			void EndEnqueue()
+			{
+				m_nTail = m_nTail + 1;
+			}
+
+			///
+			/// Producer: copies an element into the queue. Returns false if the queue is full.
+			///
+			bool TryEnqueue(const _ElementType &value)
+			{
+				_ElementType *pSlot = BeginEnqueue();
+				if (pSlot == nullptr)
+					return false;
+
+				*pSlot = value;
+				EndEnqueue();
+				return true;
+			}
+
+			///
+			/// Consumer: returns a pointer to the oldest element, or nullptr if the
+			/// queue is empty. The element stays valid until Pop() is called.
+			///
+			_ElementType *Peek()
+			{
+				uint32_t head = m_nHead;
+				if (head == m_nTail)
+					return nullptr;
+
+				return &m_pBuffer[head & m_nMask];
+			}
+
+			///
+			/// Consumer: releases the element returned by Peek().
+			///
+			void Pop()
+			{
+				m_nHead = m_nHead + 1;
+			}
+
+			///
+			/// Consumer: copies the oldest element out of the queue. Returns false if the queue is empty.
+			///
+			bool TryDequeue(_ElementType *pValue)
+			{
+				_ElementType *pSlot = Peek();
+				if (pSlot == nullptr)
+					return false;
+
+				*pValue = *pSlot;
+				Pop();
+				return true;
+			}
+		};
+	}
+}
+
+#endif /* _TEKSTORM_SPSCQUEUE_H */
\ No newline at end of file
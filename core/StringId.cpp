@@ -0,0 +1,104 @@
+#define TEKSTORM_BUILD
+#include "StringId.h"
+#include "Debug.h"
+
+namespace Tekstorm
+{
+	namespace Core
+	{
+		///
+		/// A slot of the intern table. A slot is claimed by setting its id, then
+		/// published by setting its text; slots are never released.
+		///
+		struct StringSlot
+		{
+			volatile LONG id;
+			const char * volatile pText;
+		};
+
+		static StringSlot s_stringSlots[StringId::MaxStrings];
+
+		///
+		/// Waits for a claimed slot's text to be published.
+		///
+		static const char *GetSlotText(const StringSlot &slot)
+		{
+			const char *pText;
+			while ((pText = slot.pText) == nullptr)
+				YieldProcessor();
+
+			return pText;
+		}
+
+		///
+		/// Gets the id of a name, recording the name.
+		///
+		StringId StringId::Intern(const StringRef &text)
+		{
+			uint32_t hash = HashFnv1aBytes(text.GetData(), text.GetLength());
+			if (hash == 0)
+				return StringId(hash, 0);
+
+			// linear probing; slots only ever go from empty to claimed
+			for (uint32_t probe = 0; probe < MaxStrings; probe++)
+			{
+				StringSlot &slot = s_stringSlots[(hash + probe) & (MaxStrings - 1)];
+
+				LONG id = slot.id;
+				if (id == 0)
+				{
+					id = InterlockedCompareExchange(&slot.id, (LONG)hash, 0);
+					if (id == 0)
+					{
+						char *pCopy = (char *)malloc(text.GetLength() + 1);
+						memcpy(pCopy, text.GetData(), text.GetLength());
+						pCopy[text.GetLength()] = 0;
+						slot.pText = pCopy;
+						return StringId(hash, 0);
+					}
+				}
+
+				if ((uint32_t)id == hash)
+				{
+					// two names sharing an id would silently alias each other's resources,
+					// events and bindings; the later name gets the null id instead
+					const char *pText = GetSlotText(slot);
+					if (StringRef(pText) != text)
+					{
+						TEKDEBUG_EF("StringId collision: \"" << text.ToString() << "\" and \"" << pText << "\" share an id");
+						return StringId();
+					}
+
+					return StringId(hash, 0);
+				}
+			}
+
+			// an unrecorded id would silently lose its name and collision checks
+			TEKDEBUG_EF("StringId table is full; \"" << text.ToString() << "\" cannot be interned");
+			return StringId();
+		}
+
+		///
+		/// Gets the recorded name of the id, or nullptr if it was never interned.
+		///
+		const char *StringId::GetString() const
+		{
+			if (m_nValue == 0)
+				return nullptr;
+
+			for (uint32_t probe = 0; probe < MaxStrings; probe++)
+			{
+				const StringSlot &slot = s_stringSlots[(m_nValue + probe) & (MaxStrings - 1)];
+
+				LONG id = slot.id;
+				if (id == 0)
+					return nullptr;
+
+				if ((uint32_t)id == m_nValue)
+					return GetSlotText(slot);
+			}
+
+			return nullptr;
+		}
+	}
+}
\ No newline at end of file
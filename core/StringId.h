@@ -0,0 +1,125 @@
+#pragma once
+#ifndef _TEKSTORM_STRINGID_H
+#define _TEKSTORM_STRINGID_H
+#include "../tekconfig.h"
+#include "Hash.h"
+
+///
+/// Marks functions the compiler may evaluate at compile time, where it can.
+///
+#if (defined(_MSC_VER) && _MSC_VER >= 1900) || (!defined(_MSC_VER) && __cplusplus >= 201103L)
+	#define TEKSTORM_CONSTEXPR constexpr
+#else
+	#define TEKSTORM_CONSTEXPR inline
+#endif
+
+namespace Tekstorm
+{
+	namespace Core
+	{
+		///
+		/// The 32-bit FNV-1a hash of a null-terminated string. Folded at compile time
+		/// for literals where constexpr is supported, and by the optimizer otherwise;
+		/// HashFnv1aBytes() hashes text that is only known at run time.
+		///
+		TEKSTORM_CONSTEXPR uint32_t HashFnv1a(const char *text, uint32_t hash = 2166136261u)
+		{
+			return (*text != 0) ? HashFnv1a(text + 1, (hash ^ (uint8_t)*text) * 16777619u) : hash;
+		}
+
+		///
+		/// An interned string: a 32-bit id standing in for a name, i.e. a resource
+		/// path, an event or a script binding. Comparing and hashing ids are integer
+		/// operations, and passing them around never allocates.
+		///
+		/// The id is the FNV-1a hash of the text, so an id for a literal can be made
+		/// at compile time with TEKSID() without touching the table. Intern() also
+		/// records the text in a global lock-free table, which GetString() reads back.
+		/// The table holds MaxStrings names; interned text is never freed. Running out
+		/// of slots, or interning a name whose id is already another name's, is an
+		/// error in every build: Intern() reports it and returns the null id.
+		///
+		class TEKAPI StringId
+		{
+		protected:
+			uint32_t m_nValue;
+
+		public:
+			///
+			/// The number of names the table holds.
+			///
+			static const uint32_t MaxStrings = 1u << 16;
+
+			///
+			/// Initializes the null id.
+			///
+			StringId() : m_nValue(0)
+			{
+			}
+
+			///
+			/// Gets the id of a name, recording the name. Thread-safe and lock-free.
+			/// Returns the null id if the name is new and the table is full, or if the
+			/// name collides with another.
+			///
+			static StringId Intern(const StringRef &text);
+
+			///
+			/// Gets the id for a hash from HashFnv1a(), without recording a name.
+			///
+			static TEKSTORM_CONSTEXPR StringId FromHash(uint32_t hash)
+			{
+				return StringId(hash, 0);
+			}
+
+			///
+			/// Gets the recorded name of the id, or nullptr if it was never interned.
+			///
+			const char *GetString() const;
+
+			///
+			/// Gets the id as an integer.
+			///
+			uint32_t GetValue() const
+			{
+				return m_nValue;
+			}
+
+			///
+			/// Returns true for the null id.
+			///
+			bool IsNull() const
+			{
+				return m_nValue == 0;
+			}
+
+			bool operator==(const StringId &other) const { return m_nValue == other.m_nValue; }
+			bool operator!=(const StringId &other) const { return m_nValue != other.m_nValue; }
+			bool operator<(const StringId &other) const { return m_nValue < other.m_nValue; }
+
+		protected:
+			TEKSTORM_CONSTEXPR StringId(uint32_t value, int) : m_nValue(value)
+			{
+			}
+		};
+
+		template <>
+		struct Hash<StringId>
+		{
+			// the id already is a hash; mixing spreads it over the table's tag and group bits
+			uint64_t operator()(const StringId &id) const { return MixHash(id.GetValue()); }
+		};
+	}
+}
+
+///
+/// Gets the StringId of a string literal. Debug builds intern the literal so that
+/// GetString() works and collisions are reported; release builds only hash it.
+///
+#if defined(TEKSTORM_DEBUG)
+	#define TEKSID(text) Tekstorm::Core::StringId::Intern(text)
+#else
+	#define TEKSID(text) Tekstorm::Core::StringId::FromHash(Tekstorm::Core::HashFnv1a(text))
+#endif
+
+#endif /* _TEKSTORM_STRINGID_H */
\ No newline at end of file
@@ -0,0 +1,112 @@
+#pragma once
+#ifndef _TEKSTORM_STRINGREF_H
+#define _TEKSTORM_STRINGREF_H
+#include "../tekconfig.h"
+
+namespace Tekstorm
+{
+	namespace Core
+	{
+		///
+		/// A non-owning view of a run of characters.
+		///
+		/// Lets functions taking text accept literals, std::strings and slices of
+		/// larger buffers without copying; e.g. a FlatHashMap keyed by std::string
+		/// can be searched with a StringRef into a path buffer. The referenced
+		/// characters must outlive the StringRef and need not be null-terminated.
+		///
+		class StringRef
+		{
+		protected:
+			const char *m_pData;
+			size_t m_nLength;
+
+		public:
+			StringRef() : m_pData(""), m_nLength(0)
+			{
+			}
+
+			StringRef(const char *text) : m_pData(text), m_nLength(strlen(text))
+			{
+			}
+
+			StringRef(const char *pData, size_t length) : m_pData(pData), m_nLength(length)
+			{
+			}
+
+			StringRef(const std::string &text) : m_pData(text.c_str()), m_nLength(text.length())
+			{
+			}
+
+			///
+			/// Gets the first character.
+			///
+			const char *GetData() const
+			{
+				return m_pData;
+			}
+
+			///
+			/// Gets the number of characters.
+			///
+			size_t GetLength() const
+			{
+				return m_nLength;
+			}
+
+			///
+			/// Returns true if there are no characters.
+			///
+			bool IsEmpty() const
+			{
+				return m_nLength == 0;
+			}
+
+			///
+			/// Gets a view of part of the characters.
+			///
+			StringRef Substring(size_t start, size_t length = (size_t)-1) const
+			{
+				if (start > m_nLength)
+					start = m_nLength;
+
+				if (length > m_nLength - start)
+					length = m_nLength - start;
+
+				return StringRef(m_pData + start, length);
+			}
+
+			///
+			/// Copies the characters into a std::string.
+			///
+			std::string ToString() const
+			{
+				return std::string(m_pData, m_nLength);
+			}
+
+			char operator[](size_t index) const
+			{
+				return m_pData[index];
+			}
+		};
+
+		inline bool operator==(const StringRef &a, const StringRef &b)
+		{
+			return a.GetLength() == b.GetLength() && memcmp(a.GetData(), b.GetData(), a.GetLength()) == 0;
+		}
+
+		inline bool operator!=(const StringRef &a, const StringRef &b)
+		{
+			return !(a == b);
+		}
+
+		inline bool operator<(const StringRef &a, const StringRef &b)
+		{
+			size_t length = (a.GetLength() < b.GetLength()) ? a.GetLength() : b.GetLength();
+			int result = memcmp(a.GetData(), b.GetData(), length);
+			return (result != 0) ? (result < 0) : (a.GetLength() < b.GetLength());
+		}
+	}
+}
+
+#endif /* _TEKSTORM_STRINGREF_H */
\ No newline at end of file
@@ -0,0 +1,139 @@
+#pragma once
+#ifndef _TEKSTORM_WORKSTEALINGDEQUE_H
+#define _TEKSTORM_WORKSTEALINGDEQUE_H
+#include "../tekconfig.h"
+
+namespace Tekstorm
+{
+	namespace Core
+	{
+		///
+		/// A bounded Chase-Lev work-stealing deque of pointers. The owning thread
+		/// pushes and pops at the bottom (LIFO), any other thread steals from the
+		/// top (FIFO). The capacity is rounded up to a power of two.
+		///
+		/// Plain accesses to the volatile indices rely on MSVC volatile semantics
+		/// (reads acquire, writes release); the one store-load ordering Chase-Lev
+		/// needs in Pop() comes from an interlocked exchange.
+		///
+		template <class _ElementType>
+		class WorkStealingDeque
+		{
+		protected:
+			// The ring buffer of elements.
+			_ElementType **m_pBuffer;
+
+			// The capacity of the ring buffer minus one.
+			LONG m_nMask;
+
+			char m_topPad[64];
+
+			// The next element thieves take (advanced by interlocked compare-exchange).
+			volatile LONG m_nTop;
+
+			char m_bottomPad[64];
+
+			// The next free slot of the owner (only written by the owner).
+			volatile LONG m_nBottom;
+
+			char m_endPad[64];
+
+			///
+			/// Deques are not copyable.
+			///
+			WorkStealingDeque(const WorkStealingDeque &other);
+			WorkStealingDeque &operator=(const WorkStealingDeque &other);
+
+		public:
+			///
+			/// Initializes a new deque able to hold at least 'capacity' elements.
+			///
+			WorkStealingDeque(uint32_t capacity)
+			{
+				uint32_t size = 2;
+				while (size < capacity)
+					size <<= 1;
+
+				m_pBuffer = new _ElementType *[size];
+				m_nMask = (LONG)size - 1;
+				m_nTop = 0;
+				m_nBottom = 0;
+			}
+
+			~WorkStealingDeque()
+			{
+				delete [] m_pBuffer;
+			}
+
+			///
+			/// Gets an approximate count of queued elements.
+			///
+			int32_t GetCount() const
+			{
+				LONG count = m_nBottom - m_nTop;
+				return (count > 0) ? (int32_t)count : 0;
+			}
+
+			///
+			/// Owner: pushes an element. Returns false if the deque is full.
+			///
+			bool Push(_ElementType *pElement)
+			{
+				LONG bottom = m_nBottom;
+				if (bottom - m_nTop > m_nMask)
+					return false;
+
+				m_pBuffer[bottom & m_nMask] = pElement;
+				m_nBottom = bottom + 1;
+				return true;
+			}
+
+			///
+			/// Owner: pops the most recently pushed element, or returns nullptr.
+			///
+			_ElementType *Pop()
+			{
+				LONG bottom = m_nBottom - 1;
+				InterlockedExchange(&m_nBottom, bottom);
+				LONG top = m_nTop;
+
+				if (top > bottom)
+				{
+					m_nBottom = top;
+					return nullptr;
+				}
+
+				_ElementType *pElement = m_pBuffer[bottom & m_nMask];
+				if (top != bottom)
+					return pElement;
+
+				// the last element; race the thieves for it
+				if (InterlockedCompareExchange(&m_nTop, top + 1, top) != top)
+					pElement = nullptr;
+
+				m_nBottom = top + 1;
+				return pElement;
+			}
+
+			///
+			/// Thief: takes the oldest element, or returns nullptr if the deque is
+			/// empty or another thread won the race.
+			///
+			_ElementType *Steal()
+			{
+				LONG top = m_nTop;
+				LONG bottom = m_nBottom;
+				if (top >= bottom)
+					return nullptr;
+
+				_ElementType *pElement = m_pBuffer[top & m_nMask];
+				if (InterlockedCompareExchange(&m_nTop, top + 1, top) != top)
+					return nullptr;
+
+				return pElement;
+			}
+		};
+	}
+}
+
+#endif /* _TEKSTORM_WORKSTEALINGDEQUE_H */
\ No newline at end of file
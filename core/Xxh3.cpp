@@ -0,0 +1,621 @@
+#define TEKSTORM_BUILD
+#include "Xxh3.h"
+#include <emmintrin.h>
+#if defined(_M_X64)
+#include <intrin.h>
+#endif
+
+namespace Tekstorm
+{
+	namespace Core
+	{
+		static const uint32_t Prime32_1 = 0x9E3779B1U;
+		static const uint32_t Prime32_2 = 0x85EBCA77U;
+		static const uint32_t Prime32_3 = 0xC2B2AE3DU;
+		static const uint64_t Prime64_1 = 0x9E3779B185EBCA87ULL;
+		static const uint64_t Prime64_2 = 0xC2B2AE3D27D4EB4FULL;
+		static const uint64_t Prime64_3 = 0x165667B19E3779F9ULL;
+		static const uint64_t Prime64_4 = 0x85EBCA77C2B2AE63ULL;
+		static const uint64_t Prime64_5 = 0x27D4EB2F165667C5ULL;
+		static const uint64_t PrimeMx1 = 0x165667919E3779F9ULL;
+		static const uint64_t PrimeMx2 = 0x9FB21C651E98DF25ULL;
+
+		///
+		/// Long inputs are accumulated in 64-byte stripes, 16 stripes to a block,
+		/// moving 8 bytes along the secret for each stripe.
+		///
+		static const int32_t StripeLength = 64;
+		static const int32_t SecretConsumeRate = 8;
+		static const int32_t StripesPerBlock = (Xxh3::SecretSize - StripeLength) / SecretConsumeRate;
+		static const int32_t BlockLength = StripeLength * StripesPerBlock;
+
+		///
+		/// Secret offsets used by the mid-size and long hashes.
+		///
+		static const int32_t SecretSizeMin = 136;
+		static const int32_t MidSizeMax = 240;
+		static const int32_t MidSizeStartOffset = 3;
+		static const int32_t MidSizeLastOffset = 17;
+		static const int32_t SecretLastAccStart = 7;
+		static const int32_t SecretMergeAccsStart = 11;
+
+		///
+		/// The default secret of xxHash.
+		///
+		static const uint8_t s_defaultSecret[Xxh3::SecretSize] =
+		{
+			0xb8, 0xfe, 0x6c, 0x39, 0x23, 0xa4, 0x4b, 0xbe, 0x7c, 0x01, 0x81, 0x2c, 0xf7, 0x21, 0xad, 0x1c,
+			0xde, 0xd4, 0x6d, 0xe9, 0x83, 0x90, 0x97, 0xdb, 0x72, 0x40, 0xa4, 0xa4, 0xb7, 0xb3, 0x67, 0x1f,
+			0xcb, 0x79, 0xe6, 0x4e, 0xcc, 0xc0, 0xe5, 0x78, 0x82, 0x5a, 0xd0, 0x7d, 0xcc, 0xff, 0x72, 0x21,
+			0xb8, 0x08, 0x46, 0x74, 0xf7, 0x43, 0x24, 0x8e, 0xe0, 0x35, 0x90, 0xe6, 0x81, 0x3a, 0x26, 0x4c,
+			0x3c, 0x28, 0x52, 0xbb, 0x91, 0xc3, 0x00, 0xcb, 0x88, 0xd0, 0x65, 0x8b, 0x1b, 0x53, 0x2e, 0xa3,
+			0x71, 0x64, 0x48, 0x97, 0xa2, 0x0d, 0xf9, 0x4e, 0x38, 0x19, 0xef, 0x46, 0xa9, 0xde, 0xac, 0xd8,
+			0xa8, 0xfa, 0x76, 0x3f, 0xe3, 0x9c, 0x34, 0x3f, 0xf9, 0xdc, 0xbb, 0xc7, 0xc7, 0x0b, 0x4f, 0x1d,
+			0x8a, 0x51, 0xe0, 0x4b, 0xcd, 0xb4, 0x59, 0x31, 0xc8, 0x9f, 0x7e, 0xc9, 0xd9, 0x78, 0x73, 0x64,
+			0xea, 0xc5, 0xac, 0x83, 0x34, 0xd3, 0xeb, 0xc3, 0xc5, 0x81, 0xa0, 0xff, 0xfa, 0x13, 0x63, 0xeb,
+			0x17, 0x0d, 0xdd, 0x51, 0xb7, 0xf0, 0xda, 0x49, 0xd3, 0x16, 0x55, 0x26, 0x29, 0xd4, 0x68, 0x9e,
+			0x2b, 0x16, 0xbe, 0x58, 0x7d, 0x47, 0xa1, 0xfc, 0x8f, 0xf8, 0xb8, 0xd1, 0x7a, 0xd0, 0x31, 0xce,
+			0x45, 0xcb, 0x3a, 0x8f, 0x95, 0x16, 0x04, 0x28, 0xaf, 0xd7, 0xfb, 0xca, 0xbb, 0x4b, 0x40, 0x7e,
+		};
+
+		static inline uint32_t Read32(const uint8_t *p)
+		{
+			uint32_t value;
+			memcpy(&value, p, sizeof(uint32_t));
+			return value;
+		}
+
+		static inline uint64_t Read64(const uint8_t *p)
+		{
+			uint64_t value;
+			memcpy(&value, p, sizeof(uint64_t));
+			return value;
+		}
+
+		static inline void Write64(uint8_t *p, uint64_t value)
+		{
+			memcpy(p, &value, sizeof(uint64_t));
+		}
+
+		static inline uint32_t Rotl32(uint32_t value, int32_t bits)
+		{
+			return (value << bits) | (value >> (32 - bits));
+		}
+
+		static inline uint64_t Rotl64(uint64_t value, int32_t bits)
+		{
+			return (value << bits) | (value >> (64 - bits));
+		}
+
+		static inline uint32_t Swap32(uint32_t value)
+		{
+			return (value << 24) | ((value << 8) & 0x00FF0000) | ((value >> 8) & 0x0000FF00) | (value >> 24);
+		}
+
+		static inline uint64_t Swap64(uint64_t value)
+		{
+			return ((uint64_t)Swap32((uint32_t)value) << 32) | Swap32((uint32_t)(value >> 32));
+		}
+
+		///
+		/// The full 128-bit product of two 64-bit values.
+		///
+		static inline Hash128 Multiply128(uint64_t a, uint64_t b)
+		{
+			Hash128 result;
+#if defined(_M_X64)
+			result.low = _umul128(a, b, &result.high);
+#else
+			uint64_t lowLow = (uint64_t)(uint32_t)a * (uint32_t)b;
+			uint64_t highLow = (a >> 32) * (uint32_t)b;
+			uint64_t lowHigh = (uint32_t)a * (b >> 32);
+			uint64_t highHigh = (a >> 32) * (b >> 32);
+			uint64_t cross = (lowLow >> 32) + (uint32_t)highLow + lowHigh;
+			result.high = (highLow >> 32) + (cross >> 32) + highHigh;
+			result.low = (cross << 32) | (uint32_t)lowLow;
+#endif
+			return result;
+		}
+
+		static inline uint64_t MultiplyFold64(uint64_t a, uint64_t b)
+		{
+			Hash128 product = Multiply128(a, b);
+			return product.low ^ product.high;
+		}
+
+		static inline uint64_t XorShift64(uint64_t value, int32_t shift)
+		{
+			return value ^ (value >> shift);
+		}
+
+		///
+		/// The XXH64 finalizer.
+		///
+		static inline uint64_t Avalanche64(uint64_t hash)
+		{
+			hash ^= hash >> 33;
+			hash *= Prime64_2;
+			hash ^= hash >> 29;
+			hash *= Prime64_3;
+			hash ^= hash >> 32;
+			return hash;
+		}
+
+		///
+		/// The fast finalizer, for input that is already mixed.
+		///
+		static inline uint64_t Avalanche(uint64_t hash)
+		{
+			hash = XorShift64(hash, 37);
+			hash *= PrimeMx1;
+			return XorShift64(hash, 32);
+		}
+
+		///
+		/// The strong finalizer, for input that is not mixed yet.
+		///
+		static inline uint64_t Rrmxmx(uint64_t hash, uint64_t length)
+		{
+			hash ^= Rotl64(hash, 49) ^ Rotl64(hash, 24);
+			hash *= PrimeMx2;
+			hash ^= (hash >> 35) + length;
+			hash *= PrimeMx2;
+			return XorShift64(hash, 28);
+		}
+
+		static inline uint64_t Mix16(const uint8_t *pInput, const uint8_t *pSecret, uint64_t seed)
+		{
+			return MultiplyFold64(Read64(pInput) ^ (Read64(pSecret) + seed), Read64(pInput + 8) ^ (Read64(pSecret + 8) - seed));
+		}
+
+		static inline void Mix32(Hash128 &acc, const uint8_t *pInput1, const uint8_t *pInput2, const uint8_t *pSecret, uint64_t seed)
+		{
+			acc.low += Mix16(pInput1, pSecret, seed);
+			acc.low ^= Read64(pInput2) + Read64(pInput2 + 8);
+			acc.high += Mix16(pInput2, pSecret + 16, seed);
+			acc.high ^= Read64(pInput1) + Read64(pInput1 + 8);
+		}
+
+		///
+		/// The 64-bit hash of up to 240 bytes.
+		///
+		static uint64_t Hash64Short(const uint8_t *p, size_t length, const uint8_t *pSecret, uint64_t seed)
+		{
+			if (length > 128)
+			{
+				int32_t rounds = (int32_t)length / 16;
+				uint64_t acc = length * Prime64_1;
+				for (int32_t i = 0; i < 8; i++)
+					acc += Mix16(p + 16 * i, pSecret + 16 * i, seed);
+
+				uint64_t accEnd = Mix16(p + length - 16, pSecret + SecretSizeMin - MidSizeLastOffset, seed);
+				acc = Avalanche(acc);
+				for (int32_t i = 8; i < rounds; i++)
+					accEnd += Mix16(p + 16 * i, pSecret + 16 * (i - 8) + MidSizeStartOffset, seed);
+
+				return Avalanche(acc + accEnd);
+			}
+
+			if (length > 16)
+			{
+				uint64_t acc = length * Prime64_1;
+				if (length > 32)
+				{
+					if (length > 64)
+					{
+						if (length > 96)
+						{
+							acc += Mix16(p + 48, pSecret + 96, seed);
+							acc += Mix16(p + length - 64, pSecret + 112, seed);
+						}
+						acc += Mix16(p + 32, pSecret + 64, seed);
+						acc += Mix16(p + length - 48, pSecret + 80, seed);
+					}
+					acc += Mix16(p + 16, pSecret + 32, seed);
+					acc += Mix16(p + length - 32, pSecret + 48, seed);
+				}
+				acc += Mix16(p, pSecret, seed);
+				acc += Mix16(p + length - 16, pSecret + 16, seed);
+				return Avalanche(acc);
+			}
+
+			if (length > 8)
+			{
+				uint64_t inputLow = Read64(p) ^ ((Read64(pSecret + 24) ^ Read64(pSecret + 32)) + seed);
+				uint64_t inputHigh = Read64(p + length - 8) ^ ((Read64(pSecret + 40) ^ Read64(pSecret + 48)) - seed);
+				return Avalanche(length + Swap64(inputLow) + inputHigh + MultiplyFold64(inputLow, inputHigh));
+			}
+
+			if (length >= 4)
+			{
+				seed ^= (uint64_t)Swap32((uint32_t)seed) << 32;
+				uint64_t input = Read32(p + length - 4) + ((uint64_t)Read32(p) << 32);
+				uint64_t bitflip = (Read64(pSecret + 8) ^ Read64(pSecret + 16)) - seed;
+				return Rrmxmx(input ^ bitflip, length);
+			}
+
+			if (length > 0)
+			{
+				uint32_t combined = ((uint32_t)p[0] << 16) | ((uint32_t)p[length >> 1] << 24) | p[length - 1] | ((uint32_t)length << 8);
+				uint64_t bitflip = (Read32(pSecret) ^ Read32(pSecret + 4)) + seed;
+				return Avalanche64(combined ^ bitflip);
+			}
+
+			return Avalanche64(seed ^ Read64(pSecret + 56) ^ Read64(pSecret + 64));
+		}
+
+		///
+		/// The 128-bit hash of up to 240 bytes.
+		///
+		static Hash128 Hash128Short(const uint8_t *p, size_t length, const uint8_t *pSecret, uint64_t seed)
+		{
+			Hash128 hash;
+			if (length > 16)
+			{
+				Hash128 acc;
+				acc.low = length * Prime64_1;
+				acc.high = 0;
+
+				if (length > 128)
+				{
+					for (size_t i = 32; i < 160; i += 32)
+						Mix32(acc, p + i - 32, p + i - 16, pSecret + i - 32, seed);
+
+					acc.low = Avalanche(acc.low);
+					acc.high = Avalanche(acc.high);
+					for (size_t i = 160; i <= length; i += 32)
+						Mix32(acc, p + i - 32, p + i - 16, pSecret + MidSizeStartOffset + i - 160, seed);
+
+					Mix32(acc, p + length - 16, p + length - 32, pSecret + SecretSizeMin - MidSizeLastOffset - 16, 0 - seed);
+				}
+				else
+				{
+					if (length > 32)
+					{
+						if (length > 64)
+						{
+							if (length > 96)
+								Mix32(acc, p + 48, p + length - 64, pSecret + 96, seed);
+
+							Mix32(acc, p + 32, p + length - 48, pSecret + 64, seed);
+						}
+						Mix32(acc, p + 16, p + length - 32, pSecret + 32, seed);
+					}
+					Mix32(acc, p, p + length - 16, pSecret, seed);
+				}
+
+				hash.low = Avalanche(acc.low + acc.high);
+				hash.high = 0 - Avalanche(acc.low * Prime64_1 + acc.high * Prime64_4 + (length - seed) * Prime64_2);
+				return hash;
+			}
+
+			if (length > 8)
+			{
+				uint64_t bitflipLow = (Read64(pSecret + 32) ^ Read64(pSecret + 40)) - seed;
+				uint64_t bitflipHigh = (Read64(pSecret + 48) ^ Read64(pSecret + 56)) + seed;
+				uint64_t inputLow = Read64(p);
+				uint64_t inputHigh = Read64(p + length - 8);
+
+				Hash128 m = Multiply128(inputLow ^ inputHigh ^ bitflipLow, Prime64_1);
+				m.low += (uint64_t)(length - 1) << 54;
+				inputHigh ^= bitflipHigh;
+				m.high += inputHigh + (uint64_t)(uint32_t)inputHigh * (Prime32_2 - 1);
+				m.low ^= Swap64(m.high);
+
+				hash = Multiply128(m.low, Prime64_2);
+				hash.high += m.high * Prime64_2;
+				hash.low = Avalanche(hash.low);
+				hash.high = Avalanche(hash.high);
+				return hash;
+			}
+
+			if (length >= 4)
+			{
+				seed ^= (uint64_t)Swap32((uint32_t)seed) << 32;
+				uint64_t input = Read32(p) + ((uint64_t)Read32(p + length - 4) << 32);
+				uint64_t bitflip = (Read64(pSecret + 16) ^ Read64(pSecret + 24)) + seed;
+
+				hash = Multiply128(input ^ bitflip, Prime64_1 + (length << 2));
+				hash.high += hash.low << 1;
+				hash.low ^= hash.high >> 3;
+				hash.low = XorShift64(hash.low, 35);
+				hash.low *= PrimeMx2;
+				hash.low = XorShift64(hash.low, 28);
+				hash.high = Avalanche(hash.high);
+				return hash;
+			}
+
+			if (length > 0)
+			{
+				uint32_t combinedLow = ((uint32_t)p[0] << 16) | ((uint32_t)p[length >> 1] << 24) | p[length - 1] | ((uint32_t)length << 8);
+				uint32_t combinedHigh = Rotl32(Swap32(combinedLow), 13);
+				hash.low = Avalanche64(combinedLow ^ ((Read32(pSecret) ^ Read32(pSecret + 4)) + seed));
+				hash.high = Avalanche64(combinedHigh ^ ((Read32(pSecret + 8) ^ Read32(pSecret + 12)) - seed));
+				return hash;
+			}
+
+			hash.low = Avalanche64(seed ^ Read64(pSecret + 64) ^ Read64(pSecret + 72));
+			hash.high = Avalanche64(seed ^ Read64(pSecret + 80) ^ Read64(pSecret + 88));
+			return hash;
+		}
+
+		///
+		/// Accumulates one 64-byte stripe, two lanes at a time.
+		///
+		static inline void Accumulate512(uint64_t *pAcc, const uint8_t *pInput, const uint8_t *pSecret)
+		{
+			for (int32_t i = 0; i < 4; i++)
+			{
+				__m128i acc = _mm_loadu_si128((const __m128i *)pAcc + i);
+				__m128i data = _mm_loadu_si128((const __m128i *)pInput + i);
+				__m128i key = _mm_loadu_si128((const __m128i *)pSecret + i);
+
+				// multiply the low and high halves of each keyed lane, and add the input
+				// to the neighbouring lane
+				__m128i dataKey = _mm_xor_si128(data, key);
+				__m128i dataKeyHigh = _mm_shuffle_epi32(dataKey, _MM_SHUFFLE(0, 3, 0, 1));
+				__m128i product = _mm_mul_epu32(dataKey, dataKeyHigh);
+				__m128i swapped = _mm_shuffle_epi32(data, _MM_SHUFFLE(1, 0, 3, 2));
+				acc = _mm_add_epi64(acc, _mm_add_epi64(product, swapped));
+				_mm_storeu_si128((__m128i *)pAcc + i, acc);
+			}
+		}
+
+		///
+		/// Scrambles the accumulators at the end of a block.
+		///
+		static inline void Scramble(uint64_t *pAcc, const uint8_t *pSecret)
+		{
+			const __m128i prime = _mm_set1_epi32((int)Prime32_1);
+			for (int32_t i = 0; i < 4; i++)
+			{
+				__m128i acc = _mm_loadu_si128((const __m128i *)pAcc + i);
+				__m128i key = _mm_loadu_si128((const __m128i *)pSecret + i);
+
+				acc = _mm_xor_si128(acc, _mm_srli_epi64(acc, 47));
+				__m128i dataKey = _mm_xor_si128(acc, key);
+				__m128i dataKeyHigh = _mm_shuffle_epi32(dataKey, _MM_SHUFFLE(0, 3, 0, 1));
+				__m128i productLow = _mm_mul_epu32(dataKey, prime);
+				__m128i productHigh = _mm_mul_epu32(dataKeyHigh, prime);
+				acc = _mm_add_epi64(productLow, _mm_slli_epi64(productHigh, 32));
+				_mm_storeu_si128((__m128i *)pAcc + i, acc);
+			}
+		}
+
+		static void InitAccumulators(uint64_t *pAcc)
+		{
+			pAcc[0] = Prime32_3;
+			pAcc[1] = Prime64_1;
+			pAcc[2] = Prime64_2;
+			pAcc[3] = Prime64_3;
+			pAcc[4] = Prime64_4;
+			pAcc[5] = Prime32_2;
+			pAcc[6] = Prime64_5;
+			pAcc[7] = Prime32_1;
+		}
+
+		///
+		/// Accumulates whole stripes, scrambling whenever a block fills up.
+		///
+		static void ConsumeStripes(uint64_t *pAcc, int32_t &stripesInBlock, const uint8_t *pInput, size_t stripes, const uint8_t *pSecret)
+		{
+			for (size_t i = 0; i < stripes; i++)
+			{
+				Accumulate512(pAcc, pInput + i * StripeLength, pSecret + stripesInBlock * SecretConsumeRate);
+				if (++stripesInBlock == StripesPerBlock)
+				{
+					Scramble(pAcc, pSecret + Xxh3::SecretSize - StripeLength);
+					stripesInBlock = 0;
+				}
+			}
+		}
+
+		///
+		/// Accumulates an input over 240 bytes, including its last stripe.
+		///
+		static void AccumulateLong(uint64_t *pAcc, const uint8_t *p, size_t length, const uint8_t *pSecret)
+		{
+			InitAccumulators(pAcc);
+
+			int32_t stripesInBlock = 0;
+			ConsumeStripes(pAcc, stripesInBlock, p, (length - 1) / StripeLength, pSecret);
+			Accumulate512(pAcc, p + length - StripeLength, pSecret + Xxh3::SecretSize - StripeLength - SecretLastAccStart);
+		}
+
+		static uint64_t MergeAccumulators(const uint64_t *pAcc, const uint8_t *pSecret, uint64_t start)
+		{
+			uint64_t result = start;
+			for (int32_t i = 0; i < 4; i++)
+				result += MultiplyFold64(pAcc[2 * i] ^ Read64(pSecret + 16 * i), pAcc[2 * i + 1] ^ Read64(pSecret + 16 * i + 8));
+
+			return Avalanche(result);
+		}
+
+		static uint64_t Merge64(const uint64_t *pAcc, const uint8_t *pSecret, uint64_t length)
+		{
+			return MergeAccumulators(pAcc, pSecret + SecretMergeAccsStart, length * Prime64_1);
+		}
+
+		static Hash128 Merge128(const uint64_t *pAcc, const uint8_t *pSecret, uint64_t length)
+		{
+			Hash128 hash;
+			hash.low = MergeAccumulators(pAcc, pSecret + SecretMergeAccsStart, length * Prime64_1);
+			hash.high = MergeAccumulators(pAcc, pSecret + Xxh3::SecretSize - StripeLength - SecretMergeAccsStart, ~(length * Prime64_2));
+			return hash;
+		}
+
+		///
+		/// Derives the secret for a seed: the seed is added to the even words of the
+		/// default secret and subtracted from the odd ones.
+		///
+		static void DeriveSecret(uint8_t *pSecret, uint64_t seed)
+		{
+			for (int32_t i = 0; i < Xxh3::SecretSize; i += 16)
+			{
+				Write64(pSecret + i, Read64(s_defaultSecret + i) + seed);
+				Write64(pSecret + i + 8, Read64(s_defaultSecret + i + 8) - seed);
+			}
+		}
+
+		///
+		/// Starts a streaming hash.
+		///
+		Xxh3::Xxh3(uint64_t seed)
+		{
+			Reset(seed);
+		}
+
+		///
+		/// Restarts the streaming hash.
+		///
+		void Xxh3::Reset(uint64_t seed)
+		{
+			if (seed == 0)
+				memcpy(m_secret, s_defaultSecret, SecretSize);
+			else
+				DeriveSecret(m_secret, seed);
+
+			InitAccumulators(m_acc);
+			m_nSeed = seed;
+			m_nLength = 0;
+			m_nBufferedSize = 0;
+			m_nStripesInBlock = 0;
+		}
+
+		///
+		/// Hashes the next piece of the input.
+		///
+		void Xxh3::Update(const void *pData, size_t size)
+		{
+			const uint8_t *p = (const uint8_t *)pData;
+			m_nLength += size;
+
+			if ((size_t)m_nBufferedSize + size <= (size_t)BufferSize)
+			{
+				memcpy(m_buffer + m_nBufferedSize, p, size);
+				m_nBufferedSize += (int32_t)size;
+				return;
+			}
+
+			// more input follows the buffer, so all of its stripes can be accumulated;
+			// the last stripe of the whole input must wait for Digest
+			if (m_nBufferedSize > 0)
+			{
+				int32_t fill = BufferSize - m_nBufferedSize;
+				memcpy(m_buffer + m_nBufferedSize, p, fill);
+				p += fill;
+				size -= fill;
+
+				ConsumeStripes(m_acc, m_nStripesInBlock, m_buffer, BufferSize / StripeLength, m_secret);
+				memcpy(m_lastStripe, m_buffer + BufferSize - StripeLength, StripeLength);
+				m_nBufferedSize = 0;
+			}
+
+			if (size > (size_t)BufferSize)
+			{
+				size_t stripes = (size - 1) / StripeLength;
+				ConsumeStripes(m_acc, m_nStripesInBlock, p, stripes, m_secret);
+				memcpy(m_lastStripe, p + (stripes - 1) * StripeLength, StripeLength);
+				p += stripes * StripeLength;
+				size -= stripes * StripeLength;
+			}
+
+			memcpy(m_buffer, p, size);
+			m_nBufferedSize = (int32_t)size;
+		}
+
+		///
+		/// Accumulates the rest of a long input into a copy of the accumulators.
+		///
+		void Xxh3::DigestLong(uint64_t *pAcc) const
+		{
+			memcpy(pAcc, m_acc, sizeof(m_acc));
+
+			int32_t stripesInBlock = m_nStripesInBlock;
+			ConsumeStripes(pAcc, stripesInBlock, m_buffer, (m_nBufferedSize - 1) / StripeLength, m_secret);
+
+			// the last stripe may start in the data accumulated before the buffer
+			uint8_t lastStripe[StripeLength];
+			const uint8_t *pLast = m_buffer + m_nBufferedSize - StripeLength;
+			if (m_nBufferedSize < StripeLength)
+			{
+				int32_t previous = StripeLength - m_nBufferedSize;
+				memcpy(lastStripe, m_lastStripe + StripeLength - previous, previous);
+				memcpy(lastStripe + previous, m_buffer, m_nBufferedSize);
+				pLast = lastStripe;
+			}
+
+			Accumulate512(pAcc, pLast, m_secret + SecretSize - StripeLength - SecretLastAccStart);
+		}
+
+		///
+		/// Gets the 64-bit hash of the input so far. The hash can still be updated.
+		///
+		uint64_t Xxh3::Digest64() const
+		{
+			if (m_nLength <= (uint64_t)MidSizeMax)
+				return Hash64Short(m_buffer, (size_t)m_nLength, s_defaultSecret, m_nSeed);
+
+			uint64_t acc[8];
+			DigestLong(acc);
+			return Merge64(acc, m_secret, m_nLength);
+		}
+
+		///
+		/// Gets the 128-bit hash of the input so far. The hash can still be updated.
+		///
+		Hash128 Xxh3::Digest128() const
+		{
+			if (m_nLength <= (uint64_t)MidSizeMax)
+				return Hash128Short(m_buffer, (size_t)m_nLength, s_defaultSecret, m_nSeed);
+
+			uint64_t acc[8];
+			DigestLong(acc);
+			return Merge128(acc, m_secret, m_nLength);
+		}
+
+		///
+		/// Gets the XXH3 64-bit hash of a run of bytes.
+		///
+		uint64_t Xxh3::Compute64(const void *pData, size_t size, uint64_t seed)
+		{
+			const uint8_t *p = (const uint8_t *)pData;
+			if (size <= (size_t)MidSizeMax)
+				return Hash64Short(p, size, s_defaultSecret, seed);
+
+			uint8_t secret[SecretSize];
+			const uint8_t *pSecret = s_defaultSecret;
+			if (seed != 0)
+			{
+				DeriveSecret(secret, seed);
+				pSecret = secret;
+			}
+
+			uint64_t acc[8];
+			AccumulateLong(acc, p, size, pSecret);
+			return Merge64(acc, pSecret, size);
+		}
+
+		///
+		/// Gets the XXH3 128-bit hash of a run of bytes.
+		///
+		Hash128 Xxh3::Compute128(const void *pData, size_t size, uint64_t seed)
+		{
+			const uint8_t *p = (const uint8_t *)pData;
+			if (size <= (size_t)MidSizeMax)
+				return Hash128Short(p, size, s_defaultSecret, seed);
+
+			uint8_t secret[SecretSize];
+			const uint8_t *pSecret = s_defaultSecret;
+			if (seed != 0)
+			{
+				DeriveSecret(secret, seed);
+				pSecret = secret;
+			}
+
+			uint64_t acc[8];
+			AccumulateLong(acc, p, size, pSecret);
+			return Merge128(acc, pSecret, size);
+		}
+	}
+}
\ No newline at end of file
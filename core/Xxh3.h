@@ -0,0 +1,106 @@
+#pragma once
+#ifndef _TEKSTORM_XXH3_H
+#define _TEKSTORM_XXH3_H
+#include "../tekconfig.h"
+
+namespace Tekstorm
+{
+	namespace Core
+	{
+		///
+		/// A 128-bit hash.
+		///
+		struct Hash128
+		{
+			uint64_t low;
+			uint64_t high;
+
+			bool operator==(const Hash128 &other) const { return low == other.low && high == other.high; }
+			bool operator!=(const Hash128 &other) const { return !(*this == other); }
+		};
+
+		///
+		/// XXH3, the 64- and 128-bit hashes of xxHash 0.8, for content keys such as
+		/// bytecode caches and asset hashes. Results match the reference library, so
+		/// they can be stored on disk and compared with other tools.
+		///
+		/// Compute64() and Compute128() hash a run of bytes at once; inputs over 240
+		/// bytes go through 64-byte stripes accumulated with SSE2. An Xxh3 object
+		/// hashes data arriving in pieces and gives the same results as hashing it
+		/// all at once.
+		///
+		class TEKAPI Xxh3
+		{
+		public:
+			///
+			/// The size of the default secret.
+			///
+			static const int32_t SecretSize = 192;
+
+		protected:
+			///
+			/// The bytes buffered between updates.
+			///
+			static const int32_t BufferSize = 256;
+
+			///
+			/// Streaming state: the accumulators, the secret (derived from the seed) and
+			/// the input not yet accumulated.
+			///
+			uint64_t m_acc[8];
+			uint8_t m_secret[SecretSize];
+			uint8_t m_buffer[BufferSize];
+
+			// The last stripe before the buffer, for inputs that end with a short buffer.
+			uint8_t m_lastStripe[64];
+
+			uint64_t m_nSeed;
+			uint64_t m_nLength;
+			int32_t m_nBufferedSize;
+			int32_t m_nStripesInBlock;
+
+			///
+			/// Accumulates the rest of a long input into a copy of the accumulators.
+			///
+			void DigestLong(uint64_t *pAcc) const;
+
+		public:
+			///
+			/// Starts a streaming hash.
+			///
+			Xxh3(uint64_t seed = 0);
+
+			///
+			/// Restarts the streaming hash.
+			///
+			void Reset(uint64_t seed = 0);
+
+			///
+			/// Hashes the next piece of the input.
+			///
+			void Update(const void *pData, size_t size);
+
+			///
+			/// Gets the 64-bit hash of the input so far. The hash can still be updated.
+			///
+			uint64_t Digest64() const;
+
+			///
+			/// Gets the 128-bit hash of the input so far. The hash can still be updated.
+			///
+			Hash128 Digest128() const;
+
+			///
+			/// Gets the XXH3 64-bit hash of a run of bytes.
+			///
+			static uint64_t Compute64(const void *pData, size_t size, uint64_t seed = 0);
+
+			///
+			/// Gets the XXH3 128-bit hash of a run of bytes.
+			///
+			static Hash128 Compute128(const void *pData, size_t size, uint64_t seed = 0);
+		};
+	}
+}
+
+#endif /* _TEKSTORM_XXH3_H */
\ No newline at end of file
@@ -0,0 +1,1568 @@
+#define TEKSTORM_BUILD
+#include "ImageDecoder.h"
+#include "../IO/Inflate.h"
+#include "../core/MemoryTracker.h"
+#include <intrin.h>
+#include <emmintrin.h>
+#include <tmmintrin.h>
+#include <math.h>
+
+namespace Tekstorm
+{
+	namespace Graphics
+	{
+		using namespace Tekstorm::Core;
+		using namespace Tekstorm::IO;
+
+		///
+		/// "DDS ", read as a little-endian integer.
+		///
+		static const uint32_t DdsMagic = 0x20534444;
+
+		static const uint8_t s_pngSignature[8] = { 0x89, 'P', 'N', 'G', 0x0D, 0x0A, 0x1A, 0x0A };
+
+		///
+		/// The first pixel and the spacing of the pixels of each Adam7 pass.
+		///
+		static const int32_t s_adam7StartX[7] = { 0, 4, 0, 2, 0, 1, 0 };
+		static const int32_t s_adam7StartY[7] = { 0, 0, 4, 0, 2, 0, 1 };
+		static const int32_t s_adam7StepX[7] = { 8, 8, 4, 4, 2, 2, 1 };
+		static const int32_t s_adam7StepY[7] = { 8, 8, 8, 4, 4, 2, 2 };
+
+		///
+		/// Charges a decoding scratch buffer to the Graphics tag while it is in scope.
+		///
+		struct ScratchCharge
+		{
+			size_t size;
+
+			ScratchCharge(size_t bytes) : size(bytes)
+			{
+				TEKMEM_ALLOC(TEKMEMTAG_GRAPHICS, size);
+			}
+
+			~ScratchCharge()
+			{
+				TEKMEM_FREE(TEKMEMTAG_GRAPHICS, size);
+			}
+		};
+
+		///
+		/// The layouts of DDS pixel data.
+		///
+		enum DdsPixelFormat
+		{
+			TEKDDS_BC1,
+			TEKDDS_BC2,
+			TEKDDS_BC3,
+			TEKDDS_RGBA,
+			TEKDDS_BGRA,
+			TEKDDS_BGR
+		};
+
+		struct BmpHeader
+		{
+			int32_t width;
+			int32_t height;
+			bool topDown;
+			int32_t bitCount;
+			uint32_t dataOffset;
+			uint32_t rowSize;
+
+			// The red, green, blue and alpha bit fields of 16 and 32-bit pixels.
+			uint32_t masks[4];
+
+			const uint8_t *pPalette;
+			int32_t paletteCount;
+		};
+
+		struct TgaHeader
+		{
+			int32_t width;
+			int32_t height;
+			bool topDown;
+
+			// 1 (color-mapped), 2 (true-color) or 3 (grayscale).
+			int32_t imageType;
+			bool rle;
+			int32_t pixelBytes;
+
+			const uint8_t *pColorMap;
+			int32_t colorMapFirst;
+			int32_t colorMapLength;
+			int32_t colorMapBytes;
+			uint32_t dataOffset;
+		};
+
+		struct DdsHeader
+		{
+			int32_t width;
+			int32_t height;
+			DdsPixelFormat format;
+
+			// The pixels have no alpha channel.
+			bool opaque;
+			uint32_t dataOffset;
+		};
+
+		struct PngHeader
+		{
+			int32_t width;
+			int32_t height;
+			int32_t depth;
+			int32_t colorType;
+			bool interlaced;
+		};
+
+		///
+		/// A PNG image being decoded.
+		///
+		struct PngImage
+		{
+			PngHeader header;
+			int32_t channels;
+			uint32_t palette[256];
+
+			// The transparent sample values of grayscale and true-color images.
+			bool hasKey;
+			uint32_t key[3];
+		};
+
+		///
+		/// The run state of a TGA RLE stream, which may carry over between rows.
+		///
+		struct TgaRle
+		{
+			const uint8_t *p;
+			const uint8_t *pEnd;
+			int32_t remaining;
+			bool repeat;
+			uint8_t pixel[4];
+		};
+
+		///
+		/// Extracts a channel of a BMP pixel by its bit field.
+		///
+		struct BmpChannel
+		{
+			uint32_t mask;
+			int32_t shift;
+			uint32_t maximum;
+		};
+
+		static uint8_t s_srgbToLinear[256];
+
+		///
+		/// Fills the sRGB to linear table; returns true so it can initialize a static.
+		///
+		static bool BuildSrgbTable()
+		{
+			for (int32_t i = 0; i < 256; i++)
+			{
+				double value = i / 255.0;
+				value = (value <= 0.04045) ? value / 12.92 : pow((value + 0.055) / 1.055, 2.4);
+				s_srgbToLinear[i] = (uint8_t)(value * 255.0 + 0.5);
+			}
+
+			return true;
+		}
+
+		///
+		/// Checks cpuid for SSSE3 (leaf 1, ECX bit 9).
+		///
+		static bool DetectSsse3()
+		{
+			int info[4];
+			__cpuid(info, 1);
+			return (info[2] & (1 << 9)) != 0;
+		}
+
+		static const bool s_bSrgbTableBuilt = BuildSrgbTable();
+		static const bool s_bHasSsse3 = DetectSsse3();
+
+		static inline uint32_t ReadUInt16(const uint8_t *p)
+		{
+			return (uint32_t)p[0] | ((uint32_t)p[1] << 8);
+		}
+
+		static inline uint32_t ReadUInt32(const uint8_t *p)
+		{
+			return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+		}
+
+		static inline uint32_t ReadUInt32BE(const uint8_t *p)
+		{
+			return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+		}
+
+		static inline uint32_t MakePixel(uint32_t r, uint32_t g, uint32_t b, uint32_t a)
+		{
+			return r | (g << 8) | (b << 16) | (a << 24);
+		}
+
+		///
+		/// Reads the index-th sample of a row of 1, 2, 4, 8 or 16-bit samples, packed
+		/// from the most significant bit; 16-bit samples are big-endian.
+		///
+		static inline uint32_t ReadSample(const uint8_t *pRow, int32_t index, int32_t depth)
+		{
+			if (depth == 8)
+				return pRow[index];
+			if (depth == 16)
+				return ((uint32_t)pRow[index * 2] << 8) | pRow[index * 2 + 1];
+
+			int32_t bit = index * depth;
+			return (pRow[bit >> 3] >> (8 - depth - (bit & 7))) & ((1 << depth) - 1);
+		}
+
+		///
+		/// Scales a sample of the given depth to 8 bits.
+		///
+		static inline uint32_t ScaleSample(uint32_t value, int32_t depth)
+		{
+			switch (depth)
+			{
+			case 1:
+				return value * 255;
+			case 2:
+				return value * 85;
+			case 4:
+				return value * 17;
+			case 16:
+				return value >> 8;
+			default:
+				return value;
+			}
+		}
+
+		///
+		/// Applies the decode flags to converted pixels.
+		///
+		static inline void FinishPixels(uint32_t *pPixels, int32_t count, int32_t flags)
+		{
+			if ((flags & TEKIMAGE_SRGB_TO_LINEAR) != 0)
+				ImageDecoder::ConvertSrgbToLinear(pPixels, count);
+			if ((flags & TEKIMAGE_PREMULTIPLY) != 0)
+				ImageDecoder::Premultiply(pPixels, count);
+		}
+
+		///
+		/// Sizes the texture for an image; returns false if the size is invalid.
+		///
+		static bool CreateTexture(SoftwareTexture *pTexture, int32_t width, int32_t height)
+		{
+			if (width <= 0 || height <= 0 || width > ImageDecoder::MaxDimension || height > ImageDecoder::MaxDimension)
+				return false;
+
+			pTexture->Create(width, height);
+			return true;
+		}
+
+		///
+		/// Converts 24-bit pixels to opaque RGBA8 with a byte shuffle, 4 pixels at a
+		/// time while 16 bytes can be read. Returns the number converted.
+		///
+		static int32_t ShuffleToRgba(const uint8_t *pSource, uint32_t *pDestination, int32_t count, __m128i shuffle)
+		{
+			if (!s_bHasSsse3)
+				return 0;
+
+			const __m128i alpha = _mm_set1_epi32((int)0xFF000000);
+			int32_t i = 0;
+			for (; i + 6 <= count; i += 4)
+			{
+				__m128i pixels = _mm_loadu_si128((const __m128i *)(pSource + i * 3));
+				_mm_storeu_si128((__m128i *)(pDestination + i), _mm_or_si128(_mm_shuffle_epi8(pixels, shuffle), alpha));
+			}
+
+			return i;
+		}
+
+		///
+		/// Converts 24-bit R, G, B pixels to opaque RGBA8.
+		///
+		void ImageDecoder::ConvertRgbToRgba(const uint8_t *pSource, uint32_t *pDestination, int32_t count)
+		{
+			int32_t i = ShuffleToRgba(pSource, pDestination, count,
+				_mm_setr_epi8(0, 1, 2, -128, 3, 4, 5, -128, 6, 7, 8, -128, 9, 10, 11, -128));
+
+			for (; i < count; i++)
+				pDestination[i] = MakePixel(pSource[i * 3], pSource[i * 3 + 1], pSource[i * 3 + 2], 255);
+		}
+
+		///
+		/// Converts 24-bit B, G, R pixels to opaque RGBA8.
+		///
+		void ImageDecoder::ConvertBgrToRgba(const uint8_t *pSource, uint32_t *pDestination, int32_t count)
+		{
+			int32_t i = ShuffleToRgba(pSource, pDestination, count,
+				_mm_setr_epi8(2, 1, 0, -128, 5, 4, 3, -128, 8, 7, 6, -128, 11, 10, 9, -128));
+
+			for (; i < count; i++)
+				pDestination[i] = MakePixel(pSource[i * 3 + 2], pSource[i * 3 + 1], pSource[i * 3], 255);
+		}
+
+		///
+		/// Converts 32-bit B, G, R, A pixels to RGBA8 by swapping red and blue.
+		///
+		void ImageDecoder::ConvertBgraToRgba(const uint8_t *pSource, uint32_t *pDestination, int32_t count, bool opaque)
+		{
+			const uint32_t alpha = opaque ? 0xFF000000 : 0;
+			const __m128i alphaMask = _mm_set1_epi32((int)alpha);
+			const __m128i greenAlphaMask = _mm_set1_epi32((int)0xFF00FF00);
+			const __m128i redBlueMask = _mm_set1_epi32(0x00FF00FF);
+
+			int32_t i = 0;
+			for (; i + 4 <= count; i += 4)
+			{
+				__m128i pixels = _mm_loadu_si128((const __m128i *)(pSource + i * 4));
+				__m128i redBlue = _mm_and_si128(pixels, redBlueMask);
+				redBlue = _mm_or_si128(_mm_slli_epi32(redBlue, 16), _mm_srli_epi32(redBlue, 16));
+				pixels = _mm_or_si128(_mm_and_si128(pixels, greenAlphaMask), redBlue);
+				_mm_storeu_si128((__m128i *)(pDestination + i), _mm_or_si128(pixels, alphaMask));
+			}
+
+			for (; i < count; i++)
+			{
+				uint32_t pixel = ReadUInt32(pSource + i * 4);
+				pDestination[i] = (pixel & 0xFF00FF00) | ((pixel >> 16) & 0xFF) | ((pixel & 0xFF) << 16) | alpha;
+			}
+		}
+
+		///
+		/// Converts the color channels of RGBA8 pixels from sRGB to linear.
+		///
+		void ImageDecoder::ConvertSrgbToLinear(uint32_t *pPixels, int32_t count)
+		{
+			for (int32_t i = 0; i < count; i++)
+			{
+				uint32_t pixel = pPixels[i];
+				pPixels[i] = (uint32_t)s_srgbToLinear[pixel & 0xFF] | ((uint32_t)s_srgbToLinear[(pixel >> 8) & 0xFF] << 8)
+					| ((uint32_t)s_srgbToLinear[(pixel >> 16) & 0xFF] << 16) | (pixel & 0xFF000000);
+			}
+		}
+
+		///
+		/// Multiplies a 16-bit lane per channel by its factor, divided by 255 and rounded.
+		///
+		static inline __m128i MultiplyChannels(__m128i channels, __m128i factors)
+		{
+			__m128i product = _mm_add_epi16(_mm_mullo_epi16(channels, factors), _mm_set1_epi16(128));
+			return _mm_srli_epi16(_mm_add_epi16(product, _mm_srli_epi16(product, 8)), 8);
+		}
+
+		///
+		/// Multiplies the color channels of RGBA8 pixels by alpha.
+		///
+		void ImageDecoder::Premultiply(uint32_t *pPixels, int32_t count)
+		{
+			// alpha is multiplied by 255, which leaves it unchanged
+			const __m128i zero = _mm_setzero_si128();
+			const __m128i colorMask = _mm_set_epi16(0, -1, -1, -1, 0, -1, -1, -1);
+			const __m128i alphaFactor = _mm_set_epi16(255, 0, 0, 0, 255, 0, 0, 0);
+
+			int32_t i = 0;
+			for (; i + 4 <= count; i += 4)
+			{
+				__m128i pixels = _mm_loadu_si128((const __m128i *)(pPixels + i));
+				__m128i low = _mm_unpacklo_epi8(pixels, zero);
+				__m128i high = _mm_unpackhi_epi8(pixels, zero);
+
+				__m128i lowFactors = _mm_shufflehi_epi16(_mm_shufflelo_epi16(low, 0xFF), 0xFF);
+				__m128i highFactors = _mm_shufflehi_epi16(_mm_shufflelo_epi16(high, 0xFF), 0xFF);
+				lowFactors = _mm_or_si128(_mm_and_si128(lowFactors, colorMask), alphaFactor);
+				highFactors = _mm_or_si128(_mm_and_si128(highFactors, colorMask), alphaFactor);
+
+				pixels = _mm_packus_epi16(MultiplyChannels(low, lowFactors), MultiplyChannels(high, highFactors));
+				_mm_storeu_si128((__m128i *)(pPixels + i), pixels);
+			}
+
+			for (; i < count; i++)
+			{
+				uint32_t pixel = pPixels[i];
+				uint32_t alpha = pixel >> 24;
+				uint32_t result = pixel & 0xFF000000;
+				for (int32_t shift = 0; shift < 24; shift += 8)
+				{
+					uint32_t product = ((pixel >> shift) & 0xFF) * alpha + 128;
+					result |= ((product + (product >> 8)) >> 8) << shift;
+				}
+
+				pPixels[i] = result;
+			}
+		}
+
+		///
+		/// Reads a BMP header; returns false if it is invalid or unsupported.
+		///
+		static bool ParseBmp(const uint8_t *pData, int32_t size, BmpHeader *pHeader)
+		{
+			if (size < 54 || pData[0] != 'B' || pData[1] != 'M')
+				return false;
+
+			// BITMAPINFOHEADER or later; OS/2 headers are not supported
+			uint32_t headerSize = ReadUInt32(pData + 14);
+			int32_t width = (int32_t)ReadUInt32(pData + 18);
+			int32_t height = (int32_t)ReadUInt32(pData + 22);
+			if (headerSize < 40 || headerSize > (uint32_t)size - 14 || width <= 0 || width > ImageDecoder::MaxDimension
+				|| height == 0 || height > ImageDecoder::MaxDimension || height < -ImageDecoder::MaxDimension)
+			{
+				return false;
+			}
+
+			pHeader->width = width;
+			pHeader->height = (height < 0) ? -height : height;
+			pHeader->topDown = height < 0;
+			pHeader->bitCount = (int32_t)ReadUInt16(pData + 28);
+			pHeader->dataOffset = ReadUInt32(pData + 10);
+			pHeader->pPalette = nullptr;
+			pHeader->paletteCount = 0;
+
+			uint32_t compression = ReadUInt32(pData + 30);
+			switch (pHeader->bitCount)
+			{
+			case 1:
+			case 4:
+			case 8:
+			{
+				uint32_t colorsUsed = ReadUInt32(pData + 46);
+				int32_t maximum = 1 << pHeader->bitCount;
+				pHeader->paletteCount = (colorsUsed == 0 || colorsUsed > (uint32_t)maximum) ? maximum : (int32_t)colorsUsed;
+				pHeader->pPalette = pData + 14 + headerSize;
+				if (compression != 0 || 14 + headerSize + (uint32_t)pHeader->paletteCount * 4 > (uint32_t)size)
+					return false;
+
+				break;
+			}
+
+			case 16:
+				pHeader->masks[0] = 0x7C00;
+				pHeader->masks[1] = 0x03E0;
+				pHeader->masks[2] = 0x001F;
+				pHeader->masks[3] = 0;
+				break;
+
+			case 24:
+				if (compression != 0)
+					return false;
+
+				break;
+
+			case 32:
+				pHeader->masks[0] = 0x00FF0000;
+				pHeader->masks[1] = 0x0000FF00;
+				pHeader->masks[2] = 0x000000FF;
+				pHeader->masks[3] = 0;
+				break;
+
+			default:
+				return false;
+			}
+
+			if (compression == 3 || compression == 6)
+			{
+				// BI_BITFIELDS and BI_ALPHABITFIELDS: the masks follow a 40-byte header,
+				// or are part of a larger one
+				if (pHeader->bitCount != 16 && pHeader->bitCount != 32)
+					return false;
+
+				int32_t maskCount = (compression == 6 || headerSize >= 56) ? 4 : 3;
+				if (54 + maskCount * 4 > size)
+					return false;
+
+				for (int32_t i = 0; i < maskCount; i++)
+					pHeader->masks[i] = ReadUInt32(pData + 54 + i * 4);
+			}
+			else if (compression != 0)
+			{
+				// RLE and embedded JPEG/PNG are not supported
+				return false;
+			}
+
+			uint64_t rowSize = ((uint64_t)width * pHeader->bitCount + 31) / 32 * 4;
+			pHeader->rowSize = (uint32_t)rowSize;
+			return pHeader->dataOffset <= (uint32_t)size && rowSize * pHeader->height <= (uint64_t)(size - pHeader->dataOffset);
+		}
+
+		static void MakeChannel(uint32_t mask, BmpChannel *pChannel)
+		{
+			pChannel->mask = mask;
+			pChannel->shift = 0;
+			while (mask != 0 && ((mask >> pChannel->shift) & 1) == 0)
+				pChannel->shift++;
+
+			pChannel->maximum = mask >> pChannel->shift;
+		}
+
+		static inline uint32_t ReadChannel(uint32_t pixel, const BmpChannel &channel, uint32_t missing)
+		{
+			if (channel.mask == 0)
+				return missing;
+
+			return (((pixel & channel.mask) >> channel.shift) * 255 + channel.maximum / 2) / channel.maximum;
+		}
+
+		///
+		/// Decodes a BMP image.
+		///
+		static bool LoadBmp(const uint8_t *pData, int32_t size, SoftwareTexture *pTexture, int32_t flags)
+		{
+			BmpHeader header;
+			if (!ParseBmp(pData, size, &header) || !CreateTexture(pTexture, header.width, header.height))
+				return false;
+
+			uint32_t palette[256];
+			for (int32_t i = 0; i < 256; i++)
+				palette[i] = 0xFF000000;
+
+			for (int32_t i = 0; i < header.paletteCount; i++)
+			{
+				const uint8_t *pEntry = header.pPalette + i * 4;
+				palette[i] = MakePixel(pEntry[2], pEntry[1], pEntry[0], 255);
+			}
+
+			// 32-bit pixels usually are plain B, G, R, A (or X)
+			bool bgra = header.bitCount == 32 && header.masks[0] == 0x00FF0000 && header.masks[1] == 0x0000FF00
+				&& header.masks[2] == 0x000000FF && (header.masks[3] == 0xFF000000 || header.masks[3] == 0);
+
+			BmpChannel channels[4];
+			for (int32_t i = 0; i < 4; i++)
+				MakeChannel(header.masks[i], &channels[i]);
+
+			uint32_t *pPixels = pTexture->GetPixels();
+			for (int32_t y = 0; y < header.height; y++)
+			{
+				const uint8_t *pRow = pData + header.dataOffset + (size_t)(header.topDown ? y : header.height - 1 - y) * header.rowSize;
+				uint32_t *pDestination = pPixels + (size_t)y * header.width;
+
+				if (header.bitCount == 24)
+				{
+					ImageDecoder::ConvertBgrToRgba(pRow, pDestination, header.width);
+				}
+				else if (bgra)
+				{
+					ImageDecoder::ConvertBgraToRgba(pRow, pDestination, header.width, header.masks[3] == 0);
+				}
+				else if (header.bitCount <= 8)
+				{
+					for (int32_t x = 0; x < header.width; x++)
+						pDestination[x] = palette[ReadSample(pRow, x, header.bitCount)];
+				}
+				else
+				{
+					for (int32_t x = 0; x < header.width; x++)
+					{
+						uint32_t pixel = (header.bitCount == 16) ? ReadUInt16(pRow + x * 2) : ReadUInt32(pRow + x * 4);
+						pDestination[x] = MakePixel(ReadChannel(pixel, channels[0], 0), ReadChannel(pixel, channels[1], 0),
+							ReadChannel(pixel, channels[2], 0), ReadChannel(pixel, channels[3], 255));
+					}
+				}
+
+				FinishPixels(pDestination, header.width, flags);
+			}
+
+			return true;
+		}
+
+		///
+		/// Reads a TGA header; returns false if it is invalid or unsupported.
+		///
+		static bool ParseTga(const uint8_t *pData, int32_t size, TgaHeader *pHeader)
+		{
+			if (size < 18)
+				return false;
+
+			int32_t idLength = pData[0];
+			int32_t colorMapType = pData[1];
+			int32_t colorMapBits = pData[7];
+			int32_t depth = pData[16];
+			int32_t descriptor = pData[17];
+
+			pHeader->imageType = pData[2] & ~8;
+			pHeader->rle = (pData[2] & 8) != 0;
+			pHeader->colorMapFirst = (int32_t)ReadUInt16(pData + 3);
+			pHeader->colorMapLength = (int32_t)ReadUInt16(pData + 5);
+			pHeader->colorMapBytes = (colorMapBits + 7) / 8;
+			pHeader->width = (int32_t)ReadUInt16(pData + 12);
+			pHeader->height = (int32_t)ReadUInt16(pData + 14);
+			pHeader->topDown = (descriptor & 0x20) != 0;
+			pHeader->pixelBytes = depth / 8;
+
+			// right-to-left images are not supported
+			if (colorMapType > 1 || pHeader->imageType < 1 || pHeader->imageType > 3 || (descriptor & 0x10) != 0
+				|| pHeader->width == 0 || pHeader->height == 0
+				|| pHeader->width > ImageDecoder::MaxDimension || pHeader->height > ImageDecoder::MaxDimension)
+			{
+				return false;
+			}
+
+			if (pHeader->imageType == 1)
+			{
+				if (colorMapType != 1 || depth != 8 || (colorMapBits != 24 && colorMapBits != 32))
+					return false;
+			}
+			else if (pHeader->imageType == 2)
+			{
+				if (depth != 24 && depth != 32)
+					return false;
+			}
+			else if (depth != 8)
+			{
+				return false;
+			}
+
+			uint32_t colorMapSize = (colorMapType == 1) ? (uint32_t)pHeader->colorMapLength * pHeader->colorMapBytes : 0;
+			pHeader->pColorMap = pData + 18 + idLength;
+			pHeader->dataOffset = 18 + idLength + colorMapSize;
+			if (pHeader->dataOffset > (uint32_t)size)
+				return false;
+
+			uint64_t pixelsSize = (uint64_t)pHeader->width * pHeader->height * pHeader->pixelBytes;
+			return pHeader->rle || pixelsSize <= (uint64_t)(size - pHeader->dataOffset);
+		}
+
+		///
+		/// Expands the next row of a TGA RLE stream.
+		///
+		static bool ReadTgaRleRow(TgaRle &rle, uint8_t *pRow, int32_t width, int32_t pixelBytes)
+		{
+			for (int32_t x = 0; x < width; )
+			{
+				if (rle.remaining == 0)
+				{
+					if (rle.p >= rle.pEnd)
+						return false;
+
+					uint8_t packet = *rle.p++;
+					rle.remaining = (packet & 0x7F) + 1;
+					rle.repeat = (packet & 0x80) != 0;
+					if (rle.repeat)
+					{
+						if (rle.pEnd - rle.p < pixelBytes)
+							return false;
+
+						memcpy(rle.pixel, rle.p, pixelBytes);
+						rle.p += pixelBytes;
+					}
+				}
+
+				int32_t count = (rle.remaining < width - x) ? rle.remaining : width - x;
+				if (rle.repeat)
+				{
+					for (int32_t i = 0; i < count; i++)
+						memcpy(pRow + (x + i) * pixelBytes, rle.pixel, pixelBytes);
+				}
+				else
+				{
+					if (rle.pEnd - rle.p < count * pixelBytes)
+						return false;
+
+					memcpy(pRow + x * pixelBytes, rle.p, count * pixelBytes);
+					rle.p += count * pixelBytes;
+				}
+
+				x += count;
+				rle.remaining -= count;
+			}
+
+			return true;
+		}
+
+		///
+		/// Decodes a TGA image.
+		///
+		static bool LoadTga(const uint8_t *pData, int32_t size, SoftwareTexture *pTexture, int32_t flags)
+		{
+			TgaHeader header;
+			if (!ParseTga(pData, size, &header) || !CreateTexture(pTexture, header.width, header.height))
+				return false;
+
+			uint32_t palette[256];
+			for (int32_t i = 0; i < 256; i++)
+				palette[i] = 0xFF000000;
+
+			if (header.imageType == 1)
+			{
+				for (int32_t i = 0; i < header.colorMapLength && header.colorMapFirst + i < 256; i++)
+				{
+					const uint8_t *pEntry = header.pColorMap + i * header.colorMapBytes;
+					palette[header.colorMapFirst + i] = MakePixel(pEntry[2], pEntry[1], pEntry[0], (header.colorMapBytes == 4) ? pEntry[3] : 255);
+				}
+			}
+
+			TgaRle rle;
+			rle.p = pData + header.dataOffset;
+			rle.pEnd = pData + size;
+			rle.remaining = 0;
+			rle.repeat = false;
+
+			std::vector<uint8_t> rowBuffer;
+			if (header.rle)
+				rowBuffer.resize((size_t)header.width * header.pixelBytes);
+			ScratchCharge rowCharge(rowBuffer.capacity());
+
+			uint32_t *pPixels = pTexture->GetPixels();
+			for (int32_t row = 0; row < header.height; row++)
+			{
+				const uint8_t *pRow;
+				if (header.rle)
+				{
+					if (!ReadTgaRleRow(rle, &rowBuffer[0], header.width, header.pixelBytes))
+						return false;
+
+					pRow = &rowBuffer[0];
+				}
+				else
+				{
+					pRow = pData + header.dataOffset + (size_t)row * header.width * header.pixelBytes;
+				}
+
+				int32_t y = header.topDown ? row : header.height - 1 - row;
+				uint32_t *pDestination = pPixels + (size_t)y * header.width;
+
+				if (header.imageType == 1)
+				{
+					for (int32_t x = 0; x < header.width; x++)
+						pDestination[x] = palette[pRow[x]];
+				}
+				else if (header.imageType == 3)
+				{
+					for (int32_t x = 0; x < header.width; x++)
+						pDestination[x] = MakePixel(pRow[x], pRow[x], pRow[x], 255);
+				}
+				else if (header.pixelBytes == 4)
+				{
+					ImageDecoder::ConvertBgraToRgba(pRow, pDestination, header.width);
+				}
+				else
+				{
+					ImageDecoder::ConvertBgrToRgba(pRow, pDestination, header.width);
+				}
+
+				FinishPixels(pDestination, header.width, flags);
+			}
+
+			return true;
+		}
+
+		static inline uint32_t MakeFourCC(char a, char b, char c, char d)
+		{
+			return (uint32_t)(uint8_t)a | ((uint32_t)(uint8_t)b << 8) | ((uint32_t)(uint8_t)c << 16) | ((uint32_t)(uint8_t)d << 24);
+		}
+
+		///
+		/// Reads a DDS header; returns false if it is invalid or unsupported.
+		///
+		static bool ParseDds(const uint8_t *pData, int32_t size, DdsHeader *pHeader)
+		{
+			if (size < 128 || ReadUInt32(pData) != DdsMagic || ReadUInt32(pData + 4) != 124)
+				return false;
+
+			uint32_t height = ReadUInt32(pData + 12);
+			uint32_t width = ReadUInt32(pData + 16);
+			if (width == 0 || height == 0 || width > (uint32_t)ImageDecoder::MaxDimension || height > (uint32_t)ImageDecoder::MaxDimension)
+				return false;
+
+			pHeader->width = (int32_t)width;
+			pHeader->height = (int32_t)height;
+			pHeader->opaque = false;
+			pHeader->dataOffset = 128;
+
+			// DDS_PIXELFORMAT
+			uint32_t pixelFlags = ReadUInt32(pData + 80);
+			uint32_t fourCC = ReadUInt32(pData + 84);
+			uint32_t bitCount = ReadUInt32(pData + 88);
+			uint32_t redMask = ReadUInt32(pData + 92);
+			uint32_t alphaMask = ReadUInt32(pData + 104);
+
+			if ((pixelFlags & 0x4) != 0)
+			{
+				if (fourCC == MakeFourCC('D', 'X', 'T', '1'))
+				{
+					pHeader->format = TEKDDS_BC1;
+				}
+				else if (fourCC == MakeFourCC('D', 'X', 'T', '2') || fourCC == MakeFourCC('D', 'X', 'T', '3'))
+				{
+					pHeader->format = TEKDDS_BC2;
+				}
+				else if (fourCC == MakeFourCC('D', 'X', 'T', '4') || fourCC == MakeFourCC('D', 'X', 'T', '5'))
+				{
+					pHeader->format = TEKDDS_BC3;
+				}
+				else if (fourCC == MakeFourCC('D', 'X', '1', '0') && size >= 148)
+				{
+					// DDS_HEADER_DXT10; only its DXGI_FORMAT matters here
+					pHeader->dataOffset = 148;
+					switch (ReadUInt32(pData + 128))
+					{
+					case 71: // DXGI_FORMAT_BC1_UNORM
+					case 72: // DXGI_FORMAT_BC1_UNORM_SRGB
+						pHeader->format = TEKDDS_BC1;
+						break;
+					case 74: // DXGI_FORMAT_BC2_UNORM
+					case 75: // DXGI_FORMAT_BC2_UNORM_SRGB
+						pHeader->format = TEKDDS_BC2;
+						break;
+					case 77: // DXGI_FORMAT_BC3_UNORM
+					case 78: // DXGI_FORMAT_BC3_UNORM_SRGB
+						pHeader->format = TEKDDS_BC3;
+						break;
+					case 28: // DXGI_FORMAT_R8G8B8A8_UNORM
+					case 29: // DXGI_FORMAT_R8G8B8A8_UNORM_SRGB
+						pHeader->format = TEKDDS_RGBA;
+						break;
+					case 87: // DXGI_FORMAT_B8G8R8A8_UNORM
+					case 91: // DXGI_FORMAT_B8G8R8A8_UNORM_SRGB
+						pHeader->format = TEKDDS_BGRA;
+						break;
+					case 88: // DXGI_FORMAT_B8G8R8X8_UNORM
+					case 93: // DXGI_FORMAT_B8G8R8X8_UNORM_SRGB
+						pHeader->format = TEKDDS_BGRA;
+						pHeader->opaque = true;
+						break;
+					default:
+						return false;
+					}
+				}
+				else
+				{
+					return false;
+				}
+			}
+			else if ((pixelFlags & 0x40) != 0)
+			{
+				// DDPF_RGB, with alpha if DDPF_ALPHAPIXELS is set
+				bool alpha = (pixelFlags & 0x1) != 0 && alphaMask != 0;
+				if (bitCount == 32 && redMask == 0x000000FF)
+					pHeader->format = TEKDDS_RGBA;
+				else if (bitCount == 32 && redMask == 0x00FF0000)
+					pHeader->format = TEKDDS_BGRA;
+				else if (bitCount == 24 && redMask == 0x00FF0000)
+					pHeader->format = TEKDDS_BGR;
+				else
+					return false;
+
+				pHeader->opaque = !alpha;
+			}
+			else
+			{
+				return false;
+			}
+
+			uint64_t dataSize;
+			if (pHeader->format == TEKDDS_BC1 || pHeader->format == TEKDDS_BC2 || pHeader->format == TEKDDS_BC3)
+				dataSize = (uint64_t)((width + 3) / 4) * ((height + 3) / 4) * ((pHeader->format == TEKDDS_BC1) ? 8 : 16);
+			else
+				dataSize = (uint64_t)width * height * ((pHeader->format == TEKDDS_BGR) ? 3 : 4);
+
+			return dataSize <= (uint64_t)(size - pHeader->dataOffset);
+		}
+
+		static inline uint32_t Expand565(uint32_t color)
+		{
+			uint32_t r = (color >> 11) & 31;
+			uint32_t g = (color >> 5) & 63;
+			uint32_t b = color & 31;
+			return MakePixel((r << 3) | (r >> 2), (g << 2) | (g >> 4), (b << 3) | (b >> 2), 255);
+		}
+
+		///
+		/// Blends the color channels of two opaque pixels.
+		///
+		static inline uint32_t MixColors(uint32_t a, uint32_t b, uint32_t weightA, uint32_t weightB, uint32_t divisor)
+		{
+			uint32_t result = 0xFF000000;
+			for (int32_t shift = 0; shift < 24; shift += 8)
+				result |= ((((a >> shift) & 0xFF) * weightA + ((b >> shift) & 0xFF) * weightB) / divisor) << shift;
+
+			return result;
+		}
+
+		///
+		/// Decodes the color half of a BC1-BC3 block into 16 pixels, in rows of 4.
+		///
+		static void DecodeColorBlock(const uint8_t *pBlock, uint32_t *pPixels, bool allowTransparent)
+		{
+			uint32_t color0 = ReadUInt16(pBlock);
+			uint32_t color1 = ReadUInt16(pBlock + 2);
+
+			uint32_t colors[4];
+			colors[0] = Expand565(color0);
+			colors[1] = Expand565(color1);
+			if (color0 > color1 || !allowTransparent)
+			{
+				colors[2] = MixColors(colors[0], colors[1], 2, 1, 3);
+				colors[3] = MixColors(colors[0], colors[1], 1, 2, 3);
+			}
+			else
+			{
+				// BC1's three-color mode, with transparent black
+				colors[2] = MixColors(colors[0], colors[1], 1, 1, 2);
+				colors[3] = 0;
+			}
+
+			uint32_t indices = ReadUInt32(pBlock + 4);
+			for (int32_t i = 0; i < 16; i++, indices >>= 2)
+				pPixels[i] = colors[indices & 3];
+		}
+
+		///
+		/// Decodes the 4-bit alpha of a BC2 block.
+		///
+		static void DecodeExplicitAlpha(const uint8_t *pBlock, uint32_t *pPixels)
+		{
+			for (int32_t i = 0; i < 16; i++)
+			{
+				uint32_t alpha = (pBlock[i >> 1] >> ((i & 1) * 4)) & 15;
+				pPixels[i] = (pPixels[i] & 0x00FFFFFF) | ((alpha * 17) << 24);
+			}
+		}
+
+		///
+		/// Decodes the interpolated alpha of a BC3 block.
+		///
+		static void DecodeInterpolatedAlpha(const uint8_t *pBlock, uint32_t *pPixels)
+		{
+			uint32_t alphas[8];
+			alphas[0] = pBlock[0];
+			alphas[1] = pBlock[1];
+			if (alphas[0] > alphas[1])
+			{
+				for (uint32_t i = 1; i < 7; i++)
+					alphas[i + 1] = ((7 - i) * alphas[0] + i * alphas[1]) / 7;
+			}
+			else
+			{
+				for (uint32_t i = 1; i < 5; i++)
+					alphas[i + 1] = ((5 - i) * alphas[0] + i * alphas[1]) / 5;
+
+				alphas[6] = 0;
+				alphas[7] = 255;
+			}
+
+			uint64_t indices = 0;
+			for (int32_t i = 0; i < 6; i++)
+				indices |= (uint64_t)pBlock[2 + i] << (i * 8);
+
+			for (int32_t i = 0; i < 16; i++, indices >>= 3)
+				pPixels[i] = (pPixels[i] & 0x00FFFFFF) | (alphas[indices & 7] << 24);
+		}
+
+		///
+		/// Decodes the top mip level of a DDS image.
+		///
+		static bool LoadDds(const uint8_t *pData, int32_t size, SoftwareTexture *pTexture, int32_t flags)
+		{
+			DdsHeader header;
+			if (!ParseDds(pData, size, &header) || !CreateTexture(pTexture, header.width, header.height))
+				return false;
+
+			const uint8_t *pSource = pData + header.dataOffset;
+			uint32_t *pPixels = pTexture->GetPixels();
+
+			if (header.format == TEKDDS_RGBA || header.format == TEKDDS_BGRA || header.format == TEKDDS_BGR)
+			{
+				int32_t pixelBytes = (header.format == TEKDDS_BGR) ? 3 : 4;
+				for (int32_t y = 0; y < header.height; y++)
+				{
+					const uint8_t *pRow = pSource + (size_t)y * header.width * pixelBytes;
+					uint32_t *pDestination = pPixels + (size_t)y * header.width;
+
+					if (header.format == TEKDDS_BGR)
+					{
+						ImageDecoder::ConvertBgrToRgba(pRow, pDestination, header.width);
+					}
+					else if (header.format == TEKDDS_BGRA)
+					{
+						ImageDecoder::ConvertBgraToRgba(pRow, pDestination, header.width, header.opaque);
+					}
+					else
+					{
+						memcpy(pDestination, pRow, (size_t)header.width * sizeof(uint32_t));
+						if (header.opaque)
+						{
+							for (int32_t x = 0; x < header.width; x++)
+								pDestination[x] |= 0xFF000000;
+						}
+					}
+
+					FinishPixels(pDestination, header.width, flags);
+				}
+
+				return true;
+			}
+
+			int32_t blockBytes = (header.format == TEKDDS_BC1) ? 8 : 16;
+			int32_t blocksX = (header.width + 3) / 4;
+			int32_t blocksY = (header.height + 3) / 4;
+			uint32_t block[16];
+
+			for (int32_t blockY = 0; blockY < blocksY; blockY++)
+			{
+				int32_t rows = header.height - blockY * 4;
+				if (rows > 4)
+					rows = 4;
+
+				for (int32_t blockX = 0; blockX < blocksX; blockX++, pSource += blockBytes)
+				{
+					if (header.format == TEKDDS_BC1)
+					{
+						DecodeColorBlock(pSource, block, true);
+					}
+					else if (header.format == TEKDDS_BC2)
+					{
+						DecodeColorBlock(pSource + 8, block, false);
+						DecodeExplicitAlpha(pSource, block);
+					}
+					else
+					{
+						DecodeColorBlock(pSource + 8, block, false);
+						DecodeInterpolatedAlpha(pSource, block);
+					}
+
+					int32_t columns = header.width - blockX * 4;
+					if (columns > 4)
+						columns = 4;
+
+					for (int32_t row = 0; row < rows; row++)
+						memcpy(pPixels + (size_t)(blockY * 4 + row) * header.width + blockX * 4, block + row * 4, columns * sizeof(uint32_t));
+				}
+
+				FinishPixels(pPixels + (size_t)blockY * 4 * header.width, rows * header.width, flags);
+			}
+
+			return true;
+		}
+
+		///
+		/// Reads a PNG IHDR chunk; returns false if it is invalid.
+		///
+		static bool ParsePng(const uint8_t *pData, int32_t size, PngHeader *pHeader)
+		{
+			if (size < 33 || memcmp(pData, s_pngSignature, 8) != 0 || ReadUInt32BE(pData + 8) != 13 || memcmp(pData + 12, "IHDR", 4) != 0)
+				return false;
+
+			uint32_t width = ReadUInt32BE(pData + 16);
+			uint32_t height = ReadUInt32BE(pData + 20);
+			if (width == 0 || height == 0 || width > (uint32_t)ImageDecoder::MaxDimension || height > (uint32_t)ImageDecoder::MaxDimension)
+				return false;
+
+			pHeader->width = (int32_t)width;
+			pHeader->height = (int32_t)height;
+			pHeader->depth = pData[24];
+			pHeader->colorType = pData[25];
+			pHeader->interlaced = pData[28] == 1;
+
+			// deflate, adaptive filtering, no interlacing or Adam7
+			if (pData[26] != 0 || pData[27] != 0 || pData[28] > 1)
+				return false;
+
+			int32_t depth = pHeader->depth;
+			switch (pHeader->colorType)
+			{
+			case 0:
+				return depth == 1 || depth == 2 || depth == 4 || depth == 8 || depth == 16;
+			case 3:
+				return depth == 1 || depth == 2 || depth == 4 || depth == 8;
+			case 2:
+			case 4:
+			case 6:
+				return depth == 8 || depth == 16;
+			default:
+				return false;
+			}
+		}
+
+		static inline int32_t GetPngRowBytes(int32_t width, int32_t bitsPerPixel)
+		{
+			return (int32_t)(((int64_t)width * bitsPerPixel + 7) / 8);
+		}
+
+		///
+		/// Reads a tRNS chunk into the palette alphas or the transparent key.
+		///
+		static void ReadPngTransparency(PngImage &png, const uint8_t *pChunk, uint32_t length)
+		{
+			if (png.header.colorType == 3)
+			{
+				for (uint32_t i = 0; i < length && i < 256; i++)
+					png.palette[i] = (png.palette[i] & 0x00FFFFFF) | ((uint32_t)pChunk[i] << 24);
+			}
+			else if (png.header.colorType == 0 && length >= 2)
+			{
+				png.key[0] = (pChunk[0] << 8) | pChunk[1];
+				png.hasKey = true;
+			}
+			else if (png.header.colorType == 2 && length >= 6)
+			{
+				for (int32_t i = 0; i < 3; i++)
+					png.key[i] = (pChunk[i * 2] << 8) | pChunk[i * 2 + 1];
+
+				png.hasKey = true;
+			}
+		}
+
+		static inline uint8_t Paeth(int32_t a, int32_t b, int32_t c)
+		{
+			int32_t distanceA = abs(b - c);
+			int32_t distanceB = abs(a - c);
+			int32_t distanceC = abs(a + b - c * 2);
+			if (distanceA <= distanceB && distanceA <= distanceC)
+				return (uint8_t)a;
+
+			return (uint8_t)((distanceB <= distanceC) ? b : c);
+		}
+
+		///
+		/// Reverses the filter of a PNG row in place. bpp is the filter distance:
+		/// the bytes per pixel, at least 1.
+		///
+		static bool UnfilterPngRow(uint8_t *pRow, const uint8_t *pPrevious, int32_t length, int32_t bpp, int32_t filter)
+		{
+			int32_t i = 0;
+			switch (filter)
+			{
+			case 0:
+				break;
+
+			case 1: // Sub
+				for (i = bpp; i < length; i++)
+					pRow[i] += pRow[i - bpp];
+				break;
+
+			case 2: // Up
+				for (; i + 16 <= length; i += 16)
+				{
+					__m128i row = _mm_loadu_si128((const __m128i *)(pRow + i));
+					__m128i previous = _mm_loadu_si128((const __m128i *)(pPrevious + i));
+					_mm_storeu_si128((__m128i *)(pRow + i), _mm_add_epi8(row, previous));
+				}
+
+				for (; i < length; i++)
+					pRow[i] += pPrevious[i];
+				break;
+
+			case 3: // Average
+				for (; i < bpp && i < length; i++)
+					pRow[i] += pPrevious[i] >> 1;
+				for (; i < length; i++)
+					pRow[i] += (uint8_t)((pRow[i - bpp] + pPrevious[i]) >> 1);
+				break;
+
+			case 4: // Paeth
+				for (; i < bpp && i < length; i++)
+					pRow[i] += pPrevious[i];
+				for (; i < length; i++)
+					pRow[i] += Paeth(pRow[i - bpp], pPrevious[i], pPrevious[i - bpp]);
+				break;
+
+			default:
+				return false;
+			}
+
+			return true;
+		}
+
+		///
+		/// Converts an unfiltered PNG row to RGBA8.
+		///
+		static void ConvertPngRow(const PngImage &png, const uint8_t *pRow, uint32_t *pDestination, int32_t width)
+		{
+			const PngHeader &header = png.header;
+			if (header.depth == 8)
+			{
+				if (header.colorType == 6)
+				{
+					memcpy(pDestination, pRow, (size_t)width * sizeof(uint32_t));
+					return;
+				}
+
+				if (header.colorType == 2 && !png.hasKey)
+				{
+					ImageDecoder::ConvertRgbToRgba(pRow, pDestination, width);
+					return;
+				}
+
+				if (header.colorType == 3)
+				{
+					for (int32_t x = 0; x < width; x++)
+						pDestination[x] = png.palette[pRow[x]];
+					return;
+				}
+			}
+
+			int32_t depth = header.depth;
+			for (int32_t x = 0; x < width; x++)
+			{
+				switch (header.colorType)
+				{
+				case 0:
+				{
+					uint32_t sample = ReadSample(pRow, x, depth);
+					uint32_t gray = ScaleSample(sample, depth);
+					pDestination[x] = MakePixel(gray, gray, gray, (png.hasKey && sample == png.key[0]) ? 0 : 255);
+					break;
+				}
+
+				case 2:
+				{
+					uint32_t r = ReadSample(pRow, x * 3, depth);
+					uint32_t g = ReadSample(pRow, x * 3 + 1, depth);
+					uint32_t b = ReadSample(pRow, x * 3 + 2, depth);
+					bool transparent = png.hasKey && r == png.key[0] && g == png.key[1] && b == png.key[2];
+					pDestination[x] = MakePixel(ScaleSample(r, depth), ScaleSample(g, depth), ScaleSample(b, depth), transparent ? 0 : 255);
+					break;
+				}
+
+				case 3:
+					pDestination[x] = png.palette[ReadSample(pRow, x, depth)];
+					break;
+
+				case 4:
+				{
+					uint32_t gray = ScaleSample(ReadSample(pRow, x * 2, depth), depth);
+					pDestination[x] = MakePixel(gray, gray, gray, ScaleSample(ReadSample(pRow, x * 2 + 1, depth), depth));
+					break;
+				}
+
+				default:
+					pDestination[x] = MakePixel(ScaleSample(ReadSample(pRow, x * 4, depth), depth),
+						ScaleSample(ReadSample(pRow, x * 4 + 1, depth), depth), ScaleSample(ReadSample(pRow, x * 4 + 2, depth), depth),
+						ScaleSample(ReadSample(pRow, x * 4 + 3, depth), depth));
+					break;
+				}
+			}
+		}
+
+		///
+		/// Decodes a PNG image.
+		///
+		static bool LoadPng(const uint8_t *pData, int32_t size, SoftwareTexture *pTexture, int32_t flags)
+		{
+			PngImage png;
+			if (!ParsePng(pData, size, &png.header))
+				return false;
+
+			static const int32_t channelCounts[7] = { 1, 0, 3, 1, 2, 0, 4 };
+			const PngHeader &header = png.header;
+			png.channels = channelCounts[header.colorType];
+			png.hasKey = false;
+			for (int32_t i = 0; i < 256; i++)
+				png.palette[i] = 0xFF000000;
+
+			// the image data stays in its IDAT chunks; Inflate reads across them
+			std::vector<InflateSegment> segments;
+			for (int32_t offset = 8; size - offset >= 12; )
+			{
+				uint32_t length = ReadUInt32BE(pData + offset);
+				const uint8_t *pType = pData + offset + 4;
+				const uint8_t *pChunk = pData + offset + 8;
+				if (length > (uint32_t)(size - offset - 12))
+					return false;
+
+				if (memcmp(pType, "IDAT", 4) == 0)
+				{
+					InflateSegment segment = { (const char *)pChunk, (int32_t)length };
+					segments.push_back(segment);
+				}
+				else if (memcmp(pType, "PLTE", 4) == 0)
+				{
+					for (uint32_t i = 0; i < length / 3 && i < 256; i++)
+						png.palette[i] = MakePixel(pChunk[i * 3], pChunk[i * 3 + 1], pChunk[i * 3 + 2], 255);
+				}
+				else if (memcmp(pType, "tRNS", 4) == 0)
+				{
+					ReadPngTransparency(png, pChunk, length);
+				}
+				else if (memcmp(pType, "IEND", 4) == 0)
+				{
+					break;
+				}
+
+				offset += 12 + (int32_t)length;
+			}
+
+			if (segments.empty())
+				return false;
+
+			// the size of each pass, and of the filtered rows of all passes
+			int32_t bitsPerPixel = png.channels * header.depth;
+			int32_t filterBytes = (bitsPerPixel + 7) / 8;
+			int32_t passCount = header.interlaced ? 7 : 1;
+			int32_t passWidths[7];
+			int32_t passHeights[7];
+			int64_t rawSize = 0;
+			for (int32_t pass = 0; pass < passCount; pass++)
+			{
+				if (header.interlaced)
+				{
+					int32_t startX = s_adam7StartX[pass];
+					int32_t startY = s_adam7StartY[pass];
+					passWidths[pass] = (header.width > startX) ? (header.width - startX + s_adam7StepX[pass] - 1) / s_adam7StepX[pass] : 0;
+					passHeights[pass] = (header.height > startY) ? (header.height - startY + s_adam7StepY[pass] - 1) / s_adam7StepY[pass] : 0;
+				}
+				else
+				{
+					passWidths[pass] = header.width;
+					passHeights[pass] = header.height;
+				}
+
+				if (passWidths[pass] > 0 && passHeights[pass] > 0)
+					rawSize += (int64_t)passHeights[pass] * (1 + GetPngRowBytes(passWidths[pass], bitsPerPixel));
+			}
+
+			if (rawSize > 0x7FFFFFFF)
+				return false;
+
+			std::vector<uint8_t> raw((size_t)rawSize);
+			ScratchCharge rawCharge(raw.capacity());
+			if (!Inflate::DecompressZlib(&segments[0], (int32_t)segments.size(), (char *)&raw[0], (int32_t)rawSize)
+				|| !CreateTexture(pTexture, header.width, header.height))
+			{
+				return false;
+			}
+
+			std::vector<uint8_t> zeroRow((size_t)GetPngRowBytes(header.width, bitsPerPixel), 0);
+			std::vector<uint32_t> passRow(header.interlaced ? header.width : 0);
+			uint32_t *pPixels = pTexture->GetPixels();
+			uint8_t *pRaw = &raw[0];
+
+			for (int32_t pass = 0; pass < passCount; pass++)
+			{
+				if (passWidths[pass] == 0 || passHeights[pass] == 0)
+					continue;
+
+				int32_t rowBytes = GetPngRowBytes(passWidths[pass], bitsPerPixel);
+				const uint8_t *pPrevious = &zeroRow[0];
+				for (int32_t y = 0; y < passHeights[pass]; y++)
+				{
+					uint8_t *pRow = pRaw + 1;
+					if (!UnfilterPngRow(pRow, pPrevious, rowBytes, filterBytes, pRaw[0]))
+						return false;
+
+					if (!header.interlaced)
+					{
+						uint32_t *pDestination = pPixels + (size_t)y * header.width;
+						ConvertPngRow(png, pRow, pDestination, header.width);
+						FinishPixels(pDestination, header.width, flags);
+					}
+					else
+					{
+						ConvertPngRow(png, pRow, &passRow[0], passWidths[pass]);
+
+						int32_t targetY = s_adam7StartY[pass] + y * s_adam7StepY[pass];
+						uint32_t *pDestination = pPixels + (size_t)targetY * header.width + s_adam7StartX[pass];
+						for (int32_t x = 0; x < passWidths[pass]; x++)
+							pDestination[x * s_adam7StepX[pass]] = passRow[x];
+					}
+
+					pPrevious = pRow;
+					pRaw += 1 + rowBytes;
+				}
+			}
+
+			// interlaced rows are only complete after the last pass
+			if (header.interlaced)
+				FinishPixels(pPixels, header.width * header.height, flags);
+
+			return true;
+		}
+
+		///
+		/// Detects the format of an image from its header.
+		///
+		ImageFormat ImageDecoder::DetectFormat(const char *pData, int32_t size)
+		{
+			const uint8_t *p = (const uint8_t *)pData;
+			if (size >= 8 && memcmp(p, s_pngSignature, 8) == 0)
+				return TEKIMAGE_PNG;
+			if (size >= 4 && ReadUInt32(p) == DdsMagic)
+				return TEKIMAGE_DDS;
+			if (size >= 2 && p[0] == 'B' && p[1] == 'M')
+				return TEKIMAGE_BMP;
+
+			// TGA has no signature; accept any header that makes sense
+			TgaHeader header;
+			if (ParseTga(p, size, &header))
+				return TEKIMAGE_TGA;
+
+			return TEKIMAGE_UNKNOWN;
+		}
+
+		///
+		/// Reads the format and size of an image without decoding it.
+		///
+		bool ImageDecoder::GetInfo(const char *pData, int32_t size, ImageInfo *pInfo)
+		{
+			const uint8_t *p = (const uint8_t *)pData;
+			pInfo->format = DetectFormat(pData, size);
+			pInfo->width = 0;
+			pInfo->height = 0;
+
+			switch (pInfo->format)
+			{
+			case TEKIMAGE_BMP:
+			{
+				BmpHeader header;
+				if (!ParseBmp(p, size, &header))
+					return false;
+
+				pInfo->width = header.width;
+				pInfo->height = header.height;
+				return true;
+			}
+
+			case TEKIMAGE_PNG:
+			{
+				PngHeader header;
+				if (!ParsePng(p, size, &header))
+					return false;
+
+				pInfo->width = header.width;
+				pInfo->height = header.height;
+				return true;
+			}
+
+			case TEKIMAGE_TGA:
+			{
+				TgaHeader header;
+				if (!ParseTga(p, size, &header))
+					return false;
+
+				pInfo->width = header.width;
+				pInfo->height = header.height;
+				return true;
+			}
+
+			case TEKIMAGE_DDS:
+			{
+				DdsHeader header;
+				if (!ParseDds(p, size, &header))
+					return false;
+
+				pInfo->width = header.width;
+				pInfo->height = header.height;
+				return true;
+			}
+
+			default:
+				return false;
+			}
+		}
+
+		///
+		/// Decodes an image into a texture.
+		///
+		bool ImageDecoder::LoadFromMemory(const char *pData, int32_t size, SoftwareTexture *pTexture, int32_t flags)
+		{
+			const uint8_t *p = (const uint8_t *)pData;
+			bool loaded;
+			switch (DetectFormat(pData, size))
+			{
+			case TEKIMAGE_BMP:
+				loaded = LoadBmp(p, size, pTexture, flags);
+				break;
+			case TEKIMAGE_PNG:
+				loaded = LoadPng(p, size, pTexture, flags);
+				break;
+			case TEKIMAGE_TGA:
+				loaded = LoadTga(p, size, pTexture, flags);
+				break;
+			case TEKIMAGE_DDS:
+				loaded = LoadDds(p, size, pTexture, flags);
+				break;
+			default:
+				loaded = false;
+				break;
+			}
+
+#if defined(TEKSTORM_DEBUG)
+			if (!loaded)
+			{
+				TEKDEBUG_W("ImageDecoder: the image is corrupt or in an unsupported format");
+			}
+#endif
+
+			return loaded;
+		}
+
+		///
+		/// Decodes the requests [begin, end) (a ParallelFor body).
+		///
+		static void LoadRequests(void *pData, int32_t begin, int32_t end)
+		{
+			ImageLoadRequest *pRequests = (ImageLoadRequest *)pData;
+			for (int32_t i = begin; i < end; i++)
+			{
+				ImageLoadRequest &request = pRequests[i];
+				request.succeeded = ImageDecoder::LoadFromMemory(request.pData, request.size, request.pTexture, request.flags);
+			}
+		}
+
+		///
+		/// Decodes images in parallel and waits for them.
+		///
+		int32_t ImageDecoder::LoadFromMemory(ImageLoadRequest *pRequests, int32_t count, JobSystem *pJobs)
+		{
+			// one image per job; stealing balances images of different sizes
+			if (pJobs != nullptr)
+				pJobs->ParallelFor(count, LoadRequests, pRequests, 1);
+			else
+				LoadRequests(pRequests, 0, count);
+
+			int32_t loaded = 0;
+			for (int32_t i = 0; i < count; i++)
+			{
+				if (pRequests[i].succeeded)
+					loaded++;
+			}
+
+			return loaded;
+		}
+
+		///
+		/// Maps an image file and decodes it into a texture.
+		///
+		bool ImageDecoder::LoadFromFile(const std::string &filePath, SoftwareTexture *pTexture, int32_t flags)
+		{
+			HANDLE hFile = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+				OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+			if (hFile == INVALID_HANDLE_VALUE)
+			{
+#if defined(TEKSTORM_DEBUG)
+				TEKDEBUG_W("Unable to open image " << filePath);
+#endif
+				return false;
+			}
+
+			LARGE_INTEGER size;
+			HANDLE hMapping = nullptr;
+			const char *pView = nullptr;
+			if (GetFileSizeEx(hFile, &size) != FALSE && size.QuadPart > 0 && size.QuadPart <= 0x7FFFFFFF)
+			{
+				hMapping = CreateFileMappingA(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+				if (hMapping != nullptr)
+					pView = (const char *)MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+			}
+
+			bool loaded = false;
+			if (pView != nullptr)
+			{
+				loaded = LoadFromMemory(pView, (int32_t)size.QuadPart, pTexture, flags);
+				UnmapViewOfFile(pView);
+			}
+			else
+			{
+#if defined(TEKSTORM_DEBUG)
+				TEKDEBUG_W("Unable to map image " << filePath);
+#endif
+			}
+
+			if (hMapping != nullptr)
+				CloseHandle(hMapping);
+
+			CloseHandle(hFile);
+			return loaded;
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,148 @@
+#pragma once
+#ifndef _TEKSTORM_IMAGEDECODER_H
+#define _TEKSTORM_IMAGEDECODER_H
+#include "../tekconfig.h"
+#include "../core/JobSystem.h"
+#include "SoftwareTexture.h"
+
+namespace Tekstorm
+{
+	namespace Graphics
+	{
+		///
+		/// An image file format.
+		///
+		enum ImageFormat
+		{
+			TEKIMAGE_UNKNOWN = 0,
+			TEKIMAGE_BMP = 1,
+			TEKIMAGE_PNG = 2,
+			TEKIMAGE_TGA = 3,
+			TEKIMAGE_DDS = 4
+		};
+
+		///
+		/// Conversions applied to the pixels as they are decoded, combined with |.
+		///
+		enum ImageDecodeFlags
+		{
+			TEKIMAGE_DEFAULT = 0,
+
+			// Converts the color channels from sRGB to linear.
+			TEKIMAGE_SRGB_TO_LINEAR = 1,
+
+			// Multiplies the color channels by alpha (after TEKIMAGE_SRGB_TO_LINEAR),
+			// for TEKBLEND_PREMULTIPLIED.
+			TEKIMAGE_PREMULTIPLY = 2
+		};
+
+		///
+		/// The format and size of an image, read from its header.
+		///
+		struct ImageInfo
+		{
+			ImageFormat format;
+			int32_t width;
+			int32_t height;
+		};
+
+		///
+		/// An image to decode with ImageDecoder::LoadFromMemory(), in parallel with others.
+		///
+		struct ImageLoadRequest
+		{
+			const char *pData;
+			int32_t size;
+			int32_t flags;
+			SoftwareTexture *pTexture;
+
+			// Set once the image is decoded.
+			bool succeeded;
+		};
+
+		///
+		/// Decodes BMP, PNG, TGA and DDS images into RGBA8 SoftwareTextures.
+		///
+		/// Files are read in place: LoadFromMemory() takes a pointer into a mapped
+		/// file or archive entry, and LoadFromFile() maps the file itself. Each row
+		/// is converted straight into the texture (swizzled with SSE2/SSSE3, then
+		/// linearized and premultiplied as asked) while it is still in cache. PNG
+		/// data is inflated with Inflate across its IDAT chunks without joining
+		/// them.
+		///
+		/// Supported: BMP with 1, 4, 8, 16, 24 or 32 bits per pixel, uncompressed
+		/// or with bit fields; PNG of every color type, bit depth and interlacing;
+		/// TGA color-mapped, true-color and grayscale, uncompressed or RLE; DDS
+		/// BC1-BC3 and 8-bit RGB(A)/BGR(A), top mip level only.
+		///
+		/// Every function is thread-safe, so many images can be decoded at once.
+		///
+		class TEKAPI ImageDecoder
+		{
+		private:
+			///
+			/// No public constructor
+			///
+			ImageDecoder() { }
+
+		public:
+			///
+			/// The largest width and height of an image.
+			///
+			static const int32_t MaxDimension = 16384;
+
+			///
+			/// Detects the format of an image from its header.
+			///
+			static ImageFormat DetectFormat(const char *pData, int32_t size);
+
+			///
+			/// Reads the format and size of an image without decoding it.
+			///
+			static bool GetInfo(const char *pData, int32_t size, ImageInfo *pInfo);
+
+			///
+			/// Decodes an image into a texture, which is resized to fit it.
+			///
+			static bool LoadFromMemory(const char *pData, int32_t size, SoftwareTexture *pTexture, int32_t flags = TEKIMAGE_DEFAULT);
+
+			///
+			/// Decodes images in parallel on the JobSystem (or on this thread
+			/// without one) and waits for them. Returns the number decoded.
+			///
+			static int32_t LoadFromMemory(ImageLoadRequest *pRequests, int32_t count, Core::JobSystem *pJobs);
+
+			///
+			/// Maps an image file and decodes it into a texture.
+			///
+			static bool LoadFromFile(const std::string &filePath, SoftwareTexture *pTexture, int32_t flags = TEKIMAGE_DEFAULT);
+
+			///
+			/// Converts 24-bit R, G, B pixels to opaque RGBA8.
+			///
+			static void ConvertRgbToRgba(const uint8_t *pSource, uint32_t *pDestination, int32_t count);
+
+			///
+			/// Converts 24-bit B, G, R pixels to opaque RGBA8.
+			///
+			static void ConvertBgrToRgba(const uint8_t *pSource, uint32_t *pDestination, int32_t count);
+
+			///
+			/// Converts 32-bit B, G, R, A pixels to RGBA8, optionally ignoring alpha.
+			///
+			static void ConvertBgraToRgba(const uint8_t *pSource, uint32_t *pDestination, int32_t count, bool opaque = false);
+
+			///
+			/// Converts the color channels of RGBA8 pixels from sRGB to linear.
+			///
+			static void ConvertSrgbToLinear(uint32_t *pPixels, int32_t count);
+
+			///
+			/// Multiplies the color channels of RGBA8 pixels by alpha.
+			///
+			static void Premultiply(uint32_t *pPixels, int32_t count);
+		};
+	}
+}
+
+#endif /* _TEKSTORM_IMAGEDECODER_H */
\ No newline at end of file
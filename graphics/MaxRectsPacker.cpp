@@ -0,0 +1,165 @@
+#define TEKSTORM_BUILD
+#include "MaxRectsPacker.h"
+
+namespace Tekstorm
+{
+	namespace Graphics
+	{
+		static inline bool Intersects(const AtlasRect &a, const AtlasRect &b)
+		{
+			return a.x < b.x + b.width && b.x < a.x + a.width && a.y < b.y + b.height && b.y < a.y + a.height;
+		}
+
+		static inline bool Contains(const AtlasRect &outer, const AtlasRect &inner)
+		{
+			return inner.x >= outer.x && inner.y >= outer.y &&
+				inner.x + inner.width <= outer.x + outer.width && inner.y + inner.height <= outer.y + outer.height;
+		}
+
+		static inline AtlasRect MakeRect(int32_t x, int32_t y, int32_t width, int32_t height)
+		{
+			AtlasRect rect = { x, y, width, height };
+			return rect;
+		}
+
+		MaxRectsPacker::MaxRectsPacker()
+		{
+			Reset(0, 0);
+		}
+
+		///
+		/// Creates an empty packer for the given area.
+		///
+		MaxRectsPacker::MaxRectsPacker(int32_t width, int32_t height)
+		{
+			Reset(width, height);
+		}
+
+		///
+		/// Empties the packer and sets its area.
+		///
+		void MaxRectsPacker::Reset(int32_t width, int32_t height)
+		{
+			m_nWidth = width;
+			m_nHeight = height;
+			m_nUsedArea = 0;
+			m_free.clear();
+			if (width > 0 && height > 0)
+				m_free.push_back(MakeRect(0, 0, width, height));
+		}
+
+		///
+		/// Places a rectangle where it leaves the shortest side free.
+		///
+		bool MaxRectsPacker::Insert(int32_t width, int32_t height, AtlasRect *pRect)
+		{
+			if (width <= 0 || height <= 0)
+				return false;
+
+			int32_t best = -1;
+			int32_t bestShortSide = INT32_MAX;
+			int32_t bestLongSide = INT32_MAX;
+			for (size_t i = 0; i < m_free.size(); i++)
+			{
+				const AtlasRect &free = m_free[i];
+				if (free.width < width || free.height < height)
+					continue;
+
+				int32_t leftoverX = free.width - width;
+				int32_t leftoverY = free.height - height;
+				int32_t shortSide = (leftoverX < leftoverY) ? leftoverX : leftoverY;
+				int32_t longSide = (leftoverX < leftoverY) ? leftoverY : leftoverX;
+				if (shortSide < bestShortSide || (shortSide == bestShortSide && longSide < bestLongSide))
+				{
+					best = (int32_t)i;
+					bestShortSide = shortSide;
+					bestLongSide = longSide;
+				}
+			}
+
+			if (best < 0)
+				return false;
+
+			AtlasRect placed = MakeRect(m_free[best].x, m_free[best].y, width, height);
+			SplitFreeRects(placed);
+			m_nUsedArea += (int64_t)width * height;
+			*pRect = placed;
+			return true;
+		}
+
+		///
+		/// Cuts the free rectangles that overlap a placed one into the parts around
+		/// it, then drops the parts contained in others.
+		///
+		void MaxRectsPacker::SplitFreeRects(const AtlasRect &used)
+		{
+			m_split.clear();
+			for (size_t i = 0; i < m_free.size(); )
+			{
+				AtlasRect free = m_free[i];
+				if (!Intersects(free, used))
+				{
+					i++;
+					continue;
+				}
+
+				if (used.x > free.x)
+					m_split.push_back(MakeRect(free.x, free.y, used.x - free.x, free.height));
+				if (used.x + used.width < free.x + free.width)
+					m_split.push_back(MakeRect(used.x + used.width, free.y, free.x + free.width - used.x - used.width, free.height));
+				if (used.y > free.y)
+					m_split.push_back(MakeRect(free.x, free.y, free.width, used.y - free.y));
+				if (used.y + used.height < free.y + free.height)
+					m_split.push_back(MakeRect(free.x, used.y + used.height, free.width, free.y + free.height - used.y - used.height));
+
+				m_free[i] = m_free.back();
+				m_free.pop_back();
+			}
+
+			// the untouched free rectangles were maximal already; only the new parts
+			// can be contained in another rectangle, or contain an old one
+			for (size_t i = 0; i < m_split.size(); i++)
+			{
+				bool contained = false;
+				for (size_t j = 0; j < m_split.size() && !contained; j++)
+				{
+					if (i != j && Contains(m_split[j], m_split[i]))
+					{
+						// of two equal parts, keep the later one
+						contained = !Contains(m_split[i], m_split[j]) || j > i;
+					}
+				}
+
+				for (size_t j = 0; j < m_free.size() && !contained; j++)
+					contained = Contains(m_free[j], m_split[i]);
+
+				if (contained)
+					continue;
+
+				for (size_t j = 0; j < m_free.size(); )
+				{
+					if (Contains(m_split[i], m_free[j]))
+					{
+						m_free[j] = m_free.back();
+						m_free.pop_back();
+					}
+					else
+					{
+						j++;
+					}
+				}
+
+				m_free.push_back(m_split[i]);
+			}
+		}
+
+		///
+		/// Gets the fraction of the area that is used, from 0 to 1.
+		///
+		float MaxRectsPacker::GetOccupancy() const
+		{
+			int64_t area = (int64_t)m_nWidth * m_nHeight;
+			return (area > 0) ? (float)((double)m_nUsedArea / (double)area) : 0.0f;
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,89 @@
+#pragma once
+#ifndef _TEKSTORM_MAXRECTSPACKER_H
+#define _TEKSTORM_MAXRECTSPACKER_H
+#include "../tekconfig.h"
+
+namespace Tekstorm
+{
+	namespace Graphics
+	{
+		///
+		/// A rectangle of pixels.
+		///
+		struct AtlasRect
+		{
+			int32_t x;
+			int32_t y;
+			int32_t width;
+			int32_t height;
+		};
+
+		///
+		/// Packs rectangles into a fixed area with the MaxRects algorithm: it keeps
+		/// the maximal free rectangles (which may overlap) and places each new
+		/// rectangle where it leaves the shortest side free (best short side fit).
+		/// Rectangles are never rotated.
+		///
+		class TEKAPI MaxRectsPacker
+		{
+		protected:
+			int32_t m_nWidth;
+			int32_t m_nHeight;
+
+			// The maximal free rectangles.
+			std::vector<AtlasRect> m_free;
+
+			// Free rectangles cut off by the last placement, before pruning.
+			std::vector<AtlasRect> m_split;
+
+			// The area of the placed rectangles.
+			int64_t m_nUsedArea;
+
+			///
+			/// Cuts the free rectangles that overlap a placed one into the parts
+			/// around it, then drops the parts contained in others.
+			///
+			void SplitFreeRects(const AtlasRect &used);
+
+		public:
+			MaxRectsPacker();
+
+			///
+			/// Creates an empty packer for the given area.
+			///
+			MaxRectsPacker(int32_t width, int32_t height);
+
+			///
+			/// Empties the packer and sets its area.
+			///
+			void Reset(int32_t width, int32_t height);
+
+			///
+			/// Places a rectangle of the given size. Returns false if it does not fit.
+			///
+			bool Insert(int32_t width, int32_t height, AtlasRect *pRect);
+
+			///
+			/// Gets the width of the area.
+			///
+			int32_t GetWidth() const { return m_nWidth; }
+
+			///
+			/// Gets the height of the area.
+			///
+			int32_t GetHeight() const { return m_nHeight; }
+
+			///
+			/// Gets the area of the placed rectangles.
+			///
+			int64_t GetUsedArea() const { return m_nUsedArea; }
+
+			///
+			/// Gets the fraction of the area that is used, from 0 to 1.
+			///
+			float GetOccupancy() const;
+		};
+	}
+}
+
+#endif /* _TEKSTORM_MAXRECTSPACKER_H */
\ No newline at end of file
@@ -0,0 +1,527 @@
+#define TEKSTORM_BUILD
+#include "SoftwareGraphicsDevice.h"
+#include "../IO/FileStream.h"
+#include <algorithm>
+#include <math.h>
+#include <emmintrin.h>
+
+namespace Tekstorm
+{
+	namespace Graphics
+	{
+		using namespace Tekstorm::Core;
+		using namespace Tekstorm::Math;
+		using Tekstorm::IO::FileStream;
+
+		///
+		/// Vertex positions are snapped to 1/16 of a pixel, so edges that vertices
+		/// share give exactly the same coverage on both sides.
+		///
+		static const float SubpixelSteps = 16.0f;
+
+		///
+		/// The number of interpolated attributes: r, g, b, a, u, v.
+		///
+		static const int32_t AttributeCount = 6;
+
+		static inline float SnapPosition(float value)
+		{
+			return floorf(value * SubpixelSteps + 0.5f) / SubpixelSteps;
+		}
+
+		///
+		/// Unpacks four RGBA8 pixels into channels in [0, 1].
+		///
+		static inline void UnpackPixels(__m128i pixels, __m128 &r, __m128 &g, __m128 &b, __m128 &a)
+		{
+			const __m128i byteMask = _mm_set1_epi32(0xFF);
+			const __m128 scale = _mm_set1_ps(1.0f / 255.0f);
+			r = _mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(pixels, byteMask)), scale);
+			g = _mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(pixels, 8), byteMask)), scale);
+			b = _mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(pixels, 16), byteMask)), scale);
+			a = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(pixels, 24)), scale);
+		}
+
+		///
+		/// Converts four channel values to bytes, clamping them to [0, 1].
+		///
+		static inline __m128i ChannelsToBytes(__m128 value)
+		{
+			value = _mm_min_ps(_mm_max_ps(value, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+			return _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(value, _mm_set1_ps(255.0f)), _mm_set1_ps(0.5f)));
+		}
+
+		///
+		/// Packs four pixels' channels into RGBA8.
+		///
+		static inline __m128i PackPixels(__m128 r, __m128 g, __m128 b, __m128 a)
+		{
+			__m128i pixels = ChannelsToBytes(r);
+			pixels = _mm_or_si128(pixels, _mm_slli_epi32(ChannelsToBytes(g), 8));
+			pixels = _mm_or_si128(pixels, _mm_slli_epi32(ChannelsToBytes(b), 16));
+			return _mm_or_si128(pixels, _mm_slli_epi32(ChannelsToBytes(a), 24));
+		}
+
+		///
+		/// Creates a device with a framebuffer of the given size.
+		///
+		SoftwareGraphicsDevice::SoftwareGraphicsDevice(int32_t width, int32_t height, JobSystem *pJobs)
+		{
+			if (width < 1)
+				width = 1;
+			if (height < 1)
+				height = 1;
+
+			m_nWidth = width;
+			m_nHeight = height;
+			m_nTilesX = (width + TileSize - 1) / TileSize;
+			m_nTilesY = (height + TileSize - 1) / TileSize;
+			m_nPitch = m_nTilesX * TileSize;
+			m_framebuffer.assign((size_t)m_nPitch * m_nTilesY * TileSize, 0);
+			m_bins.resize(m_nTilesX * m_nTilesY);
+			m_pJobs = pJobs;
+			m_pTexture = nullptr;
+			m_blend = TEKBLEND_OPAQUE;
+			m_nClearPixel = 0;
+		}
+
+		///
+		/// Runs a ParallelFor body on the JobSystem, or on this thread without one.
+		///
+		void SoftwareGraphicsDevice::Run(int32_t count, ParallelForFunction function)
+		{
+			if (m_pJobs != nullptr && count > 1)
+				m_pJobs->ParallelFor(count, function, this, 1);
+			else
+				function(this, 0, count);
+		}
+
+		///
+		/// Draws what was submitted so far, then fills the framebuffer with a color.
+		///
+		void SoftwareGraphicsDevice::Clear(const Color4 &color)
+		{
+			Present();
+			m_nClearPixel = SoftwareTexture::PackColor(color);
+			Run(m_nTilesY, &SoftwareGraphicsDevice::ClearRows);
+		}
+
+		///
+		/// Fills the tile rows [begin, end) with the clear pixel.
+		///
+		void SoftwareGraphicsDevice::ClearRows(void *pData, int32_t begin, int32_t end)
+		{
+			SoftwareGraphicsDevice *pDevice = (SoftwareGraphicsDevice *)pData;
+			size_t first = (size_t)begin * TileSize * pDevice->m_nPitch;
+			size_t last = (size_t)end * TileSize * pDevice->m_nPitch;
+			std::fill(pDevice->m_framebuffer.begin() + first, pDevice->m_framebuffer.begin() + last, pDevice->m_nClearPixel);
+		}
+
+		///
+		/// Sets the texture later draws are modulated by, or nullptr for none.
+		///
+		void SoftwareGraphicsDevice::SetTexture(TextureKey texture)
+		{
+			m_pTexture = static_cast<const SoftwareTexture *>(texture);
+		}
+
+		///
+		/// Sets how later draws are combined with the framebuffer.
+		///
+		void SoftwareGraphicsDevice::SetBlendMode(BlendMode blend)
+		{
+			m_blend = blend;
+		}
+
+		///
+		/// Submits a list of triangles, three vertices each.
+		///
+		void SoftwareGraphicsDevice::Draw(const SpriteVertex *pVertices, int32_t vertexCount)
+		{
+			for (int32_t i = 0; i + 2 < vertexCount; i += 3)
+				AddTriangle(pVertices[i], pVertices[i + 1], pVertices[i + 2]);
+		}
+
+		///
+		/// Submits a list of indexed triangles; indices are offset by baseVertex.
+		///
+		void SoftwareGraphicsDevice::DrawIndexed(const SpriteVertex *pVertices, const uint16_t *pIndices, int32_t indexCount, int32_t baseVertex)
+		{
+			const SpriteVertex *pBase = pVertices + baseVertex;
+			for (int32_t i = 0; i + 2 < indexCount; i += 3)
+				AddTriangle(pBase[pIndices[i]], pBase[pIndices[i + 1]], pBase[pIndices[i + 2]]);
+		}
+
+		///
+		/// Sets up a triangle and adds it to the bins of the tiles it touches.
+		///
+		void SoftwareGraphicsDevice::AddTriangle(const SpriteVertex &v0, const SpriteVertex &v1, const SpriteVertex &v2)
+		{
+			const SpriteVertex *pVertices[3] = { &v0, &v1, &v2 };
+			float x[3];
+			float y[3];
+			for (int32_t i = 0; i < 3; i++)
+			{
+				x[i] = SnapPosition(pVertices[i]->x);
+				y[i] = SnapPosition(pVertices[i]->y);
+			}
+
+			// both windings are drawn; flip counter-clockwise triangles
+			float area = (x[1] - x[0]) * (y[2] - y[0]) - (y[1] - y[0]) * (x[2] - x[0]);
+			if (area == 0)
+				return;
+
+			if (area < 0)
+			{
+				std::swap(pVertices[1], pVertices[2]);
+				std::swap(x[1], x[2]);
+				std::swap(y[1], y[2]);
+				area = -area;
+			}
+
+			SoftwareTriangle triangle;
+
+			// edge i runs from vertex i to the next one; it is positive on the inside.
+			// C is taken from the same endpoint whichever way the edge runs, so a
+			// neighbouring triangle gets exactly the negated function and every pixel
+			// on a shared edge is drawn once
+			for (int32_t i = 0; i < 3; i++)
+			{
+				int32_t next = (i + 1) % 3;
+				float a = y[i] - y[next];
+				float b = x[next] - x[i];
+				int32_t origin = (y[i] < y[next] || (y[i] == y[next] && x[i] < x[next])) ? i : next;
+				triangle.edgeA[i] = a;
+				triangle.edgeB[i] = b;
+				triangle.edgeC[i] = -(a * x[origin] + b * y[origin]);
+				triangle.topLeft[i] = a > 0 || (a == 0 && b > 0);
+			}
+
+			// the weight of a vertex is the edge opposite it over the area
+			const float inverseArea = 1.0f / area;
+			for (int32_t j = 0; j < AttributeCount; j++)
+			{
+				float values[3];
+				for (int32_t i = 0; i < 3; i++)
+				{
+					const SpriteVertex &vertex = *pVertices[i];
+					const float attributes[AttributeCount] = { vertex.r, vertex.g, vertex.b, vertex.a, vertex.tu, vertex.tv };
+					values[i] = attributes[j] * inverseArea;
+				}
+
+				triangle.planeA[j] = triangle.edgeA[1] * values[0] + triangle.edgeA[2] * values[1] + triangle.edgeA[0] * values[2];
+				triangle.planeB[j] = triangle.edgeB[1] * values[0] + triangle.edgeB[2] * values[1] + triangle.edgeB[0] * values[2];
+				triangle.planeC[j] = triangle.edgeC[1] * values[0] + triangle.edgeC[2] * values[1] + triangle.edgeC[0] * values[2];
+			}
+
+			float minX = (x[0] < x[1]) ? x[0] : x[1];
+			float maxX = (x[0] > x[1]) ? x[0] : x[1];
+			float minY = (y[0] < y[1]) ? y[0] : y[1];
+			float maxY = (y[0] > y[1]) ? y[0] : y[1];
+			minX = (x[2] < minX) ? x[2] : minX;
+			maxX = (x[2] > maxX) ? x[2] : maxX;
+			minY = (y[2] < minY) ? y[2] : minY;
+			maxY = (y[2] > maxY) ? y[2] : maxY;
+
+			triangle.minX = (minX > 0) ? (int32_t)minX : 0;
+			triangle.minY = (minY > 0) ? (int32_t)minY : 0;
+			triangle.maxX = (maxX < (float)(m_nWidth - 1)) ? (int32_t)ceilf(maxX) : m_nWidth - 1;
+			triangle.maxY = (maxY < (float)(m_nHeight - 1)) ? (int32_t)ceilf(maxY) : m_nHeight - 1;
+			if (triangle.minX > triangle.maxX || triangle.minY > triangle.maxY)
+				return;
+
+			triangle.pTexture = m_pTexture;
+			triangle.blend = m_blend;
+
+			int32_t index = (int32_t)m_triangles.size();
+			m_triangles.push_back(triangle);
+
+			// bin into the tiles of the bounding box, skipping tiles that lie wholly
+			// outside an edge; the test evaluates the nearest pixel center exactly as
+			// the rasterizer would
+			for (int32_t tileY = triangle.minY / TileSize; tileY <= triangle.maxY / TileSize; tileY++)
+			{
+				float top = (float)(tileY * TileSize) + 0.5f;
+				float bottom = top + (float)(TileSize - 1);
+				for (int32_t tileX = triangle.minX / TileSize; tileX <= triangle.maxX / TileSize; tileX++)
+				{
+					float left = (float)(tileX * TileSize) + 0.5f;
+					float right = left + (float)(TileSize - 1);
+
+					bool outside = false;
+					for (int32_t i = 0; i < 3 && !outside; i++)
+					{
+						float a = triangle.edgeA[i];
+						float b = triangle.edgeB[i];
+						float nearestX = (a > 0) ? right : left;
+						float nearestY = (b > 0) ? bottom : top;
+						outside = a * nearestX + (b * nearestY + triangle.edgeC[i]) < 0;
+					}
+
+					if (!outside)
+						m_bins[tileY * m_nTilesX + tileX].push_back(index);
+				}
+			}
+		}
+
+		///
+		/// Rasterizes the tiles [begin, end).
+		///
+		void SoftwareGraphicsDevice::RasterizeTiles(void *pData, int32_t begin, int32_t end)
+		{
+			SoftwareGraphicsDevice *pDevice = (SoftwareGraphicsDevice *)pData;
+			for (int32_t tile = begin; tile < end; tile++)
+				pDevice->RasterizeTile(tile);
+		}
+
+		///
+		/// Rasterizes the binned triangles of a tile, four pixels at a time.
+		///
+		void SoftwareGraphicsDevice::RasterizeTile(int32_t tile)
+		{
+			const std::vector<int32_t> &bin = m_bins[tile];
+			int32_t tileLeft = (tile % m_nTilesX) * TileSize;
+			int32_t tileTop = (tile / m_nTilesX) * TileSize;
+
+			const __m128 zero = _mm_setzero_ps();
+			const __m128 one = _mm_set1_ps(1.0f);
+			const __m128 allBits = _mm_castsi128_ps(_mm_set1_epi32(-1));
+			const __m128 laneOffsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+
+			for (size_t n = 0; n < bin.size(); n++)
+			{
+				const SoftwareTriangle &triangle = m_triangles[bin[n]];
+				int32_t minX = (triangle.minX > tileLeft) ? triangle.minX : tileLeft;
+				int32_t minY = (triangle.minY > tileTop) ? triangle.minY : tileTop;
+				int32_t maxX = (triangle.maxX < tileLeft + TileSize - 1) ? triangle.maxX : tileLeft + TileSize - 1;
+				int32_t maxY = (triangle.maxY < tileTop + TileSize - 1) ? triangle.maxY : tileTop + TileSize - 1;
+
+				__m128 edgeA[3];
+				__m128 topLeft[3];
+				for (int32_t i = 0; i < 3; i++)
+				{
+					edgeA[i] = _mm_set1_ps(triangle.edgeA[i]);
+					topLeft[i] = triangle.topLeft[i] ? allBits : zero;
+				}
+
+				__m128 planeA[AttributeCount];
+				for (int32_t j = 0; j < AttributeCount; j++)
+					planeA[j] = _mm_set1_ps(triangle.planeA[j]);
+
+				const SoftwareTexture *pTexture = triangle.pTexture;
+				const uint32_t *pTexels = nullptr;
+				int32_t textureWidth = 0;
+				__m128 textureSize[2];
+				__m128 textureMax[2];
+				if (pTexture != nullptr && pTexture->GetPixels() != nullptr)
+				{
+					pTexels = pTexture->GetPixels();
+					textureWidth = pTexture->GetWidth();
+					textureSize[0] = _mm_set1_ps((float)pTexture->GetWidth());
+					textureSize[1] = _mm_set1_ps((float)pTexture->GetHeight());
+					textureMax[0] = _mm_set1_ps((float)(pTexture->GetWidth() - 1));
+					textureMax[1] = _mm_set1_ps((float)(pTexture->GetHeight() - 1));
+				}
+
+				// the tile is aligned to four pixels, so groups never leave it
+				int32_t startX = minX & ~3;
+				for (int32_t y = minY; y <= maxY; y++)
+				{
+					float centerY = (float)y + 0.5f;
+					__m128 rowEdge[3];
+					__m128 rowPlane[AttributeCount];
+					for (int32_t i = 0; i < 3; i++)
+						rowEdge[i] = _mm_set1_ps(triangle.edgeB[i] * centerY + triangle.edgeC[i]);
+					for (int32_t j = 0; j < AttributeCount; j++)
+						rowPlane[j] = _mm_set1_ps(triangle.planeB[j] * centerY + triangle.planeC[j]);
+
+					uint32_t *pRow = &m_framebuffer[(size_t)y * m_nPitch];
+					for (int32_t x = startX; x <= maxX; x += 4)
+					{
+						__m128 centerX = _mm_add_ps(_mm_set1_ps((float)x), laneOffsets);
+
+						// covered where every edge is positive, or zero on a top or left edge
+						__m128 covered = allBits;
+						for (int32_t i = 0; i < 3; i++)
+						{
+							__m128 edge = _mm_add_ps(_mm_mul_ps(edgeA[i], centerX), rowEdge[i]);
+							__m128 inside = _mm_or_ps(_mm_cmpgt_ps(edge, zero), _mm_and_ps(_mm_cmpeq_ps(edge, zero), topLeft[i]));
+							covered = _mm_and_ps(covered, inside);
+						}
+
+						if (_mm_movemask_ps(covered) == 0)
+							continue;
+
+						__m128 attributes[AttributeCount];
+						for (int32_t j = 0; j < AttributeCount; j++)
+							attributes[j] = _mm_add_ps(_mm_mul_ps(planeA[j], centerX), rowPlane[j]);
+
+						__m128 sourceR = attributes[0];
+						__m128 sourceG = attributes[1];
+						__m128 sourceB = attributes[2];
+						__m128 sourceA = attributes[3];
+
+						// modulate by the nearest texel
+						if (pTexels != nullptr)
+						{
+							__m128i texelX = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(_mm_mul_ps(attributes[4], textureSize[0]), zero), textureMax[0]));
+							__m128i texelY = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(_mm_mul_ps(attributes[5], textureSize[1]), zero), textureMax[1]));
+
+							int32_t columns[4];
+							int32_t rows[4];
+							_mm_storeu_si128((__m128i *)columns, texelX);
+							_mm_storeu_si128((__m128i *)rows, texelY);
+
+							__m128i texels = _mm_setr_epi32(
+								(int)pTexels[rows[0] * textureWidth + columns[0]], (int)pTexels[rows[1] * textureWidth + columns[1]],
+								(int)pTexels[rows[2] * textureWidth + columns[2]], (int)pTexels[rows[3] * textureWidth + columns[3]]);
+
+							__m128 texelR, texelG, texelB, texelA;
+							UnpackPixels(texels, texelR, texelG, texelB, texelA);
+							sourceR = _mm_mul_ps(sourceR, texelR);
+							sourceG = _mm_mul_ps(sourceG, texelG);
+							sourceB = _mm_mul_ps(sourceB, texelB);
+							sourceA = _mm_mul_ps(sourceA, texelA);
+						}
+
+						__m128i destination = _mm_loadu_si128((const __m128i *)&pRow[x]);
+						__m128 outR = sourceR;
+						__m128 outG = sourceG;
+						__m128 outB = sourceB;
+						__m128 outA = sourceA;
+						if (triangle.blend != TEKBLEND_OPAQUE)
+						{
+							__m128 destinationR, destinationG, destinationB, destinationA;
+							UnpackPixels(destination, destinationR, destinationG, destinationB, destinationA);
+
+							sourceA = _mm_min_ps(_mm_max_ps(sourceA, zero), one);
+							__m128 inverseA = _mm_sub_ps(one, sourceA);
+							if (triangle.blend == TEKBLEND_ALPHA)
+							{
+								outR = _mm_add_ps(_mm_mul_ps(sourceR, sourceA), _mm_mul_ps(destinationR, inverseA));
+								outG = _mm_add_ps(_mm_mul_ps(sourceG, sourceA), _mm_mul_ps(destinationG, inverseA));
+								outB = _mm_add_ps(_mm_mul_ps(sourceB, sourceA), _mm_mul_ps(destinationB, inverseA));
+								outA = _mm_add_ps(sourceA, _mm_mul_ps(destinationA, inverseA));
+							}
+							else if (triangle.blend == TEKBLEND_ADDITIVE)
+							{
+								outR = _mm_add_ps(destinationR, _mm_mul_ps(sourceR, sourceA));
+								outG = _mm_add_ps(destinationG, _mm_mul_ps(sourceG, sourceA));
+								outB = _mm_add_ps(destinationB, _mm_mul_ps(sourceB, sourceA));
+								outA = _mm_add_ps(destinationA, sourceA);
+							}
+							else
+							{
+								outR = _mm_add_ps(sourceR, _mm_mul_ps(destinationR, inverseA));
+								outG = _mm_add_ps(sourceG, _mm_mul_ps(destinationG, inverseA));
+								outB = _mm_add_ps(sourceB, _mm_mul_ps(destinationB, inverseA));
+								outA = _mm_add_ps(sourceA, _mm_mul_ps(destinationA, inverseA));
+							}
+						}
+
+						__m128i mask = _mm_castps_si128(covered);
+						__m128i result = PackPixels(outR, outG, outB, outA);
+						result = _mm_or_si128(_mm_and_si128(mask, result), _mm_andnot_si128(mask, destination));
+						_mm_storeu_si128((__m128i *)&pRow[x], result);
+					}
+				}
+			}
+		}
+
+		///
+		/// Rasterizes everything submitted since the last Present().
+		///
+		void SoftwareGraphicsDevice::Present()
+		{
+			if (m_triangles.empty())
+				return;
+
+			Run(m_nTilesX * m_nTilesY, &SoftwareGraphicsDevice::RasterizeTiles);
+
+			// keep the bins' capacity for the next frame
+			m_triangles.clear();
+			for (size_t i = 0; i < m_bins.size(); i++)
+				m_bins[i].clear();
+		}
+
+		///
+		/// Writes a little-endian value into a header.
+		///
+		template <class _ValueType>
+		static void PutValue(char *pDestination, _ValueType value)
+		{
+			memcpy(pDestination, &value, sizeof(_ValueType));
+		}
+
+		///
+		/// Saves the framebuffer as a 24-bit BMP.
+		///
+		bool SoftwareGraphicsDevice::SaveScreenshot(const std::string &filePath) const
+		{
+			const int32_t headerSize = 14 + 40;
+			int32_t rowSize = (m_nWidth * 3 + 3) & ~3;
+
+			char header[headerSize];
+			memset(header, 0, headerSize);
+			header[0] = 'B';
+			header[1] = 'M';
+			PutValue<uint32_t>(&header[2], (uint32_t)(headerSize + rowSize * m_nHeight));
+			PutValue<uint32_t>(&header[10], (uint32_t)headerSize);
+			PutValue<uint32_t>(&header[14], 40);
+			PutValue<int32_t>(&header[18], m_nWidth);
+			PutValue<int32_t>(&header[22], m_nHeight);
+			PutValue<uint16_t>(&header[26], 1);
+			PutValue<uint16_t>(&header[28], 24);
+			PutValue<uint32_t>(&header[34], (uint32_t)(rowSize * m_nHeight));
+
+			FileStream stream(filePath, "wb");
+			if (!stream.IsOpen() || stream.Write(header, headerSize) != headerSize)
+				return false;
+
+			// rows are stored bottom-up, as BGR
+			std::vector<char> row(rowSize, 0);
+			for (int32_t y = m_nHeight - 1; y >= 0; y--)
+			{
+				const uint32_t *pPixels = &m_framebuffer[(size_t)y * m_nPitch];
+				for (int32_t x = 0; x < m_nWidth; x++)
+				{
+					row[x * 3 + 0] = (char)(pPixels[x] >> 16);
+					row[x * 3 + 1] = (char)(pPixels[x] >> 8);
+					row[x * 3 + 2] = (char)pPixels[x];
+				}
+
+				if (stream.Write(&row[0], rowSize) != rowSize)
+					return false;
+			}
+
+			return true;
+		}
+
+		///
+		/// Compares the framebuffer with a reference image of the same size.
+		///
+		int32_t SoftwareGraphicsDevice::Compare(const uint32_t *pReference, int32_t tolerance) const
+		{
+			int32_t mismatches = 0;
+			for (int32_t y = 0; y < m_nHeight; y++)
+			{
+				const uint32_t *pPixels = &m_framebuffer[(size_t)y * m_nPitch];
+				const uint32_t *pExpected = &pReference[(size_t)y * m_nWidth];
+				for (int32_t x = 0; x < m_nWidth; x++)
+				{
+					for (int32_t shift = 0; shift < 24; shift += 8)
+					{
+						int32_t difference = (int32_t)((pPixels[x] >> shift) & 0xFF) - (int32_t)((pExpected[x] >> shift) & 0xFF);
+						if (difference > tolerance || difference < -tolerance)
+						{
+							mismatches++;
+							break;
+						}
+					}
+				}
+			}
+
+			return mismatches;
+		}
+	}
+}
\ No newline at end of file
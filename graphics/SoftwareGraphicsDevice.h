@@ -0,0 +1,197 @@
+#pragma once
+#ifndef _TEKSTORM_SOFTWAREGRAPHICSDEVICE_H
+#define _TEKSTORM_SOFTWAREGRAPHICSDEVICE_H
+#include "../tekconfig.h"
+#include "../math/Color4.h"
+#include "../core/JobSystem.h"
+#include "SoftwareTexture.h"
+#include "SpriteBatch.h"
+
+namespace Tekstorm
+{
+	namespace Graphics
+	{
+		///
+		/// A triangle set up for rasterization: three edge functions and a plane for
+		/// each attribute (r, g, b, a, u, v), all of the form A * x + B * y + C.
+		///
+		struct SoftwareTriangle
+		{
+			float edgeA[3];
+			float edgeB[3];
+			float edgeC[3];
+
+			// Whether or not pixel centers exactly on each edge are covered (the top-left rule).
+			bool topLeft[3];
+
+			float planeA[6];
+			float planeB[6];
+			float planeC[6];
+
+			// The covered pixels lie within [minX, maxX] x [minY, maxY].
+			int32_t minX;
+			int32_t minY;
+			int32_t maxX;
+			int32_t maxY;
+
+			const SoftwareTexture *pTexture;
+			BlendMode blend;
+		};
+
+		///
+		/// A graphics device that renders into a framebuffer in system memory, for
+		/// tests, tools and servers without a GPU.
+		///
+		/// Draws take SpriteVertex triangles in pixel coordinates, colored and
+		/// optionally modulated by a nearest-sampled texture. They are set up and
+		/// binned into 64x64 tiles as they are submitted; Present() then rasterizes
+		/// the tiles in parallel on the JobSystem, four pixels at a time with SSE
+		/// edge functions. Each tile is drawn by one thread in submission order, so
+		/// blending is deterministic and the result does not depend on the thread
+		/// count.
+		///
+		/// The framebuffer is RGBA8, laid out like SoftwareTexture, with GetPitch()
+		/// pixels to a row.
+		///
+		class TEKAPI SoftwareGraphicsDevice
+		{
+		public:
+			///
+			/// The width and height, in pixels, of a tile.
+			///
+			static const int32_t TileSize = 64;
+
+		protected:
+			int32_t m_nWidth;
+			int32_t m_nHeight;
+
+			// The framebuffer covers whole tiles; the pitch is a multiple of TileSize.
+			int32_t m_nPitch;
+			int32_t m_nTilesX;
+			int32_t m_nTilesY;
+			std::vector<uint32_t> m_framebuffer;
+
+			// Rasterizes tiles in parallel, or nullptr to rasterize on the calling thread.
+			Core::JobSystem *m_pJobs;
+
+			const SoftwareTexture *m_pTexture;
+			BlendMode m_blend;
+
+			// The triangles submitted since the last Present(), and the indices of
+			// those touching each tile.
+			std::vector<SoftwareTriangle> m_triangles;
+			std::vector<std::vector<int32_t> > m_bins;
+
+			// The pixel Clear() fills with.
+			uint32_t m_nClearPixel;
+
+			///
+			/// Software devices are not copyable.
+			///
+			SoftwareGraphicsDevice(const SoftwareGraphicsDevice &other);
+			SoftwareGraphicsDevice &operator=(const SoftwareGraphicsDevice &other);
+
+			///
+			/// Sets up a triangle and adds it to the bins of the tiles it touches.
+			///
+			void AddTriangle(const SpriteVertex &v0, const SpriteVertex &v1, const SpriteVertex &v2);
+
+			///
+			/// Rasterizes the binned triangles of a tile.
+			///
+			void RasterizeTile(int32_t tile);
+
+			///
+			/// Rasterizes the tiles [begin, end) (a ParallelFor body).
+			///
+			static void RasterizeTiles(void *pData, int32_t begin, int32_t end);
+
+			///
+			/// Fills the tile rows [begin, end) with the clear pixel (a ParallelFor body).
+			///
+			static void ClearRows(void *pData, int32_t begin, int32_t end);
+
+			///
+			/// Runs a ParallelFor body on the JobSystem, or on this thread without one.
+			///
+			void Run(int32_t count, Core::ParallelForFunction function);
+
+		public:
+			///
+			/// Creates a device with a framebuffer of the given size.
+			///
+			SoftwareGraphicsDevice(int32_t width, int32_t height, Core::JobSystem *pJobs = nullptr);
+
+			///
+			/// Gets the width, in pixels, of the framebuffer.
+			///
+			int32_t GetWidth() const { return m_nWidth; }
+
+			///
+			/// Gets the height, in pixels, of the framebuffer.
+			///
+			int32_t GetHeight() const { return m_nHeight; }
+
+			///
+			/// Gets the number of pixels from one framebuffer row to the next.
+			///
+			int32_t GetPitch() const { return m_nPitch; }
+
+			///
+			/// Gets the framebuffer. It is complete after Present().
+			///
+			const uint32_t *GetPixels() const { return &m_framebuffer[0]; }
+
+			///
+			/// Gets a framebuffer pixel.
+			///
+			uint32_t GetPixel(int32_t x, int32_t y) const { return m_framebuffer[(size_t)y * m_nPitch + x]; }
+
+			///
+			/// Draws what was submitted so far, then fills the framebuffer with a color.
+			///
+			void Clear(const Math::Color4 &color);
+
+			///
+			/// Sets the texture later draws are modulated by, or nullptr for none. The key
+			/// is a SoftwareTexture *, as put in a SpriteBatch or TextureAtlas page.
+			///
+			void SetTexture(TextureKey texture);
+
+			///
+			/// Sets how later draws are combined with the framebuffer.
+			///
+			void SetBlendMode(BlendMode blend);
+
+			///
+			/// Submits a list of triangles, three vertices each.
+			///
+			void Draw(const SpriteVertex *pVertices, int32_t vertexCount);
+
+			///
+			/// Submits a list of indexed triangles; indices are offset by baseVertex.
+			///
+			void DrawIndexed(const SpriteVertex *pVertices, const uint16_t *pIndices, int32_t indexCount, int32_t baseVertex = 0);
+
+			///
+			/// Rasterizes everything submitted since the last Present().
+			///
+			void Present();
+
+			///
+			/// Saves the framebuffer as a 24-bit BMP. Returns false if the file could
+			/// not be written.
+			///
+			bool SaveScreenshot(const std::string &filePath) const;
+
+			///
+			/// Compares the framebuffer with a reference image of the same size, in
+			/// tightly packed RGBA8 rows. Returns the number of pixels where a color
+			/// channel differs by more than tolerance; alpha is ignored.
+			///
+			int32_t Compare(const uint32_t *pReference, int32_t tolerance = 0) const;
+		};
+	}
+}
+
+#endif /* _TEKSTORM_SOFTWAREGRAPHICSDEVICE_H */
\ No newline at end of file
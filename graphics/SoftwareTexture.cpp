@@ -0,0 +1,80 @@
+#define TEKSTORM_BUILD
+#include "SoftwareTexture.h"
+
+namespace Tekstorm
+{
+	namespace Graphics
+	{
+		using namespace Tekstorm::Math;
+
+		///
+		/// Converts a channel in [0, 1] to a byte.
+		///
+		static inline uint32_t ChannelToByte(tekreal value)
+		{
+			if (value <= 0)
+				return 0;
+			if (value >= 1)
+				return 255;
+
+			return (uint32_t)(value * 255 + (tekreal)0.5);
+		}
+
+		SoftwareTexture::SoftwareTexture()
+		{
+			m_nWidth = 0;
+			m_nHeight = 0;
+		}
+
+		///
+		/// Creates a texture of the given size, cleared to transparent black.
+		///
+		SoftwareTexture::SoftwareTexture(int32_t width, int32_t height)
+		{
+			m_nWidth = 0;
+			m_nHeight = 0;
+			Create(width, height);
+		}
+
+		///
+		/// Resizes the texture, clearing it to transparent black.
+		///
+		void SoftwareTexture::Create(int32_t width, int32_t height)
+		{
+			if (width < 0)
+				width = 0;
+			if (height < 0)
+				height = 0;
+
+			m_nWidth = width;
+			m_nHeight = height;
+			m_pixels.assign((size_t)width * height, 0);
+		}
+
+		///
+		/// Copies RGBA8 pixels into the texture.
+		///
+		void SoftwareTexture::SetData(const void *pPixels, int32_t pitch)
+		{
+			const char *pSource = (const char *)pPixels;
+			for (int32_t y = 0; y < m_nHeight; y++)
+				memcpy(&m_pixels[(size_t)y * m_nWidth], pSource + (size_t)y * pitch, (size_t)m_nWidth * sizeof(uint32_t));
+		}
+
+		///
+		/// Packs a color into an RGBA8 pixel.
+		///
+		uint32_t SoftwareTexture::PackColor(const Color4 &color)
+		{
+			return ChannelToByte(color.R) | (ChannelToByte(color.G) << 8) | (ChannelToByte(color.B) << 16) | (ChannelToByte(color.A) << 24);
+		}
+
+		///
+		/// Unpacks an RGBA8 pixel into a color.
+		///
+		Color4 SoftwareTexture::UnpackColor(uint32_t pixel)
+		{
+			return Color4((int)(pixel & 0xFF), (int)((pixel >> 8) & 0xFF), (int)((pixel >> 16) & 0xFF), (int)(pixel >> 24));
+		}
+	}
+}
\ No newline at end of file
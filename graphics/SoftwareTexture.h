@@ -0,0 +1,72 @@
+#pragma once
+#ifndef _TEKSTORM_SOFTWARETEXTURE_H
+#define _TEKSTORM_SOFTWARETEXTURE_H
+#include "../tekconfig.h"
+#include "../math/Color4.h"
+
+namespace Tekstorm
+{
+	namespace Graphics
+	{
+		///
+		/// A texture in system memory, for the SoftwareGraphicsDevice.
+		///
+		/// Pixels are 8-bit RGBA, stored R, G, B, A in memory (the layout of
+		/// DXGI_FORMAT_R8G8B8A8_UNORM), in tightly packed rows from the top.
+		///
+		class TEKAPI SoftwareTexture
+		{
+		protected:
+			int32_t m_nWidth;
+			int32_t m_nHeight;
+			std::vector<uint32_t> m_pixels;
+
+		public:
+			SoftwareTexture();
+
+			///
+			/// Creates a texture of the given size, cleared to transparent black.
+			///
+			SoftwareTexture(int32_t width, int32_t height);
+
+			///
+			/// Resizes the texture, clearing it to transparent black.
+			///
+			void Create(int32_t width, int32_t height);
+
+			///
+			/// Copies RGBA8 pixels into the texture. pitch is the size, in bytes, of
+			/// a source row.
+			///
+			void SetData(const void *pPixels, int32_t pitch);
+
+			///
+			/// Gets the width, in pixels.
+			///
+			int32_t GetWidth() const { return m_nWidth; }
+
+			///
+			/// Gets the height, in pixels.
+			///
+			int32_t GetHeight() const { return m_nHeight; }
+
+			///
+			/// Gets the pixels, GetWidth() to a row.
+			///
+			uint32_t *GetPixels() { return m_pixels.empty() ? nullptr : &m_pixels[0]; }
+			const uint32_t *GetPixels() const { return m_pixels.empty() ? nullptr : &m_pixels[0]; }
+
+			///
+			/// Packs a color into an RGBA8 pixel.
+			///
+			static uint32_t PackColor(const Math::Color4 &color);
+
+			///
+			/// Unpacks an RGBA8 pixel into a color.
+			///
+			static Math::Color4 UnpackColor(uint32_t pixel);
+		};
+	}
+}
+
+#endif /* _TEKSTORM_SOFTWARETEXTURE_H */
\ No newline at end of file
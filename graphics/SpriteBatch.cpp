@@ -0,0 +1,332 @@
+#define TEKSTORM_BUILD
+#include "SpriteBatch.h"
+#include "TextureAtlas.h"
+#include "../core/MemoryTracker.h"
+#include <algorithm>
+#include <math.h>
+#include <xmmintrin.h>
+
+namespace Tekstorm
+{
+	namespace Graphics
+	{
+		using namespace Tekstorm::Math;
+
+		///
+		/// Orders sprites by blend mode, then texture.
+		///
+		struct SpriteStateLess
+		{
+			const std::vector<SpriteBatchEntry> *pSprites;
+
+			bool operator()(int32_t left, int32_t right) const
+			{
+				const SpriteBatchEntry &a = (*pSprites)[left];
+				const SpriteBatchEntry &b = (*pSprites)[right];
+				if (a.blend != b.blend)
+					return a.blend < b.blend;
+
+				return std::less<TextureKey>()(a.texture, b.texture);
+			}
+		};
+
+		///
+		/// Orders sprites by depth, farthest first, then by state.
+		///
+		struct SpriteDepthGreater
+		{
+			const std::vector<SpriteBatchEntry> *pSprites;
+
+			bool operator()(int32_t left, int32_t right) const
+			{
+				const SpriteBatchEntry &a = (*pSprites)[left];
+				const SpriteBatchEntry &b = (*pSprites)[right];
+				if (a.depth != b.depth)
+					return a.depth > b.depth;
+
+				SpriteStateLess state = { pSprites };
+				return state(left, right);
+			}
+		};
+
+		///
+		/// Loads one field of four sprites into a vector.
+		///
+		static inline __m128 GatherField(const SpriteBatchEntry *const *ppSprites, float SpriteBatchEntry::*pField)
+		{
+			return _mm_setr_ps(ppSprites[0]->*pField, ppSprites[1]->*pField, ppSprites[2]->*pField, ppSprites[3]->*pField);
+		}
+
+		SpriteBatch::SpriteBatch()
+		{
+			m_sortMode = TEKSPRITESORT_TEXTURE;
+			m_bBegun = false;
+			m_nTrackedBytes = 0;
+		}
+
+		SpriteBatch::~SpriteBatch()
+		{
+			TEKMEM_FREE(Core::TEKMEMTAG_GRAPHICS, m_nTrackedBytes);
+		}
+
+		///
+		/// Starts a batch, discarding the results of the last one.
+		///
+		void SpriteBatch::Begin(SpriteSortMode sortMode)
+		{
+#if defined(TEKSTORM_DEBUG)
+			if (m_bBegun)
+			{
+				TEKDEBUG_W("SpriteBatch: Begin was called twice without End");
+			}
+#endif
+
+			m_sortMode = sortMode;
+			m_bBegun = true;
+			m_sprites.clear();
+			m_order.clear();
+			m_vertices.clear();
+			m_drawCalls.clear();
+		}
+
+		///
+		/// Queues a sprite covering the whole texture, alpha blended.
+		///
+		void SpriteBatch::Draw(TextureKey texture, const Vector2 &position, const Vector2 &size, const Color4 &color)
+		{
+			Draw(texture, position, size, Vector4(0, 0, 1, 1), color);
+		}
+
+		///
+		/// Queues a sprite.
+		///
+		void SpriteBatch::Draw(TextureKey texture, const Vector2 &position, const Vector2 &size, const Vector4 &uvRect,
+			const Color4 &color, tekreal rotation, const Vector2 &origin, const Vector2 &scale, tekreal depth, BlendMode blend)
+		{
+#if defined(TEKSTORM_DEBUG)
+			if (!m_bBegun)
+			{
+				TEKDEBUG_W("SpriteBatch: Draw was called outside of Begin/End");
+			}
+#endif
+
+			SpriteBatchEntry sprite;
+			sprite.texture = texture;
+			sprite.blend = blend;
+			sprite.x = (float)position.X;
+			sprite.y = (float)position.Y;
+			sprite.left = (float)(-origin.X * scale.X);
+			sprite.top = (float)(-origin.Y * scale.Y);
+			sprite.right = (float)((size.X - origin.X) * scale.X);
+			sprite.bottom = (float)((size.Y - origin.Y) * scale.Y);
+			sprite.cos = 1.0f;
+			sprite.sin = 0.0f;
+			if (rotation != 0)
+			{
+				sprite.cos = (float)cos(rotation);
+				sprite.sin = (float)sin(rotation);
+			}
+
+			sprite.depth = (float)depth;
+			sprite.u0 = (float)uvRect.X;
+			sprite.v0 = (float)uvRect.Y;
+			sprite.u1 = (float)uvRect.Z;
+			sprite.v1 = (float)uvRect.W;
+			sprite.r = (float)color.R;
+			sprite.g = (float)color.G;
+			sprite.b = (float)color.B;
+			sprite.a = (float)color.A;
+			m_sprites.push_back(sprite);
+		}
+
+		///
+		/// Queues an atlas region at its own size.
+		///
+		void SpriteBatch::Draw(const TextureAtlas &atlas, int32_t region, const Vector2 &position, const Color4 &color,
+			tekreal rotation, const Vector2 &origin, const Vector2 &scale, tekreal depth, BlendMode blend)
+		{
+			if (!atlas.IsValidRegion(region))
+			{
+#if defined(TEKSTORM_DEBUG)
+				TEKDEBUG_W("SpriteBatch: Draw was called with an invalid atlas region");
+#endif
+				return;
+			}
+
+			const AtlasRegion &atlasRegion = atlas.GetRegion(region);
+			Draw(atlas.GetPageTexture(atlasRegion.page), position, Vector2((tekreal)atlasRegion.rect.width, (tekreal)atlasRegion.rect.height),
+				atlas.GetUVRect(region), color, rotation, origin, scale, depth, blend);
+		}
+
+		///
+		/// Ends the batch and builds its vertices and draw calls.
+		///
+		void SpriteBatch::End()
+		{
+#if defined(TEKSTORM_DEBUG)
+			if (!m_bBegun)
+			{
+				TEKDEBUG_W("SpriteBatch: End was called without Begin");
+			}
+#endif
+
+			m_bBegun = false;
+			SortSprites();
+			BuildVertices();
+			BuildDrawCalls();
+			TrackMemory();
+		}
+
+		///
+		/// Reports the change in the lists' capacity to the MemoryTracker.
+		///
+		void SpriteBatch::TrackMemory()
+		{
+			size_t bytes = m_sprites.capacity() * sizeof(SpriteBatchEntry) + m_order.capacity() * sizeof(int32_t)
+				+ m_vertices.capacity() * sizeof(SpriteVertex) + m_indices.capacity() * sizeof(uint16_t)
+				+ m_drawCalls.capacity() * sizeof(SpriteDrawCall);
+
+			TEKMEM_RESIZE(Core::TEKMEMTAG_GRAPHICS, m_nTrackedBytes, bytes);
+			m_nTrackedBytes = bytes;
+		}
+
+		///
+		/// Orders the queued sprites for the sort mode.
+		///
+		void SpriteBatch::SortSprites()
+		{
+			int32_t count = (int32_t)m_sprites.size();
+			m_order.resize(count);
+			for (int32_t i = 0; i < count; i++)
+				m_order[i] = i;
+
+			if (m_sortMode == TEKSPRITESORT_TEXTURE)
+			{
+				SpriteStateLess less = { &m_sprites };
+				std::stable_sort(m_order.begin(), m_order.end(), less);
+			}
+			else if (m_sortMode == TEKSPRITESORT_BACKTOFRONT)
+			{
+				SpriteDepthGreater greater = { &m_sprites };
+				std::stable_sort(m_order.begin(), m_order.end(), greater);
+			}
+		}
+
+		///
+		/// Builds the vertices of the sorted sprites, four sprites at a time.
+		///
+		void SpriteBatch::BuildVertices()
+		{
+			int32_t count = (int32_t)m_sprites.size();
+			m_vertices.resize((size_t)count * 4);
+
+			for (int32_t first = 0; first < count; first += 4)
+			{
+				// the last group repeats its final sprite to fill the vector
+				const SpriteBatchEntry *pSprites[4];
+				int32_t lanes = (count - first < 4) ? count - first : 4;
+				for (int32_t lane = 0; lane < 4; lane++)
+					pSprites[lane] = &m_sprites[m_order[first + ((lane < lanes) ? lane : lanes - 1)]];
+
+				__m128 x = GatherField(pSprites, &SpriteBatchEntry::x);
+				__m128 y = GatherField(pSprites, &SpriteBatchEntry::y);
+				__m128 left = GatherField(pSprites, &SpriteBatchEntry::left);
+				__m128 top = GatherField(pSprites, &SpriteBatchEntry::top);
+				__m128 right = GatherField(pSprites, &SpriteBatchEntry::right);
+				__m128 bottom = GatherField(pSprites, &SpriteBatchEntry::bottom);
+				__m128 cosine = GatherField(pSprites, &SpriteBatchEntry::cos);
+				__m128 sine = GatherField(pSprites, &SpriteBatchEntry::sin);
+
+				// rotate the corner offsets and move them to the position
+				__m128 leftCos = _mm_mul_ps(left, cosine);
+				__m128 leftSin = _mm_mul_ps(left, sine);
+				__m128 rightCos = _mm_mul_ps(right, cosine);
+				__m128 rightSin = _mm_mul_ps(right, sine);
+				__m128 topCos = _mm_mul_ps(top, cosine);
+				__m128 topSin = _mm_mul_ps(top, sine);
+				__m128 bottomCos = _mm_mul_ps(bottom, cosine);
+				__m128 bottomSin = _mm_mul_ps(bottom, sine);
+
+				// corners in vertex order: top-left, top-right, bottom-right, bottom-left
+				float cornerX[4][4];
+				float cornerY[4][4];
+				_mm_storeu_ps(cornerX[0], _mm_add_ps(x, _mm_sub_ps(leftCos, topSin)));
+				_mm_storeu_ps(cornerY[0], _mm_add_ps(y, _mm_add_ps(leftSin, topCos)));
+				_mm_storeu_ps(cornerX[1], _mm_add_ps(x, _mm_sub_ps(rightCos, topSin)));
+				_mm_storeu_ps(cornerY[1], _mm_add_ps(y, _mm_add_ps(rightSin, topCos)));
+				_mm_storeu_ps(cornerX[2], _mm_add_ps(x, _mm_sub_ps(rightCos, bottomSin)));
+				_mm_storeu_ps(cornerY[2], _mm_add_ps(y, _mm_add_ps(rightSin, bottomCos)));
+				_mm_storeu_ps(cornerX[3], _mm_add_ps(x, _mm_sub_ps(leftCos, bottomSin)));
+				_mm_storeu_ps(cornerY[3], _mm_add_ps(y, _mm_add_ps(leftSin, bottomCos)));
+
+				for (int32_t lane = 0; lane < lanes; lane++)
+				{
+					const SpriteBatchEntry &sprite = *pSprites[lane];
+					SpriteVertex *pVertex = &m_vertices[(size_t)(first + lane) * 4];
+					for (int32_t corner = 0; corner < 4; corner++)
+					{
+						pVertex[corner].x = cornerX[corner][lane];
+						pVertex[corner].y = cornerY[corner][lane];
+						pVertex[corner].z = sprite.depth;
+						pVertex[corner].r = sprite.r;
+						pVertex[corner].g = sprite.g;
+						pVertex[corner].b = sprite.b;
+						pVertex[corner].a = sprite.a;
+					}
+
+					pVertex[0].tu = sprite.u0;
+					pVertex[0].tv = sprite.v0;
+					pVertex[1].tu = sprite.u1;
+					pVertex[1].tv = sprite.v0;
+					pVertex[2].tu = sprite.u1;
+					pVertex[2].tv = sprite.v1;
+					pVertex[3].tu = sprite.u0;
+					pVertex[3].tv = sprite.v1;
+				}
+			}
+		}
+
+		///
+		/// Groups the sorted sprites into draw calls, and grows the index stream to
+		/// cover the largest one.
+		///
+		void SpriteBatch::BuildDrawCalls()
+		{
+			int32_t count = (int32_t)m_sprites.size();
+			int32_t largest = 0;
+			SpriteDrawCall *pCurrent = nullptr;
+
+			for (int32_t i = 0; i < count; i++)
+			{
+				const SpriteBatchEntry &sprite = m_sprites[m_order[i]];
+				if (pCurrent == nullptr || pCurrent->texture != sprite.texture || pCurrent->blend != sprite.blend ||
+					pCurrent->indexCount == MaxSpritesPerDraw * 6)
+				{
+					SpriteDrawCall drawCall;
+					drawCall.texture = sprite.texture;
+					drawCall.blend = sprite.blend;
+					drawCall.baseVertex = i * 4;
+					drawCall.indexCount = 0;
+					m_drawCalls.push_back(drawCall);
+					pCurrent = &m_drawCalls.back();
+				}
+
+				pCurrent->indexCount += 6;
+				if (pCurrent->indexCount > largest)
+					largest = pCurrent->indexCount;
+			}
+
+			// two clockwise triangles per sprite: 0-1-2 and 0-2-3
+			for (int32_t sprite = (int32_t)m_indices.size() / 6; sprite < largest / 6; sprite++)
+			{
+				uint16_t base = (uint16_t)(sprite * 4);
+				m_indices.push_back(base);
+				m_indices.push_back(base + 1);
+				m_indices.push_back(base + 2);
+				m_indices.push_back(base);
+				m_indices.push_back(base + 2);
+				m_indices.push_back(base + 3);
+			}
+		}
+	}
+}
\ No newline at end of file
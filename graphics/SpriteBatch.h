@@ -0,0 +1,205 @@
+#pragma once
+#ifndef _TEKSTORM_SPRITEBATCH_H
+#define _TEKSTORM_SPRITEBATCH_H
+#include "../tekconfig.h"
+#include "../math/Color4.h"
+#include "../math/Vector2.h"
+#include "../math/Vector4.h"
+
+namespace Tekstorm
+{
+	namespace Graphics
+	{
+		///
+		/// How the pixels of a sprite are combined with the render target.
+		///
+		enum BlendMode
+		{
+			TEKBLEND_OPAQUE = 0,
+			TEKBLEND_ALPHA = 1,
+			TEKBLEND_ADDITIVE = 2,
+			TEKBLEND_PREMULTIPLIED = 3
+		};
+
+		///
+		/// The order a SpriteBatch emits its sprites in.
+		///
+		enum SpriteSortMode
+		{
+			// In the order they were drawn; only neighbouring sprites with the same
+			// state share a draw call.
+			TEKSPRITESORT_DEFERRED = 0,
+
+			// Grouped by blend mode, then texture, which gives the fewest draw calls.
+			// Sprites with the same state keep the order they were drawn in.
+			TEKSPRITESORT_TEXTURE = 1,
+
+			// Farthest depth first, for blended sprites that overlap.
+			TEKSPRITESORT_BACKTOFRONT = 2
+		};
+
+		///
+		/// A sprite corner, in the position/color/texcoord layout the 2D shaders take.
+		///
+		struct SpriteVertex
+		{
+			float x, y, z;
+			float r, g, b, a;
+			float tu, tv;
+		};
+
+		///
+		/// One draw submission: indexCount indices from the start of the index
+		/// stream, offset by baseVertex, with a texture and blend mode bound.
+		///
+		struct SpriteDrawCall
+		{
+			TextureKey texture;
+			BlendMode blend;
+			int32_t baseVertex;
+			int32_t indexCount;
+		};
+
+		///
+		/// A sprite queued in a SpriteBatch: its corners relative to its position,
+		/// already scaled, and its rotation as a cosine and sine.
+		///
+		struct SpriteBatchEntry
+		{
+			TextureKey texture;
+			BlendMode blend;
+			float x, y;
+			float left, top, right, bottom;
+			float cos, sin;
+			float depth;
+			float u0, v0, u1, v1;
+			float r, g, b, a;
+		};
+
+		///
+		/// Collects sprites between Begin() and End() and turns them into a vertex
+		/// stream, an index stream and the fewest draw calls that render them.
+		///
+		/// Each sprite is four vertices and six 16-bit indices. The index pattern is
+		/// the same for every sprite, so draw calls differ only in their base vertex
+		/// and the index stream is built once. Corners are generated four sprites at
+		/// a time with SSE. The streams keep their capacity between batches.
+		///
+		/// The batch does not talk to the device: after End(), upload the vertex and
+		/// index streams and submit the draw calls. This keeps it usable, and
+		/// checkable, without a window or GPU.
+		///
+		class TEKAPI SpriteBatch
+		{
+		public:
+			///
+			/// The most sprites a draw call can cover with 16-bit indices.
+			///
+			static const int32_t MaxSpritesPerDraw = 65536 / 4;
+
+		protected:
+			SpriteSortMode m_sortMode;
+			bool m_bBegun;
+
+			std::vector<SpriteBatchEntry> m_sprites;
+
+			// The sprite indices in emit order.
+			std::vector<int32_t> m_order;
+
+			std::vector<SpriteVertex> m_vertices;
+			std::vector<uint16_t> m_indices;
+			std::vector<SpriteDrawCall> m_drawCalls;
+
+			// The capacity of the lists last reported to the MemoryTracker.
+			size_t m_nTrackedBytes;
+
+			///
+			/// Sprite batches are not copyable.
+			///
+			SpriteBatch(const SpriteBatch &other);
+			SpriteBatch &operator=(const SpriteBatch &other);
+
+			///
+			/// Orders the queued sprites for the sort mode.
+			///
+			void SortSprites();
+
+			///
+			/// Builds the vertices of the sorted sprites.
+			///
+			void BuildVertices();
+
+			///
+			/// Groups the sorted sprites into draw calls.
+			///
+			void BuildDrawCalls();
+
+			///
+			/// Reports the change in the lists' capacity to the MemoryTracker.
+			///
+			void TrackMemory();
+
+		public:
+			SpriteBatch();
+			~SpriteBatch();
+
+			///
+			/// Starts a batch, discarding the results of the last one.
+			///
+			void Begin(SpriteSortMode sortMode = TEKSPRITESORT_TEXTURE);
+
+			///
+			/// Queues a sprite covering the whole texture, alpha blended.
+			///
+			void Draw(TextureKey texture, const Math::Vector2 &position, const Math::Vector2 &size, const Math::Color4 &color);
+
+			///
+			/// Queues a sprite.
+			/// uvRect - the texture coordinates of the top-left (X, Y) and bottom-right (Z, W) corners
+			/// origin - the point, in pixels from the top-left corner, that is placed at position
+			///          and that the sprite rotates and scales around
+			/// rotation - clockwise, in radians
+			/// depth - the z of the vertices, also used by TEKSPRITESORT_BACKTOFRONT
+			///
+			void Draw(TextureKey texture, const Math::Vector2 &position, const Math::Vector2 &size, const Math::Vector4 &uvRect,
+				const Math::Color4 &color, tekreal rotation = 0, const Math::Vector2 &origin = Math::Vector2::Zero,
+				const Math::Vector2 &scale = Math::Vector2::One, tekreal depth = 0, BlendMode blend = TEKBLEND_ALPHA);
+
+			///
+			/// Queues an atlas region at its own size, with its page texture and its
+			/// texture coordinates on the page. An invalid region (such as the -1
+			/// TextureAtlas::AddRange() gives an image that did not fit) is skipped.
+			///
+			void Draw(const TextureAtlas &atlas, int32_t region, const Math::Vector2 &position, const Math::Color4 &color,
+				tekreal rotation = 0, const Math::Vector2 &origin = Math::Vector2::Zero, const Math::Vector2 &scale = Math::Vector2::One,
+				tekreal depth = 0, BlendMode blend = TEKBLEND_ALPHA);
+
+			///
+			/// Ends the batch and builds its vertices and draw calls.
+			///
+			void End();
+
+			///
+			/// Gets the number of sprites in the batch.
+			///
+			int32_t GetSpriteCount() const { return (int32_t)m_sprites.size(); }
+
+			///
+			/// Gets the vertices built by End(), four per sprite.
+			///
+			const std::vector<SpriteVertex> &GetVertices() const { return m_vertices; }
+
+			///
+			/// Gets the index stream; it covers at least the largest draw call.
+			///
+			const std::vector<uint16_t> &GetIndices() const { return m_indices; }
+
+			///
+			/// Gets the draw calls built by End(), in submission order.
+			///
+			const std::vector<SpriteDrawCall> &GetDrawCalls() const { return m_drawCalls; }
+		};
+	}
+}
+
+#endif /* _TEKSTORM_SPRITEBATCH_H */
\ No newline at end of file
@@ -0,0 +1,260 @@
+#define TEKSTORM_BUILD
+#include "TextureAtlas.h"
+#include "../core/TimeStamp.h"
+#include "../core/TimeSpan.h"
+#include <algorithm>
+
+namespace Tekstorm
+{
+	namespace Graphics
+	{
+		using namespace Tekstorm::Core;
+		using namespace Tekstorm::Math;
+
+		///
+		/// Orders images by height, then width, largest first.
+		///
+		struct AtlasImageGreater
+		{
+			const AtlasImage *pImages;
+
+			bool operator()(int32_t left, int32_t right) const
+			{
+				const AtlasImage &a = pImages[left];
+				const AtlasImage &b = pImages[right];
+				if (a.height != b.height)
+					return a.height > b.height;
+
+				return a.width > b.width;
+			}
+		};
+
+		///
+		/// Creates an empty atlas.
+		///
+		TextureAtlas::TextureAtlas(int32_t pageWidth, int32_t pageHeight, int32_t padding)
+		{
+			m_nPageWidth = pageWidth;
+			m_nPageHeight = pageHeight;
+			m_nPadding = (padding > 0) ? padding : 0;
+			memset(&m_stats, 0, sizeof(AtlasStats));
+		}
+
+		TextureAtlas::~TextureAtlas()
+		{
+			Clear();
+		}
+
+		///
+		/// Removes all pages and regions.
+		///
+		void TextureAtlas::Clear()
+		{
+			for (size_t i = 0; i < m_pages.size(); i++)
+				delete m_pages[i];
+
+			m_pages.clear();
+			m_regions.clear();
+			memset(&m_stats, 0, sizeof(AtlasStats));
+		}
+
+		///
+		/// Adds an empty page.
+		///
+		AtlasPage *TextureAtlas::AddPage()
+		{
+			AtlasPage *pPage = new AtlasPage();
+			pPage->pixels.Create(m_nPageWidth, m_nPageHeight);
+			pPage->packer.Reset(m_nPageWidth, m_nPageHeight);
+			pPage->texture = nullptr;
+			pPage->dirty = false;
+			memset(&pPage->dirtyRect, 0, sizeof(AtlasRect));
+			m_pages.push_back(pPage);
+			return pPage;
+		}
+
+		///
+		/// Packs an image at runtime.
+		///
+		int32_t TextureAtlas::Add(const uint32_t *pPixels, int32_t width, int32_t height, int32_t pitch)
+		{
+			TimeStamp start = TimeStamp::GetNow();
+
+			AtlasImage image = { pPixels, width, height, pitch };
+			int32_t region = Pack(image);
+			UpdateStats();
+
+			TimeSpan elapsed = TimeStamp::GetNow() - start;
+			m_stats.buildMilliseconds += elapsed.GetRealMilliseconds();
+			return region;
+		}
+
+		///
+		/// Packs a set of images, largest first.
+		///
+		void TextureAtlas::AddRange(const AtlasImage *pImages, int32_t count, int32_t *pRegions)
+		{
+			TimeStamp start = TimeStamp::GetNow();
+
+			std::vector<int32_t> order(count);
+			for (int32_t i = 0; i < count; i++)
+				order[i] = i;
+
+			AtlasImageGreater greater = { pImages };
+			std::stable_sort(order.begin(), order.end(), greater);
+
+			for (int32_t i = 0; i < count; i++)
+				pRegions[order[i]] = Pack(pImages[order[i]]);
+
+			UpdateStats();
+
+			TimeSpan elapsed = TimeStamp::GetNow() - start;
+			m_stats.buildMilliseconds += elapsed.GetRealMilliseconds();
+		}
+
+		///
+		/// Places an image on a page and copies it there.
+		///
+		int32_t TextureAtlas::Pack(const AtlasImage &image)
+		{
+			int32_t paddedWidth = image.width + m_nPadding * 2;
+			int32_t paddedHeight = image.height + m_nPadding * 2;
+			if (image.width <= 0 || image.height <= 0 || paddedWidth > m_nPageWidth || paddedHeight > m_nPageHeight)
+			{
+#if defined(TEKSTORM_DEBUG)
+				TEKDEBUG_W("TextureAtlas: the image does not fit on a page");
+#endif
+				m_stats.failedCount++;
+				return -1;
+			}
+
+			AtlasRect padded;
+			int32_t page = -1;
+			for (int32_t i = 0; i < (int32_t)m_pages.size() && page < 0; i++)
+			{
+				if (m_pages[i]->packer.Insert(paddedWidth, paddedHeight, &padded))
+					page = i;
+			}
+
+			if (page < 0)
+			{
+				page = (int32_t)m_pages.size();
+				AddPage()->packer.Insert(paddedWidth, paddedHeight, &padded);
+			}
+
+			CopyImage(*m_pages[page], padded, image);
+
+			AtlasRegion region;
+			region.page = page;
+			region.rect.x = padded.x + m_nPadding;
+			region.rect.y = padded.y + m_nPadding;
+			region.rect.width = image.width;
+			region.rect.height = image.height;
+			region.u0 = (float)region.rect.x / (float)m_nPageWidth;
+			region.v0 = (float)region.rect.y / (float)m_nPageHeight;
+			region.u1 = (float)(region.rect.x + image.width) / (float)m_nPageWidth;
+			region.v1 = (float)(region.rect.y + image.height) / (float)m_nPageHeight;
+			m_regions.push_back(region);
+
+			m_stats.imagePixels += (int64_t)image.width * image.height;
+			return (int32_t)m_regions.size() - 1;
+		}
+
+		///
+		/// Copies an image into its padded place on a page, extruding its edges
+		/// into the padding.
+		///
+		void TextureAtlas::CopyImage(AtlasPage &page, const AtlasRect &padded, const AtlasImage &image)
+		{
+			int32_t pitch = (image.pitch > 0) ? image.pitch : image.width * (int32_t)sizeof(uint32_t);
+			uint32_t *pPagePixels = page.pixels.GetPixels();
+
+			for (int32_t row = 0; row < padded.height; row++)
+			{
+				int32_t sourceRow = row - m_nPadding;
+				if (sourceRow < 0)
+					sourceRow = 0;
+				else if (sourceRow >= image.height)
+					sourceRow = image.height - 1;
+
+				const uint32_t *pSource = (const uint32_t *)((const char *)image.pPixels + (size_t)sourceRow * pitch);
+				uint32_t *pDestination = &pPagePixels[(size_t)(padded.y + row) * m_nPageWidth + padded.x];
+				for (int32_t i = 0; i < m_nPadding; i++)
+				{
+					pDestination[i] = pSource[0];
+					pDestination[m_nPadding + image.width + i] = pSource[image.width - 1];
+				}
+
+				memcpy(pDestination + m_nPadding, pSource, (size_t)image.width * sizeof(uint32_t));
+			}
+
+			// grow the dirty area to cover the image
+			if (!page.dirty)
+			{
+				page.dirtyRect = padded;
+				page.dirty = true;
+			}
+			else
+			{
+				int32_t left = (padded.x < page.dirtyRect.x) ? padded.x : page.dirtyRect.x;
+				int32_t top = (padded.y < page.dirtyRect.y) ? padded.y : page.dirtyRect.y;
+				int32_t right = padded.x + padded.width;
+				int32_t bottom = padded.y + padded.height;
+				if (page.dirtyRect.x + page.dirtyRect.width > right)
+					right = page.dirtyRect.x + page.dirtyRect.width;
+				if (page.dirtyRect.y + page.dirtyRect.height > bottom)
+					bottom = page.dirtyRect.y + page.dirtyRect.height;
+				page.dirtyRect.x = left;
+				page.dirtyRect.y = top;
+				page.dirtyRect.width = right - left;
+				page.dirtyRect.height = bottom - top;
+			}
+		}
+
+		///
+		/// Updates the page and efficiency statistics.
+		///
+		void TextureAtlas::UpdateStats()
+		{
+			m_stats.pageCount = (int32_t)m_pages.size();
+			m_stats.regionCount = (int32_t)m_regions.size();
+			m_stats.pagePixels = (int64_t)m_stats.pageCount * m_nPageWidth * m_nPageHeight;
+			m_stats.efficiency = (m_stats.pagePixels > 0) ? (float)((double)m_stats.imagePixels / (double)m_stats.pagePixels) : 0.0f;
+		}
+
+		///
+		/// Gets the texture coordinates of a region.
+		///
+		Vector4 TextureAtlas::GetUVRect(int32_t region) const
+		{
+			if (!IsValidRegion(region))
+				return Vector4::Zero;
+
+			const AtlasRegion &r = m_regions[region];
+			return Vector4(r.u0, r.v0, r.u1, r.v1);
+		}
+
+		///
+		/// Maps texture coordinates of the original image to the atlas.
+		///
+		Vector4 TextureAtlas::RemapUVRect(int32_t region, const Vector4 &uvRect) const
+		{
+			if (!IsValidRegion(region))
+				return Vector4::Zero;
+
+			const AtlasRegion &r = m_regions[region];
+			tekreal width = r.u1 - r.u0;
+			tekreal height = r.v1 - r.v0;
+			return Vector4(r.u0 + uvRect.X * width, r.v0 + uvRect.Y * height, r.u0 + uvRect.Z * width, r.v0 + uvRect.W * height);
+		}
+
+		///
+		/// Sets the texture a page was uploaded to, and marks the page clean.
+		///
+		void TextureAtlas::SetPageTexture(int32_t page, TextureKey texture)
+		{
+			m_pages[page]->texture = texture;
+			m_pages[page]->dirty = false;
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,218 @@
+#pragma once
+#ifndef _TEKSTORM_TEXTUREATLAS_H
+#define _TEKSTORM_TEXTUREATLAS_H
+#include "../tekconfig.h"
+#include "../math/Vector4.h"
+#include "MaxRectsPacker.h"
+#include "SoftwareTexture.h"
+
+namespace Tekstorm
+{
+	namespace Graphics
+	{
+		///
+		/// An image to pack, in RGBA8 rows.
+		///
+		struct AtlasImage
+		{
+			const uint32_t *pPixels;
+			int32_t width;
+			int32_t height;
+
+			// The size, in bytes, of a row; 0 for tightly packed rows.
+			int32_t pitch;
+		};
+
+		///
+		/// Where an image was packed: its page, its pixels on the page (without
+		/// padding) and the matching texture coordinates.
+		///
+		struct AtlasRegion
+		{
+			int32_t page;
+			AtlasRect rect;
+			float u0, v0, u1, v1;
+		};
+
+		///
+		/// A page of an atlas: its pixels, the packer placing images on it, and the
+		/// texture the renderer uploaded it to.
+		///
+		struct AtlasPage
+		{
+			SoftwareTexture pixels;
+			MaxRectsPacker packer;
+			TextureKey texture;
+
+			// The pixels changed since the renderer last uploaded the page.
+			bool dirty;
+			AtlasRect dirtyRect;
+		};
+
+		///
+		/// Packing statistics of an atlas.
+		///
+		struct AtlasStats
+		{
+			int32_t pageCount;
+			int32_t regionCount;
+
+			// Images that were larger than a page.
+			int32_t failedCount;
+
+			// The pixels of the packed images, without padding, and of all pages.
+			int64_t imagePixels;
+			int64_t pagePixels;
+
+			// imagePixels / pagePixels.
+			float efficiency;
+
+			// The time spent packing and copying images, in total.
+			float buildMilliseconds;
+		};
+
+		///
+		/// Packs many small images into a few large pages, so sprites that use them
+		/// share textures and batch into fewer draw calls.
+		///
+		/// AddRange() packs a set of images at once, largest first, which packs
+		/// best; use it when the images are known up front. Add() packs one image
+		/// into the first page with room, opening a new page when none has, for
+		/// content made at runtime such as glyphs.
+		///
+		/// Each image is surrounded by padding filled with its edge pixels, so
+		/// filtering never picks up a neighbour. Pages are marked dirty with the
+		/// area that changed; the renderer uploads them, clears the flag and sets
+		/// the page texture, which SpriteBatch::Draw binds for atlas regions.
+		///
+		class TEKAPI TextureAtlas
+		{
+		public:
+			///
+			/// The default width and height of a page.
+			///
+			static const int32_t DefaultPageSize = 2048;
+
+		protected:
+			int32_t m_nPageWidth;
+			int32_t m_nPageHeight;
+			int32_t m_nPadding;
+
+			// Pages are allocated separately so references to them stay valid.
+			std::vector<AtlasPage *> m_pages;
+			std::vector<AtlasRegion> m_regions;
+
+			AtlasStats m_stats;
+
+			///
+			/// Texture atlases are not copyable.
+			///
+			TextureAtlas(const TextureAtlas &other);
+			TextureAtlas &operator=(const TextureAtlas &other);
+
+			///
+			/// Places an image on a page and copies it there. Returns the region
+			/// index, or -1 if the image is larger than a page.
+			///
+			int32_t Pack(const AtlasImage &image);
+
+			///
+			/// Copies an image into its padded place on a page, extruding its edges
+			/// into the padding.
+			///
+			void CopyImage(AtlasPage &page, const AtlasRect &padded, const AtlasImage &image);
+
+			///
+			/// Adds an empty page.
+			///
+			AtlasPage *AddPage();
+
+			///
+			/// Updates the page and efficiency statistics.
+			///
+			void UpdateStats();
+
+		public:
+			///
+			/// Creates an empty atlas. padding is the border, in pixels, around each image.
+			///
+			TextureAtlas(int32_t pageWidth = DefaultPageSize, int32_t pageHeight = DefaultPageSize, int32_t padding = 1);
+
+			~TextureAtlas();
+
+			///
+			/// Packs an image at runtime. Returns its region index, or -1 if it is
+			/// larger than a page.
+			///
+			int32_t Add(const uint32_t *pPixels, int32_t width, int32_t height, int32_t pitch = 0);
+
+			///
+			/// Packs a set of images, largest first. pRegions receives the region
+			/// index of each image, or -1 for images larger than a page.
+			///
+			void AddRange(const AtlasImage *pImages, int32_t count, int32_t *pRegions);
+
+			///
+			/// Removes all pages and regions.
+			///
+			void Clear();
+
+			///
+			/// Gets the number of regions.
+			///
+			int32_t GetRegionCount() const { return (int32_t)m_regions.size(); }
+
+			///
+			/// Returns true if a region index is in [0, GetRegionCount()). AddRange()
+			/// gives -1 for images that did not fit.
+			///
+			bool IsValidRegion(int32_t region) const { return region >= 0 && region < (int32_t)m_regions.size(); }
+
+			///
+			/// Gets a region, which must be valid.
+			///
+			const AtlasRegion &GetRegion(int32_t region) const { return m_regions[region]; }
+
+			///
+			/// Gets the texture coordinates of a region: top-left (X, Y) and
+			/// bottom-right (Z, W). An invalid region gives an empty rectangle.
+			///
+			Math::Vector4 GetUVRect(int32_t region) const;
+
+			///
+			/// Maps texture coordinates of the original image (for example a frame
+			/// of a sprite sheet) to the atlas. An invalid region gives an empty
+			/// rectangle.
+			///
+			Math::Vector4 RemapUVRect(int32_t region, const Math::Vector4 &uvRect) const;
+
+			///
+			/// Gets the number of pages.
+			///
+			int32_t GetPageCount() const { return (int32_t)m_pages.size(); }
+
+			///
+			/// Gets a page.
+			///
+			AtlasPage &GetPage(int32_t page) { return *m_pages[page]; }
+			const AtlasPage &GetPage(int32_t page) const { return *m_pages[page]; }
+
+			///
+			/// Sets the texture a page was uploaded to, and marks the page clean.
+			///
+			void SetPageTexture(int32_t page, TextureKey texture);
+
+			///
+			/// Gets the texture a page was uploaded to.
+			///
+			TextureKey GetPageTexture(int32_t page) const { return m_pages[page]->texture; }
+
+			///
+			/// Gets the packing statistics.
+			///
+			const AtlasStats &GetStats() const { return m_stats; }
+		};
+	}
+}
+
+#endif /* _TEKSTORM_TEXTUREATLAS_H */
\ No newline at end of file
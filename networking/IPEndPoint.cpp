@@ -53,5 +53,21 @@ namespace Tekstorm
 			{
 				return sockInfo;
 			}
+
+			///
+			/// Returns true if both end points have the same address and port.
+			///
+			bool IPEndPoint::operator==(const IPEndPoint &other) const
+			{
+				return m_nPort == other.m_nPort && sockInfo.sin_addr.s_addr == other.sockInfo.sin_addr.s_addr;
+			}
+
+			///
+			/// Returns true if the end points differ in address or port.
+			///
+			bool IPEndPoint::operator!=(const IPEndPoint &other) const
+			{
+				return !(*this == other);
+			}
 	}
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
 #ifndef _TEKSTORM_IPENDPOINT_H
 #define _TEKSTORM_IPENDPOINT_H
 #include "IPAddress.h"
+#include "../core/Hash.h"
 
 namespace Tekstorm
 {
@@ -53,6 +54,32 @@ namespace Tekstorm
 			/// Gets the underlying socket address.
 			///
 			sockaddr_in GetSocketAddress() const;
+
+			///
+			/// Returns true if both end points have the same address and port.
+			///
+			bool operator==(const IPEndPoint &other) const;
+
+			///
+			/// Returns true if the end points differ in address or port.
+			///
+			bool operator!=(const IPEndPoint &other) const;
+		};
+	}
+
+	namespace Core
+	{
+		///
+		/// Hashes an IPEndPoint by address and port, i.e. to key connection tables.
+		///
+		template <>
+		struct Hash<Networking::IPEndPoint>
+		{
+			uint64_t operator()(const Networking::IPEndPoint &endPoint) const
+			{
+				sockaddr_in address = endPoint.GetSocketAddress();
+				return MixHash(((uint64_t)address.sin_addr.s_addr << 16) | endPoint.GetPort());
+			}
 		};
 	}
 }
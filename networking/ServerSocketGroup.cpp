@@ -0,0 +1,533 @@
+#define TEKSTORM_BUILD
+#include "ServerSocketGroup.h"
+#include "../core/MemoryTracker.h"
+
+namespace Tekstorm
+{
+	namespace Networking
+	{
+		///
+		/// Builds an IPEndPoint for the remote address.
+		///
+		IPEndPoint NetMessage::GetSource() const
+		{
+			char *addr = inet_ntoa(address.sin_addr);
+			return IPEndPoint(IPAddress(std::string(addr)), ntohs(address.sin_port));
+		}
+
+		ServerSocketGroup::ServerSocketGroup()
+		{
+			m_nSocketType = 0;
+			m_bKernelBalanced = false;
+			m_nRunning = 0;
+		}
+
+		ServerSocketGroup::~ServerSocketGroup()
+		{
+			Stop();
+		}
+
+		///
+		/// Binds the group to an endpoint and starts its I/O threads.
+		///
+		bool ServerSocketGroup::Start(const IPEndPoint &endPoint, int32_t type, int32_t shardCount, int32_t queueCapacity)
+		{
+#if defined(TEKSTORM_DEBUG)
+			if (!m_shards.empty()) {
+				TEKDEBUG_WF("ServerSocketGroup is already started.");
+			}
+#endif
+			if (shardCount <= 0)
+			{
+				SYSTEM_INFO info;
+				GetSystemInfo(&info);
+				shardCount = (int32_t)info.dwNumberOfProcessors;
+			}
+
+			if (shardCount > MaxShards)
+				shardCount = MaxShards;
+
+			m_nSocketType = type;
+			int32_t proto = (type == SOCK_STREAM) ? IPPROTO_TCP : IPPROTO_UDP;
+
+#if defined(SO_REUSEPORT)
+			m_bKernelBalanced = true;
+#else
+			m_bKernelBalanced = false;
+#endif
+
+			for (int32_t i = 0; i < shardCount; i++)
+			{
+				Shard *pShard = new Shard();
+				pShard->pGroup = this;
+				pShard->index = i;
+				pShard->thread = NULL;
+				pShard->pQueue = new Core::SpscQueue<NetMessage>((uint32_t)queueCapacity);
+				pShard->dropped = 0;
+				InitializeCriticalSection(&pShard->lock);
+				m_shards.push_back(pShard);
+				TEKMEM_ALLOC(Core::TEKMEMTAG_NETWORKING, sizeof(Shard) + pShard->pQueue->GetCapacity() * sizeof(NetMessage));
+
+				if (!m_bKernelBalanced && i > 0)
+				{
+					// Winsock: every shard services the first shard's socket.
+					pShard->socket = m_shards[0]->socket;
+					continue;
+				}
+
+				pShard->socket = Socket(type, proto);
+				if (pShard->socket.GetHandle() == 0)
+				{
+					Stop();
+					return false;
+				}
+
+#if defined(SO_REUSEPORT)
+				pShard->socket.SetOption(SOL_SOCKET, SO_REUSEPORT, 1);
+#endif
+				if (!pShard->socket.Bind(endPoint) ||
+					(type == SOCK_STREAM && !pShard->socket.Listen(SOMAXCONN)) ||
+					!pShard->socket.SetBlocking(false))
+				{
+#if defined(TEKSTORM_DEBUG)
+					TEKDEBUG_WFE("Failed to bind shard socket.", WSAGetLastError());
+#endif
+					Stop();
+					return false;
+				}
+			}
+
+			InterlockedExchange(&m_nRunning, 1);
+			for (size_t i = 0; i < m_shards.size(); i++)
+			{
+				m_shards[i]->thread = CreateThread(NULL, 0, &ServerSocketGroup::ShardProc, m_shards[i], 0, NULL);
+				if (m_shards[i]->thread == NULL)
+				{
+					Stop();
+					return false;
+				}
+			}
+
+			return true;
+		}
+
+		///
+		/// Stops all I/O threads and closes every socket and connection.
+		///
+		void ServerSocketGroup::Stop()
+		{
+			InterlockedExchange(&m_nRunning, 0);
+
+			for (size_t i = 0; i < m_shards.size(); i++)
+			{
+				if (m_shards[i]->thread != NULL)
+				{
+					WaitForSingleObject(m_shards[i]->thread, INFINITE);
+					CloseHandle(m_shards[i]->thread);
+				}
+			}
+
+			for (size_t i = 0; i < m_shards.size(); i++)
+			{
+				Shard *pShard = m_shards[i];
+				for (size_t c = 0; c < pShard->connections.size(); c++)
+				{
+					RemoveConnection(pShard, pShard->connections[c]);
+					delete pShard->connections[c];
+					TEKMEM_FREE(Core::TEKMEMTAG_NETWORKING, sizeof(Connection));
+				}
+
+				// shared handles are owned by shard 0
+				if (pShard->socket.GetHandle() != 0 && (m_bKernelBalanced || i == 0))
+					pShard->socket.Close();
+
+				TEKMEM_FREE(Core::TEKMEMTAG_NETWORKING, sizeof(Shard) + pShard->pQueue->GetCapacity() * sizeof(NetMessage));
+				delete pShard->pQueue;
+				DeleteCriticalSection(&pShard->lock);
+				delete pShard;
+			}
+
+			m_shards.clear();
+		}
+
+		///
+		/// Gets the number of shards.
+		///
+		int32_t ServerSocketGroup::GetShardCount() const
+		{
+			return (int32_t)m_shards.size();
+		}
+
+		///
+		/// Returns true if every shard has its own kernel-balanced socket.
+		///
+		bool ServerSocketGroup::IsKernelBalanced() const
+		{
+			return m_bKernelBalanced;
+		}
+
+		///
+		/// Returns the oldest message of a shard without copying it, or nullptr.
+		///
+		NetMessage *ServerSocketGroup::Peek(int32_t shard)
+		{
+			return m_shards[shard]->pQueue->Peek();
+		}
+
+		///
+		/// Releases the message returned by Peek().
+		///
+		void ServerSocketGroup::Pop(int32_t shard)
+		{
+			m_shards[shard]->pQueue->Pop();
+		}
+
+		///
+		/// Copies the oldest message of a shard. Returns false if there is none.
+		///
+		bool ServerSocketGroup::Receive(int32_t shard, NetMessage *pMessage)
+		{
+			return m_shards[shard]->pQueue->TryDequeue(pMessage);
+		}
+
+		///
+		/// Sends a datagram through the given shard's socket (UDP groups).
+		///
+		int32_t ServerSocketGroup::SendTo(int32_t shard, const sockaddr_in &address, const char *data, int32_t size)
+		{
+			return sendto(m_shards[shard]->socket.GetHandle(), data, size, 0, (const sockaddr *)&address, sizeof(sockaddr_in));
+		}
+
+		///
+		/// Sends one length-prefixed message on a TCP connection (TCP groups).
+		///
+		int32_t ServerSocketGroup::Send(Core::Handle connection, const char *data, int32_t size)
+		{
+			if (size <= 0 || size > NetMessage::MaxPayload)
+			{
+#if defined(TEKSTORM_DEBUG)
+				TEKDEBUG_WF("Message size is out of range.");
+#endif
+				return -1;
+			}
+
+			char frame[2 + NetMessage::MaxPayload];
+			frame[0] = (char)((size >> 8) & 0xFF);
+			frame[1] = (char)(size & 0xFF);
+			memcpy(&frame[2], data, size);
+
+			uint32_t shard = connection.GetIndex() / MaxConnectionsPerShard;
+			uint32_t slot = connection.GetIndex() % MaxConnectionsPerShard;
+			if (connection.IsNull() || shard >= m_shards.size())
+				return -1;
+
+			// the lock keeps the shard from closing the socket while it is in use; a
+			// single send keeps frames from concurrent senders from interleaving
+			Shard *pShard = m_shards[shard];
+			int32_t res = -1;
+			EnterCriticalSection(&pShard->lock);
+			if (slot < pShard->slots.size() && pShard->slots[slot].pConnection != nullptr
+				&& pShard->slots[slot].generation == connection.GetGeneration())
+				res = send(pShard->slots[slot].pConnection->handle, frame, size + 2, 0);
+			LeaveCriticalSection(&pShard->lock);
+
+			return res;
+		}
+
+		///
+		/// Gets the number of datagrams a shard dropped because its queue was full.
+		///
+		int32_t ServerSocketGroup::GetDroppedCount(int32_t shard) const
+		{
+			return (int32_t)m_shards[shard]->dropped;
+		}
+
+		///
+		/// The I/O thread entry point.
+		///
+		DWORD WINAPI ServerSocketGroup::ShardProc(LPVOID pParam)
+		{
+			Shard *pShard = (Shard *)pParam;
+
+			SYSTEM_INFO info;
+			GetSystemInfo(&info);
+			int32_t processor = pShard->index % (int32_t)info.dwNumberOfProcessors;
+			SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << processor);
+
+			if (pShard->pGroup->m_nSocketType == SOCK_STREAM)
+				pShard->pGroup->RunStreamShard(pShard);
+			else
+				pShard->pGroup->RunDatagramShard(pShard);
+
+			return 0;
+		}
+
+		///
+		/// Services a UDP shard until the group is stopped.
+		///
+		void ServerSocketGroup::RunDatagramShard(Shard *pShard)
+		{
+			SOCKET handle = pShard->socket.GetHandle();
+			Core::SpscQueue<NetMessage> *pQueue = pShard->pQueue;
+			char discard[NetMessage::MaxPayload];
+
+			while (m_nRunning != 0)
+			{
+				fd_set readSet;
+				FD_ZERO(&readSet);
+				FD_SET(handle, &readSet);
+				timeval timeout = { 0, 50 * 1000 };
+				if (select(0, &readSet, NULL, NULL, &timeout) <= 0)
+					continue;
+
+				// drain everything that is ready before going back to select
+				while (true)
+				{
+					NetMessage *pMessage = pQueue->BeginEnqueue();
+					sockaddr_in sin;
+					int fromLen = sizeof(sockaddr_in);
+					char *pDest = (pMessage != nullptr) ? pMessage->payload : discard;
+
+					int32_t res = recvfrom(handle, pDest, NetMessage::MaxPayload, 0, (sockaddr *)&sin, &fromLen);
+					if (res < 0)
+						break; // WSAEWOULDBLOCK, or another shard won the datagram
+
+					if (pMessage == nullptr)
+					{
+						InterlockedIncrement(&pShard->dropped);
+						continue;
+					}
+
+					pMessage->type = TEKNETMSG_DATA;
+					pMessage->shard = pShard->index;
+					pMessage->connection = Core::Handle();
+					pMessage->address = sin;
+					pMessage->length = res;
+					pQueue->EndEnqueue();
+				}
+			}
+		}
+
+		///
+		/// Services a TCP shard until the group is stopped.
+		///
+		void ServerSocketGroup::RunStreamShard(Shard *pShard)
+		{
+			SOCKET listener = pShard->socket.GetHandle();
+			std::vector<Connection *> &connections = pShard->connections;
+			std::vector<WSAPOLLFD> &pollSet = pShard->pollSet;
+
+			while (m_nRunning != 0)
+			{
+				// a connection with a full buffer is left out: WSAPoll would keep reporting
+				// the bytes it cannot read yet and the shard would spin. A full shard leaves
+				// the listener out too, or a pending connection would wake it every poll.
+				size_t count = connections.size();
+				bool stalled = false;
+				pollSet.clear();
+				for (size_t i = 0; i < count; i++)
+				{
+					Connection *pConnection = connections[i];
+					stalled = stalled || pConnection->stalled;
+					pConnection->pollIndex = -1;
+					if (pConnection->fill < (int32_t)sizeof(pConnection->buffer))
+					{
+						WSAPOLLFD entry = { pConnection->handle, POLLRDNORM, 0 };
+						pConnection->pollIndex = (int32_t)pollSet.size();
+						pollSet.push_back(entry);
+					}
+				}
+
+				int32_t listenerIndex = -1;
+				if (count < (size_t)MaxConnectionsPerShard)
+				{
+					WSAPOLLFD entry = { listener, POLLRDNORM, 0 };
+					listenerIndex = (int32_t)pollSet.size();
+					pollSet.push_back(entry);
+				}
+
+				// stalled frames are retried soon, as the game thread frees queue space
+				int32_t timeout = stalled ? 1 : 50;
+				int32_t ready = 0;
+				if (!pollSet.empty())
+					ready = WSAPoll(&pollSet[0], (ULONG)pollSet.size(), timeout);
+				else
+					Sleep(timeout);
+
+				if (ready < 0 || (ready == 0 && !stalled))
+					continue;
+
+				// walk backwards so removing a connection (swapping in the last one) only
+				// moves a connection that was already serviced
+				for (size_t i = count; i-- > 0; )
+				{
+					Connection *pConnection = connections[i];
+					short revents = (pConnection->pollIndex >= 0) ? pollSet[pConnection->pollIndex].revents : 0;
+					if (revents == 0 && !pConnection->stalled)
+						continue;
+
+					bool alive = true;
+					if (revents != 0)
+					{
+						int32_t space = (int32_t)sizeof(pConnection->buffer) - pConnection->fill;
+						int32_t res = recv(pConnection->handle, &pConnection->buffer[pConnection->fill], space, 0);
+						alive = (res > 0);
+						if (alive)
+							pConnection->fill += res;
+					}
+
+					if (alive)
+						alive = DecodeFrames(pShard, pConnection);
+
+					if (!alive)
+					{
+						PostEvent(pShard, TEKNETMSG_DISCONNECTED, pConnection);
+						RemoveConnection(pShard, pConnection);
+						delete pConnection;
+						TEKMEM_FREE(Core::TEKMEMTAG_NETWORKING, sizeof(Connection));
+						connections[i] = connections.back();
+						connections.pop_back();
+					}
+				}
+
+				if (listenerIndex >= 0 && (pollSet[listenerIndex].revents & POLLRDNORM) != 0)
+				{
+					sockaddr_in sin;
+					int addrLen = sizeof(sockaddr_in);
+					SOCKET sock = accept(listener, (sockaddr *)&sin, &addrLen);
+					if (sock != INVALID_SOCKET)
+					{
+						// accepted sockets inherit non-blocking mode; recv only runs after
+						// WSAPoll reports data and Send() relies on complete blocking sends.
+						u_long nonBlocking = 0;
+						ioctlsocket(sock, FIONBIO, &nonBlocking);
+
+						Connection *pConnection = new Connection();
+						pConnection->handle = sock;
+						pConnection->address = sin;
+						pConnection->fill = 0;
+						pConnection->stalled = false;
+						pConnection->pollIndex = -1;
+						AddConnection(pShard, pConnection);
+						connections.push_back(pConnection);
+						TEKMEM_ALLOC(Core::TEKMEMTAG_NETWORKING, sizeof(Connection));
+						PostEvent(pShard, TEKNETMSG_CONNECTED, pConnection);
+					}
+				}
+			}
+		}
+
+		///
+		/// Decodes complete frames from a connection's buffer into the shard queue.
+		///
+		bool ServerSocketGroup::DecodeFrames(Shard *pShard, Connection *pConnection)
+		{
+			int32_t offset = 0;
+			pConnection->stalled = false;
+
+			while (pConnection->fill - offset >= 2)
+			{
+				const unsigned char *pHeader = (const unsigned char *)&pConnection->buffer[offset];
+				int32_t length = (pHeader[0] << 8) | pHeader[1];
+				if (length > NetMessage::MaxPayload)
+					return false;
+
+				if (pConnection->fill - offset - 2 < length)
+					break;
+
+				NetMessage *pMessage = pShard->pQueue->BeginEnqueue();
+				if (pMessage == nullptr)
+				{
+					// queue full; keep the frame buffered and retry it next round
+					pConnection->stalled = true;
+					break;
+				}
+
+				pMessage->type = TEKNETMSG_DATA;
+				pMessage->shard = pShard->index;
+				pMessage->connection = pConnection->id;
+				pMessage->address = pConnection->address;
+				pMessage->length = length;
+				memcpy(pMessage->payload, &pConnection->buffer[offset + 2], length);
+				pShard->pQueue->EndEnqueue();
+
+				offset += 2 + length;
+			}
+
+			if (offset > 0)
+			{
+				pConnection->fill -= offset;
+				memmove(pConnection->buffer, &pConnection->buffer[offset], pConnection->fill);
+			}
+
+			return true;
+		}
+
+		///
+		/// Gives a new connection a slot of the shard's table and so its id.
+		///
+		void ServerSocketGroup::AddConnection(Shard *pShard, Connection *pConnection)
+		{
+			EnterCriticalSection(&pShard->lock);
+
+			// a shard never holds more than MaxConnectionsPerShard, so a slot is always free
+			uint32_t slot;
+			if (!pShard->freeSlots.empty())
+			{
+				slot = pShard->freeSlots.back();
+				pShard->freeSlots.pop_back();
+			}
+			else
+			{
+				ConnectionSlot empty = { nullptr, 1 };
+				slot = (uint32_t)pShard->slots.size();
+				pShard->slots.push_back(empty);
+			}
+
+			pShard->slots[slot].pConnection = pConnection;
+			pConnection->id = Core::Handle(pShard->index * MaxConnectionsPerShard + slot, pShard->slots[slot].generation);
+
+			LeaveCriticalSection(&pShard->lock);
+		}
+
+		///
+		/// Frees a connection's slot, so its id stops resolving, and closes its socket.
+		///
+		void ServerSocketGroup::RemoveConnection(Shard *pShard, Connection *pConnection)
+		{
+			uint32_t slot = pConnection->id.GetIndex() % MaxConnectionsPerShard;
+
+			EnterCriticalSection(&pShard->lock);
+			pShard->slots[slot].pConnection = nullptr;
+			pShard->slots[slot].generation = Core::Handle::NextGeneration(pShard->slots[slot].generation);
+			pShard->freeSlots.push_back(slot);
+			closesocket(pConnection->handle);
+			LeaveCriticalSection(&pShard->lock);
+		}
+
+		///
+		/// Queues a connect/disconnect notification.
+		///
+		void ServerSocketGroup::PostEvent(Shard *pShard, int32_t type, Connection *pConnection)
+		{
+			NetMessage *pMessage = pShard->pQueue->BeginEnqueue();
+
+			// connection events must not be lost, so wait for the game thread
+			while (pMessage == nullptr && m_nRunning != 0)
+			{
+				Sleep(0);
+				pMessage = pShard->pQueue->BeginEnqueue();
+			}
+
+			if (pMessage == nullptr)
+				return;
+
+			pMessage->type = type;
+			pMessage->shard = pShard->index;
+			pMessage->connection = pConnection->id;
+			pMessage->address = pConnection->address;
+			pMessage->length = 0;
+			pShard->pQueue->EndEnqueue();
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,284 @@
+#pragma once
+#ifndef _TEKSTORM_SERVERSOCKETGROUP_H
+#define _TEKSTORM_SERVERSOCKETGROUP_H
+#include "NetConfig.h"
+#include "IPEndPoint.h"
+#include "Socket.h"
+#include "../core/SpscQueue.h"
+#include "../core/Handle.h"
+
+namespace Tekstorm
+{
+	namespace Networking
+	{
+		///
+		/// The kind of event carried by a NetMessage.
+		///
+		enum NetMessageType
+		{
+			TEKNETMSG_DATA = 0,
+			TEKNETMSG_CONNECTED,
+			TEKNETMSG_DISCONNECTED
+		};
+
+		///
+		/// A decoded message handed from a ServerSocketGroup shard to a game thread.
+		/// For UDP every datagram is one message. For TCP every message is framed on
+		/// the wire by a 16-bit big-endian length prefix.
+		///
+		struct TEKAPI NetMessage
+		{
+			///
+			/// The largest payload that fits in a single Ethernet frame (1500 - IP - UDP headers).
+			///
+			static const int32_t MaxPayload = 1472;
+
+			///
+			/// One of NetMessageType.
+			///
+			int32_t type;
+
+			///
+			/// The shard that received the message.
+			///
+			int32_t shard;
+
+			///
+			/// The id of the TCP connection the message arrived on, or the null handle for
+			/// UDP. Pass it to ServerSocketGroup::Send() to reply.
+			///
+			Core::Handle connection;
+
+			///
+			/// The remote address. Kept raw so no IPEndPoint (and its string) is built per packet.
+			///
+			sockaddr_in address;
+
+			///
+			/// The number of valid bytes in payload.
+			///
+			int32_t length;
+
+			///
+			/// The message bytes.
+			///
+			char payload[MaxPayload];
+
+			///
+			/// Builds an IPEndPoint for the remote address.
+			///
+			IPEndPoint GetSource() const;
+		};
+
+		///
+		/// Opens one server socket per I/O thread ("shard") on the same endpoint so the
+		/// kernel can spread flows across cores. Each shard owns its own thread and hands
+		/// received messages to game threads through a single-producer/single-consumer queue.
+		///
+		/// Where the platform provides SO_REUSEPORT every shard gets its own socket and the
+		/// kernel load-balances between them. Winsock has no load-balancing equivalent, so
+		/// on Windows all shards service one shared non-blocking socket instead and
+		/// whichever shard wins the receive/accept takes the datagram/connection.
+		///
+		/// A TCP shard serves at most MaxConnectionsPerShard connections, waiting on
+		/// them with WSAPoll. A full shard stops accepting and leaves new connections
+		/// in the listen backlog for the other shards. A connection whose buffer is
+		/// full because the shard queue is full is not polled until the game thread
+		/// makes room; its bytes wait in the kernel meanwhile.
+		///
+		/// Game threads never see a connection's socket. They get a generation-checked
+		/// id that names the shard and a slot of its connection table; closing the
+		/// connection bumps the slot's generation, so a late Send() to the id fails
+		/// instead of writing to whatever socket reuses the value.
+		///
+		class TEKAPI ServerSocketGroup
+		{
+		protected:
+			///
+			/// Per-connection receive state for TCP shards.
+			///
+			struct Connection
+			{
+				SOCKET handle;
+				sockaddr_in address;
+				int32_t fill;
+
+				// Whether a complete frame is waiting for space in the shard queue.
+				bool stalled;
+
+				// The connection's entry in the shard's poll set, or -1 if it is left out.
+				int32_t pollIndex;
+
+				// The id handed to game threads.
+				Core::Handle id;
+				char buffer[2 + NetMessage::MaxPayload];
+			};
+
+			///
+			/// A slot of a shard's connection table. The generation is that of the id of
+			/// the connection in the slot, or of the next one when the slot is free.
+			///
+			struct ConnectionSlot
+			{
+				Connection *pConnection;
+				uint32_t generation;
+			};
+
+			///
+			/// The state owned by one I/O thread.
+			///
+			struct Shard
+			{
+				ServerSocketGroup *pGroup;
+				int32_t index;
+				Socket socket;
+				HANDLE thread;
+				Core::SpscQueue<NetMessage> *pQueue;
+				std::vector<Connection *> connections;
+				std::vector<WSAPOLLFD> pollSet;
+				volatile LONG dropped;
+
+				// The connection table, its free slots, and the lock Send() resolves ids under.
+				std::vector<ConnectionSlot> slots;
+				std::vector<uint32_t> freeSlots;
+				CRITICAL_SECTION lock;
+			};
+
+			///
+			/// The most TCP connections one shard serves.
+			///
+			static const int32_t MaxConnectionsPerShard = 4096;
+
+			///
+			/// The shards of this group.
+			///
+			std::vector<Shard *> m_shards;
+
+			///
+			/// SOCK_STREAM or SOCK_DGRAM.
+			///
+			int32_t m_nSocketType;
+
+			///
+			/// Whether or not the kernel balances between per-shard sockets.
+			///
+			bool m_bKernelBalanced;
+
+			///
+			/// Non-zero while the shard threads should keep running.
+			///
+			volatile LONG m_nRunning;
+
+			///
+			/// The I/O thread entry point.
+			///
+			static DWORD WINAPI ShardProc(LPVOID pParam);
+
+			///
+			/// Services a UDP shard until the group is stopped.
+			///
+			void RunDatagramShard(Shard *pShard);
+
+			///
+			/// Services a TCP shard until the group is stopped.
+			///
+			void RunStreamShard(Shard *pShard);
+
+			///
+			/// Decodes complete frames from a connection's buffer into the shard queue,
+			/// marking the connection stalled if the queue fills up. Returns false if
+			/// the connection sent a malformed frame.
+			///
+			bool DecodeFrames(Shard *pShard, Connection *pConnection);
+
+			///
+			/// Gives a new connection a slot of the shard's table and so its id.
+			///
+			void AddConnection(Shard *pShard, Connection *pConnection);
+
+			///
+			/// Frees a connection's slot, so its id stops resolving, and closes its socket.
+			///
+			void RemoveConnection(Shard *pShard, Connection *pConnection);
+
+			///
+			/// Queues a connect/disconnect notification.
+			///
+			void PostEvent(Shard *pShard, int32_t type, Connection *pConnection);
+
+			///
+			/// Groups are not copyable.
+			///
+			ServerSocketGroup(const ServerSocketGroup &other);
+			ServerSocketGroup &operator=(const ServerSocketGroup &other);
+
+		public:
+			///
+			/// The most shards a group has; connection ids hold the shard and slot in the
+			/// index bits of a Handle.
+			///
+			static const int32_t MaxShards = (int32_t)(Core::Handle::MaxIndices / MaxConnectionsPerShard);
+
+			ServerSocketGroup();
+			~ServerSocketGroup();
+
+			///
+			/// Binds the group to an endpoint and starts its I/O threads.
+			/// type - SOCK_DGRAM or SOCK_STREAM
+			/// shardCount - the number of I/O threads, or 0 for one per processor; at most MaxShards
+			/// queueCapacity - the number of messages each shard can buffer
+			///
+			bool Start(const IPEndPoint &endPoint, int32_t type, int32_t shardCount = 0, int32_t queueCapacity = 1024);
+
+			///
+			/// Stops all I/O threads and closes every socket and connection.
+			///
+			void Stop();
+
+			///
+			/// Gets the number of shards.
+			///
+			int32_t GetShardCount() const;
+
+			///
+			/// Returns true if every shard has its own kernel-balanced socket.
+			///
+			bool IsKernelBalanced() const;
+
+			///
+			/// Returns the oldest message of a shard without copying it, or nullptr.
+			/// Each shard must only be drained by a single game thread.
+			///
+			NetMessage *Peek(int32_t shard);
+
+			///
+			/// Releases the message returned by Peek().
+			///
+			void Pop(int32_t shard);
+
+			///
+			/// Copies the oldest message of a shard. Returns false if there is none.
+			///
+			bool Receive(int32_t shard, NetMessage *pMessage);
+
+			///
+			/// Sends a datagram through the given shard's socket (UDP groups).
+			///
+			int32_t SendTo(int32_t shard, const sockaddr_in &address, const char *data, int32_t size);
+
+			///
+			/// Sends one length-prefixed message on a TCP connection (TCP groups).
+			/// Returns -1 if size is not between 1 and NetMessage::MaxPayload, or if the
+			/// connection is closed.
+			///
+			int32_t Send(Core::Handle connection, const char *data, int32_t size);
+
+			///
+			/// Gets the number of datagrams a shard dropped because its queue was full.
+			///
+			int32_t GetDroppedCount(int32_t shard) const;
+		};
+	}
+}
+
+#endif /* _TEKSTORM_SERVERSOCKETGROUP_H */
\ No newline at end of file
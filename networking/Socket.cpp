@@ -213,5 +213,54 @@ namespace Tekstorm
 		{
 			return endPoint;
 		}
+
+		///
+		/// Sets an integer socket option (i.e. SOL_SOCKET, SO_REUSEADDR).
+		///
+		bool Socket::SetOption(int32_t level, int32_t name, int32_t value)
+		{
+#if defined(TEKSTORM_DEBUG)
+			if (socketType == 0 || socketProto == 0 || socketHandle == 0) { }
+			// handle error
+#endif
+			int result = setsockopt(socketHandle, level, name, (const char *)&value, sizeof(int32_t));
+			if (result != 0) {
+#if defined(TEKSTORM_DEBUG)
+				// handle error
+#endif
+				return false;
+			}
+
+			return true;
+		}
+
+		///
+		/// Switches this socket between blocking and non-blocking mode.
+		///
+		bool Socket::SetBlocking(bool blocking)
+		{
+#if defined(TEKSTORM_DEBUG)
+			if (socketType == 0 || socketProto == 0 || socketHandle == 0) { }
+			// handle error
+#endif
+			u_long nonBlocking = blocking ? 0 : 1;
+			int result = ioctlsocket(socketHandle, FIONBIO, &nonBlocking);
+			if (result != 0) {
+#if defined(TEKSTORM_DEBUG)
+				// handle error
+#endif
+				return false;
+			}
+
+			return true;
+		}
+
+		///
+		/// Gets the underlying socket handle.
+		///
+		SOCKET Socket::GetHandle() const
+		{
+			return socketHandle;
+		}
 	}
 }
\ No newline at end of file
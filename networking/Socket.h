@@ -93,6 +93,21 @@ namespace Tekstorm
 			/// Gets the end point.
 			///
 			virtual IPEndPoint GetEndPoint();
+
+			///
+			/// Sets an integer socket option (i.e. SOL_SOCKET, SO_REUSEADDR).
+			///
+			virtual bool SetOption(int32_t level, int32_t name, int32_t value);
+
+			///
+			/// Switches this socket between blocking and non-blocking mode.
+			///
+			virtual bool SetBlocking(bool blocking);
+
+			///
+			/// Gets the underlying socket handle.
+			///
+			virtual SOCKET GetHandle() const;
 		};
 	}
 }
@@ -0,0 +1,220 @@
+#define TEKSTORM_BUILD
+#include "Archetype.h"
+#include "../core/MemoryTracker.h"
+#include "../core/Debug.h"
+
+namespace Tekstorm
+{
+	namespace Scene
+	{
+		using Tekstorm::Core::Debug;
+
+		// Component arrays start on a cache line, or the component's alignment if larger.
+		static const size_t ArrayAlignment = 64;
+
+		///
+		/// Creates an empty archetype for a set of components.
+		///
+		Archetype::Archetype(const ComponentMask &mask)
+		{
+			m_mask = mask;
+			m_nEntityCount = 0;
+
+			size_t rowBytes = sizeof(Entity);
+			for (ComponentId id = 0; id < MaxComponents; id++)
+			{
+				m_offsets[id] = -1;
+				if (mask.Has(id))
+				{
+					m_components.push_back(id);
+					rowBytes += ComponentRegistry::GetInfo(id).size;
+				}
+			}
+
+			// shrink the estimate until the padded arrays fit
+			m_nChunkCapacity = (uint32_t)(ChunkSize / rowBytes);
+			while (m_nChunkCapacity > 1 && Layout(m_nChunkCapacity) > ChunkSize)
+				m_nChunkCapacity--;
+
+			if (m_nChunkCapacity == 0)
+				m_nChunkCapacity = 1;
+
+			size_t used = Layout(m_nChunkCapacity);
+			m_nChunkBytes = (used > ChunkSize) ? used : ChunkSize;
+		}
+
+		Archetype::~Archetype()
+		{
+			for (size_t i = 0; i < m_chunks.size(); i++)
+			{
+				_aligned_free(m_chunks[i].pData);
+				TEKMEM_FREE(Core::TEKMEMTAG_SCENE, m_nChunkBytes);
+			}
+		}
+
+		///
+		/// Lays out the component arrays for a chunk capacity.
+		///
+		size_t Archetype::Layout(uint32_t capacity)
+		{
+			size_t offset = sizeof(Entity) * capacity;
+			for (size_t i = 0; i < m_components.size(); i++)
+			{
+				const ComponentInfo &info = ComponentRegistry::GetInfo(m_components[i]);
+				size_t alignment = (info.alignment > ArrayAlignment) ? info.alignment : ArrayAlignment;
+				offset = (offset + alignment - 1) & ~(alignment - 1);
+				m_offsets[m_components[i]] = (int32_t)offset;
+				offset += info.size * capacity;
+			}
+
+			return offset;
+		}
+
+		///
+		/// Gets the component types of the archetype.
+		///
+		const ComponentMask &Archetype::GetMask() const
+		{
+			return m_mask;
+		}
+
+		///
+		/// Gets the number of entities stored.
+		///
+		int32_t Archetype::GetEntityCount() const
+		{
+			return m_nEntityCount;
+		}
+
+		///
+		/// Gets the number of chunks.
+		///
+		uint32_t Archetype::GetChunkCount() const
+		{
+			return (uint32_t)m_chunks.size();
+		}
+
+		///
+		/// Gets the number of rows a chunk holds.
+		///
+		uint32_t Archetype::GetChunkCapacity() const
+		{
+			return m_nChunkCapacity;
+		}
+
+		///
+		/// Gets the number of rows in use in a chunk.
+		///
+		uint32_t Archetype::GetRowCount(uint32_t chunk) const
+		{
+			return m_chunks[chunk].count;
+		}
+
+		///
+		/// Gets the entity handles of a chunk.
+		///
+		Entity *Archetype::GetEntities(uint32_t chunk) const
+		{
+			return (Entity *)m_chunks[chunk].pData;
+		}
+
+		///
+		/// Gets a chunk's array of a component.
+		///
+		void *Archetype::GetComponentArray(uint32_t chunk, ComponentId id) const
+		{
+			if (id < 0 || m_offsets[id] < 0)
+				return nullptr;
+
+			return m_chunks[chunk].pData + m_offsets[id];
+		}
+
+		///
+		/// Gets one row's component.
+		///
+		void *Archetype::GetComponent(uint32_t chunk, uint32_t row, ComponentId id) const
+		{
+			if (id < 0 || m_offsets[id] < 0)
+				return nullptr;
+
+			return m_chunks[chunk].pData + m_offsets[id] + row * ComponentRegistry::GetInfo(id).size;
+		}
+
+		///
+		/// Appends a row for an entity with default-constructed components.
+		///
+		bool Archetype::AddRow(Entity entity, uint32_t &chunk, uint32_t &row)
+		{
+			if (m_chunks.empty() || m_chunks.back().count == m_nChunkCapacity)
+			{
+				ArchetypeChunk newChunk;
+				newChunk.pData = (char *)_aligned_malloc(m_nChunkBytes, ArrayAlignment);
+				if (newChunk.pData == nullptr)
+				{
+					TEKDEBUG_EF("Archetype could not allocate a chunk.");
+					return false;
+				}
+
+				TEKMEM_ALLOC(Core::TEKMEMTAG_SCENE, m_nChunkBytes);
+				newChunk.count = 0;
+				m_chunks.push_back(newChunk);
+			}
+
+			chunk = (uint32_t)m_chunks.size() - 1;
+			row = m_chunks[chunk].count++;
+			m_nEntityCount++;
+
+			GetEntities(chunk)[row] = entity;
+			for (size_t i = 0; i < m_components.size(); i++)
+				ComponentRegistry::GetInfo(m_components[i]).construct(GetComponent(chunk, row, m_components[i]));
+
+			return true;
+		}
+
+		///
+		/// Removes a row by moving the last row into it.
+		///
+		Entity Archetype::RemoveRow(uint32_t chunk, uint32_t row)
+		{
+			uint32_t lastChunk = (uint32_t)m_chunks.size() - 1;
+			uint32_t lastRow = m_chunks[lastChunk].count - 1;
+
+			Entity moved;
+			if (chunk != lastChunk || row != lastRow)
+			{
+				moved = GetEntities(lastChunk)[lastRow];
+				GetEntities(chunk)[row] = moved;
+				for (size_t i = 0; i < m_components.size(); i++)
+				{
+					ComponentId id = m_components[i];
+					memcpy(GetComponent(chunk, row, id), GetComponent(lastChunk, lastRow, id), ComponentRegistry::GetInfo(id).size);
+				}
+			}
+
+			m_nEntityCount--;
+			if (--m_chunks[lastChunk].count == 0)
+			{
+				_aligned_free(m_chunks[lastChunk].pData);
+				TEKMEM_FREE(Core::TEKMEMTAG_SCENE, m_nChunkBytes);
+				m_chunks.pop_back();
+			}
+
+			return moved;
+		}
+
+		///
+		/// Copies the components two archetypes share from one row to another.
+		///
+		void Archetype::CopyRow(const Archetype &source, uint32_t sourceChunk, uint32_t sourceRow,
+			const Archetype &target, uint32_t targetChunk, uint32_t targetRow)
+		{
+			for (size_t i = 0; i < target.m_components.size(); i++)
+			{
+				ComponentId id = target.m_components[i];
+				void *pSource = source.GetComponent(sourceChunk, sourceRow, id);
+				if (pSource != nullptr)
+					memcpy(target.GetComponent(targetChunk, targetRow, id), pSource, ComponentRegistry::GetInfo(id).size);
+			}
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,151 @@
+#pragma once
+#ifndef _TEKSTORM_ARCHETYPE_H
+#define _TEKSTORM_ARCHETYPE_H
+#include "Component.h"
+
+namespace Tekstorm
+{
+	namespace Scene
+	{
+		///
+		/// One chunk of an archetype.
+		///
+		struct ArchetypeChunk
+		{
+			char *pData;
+			uint32_t count;
+		};
+
+		///
+		/// Stores every entity with one exact set of components.
+		///
+		/// Entities live in fixed-size chunks laid out as structures of arrays: the
+		/// chunk holds the entity handles followed by one tightly packed array per
+		/// component, so a system touching two components streams through two
+		/// contiguous arrays. Chunks are kept dense; removing a row moves the
+		/// archetype's last row into the hole.
+		///
+		class TEKAPI Archetype
+		{
+		public:
+			///
+			/// The size of a chunk in bytes.
+			///
+			static const size_t ChunkSize = 16 * 1024;
+
+		protected:
+			///
+			/// The component types of the archetype.
+			///
+			ComponentMask m_mask;
+
+			///
+			/// The component types, in id order.
+			///
+			std::vector<ComponentId> m_components;
+
+			///
+			/// The offset of each component's array in a chunk, or -1 if absent.
+			///
+			int32_t m_offsets[MaxComponents];
+
+			///
+			/// The number of rows a chunk holds.
+			///
+			uint32_t m_nChunkCapacity;
+
+			///
+			/// The size of a chunk; ChunkSize unless a single row is larger.
+			///
+			size_t m_nChunkBytes;
+
+			///
+			/// The chunks; all but the last are full.
+			///
+			std::vector<ArchetypeChunk> m_chunks;
+
+			///
+			/// The number of entities stored.
+			///
+			int32_t m_nEntityCount;
+
+			///
+			/// Archetypes are not copyable.
+			///
+			Archetype(const Archetype &other);
+			Archetype &operator=(const Archetype &other);
+
+			///
+			/// Lays out the component arrays for a chunk capacity. Returns the bytes used.
+			///
+			size_t Layout(uint32_t capacity);
+
+		public:
+			///
+			/// Creates an empty archetype for a set of components.
+			///
+			Archetype(const ComponentMask &mask);
+			~Archetype();
+
+			///
+			/// Gets the component types of the archetype.
+			///
+			const ComponentMask &GetMask() const;
+
+			///
+			/// Gets the number of entities stored.
+			///
+			int32_t GetEntityCount() const;
+
+			///
+			/// Gets the number of chunks.
+			///
+			uint32_t GetChunkCount() const;
+
+			///
+			/// Gets the number of rows a chunk holds.
+			///
+			uint32_t GetChunkCapacity() const;
+
+			///
+			/// Gets the number of rows in use in a chunk.
+			///
+			uint32_t GetRowCount(uint32_t chunk) const;
+
+			///
+			/// Gets the entity handles of a chunk.
+			///
+			Entity *GetEntities(uint32_t chunk) const;
+
+			///
+			/// Gets a chunk's array of a component, or nullptr if the archetype lacks it.
+			///
+			void *GetComponentArray(uint32_t chunk, ComponentId id) const;
+
+			///
+			/// Gets one row's component, or nullptr if the archetype lacks it.
+			///
+			void *GetComponent(uint32_t chunk, uint32_t row, ComponentId id) const;
+
+			///
+			/// Appends a row for an entity with default-constructed components.
+			/// Returns false, and reports an error, if a chunk cannot be allocated.
+			///
+			bool AddRow(Entity entity, uint32_t &chunk, uint32_t &row);
+
+			///
+			/// Removes a row by moving the last row into it. Returns the entity that
+			/// was moved, or a null handle if the removed row was the last.
+			///
+			Entity RemoveRow(uint32_t chunk, uint32_t row);
+
+			///
+			/// Copies the components two archetypes share from one row to another.
+			///
+			static void CopyRow(const Archetype &source, uint32_t sourceChunk, uint32_t sourceRow,
+				const Archetype &target, uint32_t targetChunk, uint32_t targetRow);
+		};
+	}
+}
+
+#endif /* _TEKSTORM_ARCHETYPE_H */
\ No newline at end of file
@@ -0,0 +1,134 @@
+#define TEKSTORM_BUILD
+#include "CommandBuffer.h"
+
+namespace Tekstorm
+{
+	namespace Scene
+	{
+		///
+		/// Precedes every recorded command; the payload follows, padded to 8 bytes.
+		///
+		struct CommandHeader
+		{
+			int32_t type;
+			int32_t pending;
+			ComponentId id;
+			uint32_t target;
+			uint32_t size;
+			uint32_t reserved;
+		};
+
+		CommandBuffer::CommandBuffer()
+		{
+			m_nPendingCount = 0;
+		}
+
+		///
+		/// Appends a command.
+		///
+		void CommandBuffer::Write(CommandType type, uint32_t target, bool pending, ComponentId id, const void *pData, size_t size)
+		{
+			size_t padded = (size + 7) & ~(size_t)7;
+			size_t offset = m_buffer.size();
+			m_buffer.resize(offset + sizeof(CommandHeader) + padded);
+
+			CommandHeader *pHeader = (CommandHeader *)&m_buffer[offset];
+			pHeader->type = type;
+			pHeader->pending = pending ? 1 : 0;
+			pHeader->id = id;
+			pHeader->target = target;
+			pHeader->size = (uint32_t)size;
+			pHeader->reserved = 0;
+
+			if (size > 0)
+				memcpy(pHeader + 1, pData, size);
+		}
+
+		///
+		/// Records the creation of an entity with default-constructed components.
+		///
+		PendingEntity CommandBuffer::Create(const ComponentMask &mask)
+		{
+			uint64_t bits = mask.GetValue();
+			Write(TEKCMD_CREATE, 0, false, InvalidComponent, &bits, sizeof(bits));
+
+			PendingEntity entity = { m_nPendingCount++ };
+			return entity;
+		}
+
+		///
+		/// Records the destruction of an entity.
+		///
+		void CommandBuffer::Destroy(Entity entity)
+		{
+			Write(TEKCMD_DESTROY, entity.GetValue(), false, InvalidComponent, nullptr, 0);
+		}
+
+		///
+		/// Returns true if nothing was recorded.
+		///
+		bool CommandBuffer::IsEmpty() const
+		{
+			return m_buffer.empty();
+		}
+
+		///
+		/// Applies the commands to a world and clears the buffer.
+		///
+		void CommandBuffer::Playback(World *pWorld, std::vector<Entity> *pCreated)
+		{
+			std::vector<Entity> created;
+			if (pCreated == nullptr)
+				pCreated = &created;
+
+			pCreated->clear();
+
+			size_t offset = 0;
+			while (offset < m_buffer.size())
+			{
+				const CommandHeader *pHeader = (const CommandHeader *)&m_buffer[offset];
+				const char *pPayload = (const char *)(pHeader + 1);
+				offset += sizeof(CommandHeader) + ((pHeader->size + 7) & ~(uint32_t)7);
+
+				Entity target = Entity::FromValue(pHeader->target);
+				if (pHeader->pending != 0)
+					target = (*pCreated)[pHeader->target];
+
+				switch (pHeader->type)
+				{
+				case TEKCMD_CREATE:
+					pCreated->push_back(pWorld->Create(ComponentMask::FromValue(*(const uint64_t *)pPayload)));
+					break;
+
+				case TEKCMD_DESTROY:
+					pWorld->Destroy(target);
+					break;
+
+				case TEKCMD_ADD:
+					{
+						// components are plain data, so the recorded bytes are the value
+						void *pComponent = pWorld->AddComponent(target, pHeader->id);
+						if (pComponent != nullptr)
+							memcpy(pComponent, pPayload, pHeader->size);
+					}
+					break;
+
+				case TEKCMD_REMOVE:
+					pWorld->RemoveComponent(target, pHeader->id);
+					break;
+				}
+			}
+
+			Clear();
+		}
+
+		///
+		/// Discards the commands, keeping the memory.
+		///
+		void CommandBuffer::Clear()
+		{
+			m_buffer.clear();
+			m_nPendingCount = 0;
+		}
+	}
+}
\ No newline at end of file
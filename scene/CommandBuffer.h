@@ -0,0 +1,121 @@
+#pragma once
+#ifndef _TEKSTORM_COMMANDBUFFER_H
+#define _TEKSTORM_COMMANDBUFFER_H
+#include "World.h"
+
+namespace Tekstorm
+{
+	namespace Scene
+	{
+		///
+		/// The kinds of command a CommandBuffer records.
+		///
+		enum CommandType
+		{
+			TEKCMD_CREATE,
+			TEKCMD_DESTROY,
+			TEKCMD_ADD,
+			TEKCMD_REMOVE
+		};
+
+		///
+		/// An entity a CommandBuffer will create on playback.
+		///
+		struct PendingEntity
+		{
+			int32_t index;
+		};
+
+		///
+		/// Records structural changes to a World for later playback.
+		///
+		/// Systems running inside a query cannot create or destroy entities or add or
+		/// remove components; they record the changes here and the owner plays them
+		/// back once iteration is over. Give every job its own buffer; recording is
+		/// not thread-safe. Commands replay in recording order, and commands on
+		/// entities that no longer exist are skipped.
+		///
+		class TEKAPI CommandBuffer
+		{
+		protected:
+			///
+			/// The recorded commands.
+			///
+			std::vector<char> m_buffer;
+
+			///
+			/// The number of entities Create() has promised.
+			///
+			int32_t m_nPendingCount;
+
+			///
+			/// Buffers are not copyable.
+			///
+			CommandBuffer(const CommandBuffer &other);
+			CommandBuffer &operator=(const CommandBuffer &other);
+
+			///
+			/// Appends a command.
+			///
+			void Write(CommandType type, uint32_t target, bool pending, ComponentId id, const void *pData, size_t size);
+
+		public:
+			CommandBuffer();
+
+			///
+			/// Records the creation of an entity with default-constructed components.
+			///
+			PendingEntity Create(const ComponentMask &mask = ComponentMask());
+
+			///
+			/// Records the destruction of an entity.
+			///
+			void Destroy(Entity entity);
+
+			///
+			/// Records adding (or overwriting) a component of an existing entity.
+			///
+			template <class _Type>
+			void Add(Entity entity, const _Type &value)
+			{
+				Write(TEKCMD_ADD, entity.GetValue(), false, ComponentRegistry::GetId<_Type>(), &value, sizeof(_Type));
+			}
+
+			///
+			/// Records adding (or overwriting) a component of a pending entity.
+			///
+			template <class _Type>
+			void Add(PendingEntity entity, const _Type &value)
+			{
+				Write(TEKCMD_ADD, (uint32_t)entity.index, true, ComponentRegistry::GetId<_Type>(), &value, sizeof(_Type));
+			}
+
+			///
+			/// Records removing a component.
+			///
+			template <class _Type>
+			void Remove(Entity entity)
+			{
+				Write(TEKCMD_REMOVE, entity.GetValue(), false, ComponentRegistry::GetId<_Type>(), nullptr, 0);
+			}
+
+			///
+			/// Returns true if nothing was recorded.
+			///
+			bool IsEmpty() const;
+
+			///
+			/// Applies the commands to a world and clears the buffer. If pCreated is given,
+			/// it receives the created entities, indexed by PendingEntity::index.
+			///
+			void Playback(World *pWorld, std::vector<Entity> *pCreated = nullptr);
+
+			///
+			/// Discards the commands, keeping the memory.
+			///
+			void Clear();
+		};
+	}
+}
+
+#endif /* _TEKSTORM_COMMANDBUFFER_H */
\ No newline at end of file
@@ -0,0 +1,48 @@
+#define TEKSTORM_BUILD
+#include "Component.h"
+
+namespace Tekstorm
+{
+	namespace Scene
+	{
+		static ComponentInfo s_components[MaxComponents];
+		static int32_t s_nComponentCount = 0;
+
+		///
+		/// Registers a component type.
+		///
+		ComponentId ComponentRegistry::RegisterType(const char *name, size_t size, size_t alignment, void (*construct)(void *p))
+		{
+			if (s_nComponentCount == MaxComponents)
+			{
+#if defined(TEKSTORM_DEBUG)
+				TEKDEBUG_W("Too many component types; cannot register " << name);
+#endif
+				return InvalidComponent;
+			}
+
+			ComponentInfo &info = s_components[s_nComponentCount];
+			info.name = name;
+			info.size = size;
+			info.alignment = alignment;
+			info.construct = construct;
+			return s_nComponentCount++;
+		}
+
+		///
+		/// Gets the description of a component type.
+		///
+		const ComponentInfo &ComponentRegistry::GetInfo(ComponentId id)
+		{
+			return s_components[id];
+		}
+
+		///
+		/// Gets the number of registered component types.
+		///
+		int32_t ComponentRegistry::GetCount()
+		{
+			return s_nComponentCount;
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,195 @@
+#pragma once
+#ifndef _TEKSTORM_COMPONENT_H
+#define _TEKSTORM_COMPONENT_H
+#include "../tekconfig.h"
+#include "../core/Handle.h"
+#include <new>
+
+namespace Tekstorm
+{
+	namespace Scene
+	{
+		///
+		/// An entity is a generational handle into a World.
+		///
+		typedef Core::Handle Entity;
+
+		///
+		/// Identifies a registered component type.
+		///
+		typedef int32_t ComponentId;
+
+		///
+		/// The number of component types a program can register.
+		///
+		static const int32_t MaxComponents = 64;
+
+		///
+		/// The id of an unregistered component type.
+		///
+		static const ComponentId InvalidComponent = -1;
+
+		///
+		/// Describes a registered component type.
+		///
+		struct ComponentInfo
+		{
+			const char *name;
+			size_t size;
+			size_t alignment;
+
+			// Default-constructs a component in place.
+			void (*construct)(void *p);
+		};
+
+		///
+		/// A set of component types.
+		///
+		class ComponentMask
+		{
+		protected:
+			uint64_t m_nBits;
+
+		public:
+			ComponentMask() : m_nBits(0)
+			{
+			}
+
+			///
+			/// Adds a component type to the set.
+			///
+			ComponentMask &Set(ComponentId id)
+			{
+				m_nBits |= (uint64_t)1 << id;
+				return *this;
+			}
+
+			///
+			/// Removes a component type from the set.
+			///
+			ComponentMask &Clear(ComponentId id)
+			{
+				m_nBits &= ~((uint64_t)1 << id);
+				return *this;
+			}
+
+			///
+			/// Returns true if the set holds the component type.
+			///
+			bool Has(ComponentId id) const
+			{
+				return (m_nBits & ((uint64_t)1 << id)) != 0;
+			}
+
+			///
+			/// Returns true if the set holds every type of 'other'.
+			///
+			bool Contains(const ComponentMask &other) const
+			{
+				return (m_nBits & other.m_nBits) == other.m_nBits;
+			}
+
+			///
+			/// Returns true if the sets share a type.
+			///
+			bool Intersects(const ComponentMask &other) const
+			{
+				return (m_nBits & other.m_nBits) != 0;
+			}
+
+			///
+			/// Gets the packed bits.
+			///
+			uint64_t GetValue() const
+			{
+				return m_nBits;
+			}
+
+			///
+			/// Rebuilds a set from its packed bits.
+			///
+			static ComponentMask FromValue(uint64_t value)
+			{
+				ComponentMask mask;
+				mask.m_nBits = value;
+				return mask;
+			}
+
+			bool operator==(const ComponentMask &other) const { return m_nBits == other.m_nBits; }
+			bool operator!=(const ComponentMask &other) const { return m_nBits != other.m_nBits; }
+		};
+
+		///
+		/// Holds the id a component type was registered with.
+		///
+		template <class _Type>
+		struct ComponentTypeId
+		{
+			static ComponentId value;
+		};
+
+		template <class _Type>
+		ComponentId ComponentTypeId<_Type>::value = InvalidComponent;
+
+		///
+		/// The registry of component types.
+		///
+		/// Components are plain data: they are default-constructed in place, copied
+		/// and moved between chunks with memcpy, and never destructed. Register every
+		/// type at startup, before worlds use it; registration is not thread-safe.
+		///
+		class TEKAPI ComponentRegistry
+		{
+		private:
+			///
+			/// No public constructor
+			///
+			ComponentRegistry();
+
+			template <class _Type>
+			static void Construct(void *p)
+			{
+				new (p) _Type();
+			}
+
+			///
+			/// Registers a component type. Returns InvalidComponent if the registry is full.
+			///
+			static ComponentId RegisterType(const char *name, size_t size, size_t alignment, void (*construct)(void *p));
+
+		public:
+			///
+			/// Registers a component type, or gets its id if it already is.
+			///
+			template <class _Type>
+			static ComponentId Register(const char *name)
+			{
+				if (ComponentTypeId<_Type>::value == InvalidComponent)
+					ComponentTypeId<_Type>::value = RegisterType(name, sizeof(_Type), __alignof(_Type), &Construct<_Type>);
+
+				return ComponentTypeId<_Type>::value;
+			}
+
+			///
+			/// Gets the id of a registered component type.
+			///
+			template <class _Type>
+			static ComponentId GetId()
+			{
+				return ComponentTypeId<_Type>::value;
+			}
+
+			///
+			/// Gets the description of a component type.
+			///
+			static const ComponentInfo &GetInfo(ComponentId id);
+
+			///
+			/// Gets the number of registered component types.
+			///
+			static int32_t GetCount();
+		};
+	}
+}
+
+#endif /* _TEKSTORM_COMPONENT_H */
\ No newline at end of file
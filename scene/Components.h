@@ -0,0 +1,62 @@
+#pragma once
+#ifndef _TEKSTORM_COMPONENTS_H
+#define _TEKSTORM_COMPONENTS_H
+#include "Component.h"
+#include "../math/Vector2.h"
+#include "../math/Color4.h"
+
+namespace Tekstorm
+{
+	namespace Scene
+	{
+		///
+		/// The position of an entity in world units.
+		///
+		struct Position
+		{
+			Math::Vector2 value;
+		};
+
+		///
+		/// The velocity of an entity in world units per second.
+		///
+		struct Velocity
+		{
+			Math::Vector2 value;
+		};
+
+		///
+		/// The color an entity's sprite is multiplied with.
+		///
+		struct Tint
+		{
+			Math::Color4 value;
+		};
+
+		///
+		/// The sprite an entity draws: a texture id and a frame within it.
+		///
+		struct SpriteRef
+		{
+			uint32_t texture;
+			uint32_t frame;
+
+			SpriteRef() : texture(0), frame(0)
+			{
+			}
+		};
+
+		///
+		/// Registers the engine's built-in component types.
+		///
+		inline void RegisterBuiltinComponents()
+		{
+			ComponentRegistry::Register<Position>("Position");
+			ComponentRegistry::Register<Velocity>("Velocity");
+			ComponentRegistry::Register<Tint>("Tint");
+			ComponentRegistry::Register<SpriteRef>("SpriteRef");
+		}
+	}
+}
+
+#endif /* _TEKSTORM_COMPONENTS_H */
\ No newline at end of file
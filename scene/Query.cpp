@@ -0,0 +1,88 @@
+#define TEKSTORM_BUILD
+#include "Query.h"
+#include "../core/JobSystem.h"
+
+namespace Tekstorm
+{
+	namespace Scene
+	{
+		///
+		/// The state of one ParallelForEachChunk() call.
+		///
+		struct ChunkBatch
+		{
+			const ChunkView *pChunks;
+			ChunkFunction function;
+			void *pData;
+		};
+
+		static void RunChunkRange(void *pData, int32_t begin, int32_t end)
+		{
+			ChunkBatch *pBatch = (ChunkBatch *)pData;
+			for (int32_t i = begin; i < end; i++)
+				pBatch->function(pBatch->pData, pBatch->pChunks[i]);
+		}
+
+		///
+		/// Creates a query for entities having 'required' and none of 'excluded'.
+		///
+		Query::Query(World *pWorld, const ComponentMask &required, const ComponentMask &excluded)
+		{
+			m_pWorld = pWorld;
+			m_required = required;
+			m_excluded = excluded;
+			m_nTestedCount = 0;
+		}
+
+		///
+		/// Tests the archetypes added to the world since the last refresh.
+		///
+		void Query::Refresh()
+		{
+			int32_t count = m_pWorld->GetArchetypeCount();
+			for (; m_nTestedCount < count; m_nTestedCount++)
+			{
+				Archetype *pArchetype = m_pWorld->GetArchetype(m_nTestedCount);
+				const ComponentMask &mask = pArchetype->GetMask();
+				if (mask.Contains(m_required) && !mask.Intersects(m_excluded))
+					m_archetypes.push_back(pArchetype);
+			}
+		}
+
+		///
+		/// Gets the number of matching entities.
+		///
+		int32_t Query::GetEntityCount()
+		{
+			Refresh();
+
+			int32_t count = 0;
+			for (size_t i = 0; i < m_archetypes.size(); i++)
+				count += m_archetypes[i]->GetEntityCount();
+
+			return count;
+		}
+
+		///
+		/// Calls function(pData, chunk) for every matching chunk across the job system's threads.
+		///
+		void Query::ParallelForEachChunk(Core::JobSystem *pJobs, ChunkFunction function, void *pData)
+		{
+			Refresh();
+
+			m_chunks.clear();
+			for (size_t a = 0; a < m_archetypes.size(); a++)
+			{
+				for (uint32_t c = 0; c < m_archetypes[a]->GetChunkCount(); c++)
+					m_chunks.push_back(ChunkView(m_archetypes[a], c));
+			}
+
+			if (m_chunks.empty())
+				return;
+
+			// a chunk is already hundreds of rows, so hand them out one at a time
+			ChunkBatch batch = { &m_chunks[0], function, pData };
+			pJobs->ParallelFor((int32_t)m_chunks.size(), &RunChunkRange, &batch, 1);
+		}
+	}
+}
\ No newline at end of file
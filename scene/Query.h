@@ -0,0 +1,144 @@
+#pragma once
+#ifndef _TEKSTORM_QUERY_H
+#define _TEKSTORM_QUERY_H
+#include "World.h"
+
+namespace Tekstorm
+{
+	namespace Scene
+	{
+		///
+		/// The rows of one archetype chunk, as seen by a system.
+		///
+		class ChunkView
+		{
+		protected:
+			Archetype *m_pArchetype;
+			uint32_t m_nChunk;
+
+		public:
+			ChunkView() : m_pArchetype(nullptr), m_nChunk(0)
+			{
+			}
+
+			ChunkView(Archetype *pArchetype, uint32_t chunk) : m_pArchetype(pArchetype), m_nChunk(chunk)
+			{
+			}
+
+			///
+			/// Gets the number of rows.
+			///
+			uint32_t GetCount() const
+			{
+				return m_pArchetype->GetRowCount(m_nChunk);
+			}
+
+			///
+			/// Gets the entity of each row.
+			///
+			const Entity *GetEntities() const
+			{
+				return m_pArchetype->GetEntities(m_nChunk);
+			}
+
+			///
+			/// Gets the array of a component, or nullptr if the chunk lacks it.
+			///
+			template <class _Type>
+			_Type *GetArray() const
+			{
+				return (_Type *)m_pArchetype->GetComponentArray(m_nChunk, ComponentRegistry::GetId<_Type>());
+			}
+
+			///
+			/// Gets the archetype of the chunk.
+			///
+			Archetype *GetArchetype() const
+			{
+				return m_pArchetype;
+			}
+		};
+
+		///
+		/// A chunk iteration body for Query::ParallelForEachChunk().
+		///
+		typedef void (*ChunkFunction)(void *pData, const ChunkView &chunk);
+
+		///
+		/// Finds the chunks of every entity having a set of components.
+		///
+		/// The matching archetypes are cached; since worlds never remove archetypes,
+		/// each run only tests the archetypes created since the previous one.
+		///
+		class TEKAPI Query
+		{
+		protected:
+			World *m_pWorld;
+
+			///
+			/// The components an entity must have.
+			///
+			ComponentMask m_required;
+
+			///
+			/// The components an entity must not have.
+			///
+			ComponentMask m_excluded;
+
+			///
+			/// The matching archetypes.
+			///
+			std::vector<Archetype *> m_archetypes;
+
+			///
+			/// The number of the world's archetypes tested so far.
+			///
+			int32_t m_nTestedCount;
+
+			///
+			/// The chunks handed to ParallelForEachChunk() workers.
+			///
+			std::vector<ChunkView> m_chunks;
+
+			///
+			/// Tests the archetypes added to the world since the last refresh.
+			///
+			void Refresh();
+
+		public:
+			///
+			/// Creates a query for entities having 'required' and none of 'excluded'.
+			///
+			Query(World *pWorld, const ComponentMask &required, const ComponentMask &excluded = ComponentMask());
+
+			///
+			/// Gets the number of matching entities.
+			///
+			int32_t GetEntityCount();
+
+			///
+			/// Calls function(const ChunkView &) for every matching chunk.
+			///
+			template <class _Function>
+			void ForEachChunk(_Function function)
+			{
+				Refresh();
+				for (size_t a = 0; a < m_archetypes.size(); a++)
+				{
+					Archetype *pArchetype = m_archetypes[a];
+					for (uint32_t c = 0; c < pArchetype->GetChunkCount(); c++)
+						function(ChunkView(pArchetype, c));
+				}
+			}
+
+			///
+			/// Calls function(pData, chunk) for every matching chunk across the job
+			/// system's threads, and waits. The function may write the components of its
+			/// chunk but must not change the world's structure.
+			///
+			void ParallelForEachChunk(Core::JobSystem *pJobs, ChunkFunction function, void *pData);
+		};
+	}
+}
+
+#endif /* _TEKSTORM_QUERY_H */
\ No newline at end of file
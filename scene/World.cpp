@@ -0,0 +1,254 @@
+#define TEKSTORM_BUILD
+#include "World.h"
+#include "../core/MemoryTracker.h"
+#include "../core/Debug.h"
+
+namespace Tekstorm
+{
+	namespace Scene
+	{
+		using Tekstorm::Core::Debug;
+
+		World::World()
+		{
+			m_nEntityCount = 0;
+		}
+
+		World::~World()
+		{
+			for (size_t i = 0; i < m_archetypes.size(); i++)
+			{
+				delete m_archetypes[i];
+				TEKMEM_FREE(Core::TEKMEMTAG_SCENE, sizeof(Archetype));
+			}
+		}
+
+		///
+		/// Gets the record of a live entity, or nullptr.
+		///
+		EntityRecord *World::Resolve(Entity entity)
+		{
+			uint32_t index = entity.GetIndex();
+			if (entity.IsNull() || index >= m_records.size())
+				return nullptr;
+
+			EntityRecord &record = m_records[index];
+			if (record.pArchetype == nullptr || record.generation != entity.GetGeneration())
+				return nullptr;
+
+			return &record;
+		}
+
+		const EntityRecord *World::Resolve(Entity entity) const
+		{
+			return const_cast<World *>(this)->Resolve(entity);
+		}
+
+		///
+		/// Moves an entity to another archetype, keeping the components both share.
+		///
+		bool World::Move(EntityRecord &record, Archetype *pTarget)
+		{
+			Archetype *pSource = record.pArchetype;
+			Entity entity = pSource->GetEntities(record.chunk)[record.row];
+
+			uint32_t chunk = 0;
+			uint32_t row = 0;
+			if (!pTarget->AddRow(entity, chunk, row))
+				return false;
+
+			Archetype::CopyRow(*pSource, record.chunk, record.row, *pTarget, chunk, row);
+
+			Entity moved = pSource->RemoveRow(record.chunk, record.row);
+			if (!moved.IsNull())
+			{
+				EntityRecord &movedRecord = m_records[moved.GetIndex()];
+				movedRecord.chunk = record.chunk;
+				movedRecord.row = record.row;
+			}
+
+			record.pArchetype = pTarget;
+			record.chunk = chunk;
+			record.row = row;
+			return true;
+		}
+
+		///
+		/// Creates an entity with default-constructed components of the given types.
+		///
+		Entity World::Create(const ComponentMask &mask)
+		{
+			uint32_t index = 0;
+			if (!m_freeIndices.empty())
+			{
+				index = m_freeIndices.back();
+				m_freeIndices.pop_back();
+			}
+			else
+			{
+				if (m_records.size() >= Core::Handle::MaxIndices)
+				{
+					TEKDEBUG_EF("World is full; it holds at most Handle::MaxIndices entities.");
+					return Entity();
+				}
+
+				index = (uint32_t)m_records.size();
+				EntityRecord record = { nullptr, 0, 0, 1 };
+				m_records.push_back(record);
+			}
+
+			EntityRecord &record = m_records[index];
+			Entity entity(index, record.generation);
+			Archetype *pArchetype = GetArchetype(mask);
+			if (!pArchetype->AddRow(entity, record.chunk, record.row))
+			{
+				m_freeIndices.push_back(index);
+				return Entity();
+			}
+
+			record.pArchetype = pArchetype;
+
+			m_nEntityCount++;
+			return entity;
+		}
+
+		///
+		/// Destroys an entity.
+		///
+		bool World::Destroy(Entity entity)
+		{
+			EntityRecord *pRecord = Resolve(entity);
+			if (pRecord == nullptr)
+				return false;
+
+			Entity moved = pRecord->pArchetype->RemoveRow(pRecord->chunk, pRecord->row);
+			if (!moved.IsNull())
+			{
+				EntityRecord &movedRecord = m_records[moved.GetIndex()];
+				movedRecord.chunk = pRecord->chunk;
+				movedRecord.row = pRecord->row;
+			}
+
+			pRecord->pArchetype = nullptr;
+			pRecord->generation = Core::Handle::NextGeneration(pRecord->generation);
+			m_freeIndices.push_back(entity.GetIndex());
+
+			m_nEntityCount--;
+			return true;
+		}
+
+		///
+		/// Returns true if the entity exists.
+		///
+		bool World::IsAlive(Entity entity) const
+		{
+			return Resolve(entity) != nullptr;
+		}
+
+		///
+		/// Gets the component types of an entity.
+		///
+		ComponentMask World::GetMask(Entity entity) const
+		{
+			const EntityRecord *pRecord = Resolve(entity);
+			return (pRecord != nullptr) ? pRecord->pArchetype->GetMask() : ComponentMask();
+		}
+
+		///
+		/// Adds a default-constructed component, or gets the existing one.
+		///
+		void *World::AddComponent(Entity entity, ComponentId id)
+		{
+			EntityRecord *pRecord = Resolve(entity);
+			if (pRecord == nullptr || id == InvalidComponent)
+				return nullptr;
+
+			if (!pRecord->pArchetype->GetMask().Has(id))
+			{
+				ComponentMask mask = pRecord->pArchetype->GetMask();
+				if (!Move(*pRecord, GetArchetype(mask.Set(id))))
+					return nullptr;
+			}
+
+			return pRecord->pArchetype->GetComponent(pRecord->chunk, pRecord->row, id);
+		}
+
+		///
+		/// Removes a component.
+		///
+		bool World::RemoveComponent(Entity entity, ComponentId id)
+		{
+			EntityRecord *pRecord = Resolve(entity);
+			if (pRecord == nullptr || id == InvalidComponent || !pRecord->pArchetype->GetMask().Has(id))
+				return false;
+
+			ComponentMask mask = pRecord->pArchetype->GetMask();
+			return Move(*pRecord, GetArchetype(mask.Clear(id)));
+		}
+
+		///
+		/// Gets a component, or nullptr if the entity or component does not exist.
+		///
+		void *World::GetComponent(Entity entity, ComponentId id) const
+		{
+			const EntityRecord *pRecord = Resolve(entity);
+			if (pRecord == nullptr)
+				return nullptr;
+
+			return pRecord->pArchetype->GetComponent(pRecord->chunk, pRecord->row, id);
+		}
+
+		///
+		/// Gets the archetype of a component set, creating it if needed.
+		///
+		Archetype *World::GetArchetype(const ComponentMask &mask)
+		{
+			std::map<uint64_t, Archetype *>::iterator it = m_archetypeMap.find(mask.GetValue());
+			if (it != m_archetypeMap.end())
+				return it->second;
+
+			Archetype *pArchetype = new Archetype(mask);
+			TEKMEM_ALLOC(Core::TEKMEMTAG_SCENE, sizeof(Archetype));
+			m_archetypeMap[mask.GetValue()] = pArchetype;
+			m_archetypes.push_back(pArchetype);
+			return pArchetype;
+		}
+
+		///
+		/// Gets the number of archetypes.
+		///
+		int32_t World::GetArchetypeCount() const
+		{
+			return (int32_t)m_archetypes.size();
+		}
+
+		///
+		/// Gets an archetype by creation order.
+		///
+		Archetype *World::GetArchetype(int32_t index) const
+		{
+			return m_archetypes[index];
+		}
+
+		///
+		/// Gets the number of live entities.
+		///
+		int32_t World::GetEntityCount() const
+		{
+			return m_nEntityCount;
+		}
+
+		///
+		/// Destroys every entity.
+		///
+		void World::Clear()
+		{
+			for (uint32_t index = (uint32_t)m_records.size(); index > 0; index--)
+			{
+				EntityRecord &record = m_records[index - 1];
+				if (record.pArchetype != nullptr)
+					Destroy(Entity(index - 1, record.generation));
+			}
+		}
+	}
+}
\ No newline at end of file
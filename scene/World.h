@@ -0,0 +1,181 @@
+#pragma once
+#ifndef _TEKSTORM_WORLD_H
+#define _TEKSTORM_WORLD_H
+#include "Archetype.h"
+#include <map>
+
+namespace Tekstorm
+{
+	namespace Scene
+	{
+		///
+		/// Where an entity's components are stored.
+		///
+		struct EntityRecord
+		{
+			Archetype *pArchetype;
+			uint32_t chunk;
+			uint32_t row;
+			uint32_t generation;
+		};
+
+		///
+		/// A collection of entities, stored by archetype.
+		///
+		/// Adding or removing a component moves the entity to the archetype of its
+		/// new component set. Such structural changes must not happen while a query
+		/// iterates the world; record them in a CommandBuffer and play it back
+		/// afterwards instead. A world is not thread-safe, but systems may read and
+		/// write components of distinct chunks concurrently.
+		///
+		class TEKAPI World
+		{
+		protected:
+			///
+			/// The entity records, by handle index.
+			///
+			std::vector<EntityRecord> m_records;
+
+			///
+			/// Indices of destroyed entities, reused by Create().
+			///
+			std::vector<uint32_t> m_freeIndices;
+
+			///
+			/// The archetypes by component set.
+			///
+			std::map<uint64_t, Archetype *> m_archetypeMap;
+
+			///
+			/// The archetypes in creation order. Archetypes are never removed, so queries
+			/// only need to look at the ones added since they last ran.
+			///
+			std::vector<Archetype *> m_archetypes;
+
+			///
+			/// The number of live entities.
+			///
+			int32_t m_nEntityCount;
+
+			///
+			/// Worlds are not copyable.
+			///
+			World(const World &other);
+			World &operator=(const World &other);
+
+			///
+			/// Gets the record of a live entity, or nullptr.
+			///
+			EntityRecord *Resolve(Entity entity);
+			const EntityRecord *Resolve(Entity entity) const;
+
+			///
+			/// Moves an entity to another archetype, keeping the components both share.
+			/// Returns false, leaving the entity where it was, if the target archetype
+			/// cannot grow.
+			///
+			bool Move(EntityRecord &record, Archetype *pTarget);
+
+		public:
+			World();
+			~World();
+
+			///
+			/// Creates an entity with default-constructed components of the given types.
+			/// Returns a null handle, and reports an error, if the world already holds
+			/// Handle::MaxIndices entities or its storage cannot grow.
+			///
+			Entity Create(const ComponentMask &mask = ComponentMask());
+
+			///
+			/// Destroys an entity. Returns false if the handle was stale.
+			///
+			bool Destroy(Entity entity);
+
+			///
+			/// Returns true if the entity exists.
+			///
+			bool IsAlive(Entity entity) const;
+
+			///
+			/// Gets the component types of an entity.
+			///
+			ComponentMask GetMask(Entity entity) const;
+
+			///
+			/// Adds a default-constructed component, or gets the existing one. Returns
+			/// nullptr if the entity does not exist or its storage cannot grow.
+			///
+			void *AddComponent(Entity entity, ComponentId id);
+
+			///
+			/// Removes a component. Returns false if the entity or component does not
+			/// exist, or its storage cannot grow.
+			///
+			bool RemoveComponent(Entity entity, ComponentId id);
+
+			///
+			/// Gets a component, or nullptr if the entity or component does not exist.
+			///
+			void *GetComponent(Entity entity, ComponentId id) const;
+
+			///
+			/// Adds a component with a value, or overwrites the existing one.
+			///
+			template <class _Type>
+			_Type *Add(Entity entity, const _Type &value)
+			{
+				_Type *pComponent = (_Type *)AddComponent(entity, ComponentRegistry::GetId<_Type>());
+				if (pComponent != nullptr)
+					*pComponent = value;
+
+				return pComponent;
+			}
+
+			///
+			/// Removes a component.
+			///
+			template <class _Type>
+			bool Remove(Entity entity)
+			{
+				return RemoveComponent(entity, ComponentRegistry::GetId<_Type>());
+			}
+
+			///
+			/// Gets a component, or nullptr.
+			///
+			template <class _Type>
+			_Type *Get(Entity entity) const
+			{
+				return (_Type *)GetComponent(entity, ComponentRegistry::GetId<_Type>());
+			}
+
+			///
+			/// Gets the archetype of a component set, creating it if needed.
+			///
+			Archetype *GetArchetype(const ComponentMask &mask);
+
+			///
+			/// Gets the number of archetypes.
+			///
+			int32_t GetArchetypeCount() const;
+
+			///
+			/// Gets an archetype by creation order.
+			///
+			Archetype *GetArchetype(int32_t index) const;
+
+			///
+			/// Gets the number of live entities.
+			///
+			int32_t GetEntityCount() const;
+
+			///
+			/// Destroys every entity. Archetypes are kept.
+			///
+			void Clear();
+		};
+	}
+}
+
+#endif /* _TEKSTORM_WORLD_H */
\ No newline at end of file
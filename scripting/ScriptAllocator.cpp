@@ -0,0 +1,235 @@
+#define TEKSTORM_BUILD
+#include "ScriptAllocator.h"
+#include "../core/MemoryTracker.h"
+
+#if !defined(TEKSTORM_NO_SCRIPTING)
+namespace Tekstorm
+{
+	namespace Scripting
+	{
+		// The size of the pages pools carve their slots from.
+		static const size_t PageSize = 64 * 1024;
+
+		// Slot sizes of the pools.
+		static const size_t ClassSizes[] = { 16, 32, 48, 64, 96, 128, 192, 256, 384, 512 };
+		static const int32_t ClassCount = sizeof(ClassSizes) / sizeof(ClassSizes[0]);
+
+		///
+		/// A free slot.
+		///
+		struct PoolSlot
+		{
+			PoolSlot *pNext;
+		};
+
+		///
+		/// A size-class pool. Zero-initialized statics, so usable before any constructor runs.
+		///
+		struct SizeClassPool
+		{
+			volatile LONG lock;
+			PoolSlot *pFree;
+			int64_t used;
+			int64_t reserved;
+		};
+
+		static SizeClassPool s_pools[ClassCount];
+		static volatile LONG s_nLargeAllocations = 0;
+		static volatile LONGLONG s_nLargeBytes = 0;
+		static volatile LONGLONG s_nTotalAllocations = 0;
+
+		// Maps (size + 15) / 16 to a size class.
+		static const int8_t s_classIndex[] =
+		{
+			0, 0, 1, 2, 3, 4, 4, 5, 5, 6, 6, 6, 6, 7, 7, 7, 7,
+			8, 8, 8, 8, 8, 8, 8, 8, 9, 9, 9, 9, 9, 9, 9, 9
+		};
+
+		///
+		/// Gets the pool serving a request size, or -1 if it is too large.
+		///
+		static inline int32_t GetClass(size_t size)
+		{
+			if (size > (size_t)ScriptAllocator::MaxPooledSize)
+				return -1;
+
+			return s_classIndex[(size + 15) >> 4];
+		}
+
+		static inline void Lock(volatile LONG *pLock)
+		{
+			while (InterlockedExchange(pLock, 1) != 0)
+			{
+				while (*pLock != 0)
+					YieldProcessor();
+			}
+		}
+
+		static inline void Unlock(volatile LONG *pLock)
+		{
+			InterlockedExchange(pLock, 0);
+		}
+
+		///
+		/// Allocates a block.
+		///
+		void *ScriptAllocator::Allocate(size_t size)
+		{
+			InterlockedIncrement64(&s_nTotalAllocations);
+
+			int32_t index = GetClass(size);
+			if (index < 0)
+			{
+				void *p = malloc(size);
+				if (p != nullptr)
+				{
+					InterlockedIncrement(&s_nLargeAllocations);
+					InterlockedExchangeAdd64(&s_nLargeBytes, (LONGLONG)size);
+					TEKMEM_ALLOC(Core::TEKMEMTAG_SCRIPTING, size);
+				}
+
+				return p;
+			}
+
+			SizeClassPool &pool = s_pools[index];
+			Lock(&pool.lock);
+
+			if (pool.pFree == nullptr)
+			{
+				// carve a fresh page into slots
+				char *pPage = (char *)VirtualAlloc(nullptr, PageSize, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+				if (pPage == nullptr)
+				{
+					Unlock(&pool.lock);
+					return nullptr;
+				}
+
+				size_t slotSize = ClassSizes[index];
+				size_t slotCount = PageSize / slotSize;
+				for (size_t i = slotCount; i > 0; i--)
+				{
+					PoolSlot *pSlot = (PoolSlot *)(pPage + (i - 1) * slotSize);
+					pSlot->pNext = pool.pFree;
+					pool.pFree = pSlot;
+				}
+
+				pool.reserved += PageSize;
+			}
+
+			PoolSlot *pSlot = pool.pFree;
+			pool.pFree = pSlot->pNext;
+			pool.used += ClassSizes[index];
+
+			Unlock(&pool.lock);
+			TEKMEM_ALLOC(Core::TEKMEMTAG_SCRIPTING, size);
+			return pSlot;
+		}
+
+		///
+		/// Resizes a block allocated with the given size.
+		///
+		void *ScriptAllocator::Reallocate(void *p, size_t oldSize, size_t newSize)
+		{
+			if (p == nullptr)
+				return Allocate(newSize);
+
+			int32_t oldIndex = GetClass(oldSize);
+			int32_t newIndex = GetClass(newSize);
+			if (oldIndex >= 0 && oldIndex == newIndex)
+			{
+				TEKMEM_FREE(Core::TEKMEMTAG_SCRIPTING, oldSize);
+				TEKMEM_ALLOC(Core::TEKMEMTAG_SCRIPTING, newSize);
+				return p;
+			}
+
+			if (oldIndex < 0 && newIndex < 0)
+			{
+				void *pResized = realloc(p, newSize);
+				if (pResized != nullptr)
+				{
+					InterlockedExchangeAdd64(&s_nLargeBytes, (LONGLONG)newSize - (LONGLONG)oldSize);
+					TEKMEM_FREE(Core::TEKMEMTAG_SCRIPTING, oldSize);
+					TEKMEM_ALLOC(Core::TEKMEMTAG_SCRIPTING, newSize);
+				}
+
+				return pResized;
+			}
+
+			void *pResized = Allocate(newSize);
+			if (pResized == nullptr)
+				return nullptr;
+
+			memcpy(pResized, p, oldSize < newSize ? oldSize : newSize);
+			Free(p, oldSize);
+			return pResized;
+		}
+
+		///
+		/// Frees a block allocated with the given size.
+		///
+		void ScriptAllocator::Free(void *p, size_t size)
+		{
+			if (p == nullptr)
+				return;
+
+			TEKMEM_FREE(Core::TEKMEMTAG_SCRIPTING, size);
+
+			int32_t index = GetClass(size);
+			if (index < 0)
+			{
+				free(p);
+				InterlockedDecrement(&s_nLargeAllocations);
+				InterlockedExchangeAdd64(&s_nLargeBytes, -(LONGLONG)size);
+				return;
+			}
+
+			SizeClassPool &pool = s_pools[index];
+			Lock(&pool.lock);
+
+			PoolSlot *pSlot = (PoolSlot *)p;
+			pSlot->pNext = pool.pFree;
+			pool.pFree = pSlot;
+			pool.used -= ClassSizes[index];
+
+			Unlock(&pool.lock);
+		}
+
+		///
+		/// Gets the current allocator statistics.
+		///
+		void ScriptAllocator::GetStats(ScriptAllocatorStats *pStats)
+		{
+			pStats->bytesInUse = s_nLargeBytes;
+			pStats->bytesReserved = 0;
+			pStats->largeAllocations = s_nLargeAllocations;
+			pStats->totalAllocations = s_nTotalAllocations;
+
+			for (int32_t i = 0; i < ClassCount; i++)
+			{
+				Lock(&s_pools[i].lock);
+				pStats->bytesInUse += s_pools[i].used;
+				pStats->bytesReserved += s_pools[i].reserved;
+				Unlock(&s_pools[i].lock);
+			}
+		}
+	}
+}
+
+#if !defined(TEKSTORM_NO_SCRIPT_ALLOCATOR)
+// Squirrel's allocation entry points (squtils.h); these replace sqmem.obj.
+void *sq_vm_malloc(SQUnsignedInteger size)
+{
+	return Tekstorm::Scripting::ScriptAllocator::Allocate((size_t)size);
+}
+
+void *sq_vm_realloc(void *p, SQUnsignedInteger oldsize, SQUnsignedInteger size)
+{
+	return Tekstorm::Scripting::ScriptAllocator::Reallocate(p, (size_t)oldsize, (size_t)size);
+}
+
+void sq_vm_free(void *p, SQUnsignedInteger size)
+{
+	Tekstorm::Scripting::ScriptAllocator::Free(p, (size_t)size);
+}
+#endif
+#endif
\ No newline at end of file
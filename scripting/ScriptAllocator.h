@@ -0,0 +1,80 @@
+#pragma once
+#ifndef _TEKSTORM_SCRIPTALLOCATOR_H
+#define _TEKSTORM_SCRIPTALLOCATOR_H
+#include "tekscripting.h"
+
+#if !defined(TEKSTORM_NO_SCRIPTING)
+namespace Tekstorm
+{
+	namespace Scripting
+	{
+		///
+		/// Memory statistics of the script allocator.
+		///
+		struct ScriptAllocatorStats
+		{
+			// Bytes currently handed out to the VMs.
+			int64_t bytesInUse;
+
+			// Bytes reserved by the size-class pools.
+			int64_t bytesReserved;
+
+			// The number of live allocations too large for the pools.
+			int32_t largeAllocations;
+
+			// The number of allocations ever made.
+			int64_t totalAllocations;
+		};
+
+		///
+		/// The allocator behind sq_vm_malloc/sq_vm_realloc/sq_vm_free.
+		///
+		/// Requests up to MaxPooledSize bytes are served from size-class pools carved
+		/// out of 64KB pages, so the churn of small script objects never reaches the
+		/// system heap. Squirrel passes the size of every block it frees, which is
+		/// what selects the pool; blocks therefore carry no header. Pool pages are
+		/// kept for reuse rather than returned to the system.
+		///
+		/// The sq_vm_* functions are defined by ScriptAllocator.cpp, which makes the
+		/// linker skip sqmem.obj in squirrel.lib. Define TEKSTORM_NO_SCRIPT_ALLOCATOR
+		/// to keep Squirrel's malloc-based defaults. All functions are thread-safe.
+		///
+		class TEKAPI ScriptAllocator
+		{
+		private:
+			///
+			/// No public constructor
+			///
+			ScriptAllocator();
+
+		public:
+			///
+			/// The largest request served from a pool.
+			///
+			static const int32_t MaxPooledSize = 512;
+
+			///
+			/// Allocates a block.
+			///
+			static void *Allocate(size_t size);
+
+			///
+			/// Resizes a block allocated with the given size.
+			///
+			static void *Reallocate(void *p, size_t oldSize, size_t newSize);
+
+			///
+			/// Frees a block allocated with the given size.
+			///
+			static void Free(void *p, size_t size);
+
+			///
+			/// Gets the current allocator statistics.
+			///
+			static void GetStats(ScriptAllocatorStats *pStats);
+		};
+	}
+}
+#endif
+
+#endif /* _TEKSTORM_SCRIPTALLOCATOR_H */
\ No newline at end of file
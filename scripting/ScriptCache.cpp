@@ -0,0 +1,238 @@
+#define TEKSTORM_BUILD
+#include "ScriptCache.h"
+#include "../IO/FileStream.h"
+#include "../core/Xxh3.h"
+
+#if !defined(TEKSTORM_NO_SCRIPTING)
+namespace Tekstorm
+{
+	namespace Scripting
+	{
+		using Tekstorm::IO::FileStream;
+
+		///
+		/// Initializes a cache that stores compiled scripts in the given directory.
+		///
+		ScriptCache::ScriptCache(const std::string &cacheDirectory)
+		{
+			m_cacheDirectory = cacheDirectory;
+		}
+
+		///
+		/// Hashes script source text (XXH3 64-bit).
+		///
+		uint64_t ScriptCache::HashSource(const char *source, int32_t length)
+		{
+			return Tekstorm::Core::Xxh3::Compute64(source, length);
+		}
+
+		///
+		/// Gets a hash identifying the Squirrel version and the SQInteger/SQFloat/SQChar sizes.
+		///
+		uint64_t ScriptCache::GetCompilerHash()
+		{
+			static uint64_t compilerHash = 0;
+			if (compilerHash == 0)
+			{
+				const SQChar *version = SQUIRREL_VERSION;
+				int32_t length = 0;
+				while (version[length] != 0)
+					length++;
+
+				char sizes[3] = { (char)sizeof(SQInteger), (char)sizeof(SQFloat), (char)sizeof(SQChar) };
+				compilerHash = HashSource((const char *)version, length * sizeof(SQChar)) ^ HashSource(sizes, 3);
+			}
+
+			return compilerHash;
+		}
+
+		///
+		/// sq_writeclosure callback appending to a std::vector<char>.
+		///
+		SQInteger ScriptCache::WriteToBuffer(SQUserPointer up, SQUserPointer data, SQInteger size)
+		{
+			std::vector<char> *pBuffer = (std::vector<char> *)up;
+			const char *pData = (const char *)data;
+			pBuffer->insert(pBuffer->end(), pData, pData + size);
+			return size;
+		}
+
+		///
+		/// sq_readclosure callback reading from an IStream.
+		///
+		SQInteger ScriptCache::ReadFromStream(SQUserPointer up, SQUserPointer data, SQInteger size)
+		{
+			IStream *pStream = (IStream *)up;
+			return pStream->Read((char *)data, (int32_t)size, 0);
+		}
+
+		///
+		/// Reads a whole file into memory.
+		///
+		bool ScriptCache::ReadFile(const std::string &filePath, std::vector<char> *pContents)
+		{
+			FileStream file;
+			if (!file.Open(filePath, "rb"))
+				return false;
+
+			int32_t length = file.GetLength();
+			pContents->resize(length + 1);
+			int32_t read = (length > 0) ? file.Read(&(*pContents)[0], length, 0) : 0;
+			(*pContents)[read] = 0;
+			pContents->resize(read);
+			return (read == length);
+		}
+
+		///
+		/// Serializes the closure on top of the stack, with a header, into pBytecode.
+		///
+		bool ScriptCache::WriteClosure(HSQUIRRELVM v, uint64_t sourceHash, std::vector<char> *pBytecode)
+		{
+			ScriptCacheHeader header;
+			header.magic = Magic;
+			header.version = FormatVersion;
+			header.sourceHash = sourceHash;
+			header.compilerHash = GetCompilerHash();
+			header.length = 0;
+			header.reserved = 0;
+
+			size_t start = pBytecode->size();
+			WriteToBuffer(pBytecode, &header, sizeof(ScriptCacheHeader));
+			if (SQ_FAILED(sq_writeclosure(v, &ScriptCache::WriteToBuffer, pBytecode)))
+			{
+				pBytecode->resize(start);
+				return false;
+			}
+
+			header.length = (int32_t)(pBytecode->size() - start - sizeof(ScriptCacheHeader));
+			memcpy(&(*pBytecode)[start], &header, sizeof(ScriptCacheHeader));
+			return true;
+		}
+
+		///
+		/// Serializes the closure on top of the stack, with a header, into a stream.
+		///
+		bool ScriptCache::WriteClosure(HSQUIRRELVM v, uint64_t sourceHash, IStream *pStream)
+		{
+			std::vector<char> bytecode;
+			if (!WriteClosure(v, sourceHash, &bytecode))
+				return false;
+
+			return (pStream->Write(&bytecode[0], (int32_t)bytecode.size(), 0) == (int32_t)bytecode.size());
+		}
+
+		///
+		/// Reads a cached closure from a stream and pushes it onto the stack.
+		///
+		bool ScriptCache::ReadClosure(HSQUIRRELVM v, IStream *pStream, uint64_t sourceHash)
+		{
+			ScriptCacheHeader header;
+			if (pStream->Read((char *)&header, sizeof(ScriptCacheHeader), 0) != sizeof(ScriptCacheHeader))
+				return false;
+
+			if (header.magic != Magic || header.version != FormatVersion || header.compilerHash != GetCompilerHash())
+				return false;
+
+			if (sourceHash != 0 && header.sourceHash != sourceHash)
+				return false;
+
+			return SQ_SUCCEEDED(sq_readclosure(v, &ScriptCache::ReadFromStream, pStream));
+		}
+
+		///
+		/// Compiles source text and serializes it, with a header, into pBytecode.
+		///
+		bool ScriptCache::Compile(HSQUIRRELVM v, const SQChar *source, int32_t length, const SQChar *sourceName, std::vector<char> *pBytecode)
+		{
+			if (SQ_FAILED(sq_compilebuffer(v, source, length, sourceName, SQTrue)))
+				return false;
+
+			bool result = WriteClosure(v, HashSource((const char *)source, length * sizeof(SQChar)), pBytecode);
+			sq_pop(v, 1);
+			return result;
+		}
+
+		///
+		/// Gets the cache file used for a script path.
+		///
+		std::string ScriptCache::GetCachePath(const std::string &scriptPath) const
+		{
+			std::string name = scriptPath;
+			for (size_t i = 0; i < name.length(); i++)
+			{
+				if (name[i] == '/' || name[i] == '\\' || name[i] == ':')
+					name[i] = '_';
+			}
+
+			return m_cacheDirectory + "/" + name + ".cnut";
+		}
+
+		///
+		/// Pushes the closure of a script file onto the stack.
+		///
+		bool ScriptCache::LoadScript(HSQUIRRELVM v, const std::string &scriptPath)
+		{
+			std::string cachePath = GetCachePath(scriptPath);
+			std::vector<char> source;
+
+			if (!ReadFile(scriptPath, &source))
+			{
+#if defined(TEKSTORM_NO_SCRIPT_COMPILER)
+				// shipping builds may not carry the source at all
+				FileStream cacheFile;
+				return cacheFile.Open(cachePath, "rb") && ReadClosure(v, &cacheFile, 0);
+#else
+				return false;
+#endif
+			}
+
+			int32_t length = (int32_t)source.size();
+			uint64_t sourceHash = HashSource(length > 0 ? &source[0] : "", length);
+
+			FileStream cacheFile;
+			if (cacheFile.Open(cachePath, "rb"))
+			{
+				if (ReadClosure(v, &cacheFile, sourceHash))
+					return true;
+
+				cacheFile.Close();
+			}
+
+#if defined(TEKSTORM_NO_SCRIPT_COMPILER)
+#if defined(TEKSTORM_DEBUG)
+			TEKDEBUG_W("No up-to-date compiled script for " << scriptPath);
+#endif
+			return false;
+#else
+			// scripts are compiled as ANSI text (SQChar == char)
+			if (SQ_FAILED(sq_compilebuffer(v, (const SQChar *)(length > 0 ? &source[0] : ""), length / sizeof(SQChar),
+				(const SQChar *)scriptPath.c_str(), SQTrue)))
+			{
+				return false;
+			}
+
+			FileStream output;
+			if (output.Open(cachePath, "wb"))
+				WriteClosure(v, sourceHash, &output);
+
+			return true;
+#endif
+		}
+
+		///
+		/// LoadScript() for the main SquirrelVM; a drop-in for SquirrelVM::CompileScript.
+		///
+		SquirrelObject ScriptCache::CompileScript(const std::string &scriptPath)
+		{
+			HSQUIRRELVM v = SquirrelVM::GetVMPtr();
+			if (!LoadScript(v, scriptPath))
+				throw SquirrelError();
+
+			SquirrelObject closure;
+			closure.AttachToStackObject(-1);
+			sq_pop(v, 1);
+			return closure;
+		}
+	}
+}
+#endif
\ No newline at end of file
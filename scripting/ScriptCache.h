@@ -0,0 +1,138 @@
+#pragma once
+#ifndef _TEKSTORM_SCRIPTCACHE_H
+#define _TEKSTORM_SCRIPTCACHE_H
+#include "tekscripting.h"
+#include "../IO/IStream.h"
+
+#if !defined(TEKSTORM_NO_SCRIPTING)
+namespace Tekstorm
+{
+	namespace Scripting
+	{
+		using Tekstorm::IO::IStream;
+
+		///
+		/// The header written in front of every cached closure.
+		///
+		struct ScriptCacheHeader
+		{
+			// Always ScriptCache::Magic.
+			uint32_t magic;
+
+			// The cache format version (ScriptCache::FormatVersion).
+			uint32_t version;
+
+			// The hash of the script source the closure was compiled from.
+			uint64_t sourceHash;
+
+			// The hash of the compiler that produced the closure (see GetCompilerHash).
+			uint64_t compilerHash;
+
+			// The size, in bytes, of the serialized closure following the header.
+			int32_t length;
+
+			int32_t reserved;
+		};
+
+		///
+		/// Caches compiled Squirrel closures so scripts are only compiled once.
+		///
+		/// Every entry is a ScriptCacheHeader followed by the sq_writeclosure output.
+		/// Entries are read through any IStream, so they can live in cache files on
+		/// disk or be packed into asset archives. Builds defining
+		/// TEKSTORM_NO_SCRIPT_COMPILER never fall back to compiling source.
+		///
+		class TEKAPI ScriptCache
+		{
+		protected:
+			///
+			/// The directory compiled scripts are cached in.
+			///
+			std::string m_cacheDirectory;
+
+			///
+			/// sq_writeclosure callback appending to a std::vector<char>.
+			///
+			static SQInteger WriteToBuffer(SQUserPointer up, SQUserPointer data, SQInteger size);
+
+			///
+			/// sq_readclosure callback reading from an IStream.
+			///
+			static SQInteger ReadFromStream(SQUserPointer up, SQUserPointer data, SQInteger size);
+
+		public:
+			///
+			/// 'TKSC'
+			///
+			static const uint32_t Magic = 0x43534B54;
+
+			///
+			/// Bumped whenever the header layout or the source hash changes.
+			///
+			static const uint32_t FormatVersion = 2;
+
+			///
+			/// Initializes a cache that stores compiled scripts in the given directory.
+			///
+			ScriptCache(const std::string &cacheDirectory);
+
+			///
+			/// Hashes script source text.
+			///
+			static uint64_t HashSource(const char *source, int32_t length);
+
+			///
+			/// Gets a hash identifying the Squirrel version and the SQInteger/SQFloat/SQChar
+			/// sizes; bytecode is only valid for a matching compiler.
+			///
+			static uint64_t GetCompilerHash();
+
+			///
+			/// Serializes the closure on top of the stack, with a header, into pBytecode.
+			///
+			static bool WriteClosure(HSQUIRRELVM v, uint64_t sourceHash, std::vector<char> *pBytecode);
+
+			///
+			/// Serializes the closure on top of the stack, with a header, into a stream.
+			///
+			static bool WriteClosure(HSQUIRRELVM v, uint64_t sourceHash, IStream *pStream);
+
+			///
+			/// Reads a cached closure from a stream and pushes it onto the stack.
+			/// If sourceHash is non-zero the entry must have been compiled from that source.
+			///
+			static bool ReadClosure(HSQUIRRELVM v, IStream *pStream, uint64_t sourceHash = 0);
+
+			///
+			/// Compiles source text and serializes it, with a header, into pBytecode.
+			/// Nothing is left on the stack.
+			///
+			static bool Compile(HSQUIRRELVM v, const SQChar *source, int32_t length, const SQChar *sourceName, std::vector<char> *pBytecode);
+
+			///
+			/// Reads a whole file into memory.
+			///
+			static bool ReadFile(const std::string &filePath, std::vector<char> *pContents);
+
+			///
+			/// Gets the cache file used for a script path.
+			///
+			std::string GetCachePath(const std::string &scriptPath) const;
+
+			///
+			/// Pushes the closure of a script file onto the stack, loading it from the cache
+			/// when the cached entry matches the source and compiler, and compiling and
+			/// re-caching it otherwise.
+			///
+			bool LoadScript(HSQUIRRELVM v, const std::string &scriptPath);
+
+			///
+			/// LoadScript() for the main SquirrelVM; a drop-in for SquirrelVM::CompileScript.
+			///
+			SquirrelObject CompileScript(const std::string &scriptPath);
+		};
+	}
+}
+#endif
+
+#endif /* _TEKSTORM_SCRIPTCACHE_H */
\ No newline at end of file
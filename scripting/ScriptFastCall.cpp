@@ -0,0 +1,128 @@
+#define TEKSTORM_BUILD
+#include "ScriptFastCall.h"
+
+#if !defined(TEKSTORM_NO_SCRIPTING)
+namespace Tekstorm
+{
+	namespace Scripting
+	{
+		using namespace Tekstorm::Math;
+
+		// Script constructors for the math value types.
+		static Vector2 MakeVector2(tekreal x, tekreal y) { return Vector2(x, y); }
+		static Vector3 MakeVector3(tekreal x, tekreal y, tekreal z) { return Vector3(x, y, z); }
+		static Color4 MakeColor4(tekreal r, tekreal g, tekreal b, tekreal a) { return Color4(r, g, b, a); }
+
+		///
+		/// Sets the shared field-access delegate of the value userdata on top of the stack.
+		///
+		void SetFastValueDelegate(HSQUIRRELVM v, SQUserPointer typeTag)
+		{
+			sq_pushregistrytable(v);
+			sq_pushuserpointer(v, typeTag);
+			if (SQ_SUCCEEDED(sq_rawget(v, -2)))
+				sq_setdelegate(v, -3);
+
+			sq_pop(v, 1);
+		}
+
+		///
+		/// Finds the index of a single-character field name, or -1.
+		///
+		static int32_t FindField(const SQChar *fields, const SQChar *key)
+		{
+			if (key == nullptr || key[0] == 0 || key[1] != 0)
+				return -1;
+
+			for (int32_t i = 0; fields[i] != 0; i++)
+			{
+				if (fields[i] == key[0])
+					return i;
+			}
+
+			return -1;
+		}
+
+		///
+		/// _get metamethod of value userdata: (userdata, key) + field names as free variable.
+		///
+		SQInteger FastCall::ValueGet(HSQUIRRELVM v)
+		{
+			SQUserPointer p = nullptr;
+			SQUserPointer fields = nullptr;
+			const SQChar *key = nullptr;
+			sq_getuserdata(v, 1, &p, nullptr);
+			sq_getstring(v, 2, &key);
+			sq_getuserpointer(v, -1, &fields);
+
+			int32_t index = FindField((const SQChar *)fields, key);
+			if (index < 0)
+				return sq_throwerror(v, _SC("the index doesn't exist"));
+
+			sq_pushfloat(v, (SQFloat)((tekreal *)p)[index]);
+			return 1;
+		}
+
+		///
+		/// _set metamethod of value userdata: (userdata, key, value) + field names as free variable.
+		///
+		SQInteger FastCall::ValueSet(HSQUIRRELVM v)
+		{
+			SQUserPointer p = nullptr;
+			SQUserPointer fields = nullptr;
+			const SQChar *key = nullptr;
+			SQFloat value = 0;
+			sq_getuserdata(v, 1, &p, nullptr);
+			sq_getstring(v, 2, &key);
+			sq_getfloat(v, 3, &value);
+			sq_getuserpointer(v, -1, &fields);
+
+			int32_t index = FindField((const SQChar *)fields, key);
+			if (index < 0)
+				return sq_throwerror(v, _SC("the index doesn't exist"));
+
+			((tekreal *)p)[index] = (tekreal)value;
+			return 0;
+		}
+
+		///
+		/// Registers the delegate for a value userdata type.
+		///
+		void FastCall::RegisterValueType(HSQUIRRELVM v, SQUserPointer typeTag, const SQChar *fields)
+		{
+			sq_pushregistrytable(v);
+			sq_pushuserpointer(v, typeTag);
+			sq_newtable(v);
+
+			sq_pushstring(v, _SC("_get"), -1);
+			sq_pushuserpointer(v, (SQUserPointer)fields);
+			sq_newclosure(v, &FastCall::ValueGet, 1);
+			sq_setparamscheck(v, 2, _SC("us"));
+			sq_newslot(v, -3, SQFalse);
+
+			sq_pushstring(v, _SC("_set"), -1);
+			sq_pushuserpointer(v, (SQUserPointer)fields);
+			sq_newclosure(v, &FastCall::ValueSet, 1);
+			sq_setparamscheck(v, 3, _SC("usn"));
+			sq_newslot(v, -3, SQFalse);
+
+			sq_newslot(v, -3, SQFalse);
+			sq_pop(v, 1);
+		}
+
+		///
+		/// Registers Vector2, Vector3 and Color4 as value types along with their script constructors.
+		///
+		void FastCall::RegisterMathTypes(HSQUIRRELVM v)
+		{
+			RegisterValueType(v, FastValue<Vector2>::GetTag(), _SC("XY"));
+			RegisterValueType(v, FastValue<Vector3>::GetTag(), _SC("XYZ"));
+			RegisterValueType(v, FastValue<Color4>::GetTag(), _SC("RGBA"));
+
+			Register(v, _SC("Vector2"), &MakeVector2);
+			Register(v, _SC("Vector3"), &MakeVector3);
+			Register(v, _SC("Color4"), &MakeColor4);
+		}
+	}
+}
+#endif
\ No newline at end of file
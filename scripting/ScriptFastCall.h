@@ -0,0 +1,395 @@
+#pragma once
+#ifndef _TEKSTORM_SCRIPTFASTCALL_H
+#define _TEKSTORM_SCRIPTFASTCALL_H
+#include "tekscripting.h"
+#include "../math/Vector2.h"
+#include "../math/Vector3.h"
+#include "../math/Color4.h"
+#include "ScriptProfiler.h"
+
+#if !defined(TEKSTORM_NO_SCRIPTING)
+namespace Tekstorm
+{
+	namespace Scripting
+	{
+		///
+		/// Strips const and references from a bound argument type.
+		///
+		template <class T> struct FastStrip { typedef T Type; };
+		template <class T> struct FastStrip<const T> { typedef T Type; };
+		template <class T> struct FastStrip<T &> { typedef T Type; };
+		template <class T> struct FastStrip<const T &> { typedef T Type; };
+
+		///
+		/// Describes how a C++ type travels on the Squirrel stack for the fast call path.
+		/// Mask is the Squirrel typemask character checked by the VM before the call,
+		/// so Get() reads the stack slot directly without any further checks. Check()
+		/// covers what the typemask cannot tell apart (the type of a userdata).
+		///
+		template <class T> struct FastValue;
+
+		///
+		/// Types fully checked by their typemask character.
+		///
+		struct FastValueChecked
+		{
+			static bool Check(HSQUIRRELVM v, SQInteger idx) { return true; }
+		};
+
+		template <> struct FastValue<int32_t> : public FastValueChecked
+		{
+			static const SQChar Mask = 'i';
+			static int32_t Get(HSQUIRRELVM v, SQInteger idx) { SQInteger i = 0; sq_getinteger(v, idx, &i); return (int32_t)i; }
+			static void Push(HSQUIRRELVM v, int32_t value) { sq_pushinteger(v, value); }
+		};
+
+		template <> struct FastValue<float> : public FastValueChecked
+		{
+			static const SQChar Mask = 'n';
+			static float Get(HSQUIRRELVM v, SQInteger idx) { SQFloat f = 0; sq_getfloat(v, idx, &f); return (float)f; }
+			static void Push(HSQUIRRELVM v, float value) { sq_pushfloat(v, (SQFloat)value); }
+		};
+
+		template <> struct FastValue<double> : public FastValueChecked
+		{
+			static const SQChar Mask = 'n';
+			static double Get(HSQUIRRELVM v, SQInteger idx) { SQFloat f = 0; sq_getfloat(v, idx, &f); return (double)f; }
+			static void Push(HSQUIRRELVM v, double value) { sq_pushfloat(v, (SQFloat)value); }
+		};
+
+		template <> struct FastValue<bool> : public FastValueChecked
+		{
+			static const SQChar Mask = 'b';
+			static bool Get(HSQUIRRELVM v, SQInteger idx) { SQBool b = SQFalse; sq_getbool(v, idx, &b); return (b != SQFalse); }
+			static void Push(HSQUIRRELVM v, bool value) { sq_pushbool(v, value ? SQTrue : SQFalse); }
+		};
+
+		template <> struct FastValue<const SQChar *> : public FastValueChecked
+		{
+			static const SQChar Mask = 's';
+			static const SQChar *Get(HSQUIRRELVM v, SQInteger idx) { const SQChar *s = nullptr; sq_getstring(v, idx, &s); return s; }
+			static void Push(HSQUIRRELVM v, const SQChar *value) { sq_pushstring(v, value, -1); }
+		};
+
+		template <> struct FastValue<SQUserPointer> : public FastValueChecked
+		{
+			static const SQChar Mask = 'p';
+			static SQUserPointer Get(HSQUIRRELVM v, SQInteger idx) { SQUserPointer p = nullptr; sq_getuserpointer(v, idx, &p); return p; }
+			static void Push(HSQUIRRELVM v, SQUserPointer value) { sq_pushuserpointer(v, value); }
+		};
+
+		///
+		/// Sets the shared field-access delegate of the value userdata on top of the stack.
+		///
+		TEKAPI void SetFastValueDelegate(HSQUIRRELVM v, SQUserPointer typeTag);
+
+		///
+		/// Plain math types travel as inline value userdata: the object is copied into the
+		/// userdata block, tagged, and given a shared per-type delegate for field access.
+		/// Arguments are read in place; no C++ instance, heap allocation or release hook
+		/// is involved, unlike SqPlus class instances. The 'u' typemask accepts any
+		/// userdata, so the tag is checked by Check() before Get() reads the block.
+		///
+		template <class T> struct FastValueType
+		{
+			static const SQChar Mask = 'u';
+
+			static SQUserPointer GetTag()
+			{
+				static char tag = 0;
+				return &tag;
+			}
+
+			static bool Check(HSQUIRRELVM v, SQInteger idx)
+			{
+				SQUserPointer p = nullptr;
+				SQUserPointer tag = nullptr;
+				return SQ_SUCCEEDED(sq_getuserdata(v, idx, &p, &tag)) && tag == GetTag();
+			}
+
+			static T &Get(HSQUIRRELVM v, SQInteger idx)
+			{
+				SQUserPointer p = nullptr;
+				SQUserPointer tag = nullptr;
+				sq_getuserdata(v, idx, &p, &tag);
+				return *(T *)p;
+			}
+
+			static void Push(HSQUIRRELVM v, const T &value)
+			{
+				SQUserPointer p = sq_newuserdata(v, sizeof(T));
+				memcpy(p, &value, sizeof(T));
+				sq_settypetag(v, -1, GetTag());
+				SetFastValueDelegate(v, GetTag());
+			}
+		};
+
+		template <> struct FastValue<Math::Vector2> : public FastValueType<Math::Vector2> { };
+		template <> struct FastValue<Math::Vector3> : public FastValueType<Math::Vector3> { };
+		template <> struct FastValue<Math::Color4> : public FastValueType<Math::Color4> { };
+
+		///
+		/// Reads the arguments, calls the function and pushes its result.
+		/// Script arguments start at stack index 2 (1 is the environment).
+		///
+		template <class R> struct FastInvoker
+		{
+			static SQInteger Call(HSQUIRRELVM v, R (*func)())
+			{
+				FastValue<typename FastStrip<R>::Type>::Push(v, func());
+				return 1;
+			}
+
+			template <class A1>
+			static SQInteger Call(HSQUIRRELVM v, R (*func)(A1))
+			{
+				FastValue<typename FastStrip<R>::Type>::Push(v, func(
+					FastValue<typename FastStrip<A1>::Type>::Get(v, 2)));
+				return 1;
+			}
+
+			template <class A1, class A2>
+			static SQInteger Call(HSQUIRRELVM v, R (*func)(A1, A2))
+			{
+				FastValue<typename FastStrip<R>::Type>::Push(v, func(
+					FastValue<typename FastStrip<A1>::Type>::Get(v, 2),
+					FastValue<typename FastStrip<A2>::Type>::Get(v, 3)));
+				return 1;
+			}
+
+			template <class A1, class A2, class A3>
+			static SQInteger Call(HSQUIRRELVM v, R (*func)(A1, A2, A3))
+			{
+				FastValue<typename FastStrip<R>::Type>::Push(v, func(
+					FastValue<typename FastStrip<A1>::Type>::Get(v, 2),
+					FastValue<typename FastStrip<A2>::Type>::Get(v, 3),
+					FastValue<typename FastStrip<A3>::Type>::Get(v, 4)));
+				return 1;
+			}
+
+			template <class A1, class A2, class A3, class A4>
+			static SQInteger Call(HSQUIRRELVM v, R (*func)(A1, A2, A3, A4))
+			{
+				FastValue<typename FastStrip<R>::Type>::Push(v, func(
+					FastValue<typename FastStrip<A1>::Type>::Get(v, 2),
+					FastValue<typename FastStrip<A2>::Type>::Get(v, 3),
+					FastValue<typename FastStrip<A3>::Type>::Get(v, 4),
+					FastValue<typename FastStrip<A4>::Type>::Get(v, 5)));
+				return 1;
+			}
+		};
+
+		template <> struct FastInvoker<void>
+		{
+			static SQInteger Call(HSQUIRRELVM v, void (*func)())
+			{
+				func();
+				return 0;
+			}
+
+			template <class A1>
+			static SQInteger Call(HSQUIRRELVM v, void (*func)(A1))
+			{
+				func(FastValue<typename FastStrip<A1>::Type>::Get(v, 2));
+				return 0;
+			}
+
+			template <class A1, class A2>
+			static SQInteger Call(HSQUIRRELVM v, void (*func)(A1, A2))
+			{
+				func(FastValue<typename FastStrip<A1>::Type>::Get(v, 2),
+					FastValue<typename FastStrip<A2>::Type>::Get(v, 3));
+				return 0;
+			}
+
+			template <class A1, class A2, class A3>
+			static SQInteger Call(HSQUIRRELVM v, void (*func)(A1, A2, A3))
+			{
+				func(FastValue<typename FastStrip<A1>::Type>::Get(v, 2),
+					FastValue<typename FastStrip<A2>::Type>::Get(v, 3),
+					FastValue<typename FastStrip<A3>::Type>::Get(v, 4));
+				return 0;
+			}
+
+			template <class A1, class A2, class A3, class A4>
+			static SQInteger Call(HSQUIRRELVM v, void (*func)(A1, A2, A3, A4))
+			{
+				func(FastValue<typename FastStrip<A1>::Type>::Get(v, 2),
+					FastValue<typename FastStrip<A2>::Type>::Get(v, 3),
+					FastValue<typename FastStrip<A3>::Type>::Get(v, 4),
+					FastValue<typename FastStrip<A4>::Type>::Get(v, 5));
+				return 0;
+			}
+		};
+
+		///
+		/// The typemask and parameter count of a bound function, built once per signature,
+		/// and the argument checks the typemask cannot do.
+		///
+		template <class F> struct FastSignature;
+
+		template <class R> struct FastSignature<R (*)()>
+		{
+			static const SQInteger Params = 1;
+			static const SQChar *GetMask() { static const SQChar mask[] = { '.', 0 }; return mask; }
+			static bool Check(HSQUIRRELVM v) { return true; }
+		};
+
+		template <class R, class A1> struct FastSignature<R (*)(A1)>
+		{
+			static const SQInteger Params = 2;
+			static const SQChar *GetMask()
+			{
+				static const SQChar mask[] = { '.', FastValue<typename FastStrip<A1>::Type>::Mask, 0 };
+				return mask;
+			}
+
+			static bool Check(HSQUIRRELVM v)
+			{
+				return FastValue<typename FastStrip<A1>::Type>::Check(v, 2);
+			}
+		};
+
+		template <class R, class A1, class A2> struct FastSignature<R (*)(A1, A2)>
+		{
+			static const SQInteger Params = 3;
+			static const SQChar *GetMask()
+			{
+				static const SQChar mask[] = { '.', FastValue<typename FastStrip<A1>::Type>::Mask,
+					FastValue<typename FastStrip<A2>::Type>::Mask, 0 };
+				return mask;
+			}
+
+			static bool Check(HSQUIRRELVM v)
+			{
+				return FastValue<typename FastStrip<A1>::Type>::Check(v, 2)
+					&& FastValue<typename FastStrip<A2>::Type>::Check(v, 3);
+			}
+		};
+
+		template <class R, class A1, class A2, class A3> struct FastSignature<R (*)(A1, A2, A3)>
+		{
+			static const SQInteger Params = 4;
+			static const SQChar *GetMask()
+			{
+				static const SQChar mask[] = { '.', FastValue<typename FastStrip<A1>::Type>::Mask,
+					FastValue<typename FastStrip<A2>::Type>::Mask, FastValue<typename FastStrip<A3>::Type>::Mask, 0 };
+				return mask;
+			}
+
+			static bool Check(HSQUIRRELVM v)
+			{
+				return FastValue<typename FastStrip<A1>::Type>::Check(v, 2)
+					&& FastValue<typename FastStrip<A2>::Type>::Check(v, 3)
+					&& FastValue<typename FastStrip<A3>::Type>::Check(v, 4);
+			}
+		};
+
+		template <class R, class A1, class A2, class A3, class A4> struct FastSignature<R (*)(A1, A2, A3, A4)>
+		{
+			static const SQInteger Params = 5;
+			static const SQChar *GetMask()
+			{
+				static const SQChar mask[] = { '.', FastValue<typename FastStrip<A1>::Type>::Mask,
+					FastValue<typename FastStrip<A2>::Type>::Mask, FastValue<typename FastStrip<A3>::Type>::Mask,
+					FastValue<typename FastStrip<A4>::Type>::Mask, 0 };
+				return mask;
+			}
+
+			static bool Check(HSQUIRRELVM v)
+			{
+				return FastValue<typename FastStrip<A1>::Type>::Check(v, 2)
+					&& FastValue<typename FastStrip<A2>::Type>::Check(v, 3)
+					&& FastValue<typename FastStrip<A3>::Type>::Check(v, 4)
+					&& FastValue<typename FastStrip<A4>::Type>::Check(v, 5);
+			}
+		};
+
+		template <class R>
+		inline SQInteger FastInvoke(HSQUIRRELVM v, R (*func)()) { return FastInvoker<R>::Call(v, func); }
+		template <class R, class A1>
+		inline SQInteger FastInvoke(HSQUIRRELVM v, R (*func)(A1)) { return FastInvoker<R>::Call(v, func); }
+		template <class R, class A1, class A2>
+		inline SQInteger FastInvoke(HSQUIRRELVM v, R (*func)(A1, A2)) { return FastInvoker<R>::Call(v, func); }
+		template <class R, class A1, class A2, class A3>
+		inline SQInteger FastInvoke(HSQUIRRELVM v, R (*func)(A1, A2, A3)) { return FastInvoker<R>::Call(v, func); }
+		template <class R, class A1, class A2, class A3, class A4>
+		inline SQInteger FastInvoke(HSQUIRRELVM v, R (*func)(A1, A2, A3, A4)) { return FastInvoker<R>::Call(v, func); }
+
+		///
+		/// The native closure registered for a bound function. The function pointer is
+		/// the closure's only free variable, which Squirrel keeps on top of the stack.
+		/// Scripts over their ScriptProfiler budget, and calls with userdata of the wrong
+		/// type, are unwound here with SQ_ERROR.
+		///
+		template <class F>
+		SQInteger FastThunk(HSQUIRRELVM v)
+		{
+			if (ScriptProfiler::IsThreadOverBudget())
+				return sq_throwerror(v, _SC("script budget exceeded"));
+
+			if (!FastSignature<F>::Check(v))
+				return sq_throwerror(v, _SC("wrong userdata type passed to a native function"));
+
+			SQUserPointer func = nullptr;
+			sq_getuserpointer(v, -1, &func);
+			return FastInvoke(v, (F)func);
+		}
+
+		///
+		/// A binding path for hot native functions that bypasses the SqPlus dispatch.
+		/// Signatures are checked by the VM through a precomputed typemask and arguments
+		/// are read straight off the stack.
+		///
+		class TEKAPI FastCall
+		{
+		private:
+			///
+			/// No public constructor
+			///
+			FastCall();
+
+			///
+			/// _get metamethod of value userdata.
+			///
+			static SQInteger ValueGet(HSQUIRRELVM v);
+
+			///
+			/// _set metamethod of value userdata.
+			///
+			static SQInteger ValueSet(HSQUIRRELVM v);
+
+		public:
+			///
+			/// Binds a free or static function (up to four arguments) into the root table.
+			///
+			template <class F>
+			static void Register(HSQUIRRELVM v, const SQChar *name, F func)
+			{
+				sq_pushroottable(v);
+				sq_pushstring(v, name, -1);
+				sq_pushuserpointer(v, (SQUserPointer)func);
+				sq_newclosure(v, &FastThunk<F>, 1);
+				sq_setparamscheck(v, FastSignature<F>::Params, FastSignature<F>::GetMask());
+				sq_setnativeclosurename(v, -1, name);
+				sq_newslot(v, -3, SQFalse);
+				sq_pop(v, 1);
+			}
+
+			///
+			/// Registers the delegate for a value userdata type. fields names its tekreal
+			/// members in memory order, one character each (i.e. "XY").
+			///
+			static void RegisterValueType(HSQUIRRELVM v, SQUserPointer typeTag, const SQChar *fields);
+
+			///
+			/// Registers Vector2, Vector3 and Color4 as value types along with their
+			/// script constructors. Usable as a ScriptVMPool binding.
+			///
+			static void RegisterMathTypes(HSQUIRRELVM v);
+		};
+	}
+}
+#endif
+
+#endif /* _TEKSTORM_SCRIPTFASTCALL_H */
\ No newline at end of file
@@ -0,0 +1,170 @@
+#define TEKSTORM_BUILD
+#include "ScriptGC.h"
+#include "ScriptVMPool.h"
+#include "../core/TimeStamp.h"
+#include "../core/TimeConstants.h"
+
+#if !defined(TEKSTORM_NO_SCRIPTING)
+namespace Tekstorm
+{
+	namespace Scripting
+	{
+		using Tekstorm::Core::TimeStamp;
+
+		// Weight of the newest pause in a VM's moving average.
+		static const double PauseSmoothing = 0.25;
+
+		ScriptGC::ScriptGC()
+		{
+			if (Core::TimeConstants::TickFrequency == 0)
+				Core::TimeConstants::InitConstants();
+
+			m_nNext = 0;
+			m_maxInterval = TimeSpan(DefaultMaxInterval * Core::TimeConstants::TickFrequency);
+			ResetStats();
+		}
+
+		///
+		/// Schedules a VM.
+		///
+		void ScriptGC::AddVM(HSQUIRRELVM v)
+		{
+			VMState state;
+			state.vm = v;
+			state.lastCollection = TimeStamp::GetNow().GetTimeStamp();
+			state.averagePause = 0;
+			m_vms.push_back(state);
+		}
+
+		///
+		/// Schedules every VM of a pool.
+		///
+		void ScriptGC::AddPool(const ScriptVMPool &pool)
+		{
+			for (int32_t i = 0; i < pool.GetCount(); i++)
+				AddVM(pool.GetVM(i));
+		}
+
+		///
+		/// Stops scheduling a VM.
+		///
+		void ScriptGC::RemoveVM(HSQUIRRELVM v)
+		{
+			for (size_t i = 0; i < m_vms.size(); i++)
+			{
+				if (m_vms[i].vm == v)
+				{
+					m_vms.erase(m_vms.begin() + i);
+					if (m_nNext > i)
+						m_nNext--;
+					break;
+				}
+			}
+		}
+
+		///
+		/// Sets the longest a VM may go without being collected.
+		///
+		void ScriptGC::SetMaxInterval(const TimeSpan &interval)
+		{
+			m_maxInterval = interval;
+		}
+
+		///
+		/// Collects one VM and updates the statistics.
+		///
+		void ScriptGC::Collect(VMState &state, bool forced)
+		{
+			__int64 start = TimeStamp::GetNow().GetTimeStamp();
+			SQInteger collected = sq_collectgarbage(state.vm);
+			__int64 end = TimeStamp::GetNow().GetTimeStamp();
+
+			TimeSpan pause(end - start);
+			state.lastCollection = end;
+			state.averagePause = (state.averagePause == 0) ? (double)pause.GetTicks() :
+				state.averagePause + ((double)pause.GetTicks() - state.averagePause) * PauseSmoothing;
+
+			// -1 means Squirrel was built without the cycle collector
+			if (collected > 0)
+				m_stats.objectsCollected += collected;
+
+			m_stats.collections++;
+			if (forced)
+				m_stats.forcedCollections++;
+
+			m_stats.lastPause = pause;
+			m_stats.totalPause = m_stats.totalPause + pause;
+			if (pause > m_stats.maxPause)
+				m_stats.maxPause = pause;
+		}
+
+		///
+		/// Runs at most one collection if it fits in idleTime, or if a VM is overdue.
+		///
+		bool ScriptGC::Update(const TimeSpan &idleTime)
+		{
+			if (m_vms.empty())
+				return false;
+
+			__int64 now = TimeStamp::GetNow().GetTimeStamp();
+
+			// an overdue VM goes first, regardless of the idle time
+			for (size_t i = 0; i < m_vms.size(); i++)
+			{
+				if (now - m_vms[i].lastCollection >= m_maxInterval.GetTicks())
+				{
+					Collect(m_vms[i], true);
+					return true;
+				}
+			}
+
+			// round-robin from the next VM, skipping those whose pause does not fit, so
+			// one slow VM cannot keep the others from being collected
+			for (size_t i = 0; i < m_vms.size(); i++)
+			{
+				if (m_nNext >= m_vms.size())
+					m_nNext = 0;
+
+				VMState &state = m_vms[m_nNext++];
+				if (state.averagePause <= (double)idleTime.GetTicks())
+				{
+					Collect(state, false);
+					return true;
+				}
+			}
+
+			return false;
+		}
+
+		///
+		/// Collects every VM immediately.
+		///
+		void ScriptGC::CollectAll()
+		{
+			for (size_t i = 0; i < m_vms.size(); i++)
+				Collect(m_vms[i], false);
+		}
+
+		///
+		/// Gets the collection statistics.
+		///
+		const ScriptGCStats &ScriptGC::GetStats() const
+		{
+			return m_stats;
+		}
+
+		///
+		/// Clears the collection statistics.
+		///
+		void ScriptGC::ResetStats()
+		{
+			m_stats.collections = 0;
+			m_stats.forcedCollections = 0;
+			m_stats.objectsCollected = 0;
+			m_stats.lastPause = TimeSpan(0);
+			m_stats.maxPause = TimeSpan(0);
+			m_stats.totalPause = TimeSpan(0);
+		}
+	}
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,143 @@
+#pragma once
+#ifndef _TEKSTORM_SCRIPTGC_H
+#define _TEKSTORM_SCRIPTGC_H
+#include "tekscripting.h"
+#include "../core/TimeSpan.h"
+
+#if !defined(TEKSTORM_NO_SCRIPTING)
+namespace Tekstorm
+{
+	namespace Scripting
+	{
+		using Tekstorm::Core::TimeSpan;
+		class ScriptVMPool;
+
+		///
+		/// Cycle collection statistics of a ScriptGC.
+		///
+		struct ScriptGCStats
+		{
+			// The number of collections run.
+			int32_t collections;
+
+			// The number of collections forced by the maximum interval.
+			int32_t forcedCollections;
+
+			// The number of cyclic objects freed.
+			int64_t objectsCollected;
+
+			// The duration of the last collection.
+			TimeSpan lastPause;
+
+			// The longest collection.
+			TimeSpan maxPause;
+
+			// The total time spent collecting.
+			TimeSpan totalPause;
+		};
+
+		///
+		/// Schedules Squirrel cycle collection into idle frame time.
+		///
+		/// Reference counting frees most script objects immediately; sq_collectgarbage
+		/// only reclaims cycles, but it is a full mark and sweep that cannot be split.
+		/// The scheduler bounds each slice instead: Update() collects at most one VM,
+		/// the next one round-robin whose average pause fits in the idle time left in
+		/// the frame, skipping over those that do not. A VM that has gone MaxInterval without fitting is
+		/// collected anyway so cycles cannot pile up.
+		///
+		/// Update() must run at a point where none of the registered VMs is executing,
+		/// i.e. on the main thread after the frame's script jobs have completed.
+		///
+		class TEKAPI ScriptGC
+		{
+		protected:
+			///
+			/// Scheduling state of one VM.
+			///
+			struct VMState
+			{
+				HSQUIRRELVM vm;
+				__int64 lastCollection;
+				double averagePause;
+			};
+
+			///
+			/// The scheduled VMs.
+			///
+			std::vector<VMState> m_vms;
+
+			///
+			/// The VM considered next.
+			///
+			size_t m_nNext;
+
+			///
+			/// The longest a VM may go without being collected.
+			///
+			TimeSpan m_maxInterval;
+
+			///
+			/// Collection statistics.
+			///
+			ScriptGCStats m_stats;
+
+			///
+			/// Collects one VM and updates the statistics.
+			///
+			void Collect(VMState &state, bool forced);
+
+		public:
+			///
+			/// The default maximum interval, in seconds.
+			///
+			static const int32_t DefaultMaxInterval = 10;
+
+			ScriptGC();
+
+			///
+			/// Schedules a VM.
+			///
+			void AddVM(HSQUIRRELVM v);
+
+			///
+			/// Schedules every VM of a pool.
+			///
+			void AddPool(const ScriptVMPool &pool);
+
+			///
+			/// Stops scheduling a VM.
+			///
+			void RemoveVM(HSQUIRRELVM v);
+
+			///
+			/// Sets the longest a VM may go without being collected.
+			///
+			void SetMaxInterval(const TimeSpan &interval);
+
+			///
+			/// Runs at most one collection if it fits in idleTime, or if a VM is overdue.
+			/// Returns true if a collection ran.
+			///
+			bool Update(const TimeSpan &idleTime);
+
+			///
+			/// Collects every VM immediately, i.e. during a loading screen.
+			///
+			void CollectAll();
+
+			///
+			/// Gets the collection statistics.
+			///
+			const ScriptGCStats &GetStats() const;
+
+			///
+			/// Clears the collection statistics.
+			///
+			void ResetStats();
+		};
+	}
+}
+#endif
+
+#endif /* _TEKSTORM_SCRIPTGC_H */
\ No newline at end of file
@@ -0,0 +1,255 @@
+#define TEKSTORM_BUILD
+#include "ScriptProfiler.h"
+#include "../core/TimeConstants.h"
+#include "../IO/TextWriter.h"
+#include <algorithm>
+
+#if !defined(TEKSTORM_NO_SCRIPTING)
+namespace Tekstorm
+{
+	namespace Scripting
+	{
+		using Tekstorm::IO::TextWriter;
+
+		// Set by the hook when the script running on this thread exceeds its budget.
+		static __declspec(thread) bool s_bOverBudget = false;
+
+		ScriptProfiler::ScriptProfiler()
+		{
+			m_vm = nullptr;
+			m_bCountLines = true;
+			m_nInstructionBudget = 0;
+			m_nTimeBudget = 0;
+			m_nInstructions = 0;
+			m_nBudgetStart = 0;
+			m_bBudgetActive = false;
+			m_nOverBudgetCount = 0;
+
+			if (Core::TimeConstants::TickFrequency == 0)
+				Core::TimeConstants::InitConstants();
+		}
+
+		ScriptProfiler::~ScriptProfiler()
+		{
+			Detach();
+		}
+
+		///
+		/// Installs the profiling hook on a VM.
+		///
+		void ScriptProfiler::Attach(HSQUIRRELVM v, bool countLines)
+		{
+			Detach();
+
+			m_vm = v;
+			m_bCountLines = countLines;
+			sq_pushuserpointer(v, this);
+			sq_newclosure(v, &ScriptProfiler::DebugHook, 1);
+			sq_setdebughook(v);
+		}
+
+		///
+		/// Removes the profiling hook.
+		///
+		void ScriptProfiler::Detach()
+		{
+			if (m_vm == nullptr)
+				return;
+
+			sq_pushnull(m_vm);
+			sq_setdebughook(m_vm);
+			m_vm = nullptr;
+			m_stack.clear();
+		}
+
+		///
+		/// Clears all collected statistics.
+		///
+		void ScriptProfiler::Reset()
+		{
+			m_functions.clear();
+			m_lines.clear();
+			m_stack.clear();
+			m_nOverBudgetCount = 0;
+		}
+
+		///
+		/// The native debug hook: (root, type, source, line, funcname) + profiler as free variable.
+		///
+		SQInteger ScriptProfiler::DebugHook(HSQUIRRELVM v)
+		{
+			SQUserPointer pProfiler = nullptr;
+			SQInteger type = 0;
+			SQInteger line = 0;
+			const SQChar *source = nullptr;
+			const SQChar *name = nullptr;
+
+			sq_getuserpointer(v, -1, &pProfiler);
+			sq_getinteger(v, 2, &type);
+			if (sq_gettype(v, 3) == OT_STRING)
+				sq_getstring(v, 3, &source);
+			sq_getinteger(v, 4, &line);
+			if (sq_gettype(v, 5) == OT_STRING)
+				sq_getstring(v, 5, &name);
+
+			((ScriptProfiler *)pProfiler)->OnEvent(type, source, line, name);
+			return 0;
+		}
+
+		///
+		/// Handles one debug hook event ('c'all, 'r'eturn or 'l'ine).
+		///
+		void ScriptProfiler::OnEvent(SQInteger type, const SQChar *source, SQInteger line, const SQChar *name)
+		{
+			__int64 now = TimeStamp::GetNow().GetTimeStamp();
+
+			if (type == 'c' || type == 'r')
+			{
+				m_functionKey.first.assign(source != nullptr ? source : _SC(""));
+				m_functionKey.second.assign(name != nullptr ? name : _SC(""));
+			}
+
+			if (type == 'c')
+			{
+				std::map<FunctionKey, FunctionStats>::iterator it = m_functions.find(m_functionKey);
+				if (it == m_functions.end())
+				{
+					FunctionStats stats = { nullptr, 0, 0 };
+					it = m_functions.insert(std::make_pair(m_functionKey, stats)).first;
+					it->second.pKey = &it->first;
+				}
+
+				it->second.calls++;
+				Frame frame = { &it->second, now };
+				m_stack.push_back(frame);
+			}
+			else if (type == 'r')
+			{
+				// frames unwound by an error never see their return event; skip over them
+				while (!m_stack.empty())
+				{
+					Frame frame = m_stack.back();
+					m_stack.pop_back();
+					frame.pStats->inclusiveTicks += now - frame.start;
+					if (*frame.pStats->pKey == m_functionKey)
+						break;
+				}
+			}
+			else if (type == 'l')
+			{
+				m_nInstructions++;
+				if (m_bCountLines)
+				{
+					m_lineKey.first.assign(source != nullptr ? source : _SC(""));
+					m_lineKey.second = line;
+					m_lines[m_lineKey]++;
+				}
+			}
+
+			if (m_bBudgetActive)
+				CheckBudget();
+		}
+
+		///
+		/// Checks the active budget after an event.
+		///
+		void ScriptProfiler::CheckBudget()
+		{
+			if (s_bOverBudget)
+				return;
+
+			bool over = (m_nInstructionBudget > 0 && m_nInstructions > m_nInstructionBudget);
+			if (!over && m_nTimeBudget > 0)
+				over = (TimeStamp::GetNow().GetTimeStamp() - m_nBudgetStart > m_nTimeBudget);
+
+			if (over)
+			{
+				s_bOverBudget = true;
+				m_nOverBudgetCount++;
+#if defined(TEKSTORM_DEBUG)
+				TEKDEBUG_W("Script exceeded its budget.");
+#endif
+			}
+		}
+
+		///
+		/// Starts enforcing a budget for the script call about to be made on this thread.
+		///
+		void ScriptProfiler::BeginBudget(int32_t instructions, const TimeSpan &time)
+		{
+			m_nInstructionBudget = instructions;
+			m_nTimeBudget = time.GetTicks();
+			m_nInstructions = 0;
+			m_nBudgetStart = TimeStamp::GetNow().GetTimeStamp();
+			m_bBudgetActive = (instructions > 0 || m_nTimeBudget > 0);
+			s_bOverBudget = false;
+		}
+
+		///
+		/// Stops enforcing the budget. Returns true if the call exceeded it.
+		///
+		bool ScriptProfiler::EndBudget()
+		{
+			bool over = s_bOverBudget;
+			m_bBudgetActive = false;
+			s_bOverBudget = false;
+			return over;
+		}
+
+		///
+		/// Gets the number of calls that exceeded their budget.
+		///
+		int32_t ScriptProfiler::GetOverBudgetCount() const
+		{
+			return m_nOverBudgetCount;
+		}
+
+		///
+		/// Returns true if the script running on the calling thread has exceeded its budget.
+		///
+		bool ScriptProfiler::IsThreadOverBudget()
+		{
+			return s_bOverBudget;
+		}
+
+		// Sorts function statistics by descending inclusive time.
+		template <class _StatsType>
+		static bool CompareInclusive(const _StatsType *left, const _StatsType *right)
+		{
+			return left->inclusiveTicks > right->inclusiveTicks;
+		}
+
+		///
+		/// Writes a report, sorted by inclusive time, to a stream.
+		///
+		void ScriptProfiler::WriteReport(IStream *pStream) const
+		{
+			std::vector<const FunctionStats *> sorted;
+			for (std::map<FunctionKey, FunctionStats>::const_iterator it = m_functions.begin(); it != m_functions.end(); ++it)
+				sorted.push_back(&it->second);
+			std::sort(sorted.begin(), sorted.end(), &CompareInclusive<FunctionStats>);
+
+			TextWriter writer(pStream);
+			writer << std::string("calls\tinclusive_ms\tfunction\tsource\n");
+			for (size_t i = 0; i < sorted.size(); i++)
+			{
+				const FunctionStats *pStats = sorted[i];
+				writer << pStats->calls << '\t';
+				writer << (double)TimeSpan(pStats->inclusiveTicks).GetRealMilliseconds() << '\t';
+				writer << (pStats->pKey->second.empty() ? std::string("<anonymous>") : std::string(pStats->pKey->second.c_str())) << '\t';
+				writer << (pStats->pKey->first.empty() ? std::string("<unknown>") : std::string(pStats->pKey->first.c_str())) << '\n';
+			}
+
+			if (!m_lines.empty())
+			{
+				writer << std::string("\nhits\tline\tsource\n");
+				for (std::map<LineKey, int32_t>::const_iterator it = m_lines.begin(); it != m_lines.end(); ++it)
+				{
+					writer << it->second << '\t' << (int32_t)it->first.second << '\t';
+					writer << (it->first.first.empty() ? std::string("<unknown>") : std::string(it->first.first.c_str())) << '\n';
+				}
+			}
+		}
+	}
+}
+#endif
\ No newline at end of file
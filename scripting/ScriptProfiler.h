@@ -0,0 +1,193 @@
+#pragma once
+#ifndef _TEKSTORM_SCRIPTPROFILER_H
+#define _TEKSTORM_SCRIPTPROFILER_H
+#include "tekscripting.h"
+#include "../IO/IStream.h"
+#include "../core/TimeStamp.h"
+#include <map>
+#include <string>
+
+#if !defined(TEKSTORM_NO_SCRIPTING)
+namespace Tekstorm
+{
+	namespace Scripting
+	{
+		using Tekstorm::Core::TimeSpan;
+		using Tekstorm::Core::TimeStamp;
+		using Tekstorm::IO::IStream;
+
+		///
+		/// Profiles a Squirrel VM through its debug hook (the same hook sqdbgserver uses)
+		/// and enforces per-call instruction/time budgets.
+		///
+		/// Counts calls and inclusive time per function and hits per line. Line events
+		/// are only raised for scripts compiled with sq_enabledebuginfo(v, SQTrue).
+		///
+		/// Squirrel 2.1 discards errors raised by the debug hook, so a runaway script
+		/// cannot be stopped from inside the hook. Instead the hook marks the calling
+		/// thread as over budget and the next FastCall native the script calls raises
+		/// "script budget exceeded", unwinding the script. EndBudget() reports the
+		/// overrun so the caller can stop dispatching that script.
+		///
+		/// A script that never calls a FastCall native is therefore never interrupted:
+		/// a pure-script loop runs past its budget until it returns on its own, and the
+		/// overrun is only reported by EndBudget().
+		///
+		class TEKAPI ScriptProfiler
+		{
+		protected:
+			// Functions are keyed by copies of their source and name; the VM's strings
+			// can be freed and their addresses reused while the profiler is attached.
+			// A missing source or name is an empty string.
+			typedef std::basic_string<SQChar> ScriptString;
+			typedef std::pair<ScriptString, ScriptString> FunctionKey;
+			typedef std::pair<ScriptString, SQInteger> LineKey;
+
+			///
+			/// Accumulated statistics of one script function.
+			///
+			struct FunctionStats
+			{
+				const FunctionKey *pKey;
+				int32_t calls;
+				__int64 inclusiveTicks;
+			};
+
+			///
+			/// An active call.
+			///
+			struct Frame
+			{
+				FunctionStats *pStats;
+				__int64 start;
+			};
+
+			///
+			/// The profiled VM.
+			///
+			HSQUIRRELVM m_vm;
+
+			///
+			/// Whether or not line events are counted.
+			///
+			bool m_bCountLines;
+
+			///
+			/// Per-function statistics.
+			///
+			std::map<FunctionKey, FunctionStats> m_functions;
+
+			///
+			/// Per-line hit counts.
+			///
+			std::map<LineKey, int32_t> m_lines;
+
+			///
+			/// Scratch keys for lookups, reused so that events for known functions and
+			/// lines do not allocate.
+			///
+			FunctionKey m_functionKey;
+			LineKey m_lineKey;
+
+			///
+			/// The script call stack.
+			///
+			std::vector<Frame> m_stack;
+
+			///
+			/// The instruction (line) budget of the current call, 0 if unlimited.
+			///
+			int32_t m_nInstructionBudget;
+
+			///
+			/// The time budget of the current call in ticks, 0 if unlimited.
+			///
+			__int64 m_nTimeBudget;
+
+			///
+			/// Lines executed since BeginBudget().
+			///
+			int32_t m_nInstructions;
+
+			///
+			/// When BeginBudget() was called.
+			///
+			__int64 m_nBudgetStart;
+
+			///
+			/// Whether or not a budget is being enforced.
+			///
+			bool m_bBudgetActive;
+
+			///
+			/// The number of calls that exceeded their budget.
+			///
+			int32_t m_nOverBudgetCount;
+
+			///
+			/// The native debug hook; the profiler is its free variable.
+			///
+			static SQInteger DebugHook(HSQUIRRELVM v);
+
+			///
+			/// Handles one debug hook event ('c'all, 'r'eturn or 'l'ine).
+			///
+			void OnEvent(SQInteger type, const SQChar *source, SQInteger line, const SQChar *name);
+
+			///
+			/// Checks the active budget after an event.
+			///
+			void CheckBudget();
+
+		public:
+			ScriptProfiler();
+			~ScriptProfiler();
+
+			///
+			/// Installs the profiling hook on a VM.
+			///
+			void Attach(HSQUIRRELVM v, bool countLines = true);
+
+			///
+			/// Removes the profiling hook.
+			///
+			void Detach();
+
+			///
+			/// Clears all collected statistics.
+			///
+			void Reset();
+
+			///
+			/// Starts enforcing a budget for the script call about to be made on this thread.
+			/// The script is only unwound at its next FastCall native call.
+			/// instructions - the number of executed lines allowed, 0 for unlimited
+			/// time - the wall time allowed, a zero TimeSpan for unlimited
+			///
+			void BeginBudget(int32_t instructions, const TimeSpan &time);
+
+			///
+			/// Stops enforcing the budget. Returns true if the call exceeded it.
+			///
+			bool EndBudget();
+
+			///
+			/// Gets the number of calls that exceeded their budget.
+			///
+			int32_t GetOverBudgetCount() const;
+
+			///
+			/// Returns true if the script running on the calling thread has exceeded its budget.
+			///
+			static bool IsThreadOverBudget();
+
+			///
+			/// Writes a report, sorted by inclusive time, to a stream.
+			///
+			void WriteReport(IStream *pStream) const;
+		};
+	}
+}
+#endif
+
+#endif /* _TEKSTORM_SCRIPTPROFILER_H */
\ No newline at end of file
@@ -0,0 +1,407 @@
+#define TEKSTORM_BUILD
+#include "ScriptReloader.h"
+#include "ScriptCache.h"
+#include "ScriptVMPool.h"
+#include "../IO/MemoryStream.h"
+
+#if !defined(TEKSTORM_NO_SCRIPTING)
+namespace Tekstorm
+{
+	namespace Scripting
+	{
+		using Tekstorm::IO::MemoryStream;
+
+		///
+		/// Reports compile errors of the watcher's private VM.
+		///
+		static void ReportCompileError(HSQUIRRELVM v, const SQChar *desc, const SQChar *source, SQInteger line, SQInteger column)
+		{
+#if defined(TEKSTORM_DEBUG)
+			TEKDEBUG_W(source << "(" << (int32_t)line << ":" << (int32_t)column << "): " << desc);
+#endif
+		}
+
+		ScriptReloader::ScriptReloader()
+		{
+			m_hThread = nullptr;
+			m_hStopEvent = nullptr;
+			m_nSettleTime = DefaultSettleTime;
+			InitializeCriticalSection(&m_lock);
+		}
+
+		ScriptReloader::~ScriptReloader()
+		{
+			Stop();
+			DeleteCriticalSection(&m_lock);
+		}
+
+		///
+		/// Adds a VM reloads are applied to.
+		///
+		void ScriptReloader::AddVM(HSQUIRRELVM v)
+		{
+			m_vms.push_back(v);
+		}
+
+		///
+		/// Adds every VM of a pool.
+		///
+		void ScriptReloader::AddPool(const ScriptVMPool &pool)
+		{
+			for (int32_t i = 0; i < pool.GetCount(); i++)
+				m_vms.push_back(pool.GetVM(i));
+		}
+
+		///
+		/// Sets how long a file must stay unchanged before it is compiled.
+		///
+		void ScriptReloader::SetSettleTime(int32_t milliseconds)
+		{
+			m_nSettleTime = milliseconds;
+		}
+
+		///
+		/// Starts watching a directory tree for changed scripts.
+		///
+		bool ScriptReloader::Start(const std::string &directory)
+		{
+			Stop();
+
+			m_directory = directory;
+			m_hStopEvent = CreateEvent(nullptr, TRUE, FALSE, nullptr);
+			m_hThread = CreateThread(nullptr, 0, &ScriptReloader::WatchThread, this, 0, nullptr);
+			if (m_hThread == nullptr)
+			{
+#if defined(TEKSTORM_DEBUG)
+				TEKDEBUG_W("Could not start the script watcher thread.");
+#endif
+				CloseHandle(m_hStopEvent);
+				m_hStopEvent = nullptr;
+				return false;
+			}
+
+			return true;
+		}
+
+		///
+		/// Stops watching.
+		///
+		void ScriptReloader::Stop()
+		{
+			if (m_hThread == nullptr)
+				return;
+
+			SetEvent(m_hStopEvent);
+			WaitForSingleObject(m_hThread, INFINITE);
+			CloseHandle(m_hThread);
+			CloseHandle(m_hStopEvent);
+			m_hThread = nullptr;
+			m_hStopEvent = nullptr;
+
+			EnterCriticalSection(&m_lock);
+			m_pending.clear();
+			LeaveCriticalSection(&m_lock);
+		}
+
+		///
+		/// Entry point of the watcher thread.
+		///
+		DWORD WINAPI ScriptReloader::WatchThread(LPVOID pParameter)
+		{
+			((ScriptReloader *)pParameter)->Watch();
+			return 0;
+		}
+
+		///
+		/// Watches the directory until the stop event is signalled.
+		///
+		void ScriptReloader::Watch()
+		{
+			HANDLE hDirectory = CreateFileA(m_directory.c_str(), FILE_LIST_DIRECTORY,
+				FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+				FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+			if (hDirectory == INVALID_HANDLE_VALUE)
+			{
+#if defined(TEKSTORM_DEBUG)
+				TEKDEBUG_W("Could not watch script directory " << m_directory);
+#endif
+				return;
+			}
+
+			// compiling happens in a private VM so the running ones are never touched
+			HSQUIRRELVM compiler = sq_open(1024);
+			sq_setcompilererrorhandler(compiler, &ReportCompileError);
+
+			OVERLAPPED overlapped;
+			memset(&overlapped, 0, sizeof(OVERLAPPED));
+			overlapped.hEvent = CreateEvent(nullptr, TRUE, FALSE, nullptr);
+
+			DWORD buffer[4096];
+			std::set<std::string> changed;
+			bool reading = false;
+
+			for (;;)
+			{
+				if (!reading)
+				{
+					ResetEvent(overlapped.hEvent);
+					if (!ReadDirectoryChangesW(hDirectory, buffer, sizeof(buffer), TRUE,
+						FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME, nullptr, &overlapped, nullptr))
+					{
+						break;
+					}
+
+					reading = true;
+				}
+
+				HANDLE handles[2] = { m_hStopEvent, overlapped.hEvent };
+				DWORD result = WaitForMultipleObjects(2, handles, FALSE, changed.empty() ? INFINITE : (DWORD)m_nSettleTime);
+				if (result == WAIT_OBJECT_0 + 1)
+				{
+					DWORD size = 0;
+					reading = false;
+					if (!GetOverlappedResult(hDirectory, &overlapped, &size, FALSE) || size == 0)
+						continue;
+
+					// collect the changed scripts; they are compiled once they settle
+					const char *pEntry = (const char *)buffer;
+					for (;;)
+					{
+						const FILE_NOTIFY_INFORMATION *pInfo = (const FILE_NOTIFY_INFORMATION *)pEntry;
+						char name[MAX_PATH];
+						int32_t length = WideCharToMultiByte(CP_ACP, 0, pInfo->FileName, pInfo->FileNameLength / sizeof(WCHAR),
+							name, MAX_PATH - 1, nullptr, nullptr);
+						name[length] = 0;
+
+						if (pInfo->Action != FILE_ACTION_REMOVED && pInfo->Action != FILE_ACTION_RENAMED_OLD_NAME &&
+							length > 4 && _stricmp(name + length - 4, ".nut") == 0)
+						{
+							changed.insert(m_directory + "\\" + name);
+						}
+
+						if (pInfo->NextEntryOffset == 0)
+							break;
+						pEntry += pInfo->NextEntryOffset;
+					}
+				}
+				else if (result == WAIT_TIMEOUT)
+				{
+					CompileFiles(compiler, changed);
+					changed.clear();
+				}
+				else
+				{
+					break;
+				}
+			}
+
+			if (reading)
+			{
+				DWORD size = 0;
+				CancelIo(hDirectory);
+				GetOverlappedResult(hDirectory, &overlapped, &size, TRUE);
+			}
+
+			CloseHandle(overlapped.hEvent);
+			CloseHandle(hDirectory);
+			sq_close(compiler);
+		}
+
+		///
+		/// Compiles the changed files and queues them for Update().
+		///
+		void ScriptReloader::CompileFiles(HSQUIRRELVM compiler, const std::set<std::string> &files)
+		{
+			for (std::set<std::string>::const_iterator it = files.begin(); it != files.end(); ++it)
+			{
+				std::vector<char> source;
+				if (!ScriptCache::ReadFile(*it, &source))
+				{
+#if defined(TEKSTORM_DEBUG)
+					TEKDEBUG_W("Could not read changed script " << *it);
+#endif
+					continue;
+				}
+
+				// scripts are compiled as ANSI text (SQChar == char)
+				PendingReload reload;
+				reload.path = *it;
+				if (!ScriptCache::Compile(compiler, (const SQChar *)(source.empty() ? "" : &source[0]),
+					(int32_t)(source.size() / sizeof(SQChar)), (const SQChar *)it->c_str(), &reload.bytecode))
+				{
+					continue;
+				}
+
+				EnterCriticalSection(&m_lock);
+				m_pending.push_back(reload);
+				LeaveCriticalSection(&m_lock);
+			}
+		}
+
+		///
+		/// Applies the scripts compiled since the last call.
+		///
+		int32_t ScriptReloader::Update()
+		{
+			std::vector<PendingReload> pending;
+			EnterCriticalSection(&m_lock);
+			pending.swap(m_pending);
+			LeaveCriticalSection(&m_lock);
+
+			int32_t reloaded = 0;
+			for (size_t i = 0; i < pending.size(); i++)
+			{
+				bool succeeded = true;
+				if (m_vms.empty())
+				{
+					succeeded = Apply(SquirrelVM::GetVMPtr(), pending[i].bytecode);
+				}
+				else
+				{
+					for (size_t j = 0; j < m_vms.size(); j++)
+						succeeded = Apply(m_vms[j], pending[i].bytecode) && succeeded;
+				}
+
+				if (succeeded)
+					reloaded++;
+
+#if defined(TEKSTORM_DEBUG)
+				if (succeeded)
+				{
+					TEKDEBUG_INFO("Reloaded " << pending[i].path);
+				}
+				else
+				{
+					TEKDEBUG_W("Failed to reload " << pending[i].path);
+				}
+#endif
+			}
+
+			return reloaded;
+		}
+
+		///
+		/// Runs a compiled script in a VM and merges its definitions into the root table.
+		///
+		bool ScriptReloader::Apply(HSQUIRRELVM v, const std::vector<char> &bytecode)
+		{
+			if (bytecode.empty())
+				return false;
+
+			SQInteger top = sq_gettop(v);
+			MemoryStream stream((char *)&bytecode[0], (int32_t)bytecode.size());
+			if (!ScriptCache::ReadClosure(v, &stream))
+				return false;
+
+			// the script defines into a scratch table that reads through to the root table
+			sq_newtable(v);
+			sq_pushroottable(v);
+			sq_setdelegate(v, -2);
+
+			SQInteger environment = sq_gettop(v);
+			sq_push(v, environment - 1);
+			sq_push(v, environment);
+			if (SQ_FAILED(sq_call(v, 1, SQFalse, SQTrue)))
+			{
+				sq_settop(v, top);
+				return false;
+			}
+
+			sq_pushroottable(v);
+			SQInteger root = sq_gettop(v);
+
+			sq_pushnull(v);
+			while (SQ_SUCCEEDED(sq_next(v, environment)))
+			{
+				SQInteger value = sq_gettop(v);
+				MergeSlot(v, root);
+				sq_settop(v, value - 2);
+			}
+
+			sq_settop(v, top);
+			return true;
+		}
+
+		///
+		/// Merges the slot (key at -2, value at -1) into the table at 'root'.
+		///
+		void ScriptReloader::MergeSlot(HSQUIRRELVM v, SQInteger root)
+		{
+			SQInteger value = sq_gettop(v);
+			SQInteger key = value - 1;
+			SQObjectType type = sq_gettype(v, value);
+
+			if (type == OT_CLASS)
+			{
+				sq_push(v, key);
+				if (SQ_SUCCEEDED(sq_rawget(v, root)) && sq_gettype(v, -1) == OT_CLASS)
+				{
+					bool merged = MergeClass(v, sq_gettop(v), value);
+					sq_settop(v, value);
+					if (merged)
+						return;
+
+#if defined(TEKSTORM_DEBUG)
+					const SQChar *name = nullptr;
+					sq_getstring(v, key, &name);
+					TEKDEBUG_W("Class " << (name != nullptr ? name : "?") << " gained methods while instantiated; existing instances keep the old class.");
+#endif
+				}
+
+				sq_settop(v, value);
+			}
+			else if (type != OT_CLOSURE && type != OT_NATIVECLOSURE)
+			{
+				// data keeps its live value; only new globals are added
+				sq_push(v, key);
+				bool exists = SQ_SUCCEEDED(sq_rawget(v, root));
+				sq_settop(v, value);
+				if (exists)
+					return;
+			}
+
+			sq_push(v, key);
+			sq_push(v, value);
+			sq_newslot(v, root, SQFalse);
+			sq_settop(v, value);
+		}
+
+		///
+		/// Merges the methods of the class at 'source' into the class at 'target'.
+		///
+		bool ScriptReloader::MergeClass(HSQUIRRELVM v, SQInteger target, SQInteger source)
+		{
+			bool merged = true;
+
+			sq_pushnull(v);
+			while (SQ_SUCCEEDED(sq_next(v, source)))
+			{
+				SQInteger value = sq_gettop(v);
+				SQObjectType type = sq_gettype(v, value);
+
+				// field defaults are left alone so the state of existing instances is untouched
+				if (type == OT_CLOSURE || type == OT_NATIVECLOSURE)
+				{
+					// existing methods are replaced in place, which live instances see
+					sq_push(v, value - 1);
+					sq_push(v, value);
+					if (SQ_FAILED(sq_set(v, target)))
+					{
+						// new methods can only be added while the class has no instances
+						sq_settop(v, value);
+						sq_push(v, value - 1);
+						sq_push(v, value);
+						if (SQ_FAILED(sq_newslot(v, target, SQFalse)))
+							merged = false;
+					}
+				}
+
+				sq_settop(v, value - 2);
+			}
+
+			sq_pop(v, 1);
+			return merged;
+		}
+	}
+}
+#endif
\ No newline at end of file
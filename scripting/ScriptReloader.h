@@ -0,0 +1,158 @@
+#pragma once
+#ifndef _TEKSTORM_SCRIPTRELOADER_H
+#define _TEKSTORM_SCRIPTRELOADER_H
+#include "tekscripting.h"
+#include <set>
+
+#if !defined(TEKSTORM_NO_SCRIPTING)
+namespace Tekstorm
+{
+	namespace Scripting
+	{
+		class ScriptVMPool;
+
+		///
+		/// Reloads changed scripts into running VMs.
+		///
+		/// A background thread watches a directory tree (ReadDirectoryChangesW) for
+		/// changed .nut files and compiles each one to bytecode in a private VM.
+		/// Update() then runs the new code at a safe point between frames. Each script
+		/// is run in a scratch table that falls back to the root table. Its new
+		/// definitions are then merged into the root table:
+		///  - functions replace the old ones
+		///  - methods of existing classes are replaced in place, so live instances use them
+		///  - data globals keep their current values; only new ones are added
+		///
+		/// Squirrel locks a class once it has been instantiated. If a reload adds methods
+		/// to such a class, the root table is pointed at the new class instead. Existing
+		/// instances then keep the old class, with its existing methods updated.
+		///
+		class TEKAPI ScriptReloader
+		{
+		protected:
+			///
+			/// A compiled script waiting to be applied.
+			///
+			struct PendingReload
+			{
+				std::string path;
+				std::vector<char> bytecode;
+			};
+
+			///
+			/// The watched directory.
+			///
+			std::string m_directory;
+
+			///
+			/// The VMs reloads are applied to.
+			///
+			std::vector<HSQUIRRELVM> m_vms;
+
+			///
+			/// The watcher thread.
+			///
+			HANDLE m_hThread;
+
+			///
+			/// Signalled to stop the watcher thread.
+			///
+			HANDLE m_hStopEvent;
+
+			///
+			/// Guards m_pending.
+			///
+			CRITICAL_SECTION m_lock;
+
+			///
+			/// Compiled scripts waiting for Update().
+			///
+			std::vector<PendingReload> m_pending;
+
+			///
+			/// How long, in milliseconds, a file must stay unchanged before it is compiled.
+			///
+			int32_t m_nSettleTime;
+
+			///
+			/// Entry point of the watcher thread.
+			///
+			static DWORD WINAPI WatchThread(LPVOID pParameter);
+
+			///
+			/// Watches the directory until the stop event is signalled.
+			///
+			void Watch();
+
+			///
+			/// Compiles the changed files and queues them for Update().
+			///
+			void CompileFiles(HSQUIRRELVM compiler, const std::set<std::string> &files);
+
+			///
+			/// Merges the slot (key at -2, value at -1) into the table at 'root'.
+			///
+			static void MergeSlot(HSQUIRRELVM v, SQInteger root);
+
+			///
+			/// Merges the methods of the class at 'source' into the class at 'target'.
+			/// Returns false if some method could not be added.
+			///
+			static bool MergeClass(HSQUIRRELVM v, SQInteger target, SQInteger source);
+
+			///
+			/// Reloaders are not copyable.
+			///
+			ScriptReloader(const ScriptReloader &other);
+			ScriptReloader &operator=(const ScriptReloader &other);
+
+		public:
+			///
+			/// The default settle time in milliseconds.
+			///
+			static const int32_t DefaultSettleTime = 100;
+
+			ScriptReloader();
+			~ScriptReloader();
+
+			///
+			/// Adds a VM reloads are applied to. Without any, the main SquirrelVM is used.
+			///
+			void AddVM(HSQUIRRELVM v);
+
+			///
+			/// Adds every VM of a pool.
+			///
+			void AddPool(const ScriptVMPool &pool);
+
+			///
+			/// Sets how long a file must stay unchanged before it is compiled.
+			///
+			void SetSettleTime(int32_t milliseconds);
+
+			///
+			/// Starts watching a directory tree for changed scripts.
+			///
+			bool Start(const std::string &directory);
+
+			///
+			/// Stops watching.
+			///
+			void Stop();
+
+			///
+			/// Applies the scripts compiled since the last call. Must be called while none
+			/// of the VMs is executing. Returns the number of scripts reloaded.
+			///
+			int32_t Update();
+
+			///
+			/// Runs a compiled script (a ScriptCache entry) in a VM and merges its definitions into the root table.
+			///
+			static bool Apply(HSQUIRRELVM v, const std::vector<char> &bytecode);
+		};
+	}
+}
+#endif
+
+#endif /* _TEKSTORM_SCRIPTRELOADER_H */
\ No newline at end of file
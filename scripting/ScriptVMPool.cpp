@@ -0,0 +1,277 @@
+#define TEKSTORM_BUILD
+#include "ScriptVMPool.h"
+#include "ScriptCache.h"
+#include "../IO/MemoryStream.h"
+
+#if !defined(TEKSTORM_NO_SCRIPTING)
+#include "squirrel\sqstdaux.h"
+#include "squirrel\sqstdblob.h"
+#include "squirrel\sqstdmath.h"
+#include "squirrel\sqstdstring.h"
+
+namespace Tekstorm
+{
+	namespace Scripting
+	{
+		// The pool VM index of the calling thread.
+		static __declspec(thread) int32_t s_nThreadIndex = -1;
+
+		ScriptVMPool::ScriptVMPool()
+		{
+		}
+
+		ScriptVMPool::~ScriptVMPool()
+		{
+			Destroy();
+		}
+
+		///
+		/// Adds a native binding callback. Must be called before Create().
+		///
+		void ScriptVMPool::AddBinding(ScriptBindFunction binder)
+		{
+			m_binders.push_back(binder);
+		}
+
+		///
+		/// Adds a script that every VM compiles and runs on creation. Must be called before Create().
+		///
+		void ScriptVMPool::AddScript(const SQChar *name, const SQChar *source)
+		{
+			Script script;
+			script.name = name;
+			script.source = source;
+			m_scripts.push_back(script);
+			m_bytecode.push_back(std::vector<char>());
+		}
+
+		///
+		/// Adds a precompiled script (a ScriptCache entry) that every VM loads and runs on creation.
+		///
+		bool ScriptVMPool::AddCompiledScript(Tekstorm::IO::IStream *pStream)
+		{
+			int32_t length = pStream->GetLength();
+			if (length <= 0)
+				return false;
+
+			std::vector<char> bytecode(length);
+			if (pStream->Read(&bytecode[0], length, 0) != length)
+				return false;
+
+			m_scripts.push_back(Script());
+			m_bytecode.push_back(bytecode);
+			return true;
+		}
+
+		///
+		/// Registers a root-table function for fast dispatch and returns its index.
+		///
+		int32_t ScriptVMPool::AddFunction(const SQChar *name)
+		{
+#if defined(TEKSTORM_DEBUG)
+			if (!m_vms.empty()) {
+				TEKDEBUG_WF("Functions added after Create() are not resolved.");
+			}
+#endif
+			m_functionNames.push_back(name);
+			return (int32_t)m_functionNames.size() - 1;
+		}
+
+		///
+		/// Creates 'count' VMs, binds the native API and runs the preloaded scripts.
+		///
+		bool ScriptVMPool::Create(int32_t count)
+		{
+			if (count <= 0)
+			{
+				SYSTEM_INFO info;
+				GetSystemInfo(&info);
+				count = (int32_t)info.dwNumberOfProcessors;
+			}
+
+			// SqPlus binds into whatever SquirrelVM currently points at, so remember
+			// the main VM (keeping it alive with a reference) and restore it afterwards.
+			SquirrelVMSys mainVM;
+			SquirrelVM::GetVMSys(mainVM);
+
+			bool result = true;
+			size_t functionCount = m_functionNames.size();
+			m_functions.resize(count * functionCount);
+
+			for (int32_t i = 0; i < count && result; i++)
+			{
+				HSQUIRRELVM v = sq_open(1024);
+				if (v == nullptr)
+				{
+					result = false;
+					break;
+				}
+
+				m_vms.push_back(v);
+				sq_setforeignptr(v, this);
+				sq_setprintfunc(v, SquirrelVM::PrintFunc);
+				sqstd_seterrorhandlers(v);
+
+				sq_pushroottable(v);
+				sqstd_register_mathlib(v);
+				sqstd_register_stringlib(v);
+				sqstd_register_bloblib(v);
+				sq_pop(v, 1);
+
+				SquirrelVM::Release();
+				SquirrelVM::InitNoRef(v);
+				for (size_t b = 0; b < m_binders.size(); b++)
+					m_binders[b](v);
+				SquirrelVM::Release();
+
+				if (!LoadScripts(v))
+				{
+					result = false;
+					break;
+				}
+
+				for (size_t f = 0; f < functionCount; f++)
+				{
+					HSQOBJECT &func = m_functions[i * functionCount + f];
+					sq_resetobject(&func);
+
+					sq_pushroottable(v);
+					sq_pushstring(v, m_functionNames[f].c_str(), -1);
+					if (SQ_SUCCEEDED(sq_get(v, -2)))
+					{
+						sq_getstackobj(v, -1, &func);
+						sq_addref(v, &func);
+						sq_pop(v, 1);
+					}
+#if defined(TEKSTORM_DEBUG)
+					else {
+						TEKDEBUG_WF("A dispatch function is not defined by the preloaded scripts.");
+					}
+#endif
+					sq_pop(v, 1);
+				}
+			}
+
+			SquirrelVM::SetVMSys(mainVM);
+
+			if (!result)
+				Destroy();
+
+			return result;
+		}
+
+		///
+		/// Compiles and runs every preloaded script in the given VM.
+		///
+		bool ScriptVMPool::LoadScripts(HSQUIRRELVM v)
+		{
+			for (size_t i = 0; i < m_scripts.size(); i++)
+			{
+				std::vector<char> &bytecode = m_bytecode[i];
+				if (bytecode.empty())
+				{
+					const Script &script = m_scripts[i];
+					if (!ScriptCache::Compile(v, script.source.c_str(), (int32_t)script.source.length(), script.name.c_str(), &bytecode))
+						return false;
+				}
+
+				Tekstorm::IO::MemoryStream stream(&bytecode[0], (int32_t)bytecode.size());
+				if (!ScriptCache::ReadClosure(v, &stream))
+					return false;
+
+				sq_pushroottable(v);
+				SQRESULT res = sq_call(v, 1, SQFalse, SQTrue);
+				sq_pop(v, 1);
+				if (SQ_FAILED(res))
+					return false;
+			}
+
+			return true;
+		}
+
+		///
+		/// Closes every VM in the pool.
+		///
+		void ScriptVMPool::Destroy()
+		{
+			size_t functionCount = m_functionNames.size();
+			for (size_t i = 0; i < m_vms.size(); i++)
+			{
+				for (size_t f = 0; f < functionCount && i * functionCount + f < m_functions.size(); f++)
+					sq_release(m_vms[i], &m_functions[i * functionCount + f]);
+
+				sq_close(m_vms[i]);
+			}
+
+			m_vms.clear();
+			m_functions.clear();
+		}
+
+		///
+		/// Gets the number of VMs.
+		///
+		int32_t ScriptVMPool::GetCount() const
+		{
+			return (int32_t)m_vms.size();
+		}
+
+		///
+		/// Gets a VM by index.
+		///
+		HSQUIRRELVM ScriptVMPool::GetVM(int32_t index) const
+		{
+			return m_vms[index];
+		}
+
+		///
+		/// Associates the calling thread with a VM index.
+		///
+		void ScriptVMPool::BindThread(int32_t index)
+		{
+			s_nThreadIndex = index;
+		}
+
+		///
+		/// Gets the VM index bound to the calling thread, or -1.
+		///
+		int32_t ScriptVMPool::GetThreadIndex()
+		{
+			return s_nThreadIndex;
+		}
+
+		///
+		/// Gets the VM belonging to the calling thread.
+		///
+		HSQUIRRELVM ScriptVMPool::GetCurrentVM() const
+		{
+#if defined(TEKSTORM_DEBUG)
+			if (s_nThreadIndex < 0 || s_nThreadIndex >= (int32_t)m_vms.size()) {
+				TEKDEBUG_EF("The calling thread is not bound to a pooled VM.");
+			}
+#endif
+			return m_vms[s_nThreadIndex];
+		}
+
+		///
+		/// Calls a registered function on the calling thread's VM as function(entity, deltaTime).
+		///
+		bool ScriptVMPool::Dispatch(int32_t function, SQUserPointer pEntity, SQFloat deltaTime)
+		{
+			HSQUIRRELVM v = GetCurrentVM();
+			HSQOBJECT &func = m_functions[s_nThreadIndex * m_functionNames.size() + function];
+			if (sq_isnull(func))
+				return false;
+
+			SQInteger top = sq_gettop(v);
+			sq_pushobject(v, func);
+			sq_pushroottable(v);
+			sq_pushuserpointer(v, pEntity);
+			sq_pushfloat(v, deltaTime);
+			bool result = SQ_SUCCEEDED(sq_call(v, 3, SQFalse, SQTrue));
+			sq_settop(v, top);
+
+			return result;
+		}
+	}
+}
+#endif
\ No newline at end of file
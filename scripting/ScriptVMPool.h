@@ -0,0 +1,155 @@
+#pragma once
+#ifndef _TEKSTORM_SCRIPTVMPOOL_H
+#define _TEKSTORM_SCRIPTVMPOOL_H
+#include "tekscripting.h"
+#include "../IO/IStream.h"
+
+#if !defined(TEKSTORM_NO_SCRIPTING)
+namespace Tekstorm
+{
+	namespace Scripting
+	{
+		///
+		/// Called once per VM while the pool is created, to register native functions
+		/// and classes. While it runs, SquirrelVM is pointed at 'v', so SqPlus
+		/// registration helpers bind into that VM as well.
+		///
+		typedef void (*ScriptBindFunction)(HSQUIRRELVM v);
+
+		///
+		/// A pool of independent Squirrel VMs, one per worker thread. Every VM receives
+		/// the same native bindings and preloaded scripts, so behaviour scripts can run
+		/// on whichever VM belongs to the current worker without any locking.
+		///
+		/// SquirrelVM itself remains the single "main" VM; pooled VMs are only touched
+		/// through the raw sq_* API once the pool has been created.
+		///
+		class TEKAPI ScriptVMPool
+		{
+		protected:
+			typedef std::basic_string<SQChar> ScriptString;
+
+			///
+			/// A script that is compiled and run in every VM on creation.
+			///
+			struct Script
+			{
+				ScriptString name;
+				ScriptString source;
+			};
+
+			///
+			/// The VMs of this pool.
+			///
+			std::vector<HSQUIRRELVM> m_vms;
+
+			///
+			/// Resolved dispatch functions; m_functions[vm * functionCount + function].
+			///
+			std::vector<HSQOBJECT> m_functions;
+
+			///
+			/// Registered native binding callbacks.
+			///
+			std::vector<ScriptBindFunction> m_binders;
+
+			///
+			/// Scripts preloaded into every VM.
+			///
+			std::vector<Script> m_scripts;
+
+			///
+			/// Compiled closures (ScriptCache entries) of the preloaded scripts, so each
+			/// script is compiled once rather than once per VM.
+			///
+			std::vector<std::vector<char> > m_bytecode;
+
+			///
+			/// Names of the root-table functions that can be dispatched.
+			///
+			std::vector<ScriptString> m_functionNames;
+
+			///
+			/// Compiles and runs every preloaded script in the given VM.
+			///
+			virtual bool LoadScripts(HSQUIRRELVM v);
+
+			///
+			/// Pools are not copyable.
+			///
+			ScriptVMPool(const ScriptVMPool &other);
+			ScriptVMPool &operator=(const ScriptVMPool &other);
+
+		public:
+			ScriptVMPool();
+			virtual ~ScriptVMPool();
+
+			///
+			/// Adds a native binding callback. Must be called before Create().
+			///
+			void AddBinding(ScriptBindFunction binder);
+
+			///
+			/// Adds a script that every VM compiles and runs on creation. Must be called before Create().
+			///
+			void AddScript(const SQChar *name, const SQChar *source);
+
+			///
+			/// Adds a precompiled script (a ScriptCache entry, i.e. from a cache file or archive)
+			/// that every VM loads and runs on creation. Must be called before Create().
+			///
+			bool AddCompiledScript(Tekstorm::IO::IStream *pStream);
+
+			///
+			/// Registers a root-table function for fast dispatch and returns its index.
+			/// Must be called before Create().
+			///
+			int32_t AddFunction(const SQChar *name);
+
+			///
+			/// Creates 'count' VMs (0 = one per processor), binds the native API and runs the preloaded scripts.
+			/// Source scripts are compiled in the first VM and loaded as bytecode into the others.
+			///
+			bool Create(int32_t count = 0);
+
+			///
+			/// Closes every VM in the pool.
+			///
+			void Destroy();
+
+			///
+			/// Gets the number of VMs.
+			///
+			int32_t GetCount() const;
+
+			///
+			/// Gets a VM by index.
+			///
+			HSQUIRRELVM GetVM(int32_t index) const;
+
+			///
+			/// Associates the calling thread with a VM index. Each worker calls this once at startup.
+			///
+			static void BindThread(int32_t index);
+
+			///
+			/// Gets the VM index bound to the calling thread, or -1.
+			///
+			static int32_t GetThreadIndex();
+
+			///
+			/// Gets the VM belonging to the calling thread.
+			///
+			HSQUIRRELVM GetCurrentVM() const;
+
+			///
+			/// Calls a registered function on the calling thread's VM as function(entity, deltaTime).
+			/// Returns false if the function is missing or raised an error.
+			///
+			bool Dispatch(int32_t function, SQUserPointer pEntity, SQFloat deltaTime);
+		};
+	}
+}
+#endif
+
+#endif /* _TEKSTORM_SCRIPTVMPOOL_H */
\ No newline at end of file
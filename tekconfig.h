@@ -55,22 +55,51 @@ namespace Tekstorm
 	{
 		class IDisposable;
 		class IResource;
+		class TEKAPI Checksum;
 		class TEKAPI Debug;
+		class TEKAPI JobCounter;
+		class TEKAPI JobSystem;
+		class TEKAPI MemoryTracker;
+		class TEKAPI ResourceCache;
+		class TEKAPI ResourceManager;
+		class TEKAPI StringId;
+		class TEKAPI Xxh3;
 	}
 
 	namespace Graphics
 	{
 		class TEKAPI GraphicsAdapter;
 		class TEKAPI GraphicsDevice;
+		class TEKAPI ImageDecoder;
+		class TEKAPI MaxRectsPacker;
 		class TEKAPI VertexShader;
 		class TEKAPI PixelShader;
+		class TEKAPI SoftwareGraphicsDevice;
+		class TEKAPI SoftwareTexture;
+		class TEKAPI SpriteBatch;
+		class TEKAPI TextureAtlas;
 		class TEKAPI VertexBuffer;
 		class TEKAPI InputLayout;
 		class TEKAPI Texture;
+
+		///
+		/// Names a texture to SpriteBatch and TextureAtlas without tying them to a
+		/// backend: a Texture * for the Direct3D device, a SoftwareTexture * for the
+		/// software one. Only the device the draw calls are submitted to reads it.
+		///
+		typedef const void *TextureKey;
 	}
 
 	namespace IO
 	{
+		class TEKAPI Archive;
+		class TEKAPI ArchiveStream;
+		class TEKAPI ArchiveWriter;
+		class TEKAPI CompressStream;
+		class TEKAPI DecompressStream;
+		class TEKAPI FileStream;
+		class TEKAPI HashStream;
+		class TEKAPI Inflate;
 		class TEKAPI IStream;
 		class TEKAPI MemoryStream;
 		class TEKAPI TextWriter;
@@ -92,6 +121,7 @@ namespace Tekstorm
 		class TEKAPI IPAddress;
 		class TEKAPI IPEndPoint;
 		class TEKAPI NetworkStream;
+		class TEKAPI ServerSocketGroup;
 		class TEKAPI Socket;
 	}
 
@@ -99,6 +129,14 @@ namespace Tekstorm
 	{
 	}
 
+	namespace Scene
+	{
+		class TEKAPI Archetype;
+		class TEKAPI CommandBuffer;
+		class TEKAPI Query;
+		class TEKAPI World;
+	}
+
 	namespace Scripting
 	{
 	}
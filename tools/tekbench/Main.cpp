@@ -0,0 +1,606 @@
+#include "../../core/SlotMap.h"
+#include "../../core/SparseSet.h"
+#include "../../core/FlatHashMap.h"
+#include "../../core/Checksum.h"
+#include "../../core/Xxh3.h"
+#include "../../core/TimeConstants.h"
+#include "../../core/TimeStamp.h"
+#include "../../IO/Compression.h"
+#if !defined(TEKSTORM_NO_SCRIPTING)
+	#include "../../scripting/ScriptFastCall.h"
+#endif
+#include <unordered_map>
+#include <iomanip>
+
+using namespace Tekstorm;
+using namespace IO;
+using namespace Core;
+#if !defined(TEKSTORM_NO_SCRIPTING)
+using namespace Math;
+using namespace Scripting;
+#endif
+
+///
+/// Results are folded into this so the optimizer cannot drop the measured work.
+///
+static volatile uint64_t g_sink = 0;
+
+///
+/// Measures elapsed wall time.
+///
+struct Stopwatch
+{
+	__int64 start;
+
+	Stopwatch() : start(TimeStamp::GetNow().GetTimeStamp()) { }
+
+	double GetSeconds() const
+	{
+		return (double)(TimeStamp::GetNow().GetTimeStamp() - start) * TimeConstants::InvTickFrequency;
+	}
+};
+
+///
+/// Prints one result line: the name, the time per run and a rate.
+///
+static void Report(const char *name, double seconds, double rate, const char *unit)
+{
+	std::cout << "  " << std::left << std::setw(44) << name << std::right
+		<< std::setw(10) << std::fixed << std::setprecision(2) << seconds * 1000.0 << " ms"
+		<< std::setw(12) << std::setprecision(1) << rate << " " << unit << "\n";
+}
+
+///
+/// Prints a result as millions of operations per second.
+///
+static void ReportOps(const char *name, double seconds, uint32_t count)
+{
+	Report(name, seconds, (double)count / seconds / 1e6, "M ops/s");
+}
+
+///
+/// A stand-in for a component: a position and a velocity.
+///
+struct Particle
+{
+	float x, y, vx, vy;
+};
+
+static Particle MakeParticle(uint32_t i)
+{
+	Particle particle = { (float)i, (float)i, 1.0f, -1.0f };
+	return particle;
+}
+
+///
+/// A fixed pseudo-random sequence (xorshift32), so runs are comparable.
+///
+struct Random
+{
+	uint32_t state;
+
+	Random() : state(2463534242u) { }
+
+	uint32_t Next()
+	{
+		state ^= state << 13;
+		state ^= state >> 17;
+		state ^= state << 5;
+		return state;
+	}
+};
+
+///
+/// Builds the random lookup order used by every container at one size.
+///
+static void MakeLookupOrder(uint32_t count, std::vector<uint32_t> &order)
+{
+	Random random;
+	order.resize(count);
+	for (uint32_t i = 0; i < count; i++)
+		order[i] = random.Next() % count;
+}
+
+///
+/// SlotMap: insert, random lookup, iteration over the packed values, erase.
+///
+static void BenchSlotMap(uint32_t count, const std::vector<uint32_t> &order)
+{
+	SlotMap<Particle> map;
+	std::vector<Handle> handles(count);
+	uint64_t sum = 0;
+
+	Stopwatch insert;
+	for (uint32_t i = 0; i < count; i++)
+		handles[i] = map.Insert(MakeParticle(i));
+	ReportOps("SlotMap insert", insert.GetSeconds(), count);
+
+	Stopwatch lookup;
+	for (uint32_t i = 0; i < count; i++)
+		sum += (uint64_t)map.Get(handles[order[i]])->x;
+	ReportOps("SlotMap lookup", lookup.GetSeconds(), count);
+
+	Stopwatch iterate;
+	Particle *pValues = map.GetValues();
+	for (uint32_t i = 0; i < map.GetCount(); i++)
+		pValues[i].x += pValues[i].vx;
+	sum += (uint64_t)pValues[count / 2].x;
+	ReportOps("SlotMap iterate", iterate.GetSeconds(), count);
+
+	Stopwatch erase;
+	for (uint32_t i = 0; i < count; i++)
+		map.Erase(handles[i]);
+	ReportOps("SlotMap erase", erase.GetSeconds(), count);
+
+	g_sink += sum;
+}
+
+///
+/// SparseSet keyed by handles issued in order, as World issues entities.
+///
+static void BenchSparseSet(uint32_t count, const std::vector<uint32_t> &order)
+{
+	SparseSet<Particle> set;
+	uint64_t sum = 0;
+
+	Stopwatch insert;
+	for (uint32_t i = 0; i < count; i++)
+		set.Insert(Handle(i, 1), MakeParticle(i));
+	ReportOps("SparseSet insert", insert.GetSeconds(), count);
+
+	Stopwatch lookup;
+	for (uint32_t i = 0; i < count; i++)
+		sum += (uint64_t)set.Get(Handle(order[i], 1))->x;
+	ReportOps("SparseSet lookup", lookup.GetSeconds(), count);
+
+	Stopwatch iterate;
+	Particle *pValues = set.GetValues();
+	for (uint32_t i = 0; i < set.GetCount(); i++)
+		pValues[i].x += pValues[i].vx;
+	sum += (uint64_t)pValues[count / 2].x;
+	ReportOps("SparseSet iterate", iterate.GetSeconds(), count);
+
+	Stopwatch erase;
+	for (uint32_t i = 0; i < count; i++)
+		set.Erase(Handle(i, 1));
+	ReportOps("SparseSet erase", erase.GetSeconds(), count);
+
+	g_sink += sum;
+}
+
+///
+/// The std::unordered_map<id, T> these containers replace.
+///
+static void BenchUnorderedMap(uint32_t count, const std::vector<uint32_t> &order)
+{
+	std::unordered_map<uint32_t, Particle> map;
+	uint64_t sum = 0;
+
+	Stopwatch insert;
+	for (uint32_t i = 0; i < count; i++)
+		map[i] = MakeParticle(i);
+	ReportOps("std::unordered_map insert", insert.GetSeconds(), count);
+
+	Stopwatch lookup;
+	for (uint32_t i = 0; i < count; i++)
+		sum += (uint64_t)map.find(order[i])->second.x;
+	ReportOps("std::unordered_map lookup", lookup.GetSeconds(), count);
+
+	Stopwatch iterate;
+	for (std::unordered_map<uint32_t, Particle>::iterator it = map.begin(); it != map.end(); ++it)
+		it->second.x += it->second.vx;
+	sum += (uint64_t)map[count / 2].x;
+	ReportOps("std::unordered_map iterate", iterate.GetSeconds(), count);
+
+	Stopwatch erase;
+	for (uint32_t i = 0; i < count; i++)
+		map.erase(i);
+	ReportOps("std::unordered_map erase", erase.GetSeconds(), count);
+
+	g_sink += sum;
+}
+
+///
+/// The std::vector<T *> of individually allocated objects these containers replace.
+///
+static void BenchPointerVector(uint32_t count, const std::vector<uint32_t> &order)
+{
+	std::vector<Particle *> objects;
+	uint64_t sum = 0;
+
+	Stopwatch insert;
+	for (uint32_t i = 0; i < count; i++)
+		objects.push_back(new Particle(MakeParticle(i)));
+	ReportOps("std::vector<T *> insert", insert.GetSeconds(), count);
+
+	Stopwatch lookup;
+	for (uint32_t i = 0; i < count; i++)
+		sum += (uint64_t)objects[order[i]]->x;
+	ReportOps("std::vector<T *> lookup", lookup.GetSeconds(), count);
+
+	Stopwatch iterate;
+	for (uint32_t i = 0; i < count; i++)
+		objects[i]->x += objects[i]->vx;
+	sum += (uint64_t)objects[count / 2]->x;
+	ReportOps("std::vector<T *> iterate", iterate.GetSeconds(), count);
+
+	Stopwatch erase;
+	for (uint32_t i = 0; i < count; i++)
+		delete objects[i];
+	objects.clear();
+	ReportOps("std::vector<T *> erase", erase.GetSeconds(), count);
+
+	g_sink += sum;
+}
+
+///
+/// SlotMap and SparseSet against std containers, from 10k objects up to the
+/// Handle::MaxIndices (1,048,576) a handle can address.
+///
+static void BenchContainers()
+{
+	static const uint32_t Counts[] = { 10000, 100000, 1000000 };
+
+	for (int32_t i = 0; i < (int32_t)(sizeof(Counts) / sizeof(Counts[0])); i++)
+	{
+		std::vector<uint32_t> order;
+		MakeLookupOrder(Counts[i], order);
+
+		std::cout << "containers, " << Counts[i] << " objects:\n";
+		BenchSlotMap(Counts[i], order);
+		BenchSparseSet(Counts[i], order);
+		BenchUnorderedMap(Counts[i], order);
+		BenchPointerVector(Counts[i], order);
+	}
+
+	std::cout << "  (handles address at most " << Handle::MaxIndices << " objects, so larger counts are not run)\n";
+}
+
+///
+/// FlatHashMap against std::unordered_map with integer and string keys:
+/// insert, lookups that hit, lookups that miss, erase.
+///
+template <class _Key, class _FlatMap, class _StdMap>
+static void BenchHashMap(const char *label, const std::vector<_Key> &keys, const std::vector<_Key> &missing)
+{
+	uint32_t count = (uint32_t)keys.size();
+	uint64_t found = 0;
+
+	std::cout << "hash maps, " << count << " " << label << " keys:\n";
+
+	{
+		_FlatMap map;
+
+		Stopwatch insert;
+		for (uint32_t i = 0; i < count; i++)
+			map.Insert(keys[i], i);
+		ReportOps("FlatHashMap insert", insert.GetSeconds(), count);
+
+		Stopwatch hit;
+		for (uint32_t i = 0; i < count; i++)
+			found += *map.Find(keys[i]);
+		ReportOps("FlatHashMap find (hit)", hit.GetSeconds(), count);
+
+		Stopwatch miss;
+		for (uint32_t i = 0; i < count; i++)
+			found += (map.Find(missing[i]) != nullptr) ? 1 : 0;
+		ReportOps("FlatHashMap find (miss)", miss.GetSeconds(), count);
+
+		Stopwatch erase;
+		for (uint32_t i = 0; i < count; i++)
+			map.Erase(keys[i]);
+		ReportOps("FlatHashMap erase", erase.GetSeconds(), count);
+	}
+
+	{
+		_StdMap map;
+
+		Stopwatch insert;
+		for (uint32_t i = 0; i < count; i++)
+			map.insert(std::make_pair(keys[i], i));
+		ReportOps("std::unordered_map insert", insert.GetSeconds(), count);
+
+		Stopwatch hit;
+		for (uint32_t i = 0; i < count; i++)
+			found += map.find(keys[i])->second;
+		ReportOps("std::unordered_map find (hit)", hit.GetSeconds(), count);
+
+		Stopwatch miss;
+		for (uint32_t i = 0; i < count; i++)
+			found += (map.find(missing[i]) != map.end()) ? 1 : 0;
+		ReportOps("std::unordered_map find (miss)", miss.GetSeconds(), count);
+
+		Stopwatch erase;
+		for (uint32_t i = 0; i < count; i++)
+			map.erase(keys[i]);
+		ReportOps("std::unordered_map erase", erase.GetSeconds(), count);
+	}
+
+	g_sink += found;
+}
+
+static void BenchHashMaps()
+{
+	static const uint32_t IntegerCount = 1000000;
+	static const uint32_t StringCount = 100000;
+
+	// Keys are spread over 64 bits; the missing keys are odd where the present ones are even.
+	std::vector<uint64_t> integers(IntegerCount), missingIntegers(IntegerCount);
+	for (uint32_t i = 0; i < IntegerCount; i++)
+	{
+		integers[i] = (uint64_t)i * 0x9E3779B97F4A7C16ull;
+		missingIntegers[i] = integers[i] | 1;
+	}
+	BenchHashMap<uint64_t, FlatHashMap<uint64_t, uint32_t>, std::unordered_map<uint64_t, uint32_t> >(
+		"uint64_t", integers, missingIntegers);
+
+	// Asset-like paths.
+	std::vector<std::string> strings(StringCount), missingStrings(StringCount);
+	char path[64];
+	for (uint32_t i = 0; i < StringCount; i++)
+	{
+		_snprintf(path, sizeof(path), "textures/level%u/sprite%u.png", i % 64, i);
+		strings[i] = path;
+		_snprintf(path, sizeof(path), "sounds/level%u/effect%u.ogg", i % 64, i);
+		missingStrings[i] = path;
+	}
+	BenchHashMap<std::string, FlatHashMap<std::string, uint32_t>, std::unordered_map<std::string, uint32_t> >(
+		"string", strings, missingStrings);
+}
+
+///
+/// Fills a buffer with text-like data, about as compressible as game assets.
+///
+static void MakeCompressibleData(std::vector<char> &data)
+{
+	static const char *Words[] = { "sprite", "texture", "player", "enemy", "position", "velocity",
+		"0.000", "1.250", "{", "}", "\n", " ", "\t", "=", ";", "level", "tile", "42", "true", "false" };
+	static const uint32_t WordCount = sizeof(Words) / sizeof(Words[0]);
+
+	Random random;
+	size_t size = 0;
+	while (size < data.size())
+	{
+		const char *word = Words[random.Next() % WordCount];
+		while (*word != 0 && size < data.size())
+			data[size++] = *word++;
+	}
+}
+
+///
+/// Compression and decompression throughput of each supported codec.
+///
+static void BenchCompression()
+{
+	static const int32_t Size = 16 * 1024 * 1024;
+	static const CompressionCodec Codecs[] = { TEKCOMPRESSION_LZ4, TEKCOMPRESSION_ZSTD };
+	static const char *Names[] = { "LZ4", "zstd" };
+
+	std::vector<char> source(Size);
+	MakeCompressibleData(source);
+	std::vector<char> restored(Size);
+
+	std::cout << "compression, " << (Size >> 20) << " MB of text:\n";
+	for (int32_t i = 0; i < 2; i++)
+	{
+		if (!Compression::IsSupported(Codecs[i]))
+		{
+			std::cout << "  " << Names[i] << " is not supported in this build\n";
+			continue;
+		}
+
+		std::vector<char> compressed(Compression::GetBound(Codecs[i], Size));
+
+		Stopwatch compress;
+		int32_t compressedSize = Compression::Compress(Codecs[i], 0, &source[0], Size,
+			&compressed[0], (int32_t)compressed.size());
+		double compressSeconds = compress.GetSeconds();
+
+		Stopwatch decompress;
+		bool decompressed = Compression::Decompress(Codecs[i], &compressed[0], compressedSize, &restored[0], Size);
+		double decompressSeconds = decompress.GetSeconds();
+
+		if (compressedSize <= 0 || !decompressed || memcmp(&source[0], &restored[0], Size) != 0)
+		{
+			std::cout << "  " << Names[i] << " failed to round-trip\n";
+			continue;
+		}
+
+		std::string name = Names[i];
+		Report((name + " compress").c_str(), compressSeconds, Size / compressSeconds / 1e6, "MB/s");
+		Report((name + " decompress").c_str(), decompressSeconds, Size / decompressSeconds / 1e6, "MB/s");
+		std::cout << "  " << name << " ratio " << std::setprecision(2) << (double)Size / compressedSize << ":1\n";
+	}
+}
+
+///
+/// CRC32C and XXH3 throughput over a buffer larger than the caches.
+///
+static void BenchChecksums()
+{
+	static const size_t Size = 64 * 1024 * 1024;
+	static const int32_t Passes = 4;
+
+	std::vector<char> data(Size);
+	MakeCompressibleData(data);
+
+	std::cout << "checksums, " << (Size >> 20) << " MB x " << Passes << ":\n";
+
+	uint64_t result = 0;
+	Stopwatch crc;
+	for (int32_t i = 0; i < Passes; i++)
+		result += Checksum::Crc32c(&data[0], Size);
+	double crcSeconds = crc.GetSeconds() / Passes;
+	Report(Checksum::HasHardwareCrc32c() ? "Crc32c (SSE4.2)" : "Crc32c (table)", crcSeconds, Size / crcSeconds / 1e9, "GB/s");
+
+	Stopwatch xxh64;
+	for (int32_t i = 0; i < Passes; i++)
+		result += Xxh3::Compute64(&data[0], Size);
+	double xxh64Seconds = xxh64.GetSeconds() / Passes;
+	Report("Xxh3::Compute64", xxh64Seconds, Size / xxh64Seconds / 1e9, "GB/s");
+
+	Stopwatch xxh128;
+	for (int32_t i = 0; i < Passes; i++)
+		result += Xxh3::Compute128(&data[0], Size).low;
+	double xxh128Seconds = xxh128.GetSeconds() / Passes;
+	Report("Xxh3::Compute128", xxh128Seconds, Size / xxh128Seconds / 1e9, "GB/s");
+
+	g_sink += result;
+}
+
+#if !defined(TEKSTORM_NO_SCRIPTING)
+static int32_t Add(int32_t left, int32_t right)
+{
+	return left + right;
+}
+
+static tekreal Dot(const Vector2 &left, const Vector2 &right)
+{
+	return Vector2::GetDot(left, right);
+}
+
+///
+/// Each Run function makes n calls from a script loop; RunLoop is the loop alone.
+///
+static const SQChar *BenchScript = _SC(
+	"function RunLoop(n) { local s = 0; for (local i = 0; i < n; i++) s = s + 1; return s; }\n"
+	"function RunSqPlus(n) { local s = 0; for (local i = 0; i < n; i++) s = SqPlusAdd(s, 1); return s; }\n"
+	"function RunFastCall(n) { local s = 0; for (local i = 0; i < n; i++) s = FastAdd(s, 1); return s; }\n"
+	"function RunFastCallVector(n) { local a = Vector2(1, 2); local b = Vector2(3, 4); local s = 0;\n"
+	"  for (local i = 0; i < n; i++) s = FastDot(a, b); return s; }\n");
+
+///
+/// Calls a script function with one integer argument, returning the time it took.
+///
+static double CallScript(HSQUIRRELVM v, const SQChar *name, int32_t n)
+{
+	sq_pushroottable(v);
+	sq_pushstring(v, name, -1);
+	sq_get(v, -2);
+	sq_pushroottable(v);
+	sq_pushinteger(v, n);
+
+	Stopwatch call;
+	if (SQ_FAILED(sq_call(v, 2, SQFalse, SQTrue)))
+		std::cout << "  calling " << name << " failed\n";
+	double seconds = call.GetSeconds();
+
+	sq_pop(v, 2);
+	return seconds;
+}
+
+///
+/// Native calls per second through SqPlus and through FastCall, with the cost of
+/// the script loop itself subtracted.
+///
+static void BenchScripting()
+{
+	static const int32_t Calls = 5000000;
+
+	HSQUIRRELVM v = sq_open(1024);
+	FastCall::RegisterMathTypes(v);
+	FastCall::Register(v, _SC("FastAdd"), &Add);
+	FastCall::Register(v, _SC("FastDot"), &Dot);
+	SqPlus::RegisterGlobal(v, &Add, _SC("SqPlusAdd"));
+
+	// Runs the script body to define its functions in the root table.
+	bool loaded = SQ_SUCCEEDED(sq_compilebuffer(v, BenchScript, (SQInteger)scstrlen(BenchScript), _SC("tekbench"), SQTrue));
+	if (loaded)
+	{
+		sq_pushroottable(v);
+		loaded = SQ_SUCCEEDED(sq_call(v, 1, SQFalse, SQTrue));
+	}
+	sq_settop(v, 0);
+
+	if (!loaded)
+	{
+		std::cout << "scripting: cannot compile the benchmark script\n";
+		sq_close(v);
+		return;
+	}
+
+	std::cout << "scripting, " << Calls << " calls:\n";
+
+	double loop = CallScript(v, _SC("RunLoop"), Calls);
+	Report("script loop alone", loop, Calls / loop / 1e6, "M iter/s");
+
+	double sqplus = CallScript(v, _SC("RunSqPlus"), Calls) - loop;
+	Report("SqPlus Add(int, int)", sqplus, Calls / sqplus / 1e6, "M calls/s");
+
+	double fast = CallScript(v, _SC("RunFastCall"), Calls) - loop;
+	Report("FastCall Add(int, int)", fast, Calls / fast / 1e6, "M calls/s");
+
+	double vector = CallScript(v, _SC("RunFastCallVector"), Calls) - loop;
+	Report("FastCall Dot(Vector2, Vector2)", vector, Calls / vector / 1e6, "M calls/s");
+
+	sq_close(v);
+}
+#endif
+
+///
+/// A benchmark that can be picked by name on the command line.
+///
+struct Benchmark
+{
+	const char *name;
+	void (*run)();
+};
+
+static const Benchmark Benchmarks[] =
+{
+	{ "containers", &BenchContainers },
+	{ "hashmaps", &BenchHashMaps },
+	{ "compression", &BenchCompression },
+	{ "checksums", &BenchChecksums },
+#if !defined(TEKSTORM_NO_SCRIPTING)
+	{ "scripting", &BenchScripting },
+#endif
+};
+
+static const int32_t BenchmarkCount = (int32_t)(sizeof(Benchmarks) / sizeof(Benchmarks[0]));
+
+///
+/// tekbench [benchmark]...
+///
+/// Measures the engine's hot paths against the code they replaced:
+/// containers   SlotMap and SparseSet against std::unordered_map and std::vector<T *>
+/// hashmaps     FlatHashMap against std::unordered_map
+/// compression  LZ4 and zstd compression and decompression MB/s
+/// checksums    CRC32C and XXH3 GB/s
+/// scripting    native calls per second through SqPlus and FastCall
+///
+/// With no arguments every benchmark is run. Build in Release for meaningful
+/// numbers.
+///
+int main(int argc, char **argv)
+{
+	for (int i = 1; i < argc; i++)
+	{
+		bool known = false;
+		for (int32_t j = 0; j < BenchmarkCount && !known; j++)
+			known = (strcmp(argv[i], Benchmarks[j].name) == 0);
+
+		if (!known)
+		{
+			std::cerr << "usage: tekbench";
+			for (int32_t j = 0; j < BenchmarkCount; j++)
+				std::cerr << " [" << Benchmarks[j].name << "]";
+			std::cerr << "\n";
+			return 1;
+		}
+	}
+
+	TimeConstants::InitConstants();
+
+	for (int32_t i = 0; i < BenchmarkCount; i++)
+	{
+		bool selected = (argc < 2);
+		for (int j = 1; j < argc && !selected; j++)
+			selected = (strcmp(argv[j], Benchmarks[i].name) == 0);
+
+		if (selected)
+			Benchmarks[i].run();
+	}
+
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,99 @@
+#include "../../IO/ArchiveWriter.h"
+#include "../../core/JobSystem.h"
+
+using namespace Tekstorm;
+using namespace IO;
+using namespace Core;
+
+///
+/// Adds every file under a directory, named by its path relative to the root.
+///
+static bool AddDirectory(ArchiveWriter &writer, const std::string &root, const std::string &relative,
+	ArchiveCompression compression)
+{
+	std::string directory = relative.empty() ? root : root + "\\" + relative;
+
+	WIN32_FIND_DATAA data;
+	HANDLE hFind = FindFirstFileA((directory + "\\*").c_str(), &data);
+	if (hFind == INVALID_HANDLE_VALUE)
+	{
+		std::cerr << "tekpak: cannot read " << directory << "\n";
+		return false;
+	}
+
+	bool ok = true;
+	do
+	{
+		std::string name = data.cFileName;
+		if (name == "." || name == "..")
+			continue;
+
+		std::string path = relative.empty() ? name : relative + "/" + name;
+		if ((data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0)
+			ok = AddDirectory(writer, root, path, compression) && ok;
+		else
+			writer.AddFile(path, directory + "\\" + name, compression);
+	}
+	while (FindNextFileA(hFind, &data) != FALSE);
+
+	FindClose(hFind);
+	return ok;
+}
+
+///
+/// tekpak [-lz4 | -zstd[=level]] <archive.tekpak> <directory>...
+///
+/// Packs the files under each directory into a .tekpak archive. Entries are named
+/// by their path relative to the directory they were found under, i.e.
+/// "textures/player.png". With -lz4 or -zstd, files are compressed on all cores
+/// and kept compressed where that makes them smaller.
+///
+int main(int argc, char **argv)
+{
+	ArchiveCompression compression = TEKPAK_COMPRESSION_NONE;
+	int32_t level = 0;
+
+	int first = 1;
+	if (first < argc && strcmp(argv[first], "-lz4") == 0)
+	{
+		compression = TEKPAK_COMPRESSION_LZ4;
+		first++;
+	}
+	else if (first < argc && strncmp(argv[first], "-zstd", 5) == 0)
+	{
+		compression = TEKPAK_COMPRESSION_ZSTD;
+		if (argv[first][5] == '=')
+			level = atoi(argv[first] + 6);
+		first++;
+	}
+
+	if (argc - first < 2)
+	{
+		std::cerr << "usage: tekpak [-lz4 | -zstd[=level]] <archive.tekpak> <directory>...\n";
+		return 1;
+	}
+
+	JobSystem jobs;
+	jobs.Start();
+
+	ArchiveWriter writer(&jobs);
+	writer.SetLevel(level);
+	for (int i = first + 1; i < argc; i++)
+	{
+		if (!AddDirectory(writer, argv[i], "", compression))
+			return 1;
+	}
+
+	const char *pArchivePath = argv[first];
+	bool written = writer.Write(pArchivePath);
+	jobs.Stop();
+
+	if (!written)
+	{
+		std::cerr << "tekpak: cannot write " << pArchivePath << "\n";
+		return 1;
+	}
+
+	std::cout << "tekpak: packed " << writer.GetCount() << " files into " << pArchivePath << "\n";
+	return 0;
+}
\ No newline at end of file
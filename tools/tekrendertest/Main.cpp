@@ -0,0 +1,198 @@
+#include "../../graphics/SpriteBatch.h"
+#include "../../graphics/SoftwareGraphicsDevice.h"
+#include "../../graphics/ImageDecoder.h"
+
+using namespace Tekstorm;
+using namespace Core;
+using namespace Graphics;
+using namespace Math;
+
+///
+/// The size of the framebuffer; it spans four tiles so binning is exercised.
+///
+static const int32_t FrameWidth = 128;
+static const int32_t FrameHeight = 128;
+
+///
+/// The number of checks that failed.
+///
+static int32_t g_failures = 0;
+
+///
+/// Reports a failed check.
+///
+static void Check(bool condition, const char *description)
+{
+	if (!condition)
+	{
+		std::cerr << "tekrendertest: FAILED " << description << "\n";
+		g_failures++;
+	}
+}
+
+///
+/// Checks the position and texture coordinates of a built vertex.
+///
+static void CheckVertex(const std::vector<SpriteVertex> &vertices, int32_t index, float x, float y, float tu, float tv,
+	const char *description)
+{
+	Check(index < (int32_t)vertices.size() && vertices[index].x == x && vertices[index].y == y
+		&& vertices[index].tu == tu && vertices[index].tv == tv, description);
+}
+
+///
+/// Checks a built draw call.
+///
+static void CheckDrawCall(const std::vector<SpriteDrawCall> &drawCalls, int32_t index, TextureKey texture, BlendMode blend,
+	int32_t baseVertex, int32_t indexCount, const char *description)
+{
+	Check(index < (int32_t)drawCalls.size() && drawCalls[index].texture == texture && drawCalls[index].blend == blend
+		&& drawCalls[index].baseVertex == baseVertex && drawCalls[index].indexCount == indexCount, description);
+}
+
+///
+/// Renders a batch as a renderer would submit it.
+///
+static void Render(SoftwareGraphicsDevice &device, const SpriteBatch &batch)
+{
+	const std::vector<SpriteDrawCall> &drawCalls = batch.GetDrawCalls();
+	const std::vector<SpriteVertex> &vertices = batch.GetVertices();
+	const std::vector<uint16_t> &indices = batch.GetIndices();
+
+	device.Clear(Color4(0.0f, 0.0f, 0.25f, 1.0f));
+	for (size_t i = 0; i < drawCalls.size(); i++)
+	{
+		device.SetTexture(drawCalls[i].texture);
+		device.SetBlendMode(drawCalls[i].blend);
+		device.DrawIndexed(&vertices[0], &indices[0], drawCalls[i].indexCount, drawCalls[i].baseVertex);
+	}
+	device.Present();
+}
+
+///
+/// Checks a frame against the reference image, allowing for rounding in the
+/// last bit of a channel.
+///
+static void CheckFrame(const SoftwareGraphicsDevice &device, const SoftwareTexture &reference, const char *description)
+{
+	int32_t mismatches = device.Compare(reference.GetPixels(), 1);
+	if (mismatches > 0)
+		std::cerr << "tekrendertest: " << mismatches << " pixels differ from the reference\n";
+	Check(mismatches == 0, description);
+}
+
+///
+/// tekrendertest [-update] <reference.bmp>
+///
+/// Renders a fixed SpriteBatch through the SoftwareGraphicsDevice, checks the
+/// vertices, indices and draw calls the batch built, and compares the frame
+/// with a reference image (tools\tekrendertest\reference.bmp). The frame is
+/// rendered twice, on the calling thread and with its tiles spread over a
+/// JobSystem, and both must match. On a mismatch the frames are saved next to
+/// the reference as <reference>.actual.bmp and <reference>.parallel.bmp. With
+/// -update, the reference is rewritten from the frame instead.
+///
+/// Exits with 0 when every check passes.
+///
+int main(int argc, char **argv)
+{
+	bool update = (argc > 1 && strcmp(argv[1], "-update") == 0);
+	int first = update ? 2 : 1;
+	if (argc - first != 1)
+	{
+		std::cerr << "usage: tekrendertest [-update] <reference.bmp>\n";
+		return 1;
+	}
+	std::string referencePath = argv[first];
+
+	// An 8x8 checkerboard of 2x2 white and grey squares.
+	SoftwareTexture checker(8, 8);
+	uint32_t *pTexels = checker.GetPixels();
+	for (int32_t y = 0; y < 8; y++)
+	{
+		for (int32_t x = 0; x < 8; x++)
+			pTexels[y * 8 + x] = (((x >> 1) + (y >> 1)) & 1) ? SoftwareTexture::PackColor(Color4(0.25f, 0.25f, 0.25f, 1.0f)) : 0xFFFFFFFF;
+	}
+
+	SpriteBatch batch;
+	batch.Begin(TEKSPRITESORT_TEXTURE);
+	batch.Draw(nullptr, Vector2(8, 8), Vector2(48, 48), Color4(1.0f, 0.0f, 0.0f, 1.0f));
+	batch.Draw(&checker, Vector2(40, 40), Vector2(64, 64), Color4(1.0f, 1.0f, 1.0f, 1.0f));
+	batch.Draw(nullptr, Vector2(80, 16), Vector2(32, 32), Color4(0.0f, 1.0f, 0.0f, 0.5f));
+	batch.Draw(&checker, Vector2(16, 88), Vector2(32, 32), Vector4(0.0f, 0.0f, 0.5f, 0.5f), Color4(0.5f, 0.5f, 1.0f, 1.0f),
+		0, Vector2::Zero, Vector2::One, 0, TEKBLEND_ADDITIVE);
+	batch.End();
+
+	// Sorted by blend mode, then texture: both untextured sprites share the first call.
+	const std::vector<SpriteDrawCall> &drawCalls = batch.GetDrawCalls();
+	Check(batch.GetSpriteCount() == 4, "four sprites are queued");
+	Check(drawCalls.size() == 3, "the batch builds three draw calls");
+	CheckDrawCall(drawCalls, 0, nullptr, TEKBLEND_ALPHA, 0, 12, "draw call 0 is both untextured alpha sprites");
+	CheckDrawCall(drawCalls, 1, &checker, TEKBLEND_ALPHA, 8, 6, "draw call 1 is the textured alpha sprite");
+	CheckDrawCall(drawCalls, 2, &checker, TEKBLEND_ADDITIVE, 12, 6, "draw call 2 is the additive sprite");
+
+	// Corners run top-left, top-right, bottom-right, bottom-left.
+	const std::vector<SpriteVertex> &vertices = batch.GetVertices();
+	Check(vertices.size() == 16, "the batch builds four vertices per sprite");
+	CheckVertex(vertices, 0, 8, 8, 0, 0, "vertex 0 is the red sprite's top-left corner");
+	CheckVertex(vertices, 2, 56, 56, 1, 1, "vertex 2 is the red sprite's bottom-right corner");
+	CheckVertex(vertices, 5, 112, 16, 1, 0, "vertex 5 is the green sprite's top-right corner");
+	CheckVertex(vertices, 11, 40, 104, 0, 1, "vertex 11 is the checker sprite's bottom-left corner");
+	CheckVertex(vertices, 14, 48, 120, 0.5f, 0.5f, "vertex 14 is the additive sprite's bottom-right corner");
+	Check(vertices.size() == 16 && vertices[4].g == 1.0f && vertices[4].a == 0.5f, "the green sprite keeps its color");
+
+	const std::vector<uint16_t> &indices = batch.GetIndices();
+	static const uint16_t ExpectedIndices[] = { 0, 1, 2, 0, 2, 3, 4, 5, 6, 4, 6, 7 };
+	bool indicesMatch = (indices.size() >= 12);
+	for (int32_t i = 0; i < 12 && indicesMatch; i++)
+		indicesMatch = (indices[i] == ExpectedIndices[i]);
+	Check(indicesMatch, "the index stream covers two sprites of two clockwise triangles");
+
+	if (g_failures > 0)
+		return 1;
+
+	SoftwareGraphicsDevice device(FrameWidth, FrameHeight);
+	Render(device, batch);
+
+	JobSystem jobs;
+	jobs.Start();
+	SoftwareGraphicsDevice parallelDevice(FrameWidth, FrameHeight, &jobs);
+	Render(parallelDevice, batch);
+	jobs.Stop();
+
+	if (update)
+	{
+		if (!device.SaveScreenshot(referencePath))
+		{
+			std::cerr << "tekrendertest: cannot write " << referencePath << "\n";
+			return 1;
+		}
+
+		std::cout << "tekrendertest: updated " << referencePath << "\n";
+		return 0;
+	}
+
+	SoftwareTexture reference;
+	if (!ImageDecoder::LoadFromFile(referencePath, &reference))
+	{
+		std::cerr << "tekrendertest: cannot read " << referencePath << "\n";
+		return 1;
+	}
+
+	Check(reference.GetWidth() == FrameWidth && reference.GetHeight() == FrameHeight, "the reference image is 128x128");
+	if (g_failures == 0)
+	{
+		CheckFrame(device, reference, "the frame matches the reference image");
+		CheckFrame(parallelDevice, reference, "the frame rendered on the job system matches the reference image");
+	}
+
+	if (g_failures > 0)
+	{
+		device.SaveScreenshot(referencePath + ".actual.bmp");
+		parallelDevice.SaveScreenshot(referencePath + ".parallel.bmp");
+		return 1;
+	}
+
+	std::cout << "tekrendertest: passed\n";
+	return 0;
+}
\ No newline at end of file